@@ -0,0 +1,483 @@
+// List rendering harness: the song lists of the Downloads, Search, Liked
+// Songs and radio pages, filled with synthetic tracks on the offscreen QPA.
+//
+// Per page it reports
+//   populate      time to build the rows (page constructor / setTracks /
+//                 typing a query / RadioSongListModel::setEntries)
+//   frame         time per scroll step: scroll by a quarter page, process
+//                 the resulting layout events, repaint the viewport
+//   row memory    resident set growth per row after the first paint
+//   track change  time to react to the playing track moving to another row
+//                 (pages that don't follow playback report n/a)
+//
+// Results are checked against a budgets file (benchmarks/data/
+// list_budgets.json by default); any overrun is listed on stderr and the
+// exit code is 1.
+//
+// Usage: bench_listrender [--tracks N] [--frames N] [--pages downloaded,search,liked,radio]
+//                         [--budgets FILE] [--json]
+
+#include "corpusgenerator.h"
+#include "config/appconfig.h"
+#include "models/playlistdata.h"
+#include "models/radiosonglistmodel.h"
+#include "services/musicstorageservice.h"
+#include "services/playerservice.h"
+#include "services/thumbnailcache.h"
+#include "ui/downloadedpage.h"
+#include "ui/likedsongs.h"
+#include "ui/radiosongdelegate.h"
+#include "ui/searchpage.h"
+
+#include <QAbstractItemView>
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLineEdit>
+#include <QListView>
+#include <QLoggingCategory>
+#include <QScrollBar>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#endif
+
+namespace {
+
+constexpr int kWindowWidth = 1200;
+constexpr int kWindowHeight = 800;
+constexpr int kLibraryTimeoutMs = 120000;
+
+struct PageResult {
+    QString page;
+    int rows = 0;
+    double populateMs = 0;
+    double frameMsP50 = 0;
+    double frameMsP95 = 0;
+    double frameMsMax = 0;
+    double rowKb = -1;          // -1: resident size not available
+    double trackChangeMs = -1;  // -1: page doesn't follow playback
+};
+
+// ========== Measurement ==========
+
+qint64 residentBytes()
+{
+#if defined(Q_OS_LINUX)
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return qint64(counters.WorkingSetSize);
+    }
+#elif defined(Q_OS_MACOS)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        return qint64(info.resident_size);
+    }
+#endif
+    return -1;
+}
+
+double elapsedMs(const std::function<void()> &fn)
+{
+    QElapsedTimer timer;
+    timer.start();
+    fn();
+    return timer.nsecsElapsed() / 1e6;
+}
+
+void settle()
+{
+    // Twice: the first pass runs delayed layouts, which post repaints
+    QCoreApplication::processEvents();
+    QCoreApplication::processEvents();
+}
+
+double percentile(QVector<double> samples, int percent)
+{
+    if (samples.isEmpty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    const int index = qMin(int(samples.size()) - 1, int(samples.size()) * percent / 100);
+    return samples[index];
+}
+
+void showPage(QWidget *page)
+{
+    page->resize(kWindowWidth, kWindowHeight);
+    page->show();
+    settle();
+}
+
+// Scroll the page's list top to bottom (wrapping) a quarter page per frame
+void measureFrames(QWidget *page, int frames, PageResult &result)
+{
+    QAbstractItemView *view = page->findChild<QAbstractItemView*>();
+    if (!view) {
+        return;
+    }
+
+    QScrollBar *bar = view->verticalScrollBar();
+    const int step = qMax(1, bar->pageStep() / 4);
+
+    QVector<double> samples;
+    samples.reserve(frames);
+    for (int frame = 0; frame < frames; ++frame) {
+        const int next = bar->value() + step;
+        samples.append(elapsedMs([&]() {
+            bar->setValue(next > bar->maximum() ? 0 : next);
+            QCoreApplication::processEvents();
+            view->viewport()->repaint();
+        }));
+    }
+
+    result.frameMsP50 = percentile(samples, 50);
+    result.frameMsP95 = percentile(samples, 95);
+    result.frameMsMax = percentile(samples, 100);
+}
+
+// Build the page, show it, and charge resident growth to its rows
+template <typename Populate>
+std::unique_ptr<QWidget> buildPage(PageResult &result, const Populate &populate)
+{
+    settle();
+    const qint64 before = residentBytes();
+
+    std::unique_ptr<QWidget> page;
+    result.populateMs = elapsedMs([&]() { page = populate(); });
+    showPage(page.get());
+
+    const qint64 after = residentBytes();
+    if (before >= 0 && after >= 0 && result.rows > 0) {
+        result.rowKb = qMax<qint64>(0, after - before) / 1024.0 / result.rows;
+    }
+    return page;
+}
+
+// ========== Pages ==========
+
+// Empty song files plus a matching playlist.json, so the library loads
+// from the snapshot without extracting anything
+bool prepareLibrary(const QList<Track> &tracks)
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QCoreApplication::setOrganizationName(AppConfig::ORGANIZATION_NAME);
+    QCoreApplication::setApplicationName("EKNMusicBenchLists");
+    QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).removeRecursively();
+
+    MusicStorageService *storage = MusicStorageService::instance();
+    PlaylistData snapshot;
+    for (int i = 0; i < tracks.size(); ++i) {
+        TrackData data;
+        data.filePath = storage->musicDirectory() + QString("/list_%1.mp3").arg(i, 6, 10, QChar('0'));
+        data.title = tracks[i].title();
+        data.artist = tracks[i].artist();
+        data.album = tracks[i].album();
+        data.duration = tracks[i].duration();
+        data.dateAdded = tracks[i].dateAdded();
+
+        QFile song(data.filePath);
+        if (!song.open(QIODevice::WriteOnly)) {
+            QTextStream(stderr) << "Cannot create " << data.filePath << "\n";
+            return false;
+        }
+        snapshot.setTrackData(data.filePath, data);
+    }
+    if (!snapshot.saveToFile(storage->playlistDataFilePath())) {
+        return false;
+    }
+
+    storage->loadLibrary();
+    QElapsedTimer timer;
+    timer.start();
+    while (!storage->isLibraryLoaded() || storage->isScanning()) {
+        if (timer.elapsed() > kLibraryTimeoutMs) {
+            QTextStream(stderr) << "Library did not load\n";
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+    return true;
+}
+
+bool runDownloaded(const QList<Track> &tracks, int frames, PageResult &result)
+{
+    if (!prepareLibrary(tracks)) {
+        return false;
+    }
+
+    const QList<Track> library = MusicStorageService::instance()->getDownloadedTracks();
+    result.rows = library.size();
+    std::unique_ptr<QWidget> page = buildPage(result, []() {
+        return std::make_unique<DownloadedSongsPage>();
+    });
+    measureFrames(page.get(), frames, result);
+
+    // What PlayerService emits when playback moves to another song
+    PlayerService *player = PlayerService::instance();
+    result.trackChangeMs = elapsedMs([&]() {
+        emit player->trackChanged(library[library.size() / 2]);
+        settle();
+    });
+    return true;
+}
+
+void runSearch(const QList<Track> &tracks, int frames, PageResult &result)
+{
+    // Every synthetic title and artist has a space in it, so " " lists
+    // the whole catalog
+    result.rows = tracks.size();
+    std::unique_ptr<QWidget> page = buildPage(result, [&]() {
+        auto search = std::make_unique<SearchPage>();
+        search->setCatalog(tracks);
+        search->findChild<QLineEdit*>()->setText(" ");
+        return search;
+    });
+    measureFrames(page.get(), frames, result);
+}
+
+void runLiked(const QList<Track> &tracks, int frames, PageResult &result)
+{
+    result.rows = tracks.size();
+    std::unique_ptr<QWidget> page = buildPage(result, [&]() {
+        auto liked = std::make_unique<LikedSongsPage>();
+        liked->setTracks(tracks);
+        return liked;
+    });
+    measureFrames(page.get(), frames, result);
+}
+
+// Same view setup as BaseRadioPage::setupRightPanel
+QList<RadioSongListModel::Entry> radioEntries(const QList<Track> &tracks, int current)
+{
+    using Slot = RadioSongListModel::Slot;
+    QList<RadioSongListModel::Entry> entries;
+    entries.reserve(tracks.size());
+    for (int i = 0; i < tracks.size(); ++i) {
+        RadioSongInfo song;
+        song.id = QString::number(i);
+        song.title = tracks[i].title();
+        song.artist = tracks[i].artist();
+        song.album = tracks[i].album();
+        song.duration = int(tracks[i].duration() / 1000);
+        entries.append({song, i < current ? Slot::Previous : i == current ? Slot::Current : Slot::Next});
+    }
+    return entries;
+}
+
+void runRadio(const QList<Track> &tracks, int frames, PageResult &result)
+{
+    RadioSongListModel *model = nullptr;
+    const int current = tracks.size() / 2;
+
+    result.rows = tracks.size();
+    std::unique_ptr<QWidget> page = buildPage(result, [&]() {
+        auto panel = std::make_unique<QWidget>();
+        ThumbnailCache *thumbnails = new ThumbnailCache(
+            QSize(RadioSongDelegate::kThumbnailSize, RadioSongDelegate::kThumbnailSize), panel.get());
+        model = new RadioSongListModel(thumbnails, panel.get());
+
+        QListView *view = new QListView(panel.get());
+        view->setModel(model);
+        view->setItemDelegate(new RadioSongDelegate(view));
+        view->setUniformItemSizes(true);
+        view->setSelectionMode(QAbstractItemView::NoSelection);
+        view->setGeometry(0, 0, kWindowWidth, kWindowHeight);
+
+        model->setEntries(radioEntries(tracks, current));
+        return panel;
+    });
+    measureFrames(page.get(), frames, result);
+
+    // Next song starts: one row becomes PREVIOUS, the following one NOW PLAYING
+    result.trackChangeMs = elapsedMs([&]() {
+        model->setEntries(radioEntries(tracks, current + 1));
+        settle();
+    });
+}
+
+// ========== Budgets ==========
+
+struct Budget {
+    double populateMs = -1;
+    double frameMsP95 = -1;
+    double rowKb = -1;
+    double trackChangeMs = -1;
+};
+
+Budget budgetFor(const QJsonObject &budgets, const QString &page)
+{
+    Budget budget;
+    for (const QJsonObject &source : {budgets["default"].toObject(),
+                                      budgets["pages"].toObject()[page].toObject()}) {
+        budget.populateMs = source["populate_ms"].toDouble(budget.populateMs);
+        budget.frameMsP95 = source["frame_ms_p95"].toDouble(budget.frameMsP95);
+        budget.rowKb = source["row_kb"].toDouble(budget.rowKb);
+        budget.trackChangeMs = source["track_change_ms"].toDouble(budget.trackChangeMs);
+    }
+    return budget;
+}
+
+QStringList checkBudget(const PageResult &result, const Budget &budget)
+{
+    QStringList overruns;
+    auto check = [&](const char *name, double value, double limit) {
+        if (limit >= 0 && value >= 0 && value > limit) {
+            overruns << QString("%1 %2: %3 > %4").arg(result.page, QString::fromLatin1(name))
+                            .arg(value, 0, 'f', 2).arg(limit, 0, 'f', 2);
+        }
+    };
+    check("populate_ms", result.populateMs, budget.populateMs);
+    check("frame_ms_p95", result.frameMsP95, budget.frameMsP95);
+    check("row_kb", result.rowKb, budget.rowKb);
+    check("track_change_ms", result.trackChangeMs, budget.trackChangeMs);
+    return overruns;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    int tracks = -1;
+    int frames = 120;
+    QStringList pages = {"downloaded", "search", "liked", "radio"};
+    QString budgetsPath = QStringLiteral(BENCH_DATA_DIR) + "/list_budgets.json";
+    bool jsonOutput = false;
+
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--tracks" && i + 1 < argc) {
+            tracks = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frames = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--pages" && i + 1 < argc) {
+            pages = QString::fromLocal8Bit(argv[++i]).split(',', Qt::SkipEmptyParts);
+        } else if (arg == "--budgets" && i + 1 < argc) {
+            budgetsPath = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--json") {
+            jsonOutput = true;
+        }
+    }
+
+    QApplication app(argc, argv);
+    AppConfig::initializeApp();
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    QJsonObject budgets;
+    QFile budgetsFile(budgetsPath);
+    if (budgetsFile.open(QIODevice::ReadOnly)) {
+        budgets = QJsonDocument::fromJson(budgetsFile.readAll()).object();
+    } else {
+        QTextStream(stderr) << "No budgets file at " << budgetsPath << ", reporting only\n";
+    }
+    // Budgets are written for a row count; use it unless told otherwise
+    if (tracks < 0) {
+        tracks = budgets["tracks"].toInt(1000);
+    }
+
+    const QList<Track> synthetic = CorpusGenerator::syntheticTracks(tracks);
+    QVector<PageResult> results;
+    for (const QString &name : std::as_const(pages)) {
+        PageResult result;
+        result.page = name;
+        if (name == "downloaded") {
+            if (!runDownloaded(synthetic, frames, result)) {
+                return 1;
+            }
+        } else if (name == "search") {
+            runSearch(synthetic, frames, result);
+        } else if (name == "liked") {
+            runLiked(synthetic, frames, result);
+        } else if (name == "radio") {
+            runRadio(synthetic, frames, result);
+        } else {
+            QTextStream(stderr) << "Unknown page " << name << "\n";
+            return 2;
+        }
+        results.append(result);
+    }
+
+    QStringList overruns;
+    for (const PageResult &result : std::as_const(results)) {
+        overruns << checkBudget(result, budgetFor(budgets, result.page));
+    }
+
+    QTextStream out(stdout);
+    if (jsonOutput) {
+        QJsonArray cases;
+        for (const PageResult &result : std::as_const(results)) {
+            QJsonObject entry;
+            entry["page"] = result.page;
+            entry["rows"] = result.rows;
+            entry["populate_ms"] = result.populateMs;
+            entry["frame_ms_p50"] = result.frameMsP50;
+            entry["frame_ms_p95"] = result.frameMsP95;
+            entry["frame_ms_max"] = result.frameMsMax;
+            entry["row_kb"] = result.rowKb;
+            entry["track_change_ms"] = result.trackChangeMs;
+            cases.append(entry);
+        }
+        QJsonObject root;
+        root["benchmark"] = "listrender";
+        root["tracks"] = tracks;
+        root["frames"] = frames;
+        root["cases"] = cases;
+        root["overruns"] = QJsonArray::fromStringList(overruns);
+        out << QJsonDocument(root).toJson(QJsonDocument::Indented);
+    } else {
+        auto ms = [](double value) {
+            return value < 0 ? QString("n/a") : QString::number(value, 'f', 2) + " ms";
+        };
+        out << QString("%1 %2 %3 %4 %5 %6 %7\n")
+                   .arg("page", -12).arg("rows", 7).arg("populate", 12).arg("frame p50", 11)
+                   .arg("frame p95", 11).arg("row mem", 10).arg("track change", 13);
+        for (const PageResult &result : std::as_const(results)) {
+            out << QString("%1 %2 %3 %4 %5 %6 %7\n")
+                       .arg(result.page, -12)
+                       .arg(result.rows, 7)
+                       .arg(ms(result.populateMs), 12)
+                       .arg(ms(result.frameMsP50), 11)
+                       .arg(ms(result.frameMsP95), 11)
+                       .arg(result.rowKb < 0 ? QString("n/a") : QString::number(result.rowKb, 'f', 1) + " KB", 10)
+                       .arg(ms(result.trackChangeMs), 13);
+        }
+    }
+    out.flush();
+
+    for (const QString &overrun : std::as_const(overruns)) {
+        QTextStream(stderr) << "Over budget: " << overrun << "\n";
+    }
+    return overruns.isEmpty() ? 0 : 1;
+}
@@ -0,0 +1,262 @@
+// Radio payload parsing benchmark: QJsonDocument DOM vs. NowPlayingParser.
+//
+// Runs both parsers over captured AzuraCast payloads in benchmarks/data and
+// reports per-parse time. The DOM variant is the code RadioService and
+// NowPlayingFeed used before they switched to the pull parser.
+//
+// Usage: bench_radiojson [--iterations N] [--json] [--data DIR]
+
+#include "services/nowplayingparser.h"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+// ========== Baseline (QJsonDocument) ==========
+
+RadioSongInfo domParseSong(const QJsonObject &songObj)
+{
+    RadioSongInfo info;
+    info.id = songObj["id"].toString();
+    info.title = songObj["title"].toString("Unknown");
+    info.artist = songObj["artist"].toString("Unknown");
+    info.album = songObj["album"].toString();
+    info.artUrl = songObj["art"].toString();
+    info.duration = songObj["duration"].toInt(0);
+    return info;
+}
+
+RadioState domParseState(const QJsonObject &obj)
+{
+    RadioState state;
+    RadioNowPlayingInfo &info = state.nowPlaying;
+
+    QJsonObject station = obj["station"].toObject();
+    info.stationName = station["name"].toString();
+    info.isOnline = obj["is_online"].toBool(false);
+
+    QJsonObject nowPlaying = obj["now_playing"].toObject();
+    info.song = domParseSong(nowPlaying["song"].toObject());
+    info.elapsed = nowPlaying["elapsed"].toInt(0);
+    info.duration = nowPlaying["duration"].toInt(0);
+    info.remaining = nowPlaying["remaining"].toInt(0);
+
+    info.listeners = obj["listeners"].toObject()["current"].toInt(0);
+
+    const QJsonArray historyArray = obj["song_history"].toArray();
+    for (const QJsonValue &val : historyArray) {
+        state.history.append(domParseSong(val.toObject()["song"].toObject()));
+    }
+
+    QJsonObject playingNext = obj["playing_next"].toObject();
+    if (!playingNext.isEmpty()) {
+        state.queue.append(domParseSong(playingNext["song"].toObject()));
+    }
+    return state;
+}
+
+RadioState domParseNowPlaying(const QByteArray &json)
+{
+    return domParseState(QJsonDocument::fromJson(json).object());
+}
+
+RadioState domParseFeedMessage(const QByteArray &json)
+{
+    QJsonObject message = QJsonDocument::fromJson(json).object();
+    QJsonObject subs = message["connect"].toObject()["subs"].toObject();
+    for (auto it = subs.constBegin(); it != subs.constEnd(); ++it) {
+        QJsonArray publications = it.value().toObject()["publications"].toArray();
+        if (!publications.isEmpty()) {
+            return domParseState(publications.last().toObject()["data"].toObject()["np"].toObject());
+        }
+    }
+    return RadioState();
+}
+
+QList<RadioSongInfo> domParseSongList(const QByteArray &json)
+{
+    QList<RadioSongInfo> songs;
+    const QJsonArray arr = QJsonDocument::fromJson(json).array();
+    for (const QJsonValue &val : arr) {
+        songs.append(domParseSong(val.toObject()["song"].toObject()));
+    }
+    return songs;
+}
+
+// ========== Pull parser ==========
+
+RadioState pullParseNowPlaying(const QByteArray &json)
+{
+    RadioState state;
+    NowPlayingParser::parseNowPlaying(json, state);
+    return state;
+}
+
+RadioState pullParseFeedMessage(const QByteArray &json)
+{
+    // Mirrors NowPlayingFeed: slice out "np", copy it, then parse the copy
+    RadioState state;
+    QList<NowPlayingPayload> payloads;
+    if (NowPlayingParser::extractFeedPayloads(json, payloads)) {
+        NowPlayingParser::parseNowPlaying(payloads.last().json.toByteArray(), state);
+    }
+    return state;
+}
+
+QList<RadioSongInfo> pullParseSongList(const QByteArray &json)
+{
+    QList<RadioSongInfo> songs;
+    NowPlayingParser::parseSongList(json, songs);
+    return songs;
+}
+
+// ========== Harness ==========
+
+struct Result {
+    QString name;
+    qsizetype bytes = 0;
+    double domNs = 0;
+    double pullNs = 0;
+};
+
+bool sameState(const RadioState &a, const RadioState &b)
+{
+    const RadioNowPlayingInfo &x = a.nowPlaying;
+    const RadioNowPlayingInfo &y = b.nowPlaying;
+    return x.song == y.song && x.stationName == y.stationName && x.elapsed == y.elapsed
+        && x.duration == y.duration && x.remaining == y.remaining
+        && x.listeners == y.listeners && x.isOnline == y.isOnline
+        && a.history == b.history && a.queue == b.queue;
+}
+
+// Median nanoseconds per call over a few batches
+double measure(const std::function<void()> &fn, int iterations)
+{
+    constexpr int kBatches = 7;
+    for (int i = 0; i < iterations / 10 + 1; ++i) {
+        fn(); // Warm up
+    }
+
+    QVector<double> samples;
+    for (int batch = 0; batch < kBatches; ++batch) {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            fn();
+        }
+        samples.append(double(timer.nsecsElapsed()) / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[kBatches / 2];
+}
+
+QByteArray loadPayload(const QString &dir, const QString &name)
+{
+    QFile file(dir + "/" + name);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QTextStream(stderr) << "Cannot open " << file.fileName() << "\n";
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int iterations = 2000;
+    bool jsonOutput = false;
+    QString dataDir = QStringLiteral(BENCH_DATA_DIR);
+
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--json") {
+            jsonOutput = true;
+        } else if (arg == "--data" && i + 1 < argc) {
+            dataDir = QString::fromLocal8Bit(argv[++i]);
+        }
+    }
+
+    const QByteArray nowPlaying = loadPayload(dataDir, "nowplaying_eknm_intercom.json");
+    const QByteArray feedMessage = loadPayload(dataDir, "sse_connect_eknm_intercom.json");
+    const QByteArray history = loadPayload(dataDir, "history_eknm_intercom.json");
+    if (nowPlaying.isEmpty() || feedMessage.isEmpty() || history.isEmpty()) {
+        return 1;
+    }
+
+    // Both parsers must agree before their timings mean anything
+    if (!sameState(domParseNowPlaying(nowPlaying), pullParseNowPlaying(nowPlaying))
+        || !sameState(domParseFeedMessage(feedMessage), pullParseFeedMessage(feedMessage))
+        || domParseSongList(history) != pullParseSongList(history)) {
+        QTextStream(stderr) << "Parser output mismatch\n";
+        return 1;
+    }
+
+    QVector<Result> results;
+    auto run = [&](const QString &name, const QByteArray &payload,
+                   const std::function<void()> &dom, const std::function<void()> &pull) {
+        Result result;
+        result.name = name;
+        result.bytes = payload.size();
+        result.domNs = measure(dom, iterations);
+        result.pullNs = measure(pull, iterations);
+        results.append(result);
+    };
+
+    run("nowplaying", nowPlaying,
+        [&]() { domParseNowPlaying(nowPlaying); },
+        [&]() { pullParseNowPlaying(nowPlaying); });
+    run("sse_connect", feedMessage,
+        [&]() { domParseFeedMessage(feedMessage); },
+        [&]() { pullParseFeedMessage(feedMessage); });
+    run("history", history,
+        [&]() { domParseSongList(history); },
+        [&]() { pullParseSongList(history); });
+
+    QTextStream out(stdout);
+    if (jsonOutput) {
+        QJsonArray cases;
+        for (const Result &result : results) {
+            QJsonObject entry;
+            entry["name"] = result.name;
+            entry["bytes"] = result.bytes;
+            entry["qjsondocument_ns"] = result.domNs;
+            entry["pull_ns"] = result.pullNs;
+            entry["speedup"] = result.domNs / result.pullNs;
+            cases.append(entry);
+        }
+        QJsonObject root;
+        root["benchmark"] = "radiojson";
+        root["iterations"] = iterations;
+        root["cases"] = cases;
+        out << QJsonDocument(root).toJson(QJsonDocument::Indented);
+        return 0;
+    }
+
+    out << QString("%1 %2 %3 %4 %5\n")
+               .arg("payload", -14).arg("bytes", 8).arg("QJsonDocument", 16)
+               .arg("pull parser", 14).arg("speedup", 9);
+    for (const Result &result : results) {
+        out << QString("%1 %2 %3 %4 %5\n")
+                   .arg(result.name, -14)
+                   .arg(result.bytes, 8)
+                   .arg(QString::number(result.domNs / 1000.0, 'f', 2) + " us", 16)
+                   .arg(QString::number(result.pullNs / 1000.0, 'f', 2) + " us", 14)
+                   .arg(QString::number(result.domNs / result.pullNs, 'f', 2) + "x", 9);
+    }
+    return 0;
+}
@@ -0,0 +1,393 @@
+// Startup benchmark: time-to-first-frame of MainWindow for synthetic libraries.
+//
+// For each library size the harness writes a playlist.json snapshot plus
+// matching (empty) song files into an isolated QStandardPaths test-mode
+// location, then launches itself in --child mode on the offscreen QPA:
+//
+//   cold  fresh process: QApplication + AppConfig::initializeApp + MainWindow
+//         until the window's first paint event
+//   warm  a second MainWindow in the same process (fonts, styles, plugins and
+//         the loaded library are already in memory)
+//
+// It also reports when the library snapshot became visible and when the
+// background folder scan finished; those should grow with library size
+// while first-frame times should not.
+//
+// Usage: bench_startup [--tracks 1000,10000,100000] [--runs N] [--warm N] [--json]
+
+#include "config/appconfig.h"
+#include "models/playlistdata.h"
+#include "services/musicstorageservice.h"
+#include "ui/mainwindow.h"
+#include "utils/rankkey.h"
+#include "utils/startuptrace.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+constexpr int kFrameTimeoutMs = 30000;
+constexpr int kScanTimeoutMs = 300000;
+
+// ========== Synthetic library ==========
+
+QString benchAppName(int tracks)
+{
+    return QString("EKNMusicBench%1").arg(tracks);
+}
+
+// Same layout as MusicStorageService: <AppData>/songs and <AppData>/metadata
+void useBenchPaths(int tracks)
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QCoreApplication::setOrganizationName(AppConfig::ORGANIZATION_NAME);
+    QCoreApplication::setApplicationName(benchAppName(tracks));
+}
+
+QString appDataPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+}
+
+bool prepareLibrary(int tracks)
+{
+    const QString root = appDataPath();
+    const QString songsDir = root + "/songs";
+    const QString metadataDir = root + "/metadata";
+    const QString markerPath = metadataDir + "/bench_ready";
+
+    // Reuse a library generated by an earlier run
+    QFile marker(markerPath);
+    if (marker.open(QIODevice::ReadOnly) && marker.readAll().trimmed().toInt() == tracks) {
+        return true;
+    }
+    marker.close();
+
+    QDir(root).removeRecursively();
+    if (!QDir().mkpath(songsDir) || !QDir().mkpath(metadataDir)) {
+        QTextStream(stderr) << "Cannot create " << root << "\n";
+        return false;
+    }
+
+    // Empty files with a saved title are taken from the snapshot as-is,
+    // so the background scan only lists the folder and extracts nothing
+    const QDateTime added = QDateTime::currentDateTime();
+    QJsonArray tracksArray;
+    QByteArray rank;
+    for (int i = 0; i < tracks; ++i) {
+        TrackData data;
+        data.filePath = songsDir + QString("/bench_%1.mp3").arg(i, 6, 10, QChar('0'));
+        data.title = QString("Track %1").arg(i);
+        data.artist = QString("Artist %1").arg(i % 500);
+        data.album = QString("Album %1").arg(i % 2000);
+        data.duration = 180000 + (i % 120) * 1000;
+        rank = RankKey::after(rank);
+        data.rank = rank;
+        data.dateAdded = added;
+        data.fileSize = 0;
+
+        QFile song(data.filePath);
+        if (!song.open(QIODevice::WriteOnly)) {
+            QTextStream(stderr) << "Cannot create " << data.filePath << "\n";
+            return false;
+        }
+        tracksArray.append(data.toJson());
+    }
+
+    QJsonObject snapshot;
+    snapshot["version"] = 2;
+    snapshot["tracks"] = tracksArray;
+    QFile snapshotFile(metadataDir + "/playlist.json");
+    if (!snapshotFile.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    snapshotFile.write(QJsonDocument(snapshot).toJson(QJsonDocument::Compact));
+
+    if (marker.open(QIODevice::WriteOnly)) {
+        marker.write(QByteArray::number(tracks));
+    }
+    return true;
+}
+
+// ========== Child process ==========
+
+class FirstPaintWatcher : public QObject
+{
+public:
+    bool painted = false;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (event->type() == QEvent::Paint) {
+            painted = true;
+        }
+        return QObject::eventFilter(watched, event);
+    }
+};
+
+bool waitFor(const std::function<bool()> &condition, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!condition()) {
+        if (timer.elapsed() > timeoutMs) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+    return true;
+}
+
+// Milliseconds from construction to first paint; the window is returned
+// so the caller decides when to tear it down
+double showMainWindow(MainWindow *&window)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    window = new MainWindow();
+    FirstPaintWatcher watcher;
+    window->installEventFilter(&watcher);
+    window->show();
+
+    const bool painted = waitFor([&]() { return watcher.painted; }, kFrameTimeoutMs);
+    const double elapsedMs = timer.nsecsElapsed() / 1e6;
+    window->removeEventFilter(&watcher);
+    return painted ? elapsedMs : -1.0;
+}
+
+int runChild(int argc, char *argv[], int tracks, int warmRuns)
+{
+    QElapsedTimer processTimer;
+    processTimer.start();
+
+    StartupTrace::setEnabled(true);
+    QApplication app(argc, argv);
+    AppConfig::initializeApp();
+    useBenchPaths(tracks);
+
+    // Cold: first window of a fresh process
+    const qint64 windowStartNs = StartupTrace::nowNs();
+    MainWindow *window = nullptr;
+    const double coldWindowMs = showMainWindow(window);
+    const double coldFirstFrameMs = processTimer.nsecsElapsed() / 1e6;
+
+    // Spans recorded up to the first frame
+    QJsonObject spans;
+    const QList<StartupTrace::Event> events = StartupTrace::events();
+    for (const StartupTrace::Event &event : events) {
+        if (event.phase == 'X') {
+            spans[QString::fromUtf8(event.name)] = event.durationNs / 1e6;
+        }
+    }
+
+    // Library: snapshot visible, then background scan done
+    MusicStorageService *storage = MusicStorageService::instance();
+    waitFor([&]() { return storage->isLibraryLoaded(); }, kScanTimeoutMs);
+    const double libraryReadyMs = (StartupTrace::nowNs() - windowStartNs) / 1e6;
+    waitFor([&]() { return !storage->isScanning(); }, kScanTimeoutMs);
+    const double scanDoneMs = (StartupTrace::nowNs() - windowStartNs) / 1e6;
+    const int loadedTracks = storage->getDownloadedTracks().size();
+
+    // Warm: later windows in the same process
+    QJsonArray warmSamples;
+    for (int i = 0; i < warmRuns; ++i) {
+        delete window;
+        window = nullptr;
+        QCoreApplication::processEvents();
+        warmSamples.append(showMainWindow(window));
+    }
+    delete window;
+
+    QJsonObject result;
+    result["tracks"] = tracks;
+    result["loaded_tracks"] = loadedTracks;
+    result["cold_first_frame_ms"] = coldFirstFrameMs;
+    result["cold_window_ms"] = coldWindowMs;
+    result["library_ready_ms"] = libraryReadyMs;
+    result["scan_done_ms"] = scanDoneMs;
+    result["warm_window_ms"] = warmSamples;
+    result["spans_ms"] = spans;
+
+    QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact) << "\n";
+    return 0;
+}
+
+// ========== Harness ==========
+
+struct Result {
+    int tracks = 0;
+    int loadedTracks = 0;
+    double coldFirstFrameMs = 0;
+    double coldWindowMs = 0;
+    double warmWindowMs = 0;
+    double libraryReadyMs = 0;
+    double scanDoneMs = 0;
+    QJsonObject spans;
+};
+
+double median(QVector<double> samples)
+{
+    if (samples.isEmpty()) {
+        return -1.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+bool runSize(int tracks, int runs, int warmRuns, Result &result)
+{
+    useBenchPaths(tracks);
+    if (!prepareLibrary(tracks)) {
+        return false;
+    }
+
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    if (!env.contains("QT_QPA_PLATFORM")) {
+        env.insert("QT_QPA_PLATFORM", "offscreen");
+    }
+    env.remove("EKNM_STARTUP_TRACE");
+
+    QVector<double> coldFirstFrame, coldWindow, warmWindow, libraryReady, scanDone;
+    result.tracks = tracks;
+
+    for (int run = 0; run < runs; ++run) {
+        QProcess child;
+        child.setProcessEnvironment(env);
+        child.setStandardErrorFile(QProcess::nullDevice());
+        child.start(QCoreApplication::applicationFilePath(),
+                    {"--child", QString::number(tracks), "--warm", QString::number(warmRuns)});
+        if (!child.waitForFinished(kScanTimeoutMs + kFrameTimeoutMs) || child.exitCode() != 0) {
+            QTextStream(stderr) << "Child run failed for " << tracks << " tracks\n";
+            return false;
+        }
+
+        const QList<QByteArray> lines = child.readAllStandardOutput().trimmed().split('\n');
+        const QJsonObject sample = QJsonDocument::fromJson(lines.last()).object();
+        if (sample.isEmpty()) {
+            QTextStream(stderr) << "Unreadable child output for " << tracks << " tracks\n";
+            return false;
+        }
+
+        coldFirstFrame.append(sample["cold_first_frame_ms"].toDouble());
+        coldWindow.append(sample["cold_window_ms"].toDouble());
+        libraryReady.append(sample["library_ready_ms"].toDouble());
+        scanDone.append(sample["scan_done_ms"].toDouble());
+        const QJsonArray warm = sample["warm_window_ms"].toArray();
+        for (const QJsonValue &value : warm) {
+            warmWindow.append(value.toDouble());
+        }
+        if (run == 0) {
+            result.spans = sample["spans_ms"].toObject();
+            result.loadedTracks = sample["loaded_tracks"].toInt();
+        }
+    }
+
+    result.coldFirstFrameMs = median(coldFirstFrame);
+    result.coldWindowMs = median(coldWindow);
+    result.warmWindowMs = median(warmWindow);
+    result.libraryReadyMs = median(libraryReady);
+    result.scanDoneMs = median(scanDone);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QList<int> sizes = {1000, 10000, 100000};
+    int runs = 3;
+    int warmRuns = 5;
+    int childTracks = -1;
+    bool jsonOutput = false;
+
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--tracks" && i + 1 < argc) {
+            sizes.clear();
+            const QStringList parts = QString::fromLocal8Bit(argv[++i]).split(',', Qt::SkipEmptyParts);
+            for (const QString &part : parts) {
+                sizes.append(qMax(0, part.trimmed().toInt()));
+            }
+        } else if (arg == "--runs" && i + 1 < argc) {
+            runs = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--warm" && i + 1 < argc) {
+            warmRuns = qMax(0, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--child" && i + 1 < argc) {
+            childTracks = qMax(0, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--json") {
+            jsonOutput = true;
+        }
+    }
+
+    if (childTracks >= 0) {
+        return runChild(argc, argv, childTracks, warmRuns);
+    }
+
+    QCoreApplication app(argc, argv);
+
+    QVector<Result> results;
+    for (int tracks : std::as_const(sizes)) {
+        Result result;
+        if (!runSize(tracks, runs, warmRuns, result)) {
+            return 1;
+        }
+        results.append(result);
+    }
+
+    QTextStream out(stdout);
+    if (jsonOutput) {
+        QJsonArray cases;
+        for (const Result &result : results) {
+            QJsonObject entry;
+            entry["tracks"] = result.tracks;
+            entry["loaded_tracks"] = result.loadedTracks;
+            entry["cold_first_frame_ms"] = result.coldFirstFrameMs;
+            entry["cold_window_ms"] = result.coldWindowMs;
+            entry["warm_window_ms"] = result.warmWindowMs;
+            entry["library_ready_ms"] = result.libraryReadyMs;
+            entry["scan_done_ms"] = result.scanDoneMs;
+            entry["cold_spans_ms"] = result.spans;
+            cases.append(entry);
+        }
+        QJsonObject root;
+        root["benchmark"] = "startup";
+        root["runs"] = runs;
+        root["warm_runs"] = warmRuns;
+        root["cases"] = cases;
+        out << QJsonDocument(root).toJson(QJsonDocument::Indented);
+        return 0;
+    }
+
+    out << QString("%1 %2 %3 %4 %5 %6\n")
+               .arg("tracks", -8).arg("cold frame", 12).arg("cold window", 13)
+               .arg("warm window", 13).arg("library", 10).arg("scan done", 11);
+    for (const Result &result : results) {
+        auto ms = [](double value) { return QString::number(value, 'f', 1) + " ms"; };
+        out << QString("%1 %2 %3 %4 %5 %6\n")
+                   .arg(result.tracks, -8)
+                   .arg(ms(result.coldFirstFrameMs), 12)
+                   .arg(ms(result.coldWindowMs), 13)
+                   .arg(ms(result.warmWindowMs), 13)
+                   .arg(ms(result.libraryReadyMs), 10)
+                   .arg(ms(result.scanDoneMs), 11);
+    }
+    return 0;
+}
@@ -0,0 +1,573 @@
+// Hot-path benchmark suite: library, search, persistence, queue and radio JSON.
+//
+// Cases (select with --filter SUBSTRING):
+//   metadata.extract.{mp3,flac,m4a}  MetadataExtractor on generated files
+//   tagreader.{mp3,flac,m4a}         TagReader alone (mapped, in place)
+//   scan.full                        MusicStorageService::loadLibrary on an
+//                                    empty snapshot (every file extracted)
+//   scan.incremental.unchanged       rescanLibrary with nothing changed
+//   scan.incremental.changed         rescanLibrary after 10% of files grew
+//   playlistdata.{save,load}         playlist.json round trip
+//   playlistdata.move                Drag-and-drop move: re-rank one track
+//                                    and append it to the journal
+//   search.*                         SearchMatcher over the whole library
+//   queue.*                          PlayQueue operations
+//   radiojson.*                      NowPlayingParser on captured payloads
+//   seekindex.scan                   Frame scan of a 3-hour VBR MP3
+//   seekindex.locate                 Frame-accurate lookup at random times
+//   seekindex.size                   Serialized (on-disk) index size
+//
+// The library and corpus live in an isolated QStandardPaths test-mode
+// location. Runs on the offscreen QPA unless QT_QPA_PLATFORM is set.
+//
+// Usage: bench_suite [--filter S] [--files N] [--file-kb K]
+//                    [--tracks N] [--data DIR] [--json]
+
+#include "corpusgenerator.h"
+#include "config/appconfig.h"
+#include "models/playlistdata.h"
+#include "models/playqueue.h"
+#include "services/metadataextractor.h"
+#include "services/musicstorageservice.h"
+#include "services/nowplayingparser.h"
+#include "services/seekindex.h"
+#include "services/tagreader.h"
+#include "utils/rankkey.h"
+#include "utils/searchmatcher.h"
+
+#include <QApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLoggingCategory>
+#include <QPair>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+constexpr int kScanTimeoutMs = 600000;
+constexpr int kSchemaVersion = 1;
+// Length of the synthetic MP3 for the seek index cases (a long DJ mix)
+constexpr int kSeekFileMinutes = 180;
+
+struct Result {
+    QString name;
+    QString unit;
+    double value = 0;
+    int iterations = 0;
+};
+
+struct Config {
+    QString filter;
+    int filesPerFormat = 50;
+    int fileKb = 512;
+    int tracks = 10000;
+    QString dataDir = QStringLiteral(BENCH_DATA_DIR);
+};
+
+class Suite
+{
+public:
+    explicit Suite(const Config &config) : m_config(config) {}
+
+    bool selected(const QString &name) const
+    {
+        return m_config.filter.isEmpty() || name.contains(m_config.filter);
+    }
+
+    bool anySelected(const QStringList &names) const
+    {
+        for (const QString &name : names) {
+            if (selected(name)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void add(const QString &name, const QString &unit, double value, int iterations)
+    {
+        m_results.append({name, unit, value, iterations});
+    }
+
+    // Median nanoseconds per call over a few batches
+    void measure(const QString &name, int iterations, const std::function<void()> &fn)
+    {
+        if (!selected(name)) {
+            return;
+        }
+
+        constexpr int kBatches = 5;
+        for (int i = 0; i < iterations / 10 + 1; ++i) {
+            fn(); // Warm up
+        }
+
+        QVector<double> samples;
+        for (int batch = 0; batch < kBatches; ++batch) {
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < iterations; ++i) {
+                fn();
+            }
+            samples.append(double(timer.nsecsElapsed()) / iterations);
+        }
+        std::sort(samples.begin(), samples.end());
+        add(name, "ns/op", samples[kBatches / 2], iterations * kBatches);
+    }
+
+    const Config &config() const { return m_config; }
+    const QVector<Result> &results() const { return m_results; }
+
+private:
+    Config m_config;
+    QVector<Result> m_results;
+};
+
+bool waitFor(const std::function<bool()> &condition, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!condition()) {
+        if (timer.elapsed() > timeoutMs) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+    return true;
+}
+
+// ========== Library ==========
+
+// Same layout as MusicStorageService: <AppData>/songs and <AppData>/metadata
+QString prepareLibraryRoot()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QCoreApplication::setOrganizationName(AppConfig::ORGANIZATION_NAME);
+    QCoreApplication::setApplicationName("EKNMusicBenchSuite");
+
+    const QString root = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir(root).removeRecursively();
+    return root;
+}
+
+bool runLibrary(Suite &suite)
+{
+    const QStringList formats = CorpusOptions().formats;
+    QStringList extractCases;
+    for (const QString &format : formats) {
+        extractCases << "metadata.extract." + format << "tagreader." + format;
+    }
+    const bool wantExtract = suite.anySelected(extractCases);
+    const bool wantScan = suite.anySelected({"scan.full", "scan.incremental.unchanged",
+                                             "scan.incremental.changed"});
+    if (!wantExtract && !wantScan) {
+        return true;
+    }
+
+    const QString root = prepareLibraryRoot();
+    CorpusOptions options;
+    options.directory = root + "/songs";
+    options.filesPerFormat = suite.config().filesPerFormat;
+    options.fileKb = suite.config().fileKb;
+    options.formats = formats;
+    const QList<CorpusEntry> corpus = CorpusGenerator::generate(options);
+    if (corpus.isEmpty()) {
+        QTextStream(stderr) << "Cannot generate corpus in " << options.directory << "\n";
+        return false;
+    }
+
+    for (const QString &format : formats) {
+        const QString name = "tagreader." + format;
+        if (!suite.selected(name)) {
+            continue;
+        }
+
+        int files = 0;
+        int parsed = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (const CorpusEntry &entry : corpus) {
+            if (entry.filePath.endsWith("." + format)) {
+                parsed += TagReader::read(entry.filePath).isValid() ? 1 : 0;
+                ++files;
+            }
+        }
+        suite.add(name, "us/file", timer.nsecsElapsed() / 1e3 / qMax(1, files), parsed);
+    }
+
+    for (const QString &format : formats) {
+        const QString name = "metadata.extract." + format;
+        if (!suite.selected(name)) {
+            continue;
+        }
+
+        // Same pattern as the library scan: one extractor, one file at a time
+        MetadataExtractor extractor;
+        int files = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (const CorpusEntry &entry : corpus) {
+            if (entry.filePath.endsWith("." + format)) {
+                const QFuture<Track> future = extractor.extract(entry.filePath);
+                waitFor([&future]() { return future.isFinished(); }, kScanTimeoutMs);
+                ++files;
+            }
+        }
+        suite.add(name, "ms/file", timer.nsecsElapsed() / 1e6 / qMax(1, files), files);
+    }
+
+    if (!wantScan) {
+        return true;
+    }
+
+    // The service is created here, after the corpus exists, so the full
+    // scan starts from an empty snapshot
+    MusicStorageService *storage = MusicStorageService::instance();
+    auto scanDone = [storage]() { return storage->isLibraryLoaded() && !storage->isScanning(); };
+
+    QElapsedTimer timer;
+    timer.start();
+    storage->loadLibrary();
+    if (!waitFor(scanDone, kScanTimeoutMs)) {
+        QTextStream(stderr) << "Full scan timed out\n";
+        return false;
+    }
+    if (suite.selected("scan.full")) {
+        suite.add("scan.full", "ms", timer.nsecsElapsed() / 1e6, corpus.size());
+    }
+
+    if (suite.selected("scan.incremental.unchanged")) {
+        timer.restart();
+        storage->rescanLibrary();
+        waitFor(scanDone, kScanTimeoutMs);
+        suite.add("scan.incremental.unchanged", "ms", timer.nsecsElapsed() / 1e6, corpus.size());
+    }
+
+    if (suite.selected("scan.incremental.changed")) {
+        // Growing a file changes its size, which marks it for re-extraction
+        int changed = 0;
+        for (int i = 0; i < corpus.size(); i += 10, ++changed) {
+            QFile file(corpus[i].filePath);
+            if (file.open(QIODevice::Append)) {
+                file.write(QByteArray(1024, '\0'));
+            }
+        }
+
+        timer.restart();
+        storage->rescanLibrary();
+        waitFor(scanDone, kScanTimeoutMs);
+        suite.add("scan.incremental.changed", "ms", timer.nsecsElapsed() / 1e6, changed);
+    }
+
+    return true;
+}
+
+// ========== Persistence ==========
+
+void runPlaylistData(Suite &suite)
+{
+    if (!suite.anySelected({"playlistdata.save", "playlistdata.load", "playlistdata.move"})) {
+        return;
+    }
+
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("playlist.json");
+    const QList<Track> tracks = CorpusGenerator::syntheticTracks(suite.config().tracks);
+
+    PlaylistData data;
+    for (int i = 0; i < tracks.size(); ++i) {
+        const Track &track = tracks[i];
+        TrackData trackData;
+        trackData.filePath = track.filePath();
+        trackData.title = track.title();
+        trackData.artist = track.artist();
+        trackData.album = track.album();
+        trackData.duration = track.duration();
+        trackData.dateAdded = track.dateAdded();
+        trackData.fileSize = track.fileSize();
+        data.setTrackData(trackData.filePath, trackData);
+    }
+
+    suite.measure("playlistdata.save", 5, [&]() { data.saveToFile(filePath); });
+    suite.measure("playlistdata.load", 5, [&]() {
+        PlaylistData loaded;
+        loaded.loadFromFile(filePath);
+    });
+
+    // Alternately move the first track to the middle and back, as a
+    // drag and drop would; each move persists one journal entry
+    const QList<TrackData> ordered = data.getAllTracksOrdered();
+    if (ordered.size() >= 3) {
+        const int middle = ordered.size() / 2;
+        const QString moved = ordered.first().filePath;
+        const QByteArray first = ordered.first().rank;
+        const QByteArray between = RankKey::between(ordered[middle].rank, ordered[middle + 1].rank);
+        int iteration = 0;
+        suite.measure("playlistdata.move", 200, [&]() {
+            data.setTrackRank(moved, (iteration++ % 2) ? first : between);
+            data.saveChanges(filePath);
+        });
+    }
+}
+
+// ========== Search ==========
+
+void runSearch(Suite &suite)
+{
+    const QList<QPair<QString, QString>> queries = {
+        {"search.common_word", "love"},
+        {"search.two_words", "midnight garden"},
+        {"search.single_char", "s"},
+        {"search.no_match", "zzzz"},
+    };
+    QStringList names;
+    for (const auto &query : queries) {
+        names << query.first;
+    }
+    if (!suite.anySelected(names)) {
+        return;
+    }
+
+    const QList<Track> tracks = CorpusGenerator::syntheticTracks(suite.config().tracks);
+
+    for (const auto &query : queries) {
+        int hits = 0;
+        // Same loop as SearchPage::performSearch
+        suite.measure(query.first, 20, [&]() {
+            const SearchMatcher matcher(query.second);
+            hits = 0;
+            for (const Track &track : tracks) {
+                if (matcher.matches(track.title(), track.artist(), track.album())) {
+                    ++hits;
+                }
+            }
+        });
+    }
+}
+
+// ========== Queue ==========
+
+void runQueue(Suite &suite)
+{
+    if (!suite.anySelected({"queue.set_playlist", "queue.append",
+                            "queue.next.sequential", "queue.next.shuffle"})) {
+        return;
+    }
+
+    const QList<Track> tracks = CorpusGenerator::syntheticTracks(suite.config().tracks);
+
+    suite.measure("queue.set_playlist", 100, [&]() {
+        PlayQueue queue;
+        queue.setTracks(tracks, tracks.size() / 2);
+    });
+    suite.measure("queue.append", 5, [&]() {
+        PlayQueue queue;
+        for (const Track &track : tracks) {
+            queue.append(track);
+        }
+    });
+
+    PlayQueue queue;
+    queue.setTracks(tracks);
+    suite.measure("queue.next.sequential", 100000, [&]() {
+        queue.setCurrentIndex(queue.nextIndex(false, true));
+    });
+    suite.measure("queue.next.shuffle", 100000, [&]() {
+        queue.setCurrentIndex(queue.nextIndex(true, true));
+    });
+}
+
+// ========== Radio JSON ==========
+
+bool runRadioJson(Suite &suite)
+{
+    if (!suite.anySelected({"radiojson.nowplaying", "radiojson.feed_message",
+                            "radiojson.history"})) {
+        return true;
+    }
+
+    auto load = [&](const QString &name) {
+        QFile file(suite.config().dataDir + "/" + name);
+        if (!file.open(QIODevice::ReadOnly)) {
+            QTextStream(stderr) << "Cannot open " << file.fileName() << "\n";
+            return QByteArray();
+        }
+        return file.readAll();
+    };
+
+    const QByteArray nowPlaying = load("nowplaying_eknm_intercom.json");
+    const QByteArray feedMessage = load("sse_connect_eknm_intercom.json");
+    const QByteArray history = load("history_eknm_intercom.json");
+    if (nowPlaying.isEmpty() || feedMessage.isEmpty() || history.isEmpty()) {
+        return false;
+    }
+
+    suite.measure("radiojson.nowplaying", 2000, [&]() {
+        RadioState state;
+        NowPlayingParser::parseNowPlaying(nowPlaying, state);
+    });
+    suite.measure("radiojson.feed_message", 2000, [&]() {
+        RadioState state;
+        QList<NowPlayingPayload> payloads;
+        if (NowPlayingParser::extractFeedPayloads(feedMessage, payloads)) {
+            NowPlayingParser::parseNowPlaying(payloads.last().json.toByteArray(), state);
+        }
+    });
+    suite.measure("radiojson.history", 2000, [&]() {
+        QList<RadioSongInfo> songs;
+        NowPlayingParser::parseSongList(history, songs);
+    });
+    return true;
+}
+
+// ========== Seek Index ==========
+
+// MPEG-1 Layer III, 44.1 kHz stereo frames cycling through 64, 128 and
+// 192 kbps (no Xing TOC), so only a frame scan can seek it accurately
+bool writeVbrMp3(const QString &filePath, int minutes)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    const int bitrateIndexes[] = { 5, 9, 11 };
+    const int bitratesKbps[] = { 64, 128, 192 };
+    QByteArray frames[3];
+    for (int i = 0; i < 3; ++i) {
+        frames[i] = QByteArray(144 * bitratesKbps[i] * 1000 / 44100, '\0');
+        frames[i][0] = char(0xFF);
+        frames[i][1] = char(0xFB);
+        frames[i][2] = char(bitrateIndexes[i] << 4);
+    }
+
+    const qint64 frameCount = qint64(minutes) * 60 * 44100 / 1152;
+    for (qint64 i = 0; i < frameCount; ++i) {
+        if (file.write(frames[i % 3]) != frames[i % 3].size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void runSeekIndex(Suite &suite)
+{
+    if (!suite.anySelected({"seekindex.scan", "seekindex.locate", "seekindex.size"})) {
+        return;
+    }
+
+    QTemporaryDir dir;
+    const QString filePath = dir.filePath("mix.mp3");
+    if (!dir.isValid() || !writeVbrMp3(filePath, kSeekFileMinutes)) {
+        QTextStream(stderr) << "Cannot write " << filePath << "\n";
+        return;
+    }
+    const MappedFilePtr file = MappedFile::open(filePath);
+
+    QElapsedTimer timer;
+    timer.start();
+    const SeekIndex index = SeekIndex::scanMpegFrames(file);
+    if (suite.selected("seekindex.scan")) {
+        suite.add("seekindex.scan", "ms", timer.nsecsElapsed() / 1e6, index.points().size());
+    }
+
+    QRandomGenerator random(46);
+    suite.measure("seekindex.locate", 10000, [&]() {
+        index.locate(random.bounded(index.durationUs()), file);
+    });
+
+    if (suite.selected("seekindex.size")) {
+        suite.add("seekindex.size", "KiB", index.toData().size() / 1024.0, index.points().size());
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    Config config;
+    bool jsonOutput = false;
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--filter" && i + 1 < argc) {
+            config.filter = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--files" && i + 1 < argc) {
+            config.filesPerFormat = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--file-kb" && i + 1 < argc) {
+            config.fileKb = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--tracks" && i + 1 < argc) {
+            config.tracks = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--data" && i + 1 < argc) {
+            config.dataDir = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--json") {
+            jsonOutput = true;
+        }
+    }
+
+    QApplication app(argc, argv);
+    // The services log per operation; keep the output to results
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    Suite suite(config);
+    if (!runLibrary(suite) || !runRadioJson(suite)) {
+        return 1;
+    }
+    runPlaylistData(suite);
+    runSearch(suite);
+    runQueue(suite);
+    runSeekIndex(suite);
+
+    QTextStream out(stdout);
+    if (jsonOutput) {
+        QJsonArray results;
+        for (const Result &result : suite.results()) {
+            QJsonObject entry;
+            entry["name"] = result.name;
+            entry["unit"] = result.unit;
+            entry["value"] = result.value;
+            entry["iterations"] = result.iterations;
+            results.append(entry);
+        }
+        QJsonObject configJson;
+        configJson["files_per_format"] = config.filesPerFormat;
+        configJson["file_kb"] = config.fileKb;
+        configJson["tracks"] = config.tracks;
+        configJson["filter"] = config.filter;
+
+        QJsonObject root;
+        root["benchmark"] = "suite";
+        root["schema"] = kSchemaVersion;
+        root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        root["qt"] = QString::fromLatin1(qVersion());
+        root["config"] = configJson;
+        root["results"] = results;
+        out << QJsonDocument(root).toJson(QJsonDocument::Indented);
+        return 0;
+    }
+
+    out << QString("%1 %2 %3\n").arg("case", -30).arg("value", 14).arg("iterations", 11);
+    for (const Result &result : suite.results()) {
+        out << QString("%1 %2 %3\n")
+                   .arg(result.name, -30)
+                   .arg(QString::number(result.value, 'f', 2) + " " + result.unit, 14)
+                   .arg(result.iterations, 11);
+    }
+    return 0;
+}
@@ -0,0 +1,546 @@
+#include "corpusgenerator.h"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QRandomGenerator>
+#include <QDebug>
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+constexpr int kMp3FrameBytes = 417;        // 128 kbps, 44.1 kHz, no padding
+constexpr int kMp3SamplesPerFrame = 1152;
+constexpr int kFlacBlockSize = 4096;
+constexpr int kFlacMaxPadding = (1 << 24) - 1;
+constexpr int kCoverSize = 64;
+
+const char *const kWords[] = {
+    "Love", "Night", "Fire", "Dream", "Summer", "Light", "Heart", "Rain",
+    "City", "Gold", "Blue", "Road", "Star", "Wild", "Echo", "River",
+    "Shadow", "Neon", "Storm", "Home", "Glass", "Ocean", "Silver", "Winter",
+    "Moon", "Paper", "Velvet", "Midnight", "Garden", "Signal", "Ghost", "Horizon"
+};
+constexpr int kWordCount = int(sizeof(kWords) / sizeof(kWords[0]));
+
+QString word(QRandomGenerator &rng)
+{
+    return QString::fromLatin1(kWords[rng.bounded(kWordCount)]);
+}
+
+// Names drawn from small pools so that artists and albums repeat like in
+// a real library (and search queries hit more than one row)
+struct Naming {
+    QString title;
+    QString artist;
+    QString album;
+    int trackNumber = 0;
+    qint64 durationMs = 0;
+};
+
+Naming nextNaming(QRandomGenerator &rng, int index)
+{
+    Naming naming;
+    const int artistId = rng.bounded(64);
+    QRandomGenerator artistRng(quint32(artistId) * 7919u + 1u);
+    naming.artist = word(artistRng) + " " + word(artistRng) + "s";
+    naming.album = word(artistRng) + " " + word(rng);
+    naming.title = rng.bounded(2) ? word(rng) + " " + word(rng)
+                                  : word(rng) + " of the " + word(rng);
+    naming.trackNumber = index % 12 + 1;
+    naming.durationMs = 120000 + rng.bounded(240000);
+    return naming;
+}
+
+QString safeName(QString name)
+{
+    static const QString kInvalid = QStringLiteral("\\/:*?\"<>|");
+    for (QChar &ch : name) {
+        if (kInvalid.contains(ch)) {
+            ch = QLatin1Char('_');
+        }
+    }
+    return name;
+}
+
+// ========== Byte helpers ==========
+
+void appendBE16(QByteArray &out, quint32 value)
+{
+    out.append(char((value >> 8) & 0xFF));
+    out.append(char(value & 0xFF));
+}
+
+void appendBE24(QByteArray &out, quint32 value)
+{
+    out.append(char((value >> 16) & 0xFF));
+    appendBE16(out, value);
+}
+
+void appendBE32(QByteArray &out, quint32 value)
+{
+    out.append(char((value >> 24) & 0xFF));
+    appendBE24(out, value);
+}
+
+void appendLE32(QByteArray &out, quint32 value)
+{
+    out.append(char(value & 0xFF));
+    out.append(char((value >> 8) & 0xFF));
+    out.append(char((value >> 16) & 0xFF));
+    out.append(char((value >> 24) & 0xFF));
+}
+
+bool writeFile(const QString &filePath, const QByteArray &data)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Cannot write corpus file" << filePath;
+        return false;
+    }
+    return file.write(data) == data.size();
+}
+
+// ========== ID3v2.3 ==========
+
+void appendSyncsafe(QByteArray &out, quint32 value)
+{
+    out.append(char((value >> 21) & 0x7F));
+    out.append(char((value >> 14) & 0x7F));
+    out.append(char((value >> 7) & 0x7F));
+    out.append(char(value & 0x7F));
+}
+
+QByteArray id3Frame(const char *id, const QByteArray &body)
+{
+    QByteArray frame(id, 4);
+    appendBE32(frame, quint32(body.size()));
+    appendBE16(frame, 0);  // flags
+    frame.append(body);
+    return frame;
+}
+
+QByteArray id3TextFrame(const char *id, const QString &text)
+{
+    QByteArray body;
+    bool latin1 = true;
+    for (QChar ch : text) {
+        if (ch.unicode() > 0xFF) {
+            latin1 = false;
+            break;
+        }
+    }
+
+    if (latin1) {
+        body.append('\0');
+        body.append(text.toLatin1());
+    } else {
+        body.append('\1');  // UTF-16 with BOM
+        body.append("\xFF\xFE", 2);
+        for (QChar ch : text) {
+            body.append(char(ch.unicode() & 0xFF));
+            body.append(char(ch.unicode() >> 8));
+        }
+    }
+    return id3Frame(id, body);
+}
+
+// ========== FLAC ==========
+
+quint8 crc8(const QByteArray &data)
+{
+    quint8 crc = 0;
+    for (char byte : data) {
+        crc ^= quint8(byte);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? quint8((crc << 1) ^ 0x07) : quint8(crc << 1);
+        }
+    }
+    return crc;
+}
+
+quint16 crc16(const QByteArray &data)
+{
+    quint16 crc = 0;
+    for (char byte : data) {
+        crc ^= quint16(quint8(byte)) << 8;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? quint16((crc << 1) ^ 0x8005) : quint16(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// FLAC's extended UTF-8 coding of the frame number
+void appendFlacUtf8(QByteArray &out, quint32 value)
+{
+    if (value < 0x80) {
+        out.append(char(value));
+    } else if (value < 0x800) {
+        out.append(char(0xC0 | (value >> 6)));
+        out.append(char(0x80 | (value & 0x3F)));
+    } else if (value < 0x10000) {
+        out.append(char(0xE0 | (value >> 12)));
+        out.append(char(0x80 | ((value >> 6) & 0x3F)));
+        out.append(char(0x80 | (value & 0x3F)));
+    } else {
+        out.append(char(0xF0 | (value >> 18)));
+        out.append(char(0x80 | ((value >> 12) & 0x3F)));
+        out.append(char(0x80 | ((value >> 6) & 0x3F)));
+        out.append(char(0x80 | (value & 0x3F)));
+    }
+}
+
+QByteArray flacBlockHeader(int type, int length, bool last)
+{
+    QByteArray header;
+    header.append(char((last ? 0x80 : 0x00) | type));
+    appendBE24(header, quint32(length));
+    return header;
+}
+
+// One block of digital silence: fixed 4096-sample blocks, 44.1 kHz,
+// stereo, 16 bit, two CONSTANT subframes
+QByteArray flacSilentFrame(quint32 frameNumber)
+{
+    QByteArray frame;
+    frame.append("\xFF\xF8\xC9\x18", 4);
+    appendFlacUtf8(frame, frameNumber);
+    frame.append(char(crc8(frame)));
+    for (int channel = 0; channel < 2; ++channel) {
+        frame.append('\0');     // CONSTANT subframe, no wasted bits
+        appendBE16(frame, 0);   // sample value
+    }
+    appendBE16(frame, crc16(frame));
+    return frame;
+}
+
+// ========== MP4 ==========
+
+QByteArray mp4Box(const QByteArray &type, const QByteArray &payload)
+{
+    QByteArray box;
+    appendBE32(box, quint32(8 + payload.size()));
+    box.append(type);
+    box.append(payload);
+    return box;
+}
+
+QByteArray mp4FullBox(const QByteArray &type, const QByteArray &payload)
+{
+    QByteArray body(4, '\0');  // version 0, no flags
+    body.append(payload);
+    return mp4Box(type, body);
+}
+
+QByteArray mp4DataItem(const QByteArray &type, quint32 dataType, const QByteArray &value)
+{
+    QByteArray data;
+    appendBE32(data, dataType);
+    appendBE32(data, 0);  // locale
+    data.append(value);
+    return mp4Box(type, mp4Box("data", data));
+}
+
+QByteArray mp4Mvhd(qint64 durationMs)
+{
+    QByteArray body;
+    appendBE32(body, 0);            // creation time
+    appendBE32(body, 0);            // modification time
+    appendBE32(body, 1000);         // timescale: milliseconds
+    appendBE32(body, quint32(durationMs));
+    appendBE32(body, 0x00010000);   // rate 1.0
+    appendBE16(body, 0x0100);       // volume 1.0
+    body.append(10, '\0');          // reserved
+    const quint32 matrix[9] = {0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000};
+    for (quint32 value : matrix) {
+        appendBE32(body, value);
+    }
+    body.append(24, '\0');          // pre_defined
+    appendBE32(body, 1);            // next track id
+    return mp4FullBox("mvhd", body);
+}
+
+} // namespace
+
+// ========== Corpus ==========
+
+QList<CorpusEntry> CorpusGenerator::generate(const CorpusOptions &options)
+{
+    QList<CorpusEntry> entries;
+    QDir root(options.directory);
+    if (!root.mkpath(".")) {
+        qWarning() << "Cannot create corpus directory" << options.directory;
+        return entries;
+    }
+
+    const QByteArray cover = options.withCover ? coverImage() : QByteArray();
+    const int sizeBytes = options.fileKb * 1024;
+    QRandomGenerator rng(options.seed);
+
+    int index = 0;
+    for (const QString &format : options.formats) {
+        for (int i = 0; i < options.filesPerFormat; ++i, ++index) {
+            const Naming naming = nextNaming(rng, index);
+
+            CorpusEntry entry;
+            entry.title = naming.title;
+            entry.artist = naming.artist;
+            entry.album = naming.album;
+            entry.trackNumber = naming.trackNumber;
+            entry.durationMs = naming.durationMs;
+
+            const QString albumDir = safeName(entry.artist) + "/" + safeName(entry.album);
+            if (!root.mkpath(albumDir)) {
+                qWarning() << "Cannot create corpus directory" << root.filePath(albumDir);
+                return {};
+            }
+            // The running index keeps names unique when titles repeat
+            entry.filePath = root.filePath(QString("%1/%2 %3 %4.%5")
+                .arg(albumDir)
+                .arg(entry.trackNumber, 2, 10, QLatin1Char('0'))
+                .arg(safeName(entry.title))
+                .arg(index)
+                .arg(format));
+
+            bool written = false;
+            if (format == "mp3") {
+                written = writeMp3(entry, sizeBytes, cover);
+            } else if (format == "flac") {
+                written = writeFlac(entry, sizeBytes, cover);
+            } else if (format == "m4a") {
+                written = writeM4a(entry, sizeBytes, cover);
+            } else {
+                qWarning() << "Unknown corpus format" << format;
+                return {};
+            }
+
+            if (!written) {
+                return {};
+            }
+            entries.append(entry);
+        }
+    }
+
+    return entries;
+}
+
+QList<Track> CorpusGenerator::syntheticTracks(int count, quint32 seed)
+{
+    QList<Track> tracks;
+    tracks.reserve(count);
+    QRandomGenerator rng(seed);
+    const QDateTime base = QDateTime::fromSecsSinceEpoch(1700000000);
+
+    for (int i = 0; i < count; ++i) {
+        const Naming naming = nextNaming(rng, i);
+        Track track(QString("/synthetic/%1/%2/%3 %4 %5.mp3")
+                        .arg(naming.artist, naming.album)
+                        .arg(naming.trackNumber, 2, 10, QLatin1Char('0'))
+                        .arg(naming.title)
+                        .arg(i),
+                    naming.title, naming.artist, naming.album, naming.durationMs);
+        track.setFileSize(4 * 1024 * 1024 + rng.bounded(4 * 1024 * 1024));
+        track.setDateAdded(base.addSecs(i * 60));
+        tracks.append(track);
+    }
+    return tracks;
+}
+
+QByteArray CorpusGenerator::coverImage(QString *mimeType)
+{
+    QImage image(kCoverSize, kCoverSize, QImage::Format_RGB32);
+    for (int y = 0; y < kCoverSize; ++y) {
+        for (int x = 0; x < kCoverSize; ++x) {
+            image.setPixel(x, y, qRgb(x * 4, y * 4, 160));
+        }
+    }
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (image.save(&buffer, "JPG", 85)) {
+        if (mimeType) {
+            *mimeType = "image/jpeg";
+        }
+        return data;
+    }
+
+    data.clear();
+    buffer.seek(0);
+    image.save(&buffer, "PNG");
+    if (mimeType) {
+        *mimeType = "image/png";
+    }
+    return data;
+}
+
+// ========== Writers ==========
+
+bool CorpusGenerator::writeMp3(CorpusEntry &entry, int sizeBytes, const QByteArray &cover)
+{
+    QByteArray frames;
+    frames.append(id3TextFrame("TIT2", entry.title));
+    frames.append(id3TextFrame("TPE1", entry.artist));
+    frames.append(id3TextFrame("TALB", entry.album));
+    frames.append(id3TextFrame("TRCK", QString::number(entry.trackNumber)));
+
+    // Audio length follows from the size budget left after the tag
+    const int tagEstimate = 10 + frames.size() + 64 + (cover.isEmpty() ? 0 : cover.size() + 32);
+    const int audioFrames = qMax(1, (sizeBytes - tagEstimate) / kMp3FrameBytes);
+    entry.durationMs = qint64(audioFrames) * kMp3SamplesPerFrame * 1000 / kSampleRate;
+    frames.append(id3TextFrame("TLEN", QString::number(entry.durationMs)));
+
+    if (!cover.isEmpty()) {
+        const bool png = cover.startsWith("\x89PNG");
+        QByteArray body;
+        body.append('\0');  // Latin-1 description
+        body.append(png ? "image/png" : "image/jpeg");
+        body.append('\0');
+        body.append('\3');  // front cover
+        body.append('\0');  // empty description
+        body.append(cover);
+        frames.append(id3Frame("APIC", body));
+    }
+
+    const int audioBytes = audioFrames * kMp3FrameBytes;
+    const int padding = qMax(0, sizeBytes - 10 - frames.size() - audioBytes);
+    frames.append(padding, '\0');
+
+    QByteArray data("ID3\x03\x00\x00", 6);
+    appendSyncsafe(data, quint32(frames.size()));
+    data.append(frames);
+
+    // MPEG-1 Layer III, 128 kbps, 44.1 kHz, stereo; all-zero side info
+    // and main data decode as silence
+    QByteArray frame(kMp3FrameBytes, '\0');
+    frame[0] = char(0xFF);
+    frame[1] = char(0xFB);
+    frame[2] = char(0x90);
+    frame[3] = char(0x00);
+    data.reserve(data.size() + audioBytes);
+    for (int i = 0; i < audioFrames; ++i) {
+        data.append(frame);
+    }
+
+    return writeFile(entry.filePath, data);
+}
+
+bool CorpusGenerator::writeFlac(CorpusEntry &entry, int sizeBytes, const QByteArray &cover)
+{
+    const quint32 frameCount = quint32(qMax<qint64>(1,
+        entry.durationMs * kSampleRate / 1000 / kFlacBlockSize));
+    const quint64 totalSamples = quint64(frameCount) * kFlacBlockSize;
+    entry.durationMs = qint64(totalSamples * 1000 / kSampleRate);
+
+    QByteArray audio;
+    for (quint32 i = 0; i < frameCount; ++i) {
+        audio.append(flacSilentFrame(i));
+    }
+
+    QByteArray streamInfo;
+    appendBE16(streamInfo, kFlacBlockSize);   // min block size
+    appendBE16(streamInfo, kFlacBlockSize);   // max block size
+    appendBE24(streamInfo, 0);                // min frame size (unknown)
+    appendBE24(streamInfo, 0);                // max frame size (unknown)
+    const quint64 packed = (quint64(kSampleRate) << 44) | (quint64(2 - 1) << 41)
+                         | (quint64(16 - 1) << 36) | totalSamples;
+    appendBE32(streamInfo, quint32(packed >> 32));
+    appendBE32(streamInfo, quint32(packed));
+    streamInfo.append(16, '\0');              // MD5 not computed
+
+    QByteArray comments;
+    const QByteArray vendor("EKNMusic corpus");
+    appendLE32(comments, quint32(vendor.size()));
+    comments.append(vendor);
+    const QList<QByteArray> fields = {
+        "TITLE=" + entry.title.toUtf8(),
+        "ARTIST=" + entry.artist.toUtf8(),
+        "ALBUM=" + entry.album.toUtf8(),
+        "TRACKNUMBER=" + QByteArray::number(entry.trackNumber)
+    };
+    appendLE32(comments, quint32(fields.size()));
+    for (const QByteArray &field : fields) {
+        appendLE32(comments, quint32(field.size()));
+        comments.append(field);
+    }
+
+    QByteArray data("fLaC", 4);
+    data.append(flacBlockHeader(0, streamInfo.size(), false));
+    data.append(streamInfo);
+    data.append(flacBlockHeader(4, comments.size(), false));
+    data.append(comments);
+
+    if (!cover.isEmpty()) {
+        const QByteArray mime = cover.startsWith("\x89PNG") ? "image/png" : "image/jpeg";
+        QByteArray picture;
+        appendBE32(picture, 3);  // front cover
+        appendBE32(picture, quint32(mime.size()));
+        picture.append(mime);
+        appendBE32(picture, 0);  // description
+        appendBE32(picture, kCoverSize);
+        appendBE32(picture, kCoverSize);
+        appendBE32(picture, 24);
+        appendBE32(picture, 0);
+        appendBE32(picture, quint32(cover.size()));
+        picture.append(cover);
+        data.append(flacBlockHeader(6, picture.size(), false));
+        data.append(picture);
+    }
+
+    // PADDING blocks bring the file up to the requested size; the last one
+    // carries the last-metadata-block flag
+    int remaining = qMax(0, sizeBytes - data.size() - audio.size() - 4);
+    while (remaining > kFlacMaxPadding + 4) {
+        data.append(flacBlockHeader(1, kFlacMaxPadding, false));
+        data.append(kFlacMaxPadding, '\0');
+        remaining -= kFlacMaxPadding + 4;
+    }
+    data.append(flacBlockHeader(1, remaining, true));
+    data.append(remaining, '\0');
+
+    data.append(audio);
+    return writeFile(entry.filePath, data);
+}
+
+bool CorpusGenerator::writeM4a(CorpusEntry &entry, int sizeBytes, const QByteArray &cover)
+{
+    QByteArray trkn(2, '\0');
+    appendBE16(trkn, quint32(entry.trackNumber));
+    appendBE16(trkn, 12);
+    trkn.append(2, '\0');
+
+    QByteArray items;
+    items.append(mp4DataItem(QByteArray("\xA9" "nam", 4), 1, entry.title.toUtf8()));
+    items.append(mp4DataItem(QByteArray("\xA9" "ART", 4), 1, entry.artist.toUtf8()));
+    items.append(mp4DataItem(QByteArray("\xA9" "alb", 4), 1, entry.album.toUtf8()));
+    items.append(mp4DataItem("trkn", 0, trkn));
+    if (!cover.isEmpty()) {
+        items.append(mp4DataItem("covr", cover.startsWith("\x89PNG") ? 14 : 13, cover));
+    }
+
+    QByteArray hdlr(4, '\0');  // pre_defined
+    hdlr.append("mdir");
+    hdlr.append("appl");
+    hdlr.append(8, '\0');      // reserved
+    hdlr.append('\0');         // empty name
+
+    QByteArray meta = mp4FullBox("hdlr", hdlr);
+    meta.append(mp4Box("ilst", items));
+
+    QByteArray moov = mp4Mvhd(entry.durationMs);
+    moov.append(mp4Box("udta", mp4FullBox("meta", meta)));
+
+    QByteArray ftyp("M4A ", 4);
+    appendBE32(ftyp, 0);
+    ftyp.append("M4A mp42isom", 12);
+
+    QByteArray data = mp4Box("ftyp", ftyp);
+    data.append(mp4Box("moov", moov));
+
+    const int padding = qMax(0, sizeBytes - data.size() - 8);
+    data.append(mp4Box("mdat", QByteArray(padding, '\0')));
+    return writeFile(entry.filePath, data);
+}
@@ -0,0 +1,58 @@
+#ifndef CORPUSGENERATOR_H
+#define CORPUSGENERATOR_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "models/track.h"
+
+// Synthetic music library for benchmarks.
+//
+// Writes tagged files laid out like a real library (Artist/Album/NN Title.ext):
+//   mp3   ID3v2.3 (TIT2/TPE1/TALB/TRCK/TLEN/APIC) + silent CBR MPEG-1 Layer III frames
+//   flac  STREAMINFO + VORBIS_COMMENT + PICTURE + silent constant-subframe frames
+//   m4a   ftyp + moov/udta/meta/ilst (©nam/©ART/©alb/trkn/covr) + mdat
+//
+// MP3 and FLAC files decode (as silence); M4A files carry realistic tag
+// atoms but no audio track, so players fall back to file-name metadata.
+// Files are padded to the requested size. Output is deterministic per seed.
+
+struct CorpusOptions {
+    QString directory;
+    int filesPerFormat = 20;
+    int fileKb = 256;
+    QStringList formats = {"mp3", "flac", "m4a"};
+    bool withCover = true;
+    quint32 seed = 1;
+};
+
+struct CorpusEntry {
+    QString filePath;
+    QString title;
+    QString artist;
+    QString album;
+    int trackNumber = 0;
+    qint64 durationMs = 0;
+};
+
+class CorpusGenerator
+{
+public:
+    // Write the corpus; returns the files written (empty on error)
+    static QList<CorpusEntry> generate(const CorpusOptions &options);
+
+    // In-memory tracks with the same naming scheme (no files), for
+    // benchmarks that only need metadata
+    static QList<Track> syntheticTracks(int count, quint32 seed = 1);
+
+    // Writers fill in entry.durationMs from the audio they actually wrote
+    static bool writeMp3(CorpusEntry &entry, int sizeBytes, const QByteArray &cover);
+    static bool writeFlac(CorpusEntry &entry, int sizeBytes, const QByteArray &cover);
+    static bool writeM4a(CorpusEntry &entry, int sizeBytes, const QByteArray &cover);
+
+    // Small JPEG (PNG if no JPEG writer is available) used as cover art
+    static QByteArray coverImage(QString *mimeType = nullptr);
+};
+
+#endif // CORPUSGENERATOR_H
@@ -0,0 +1,54 @@
+// Writes a synthetic tagged music library (see corpusgenerator.h), e.g. to
+// point the app or a profiler at a reproducible library.
+//
+// Usage: gen_corpus --out DIR [--count N] [--size-kb K]
+//                   [--formats mp3,flac,m4a] [--seed S] [--no-cover]
+
+#include "corpusgenerator.h"
+
+#include <QGuiApplication>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    // QImage encoders only; no window is ever shown
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+
+    CorpusOptions options;
+    for (int i = 1; i < argc; ++i) {
+        QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--out" && i + 1 < argc) {
+            options.directory = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--count" && i + 1 < argc) {
+            options.filesPerFormat = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--size-kb" && i + 1 < argc) {
+            options.fileKb = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--formats" && i + 1 < argc) {
+            options.formats = QString::fromLocal8Bit(argv[++i]).split(',', Qt::SkipEmptyParts);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = QString::fromLocal8Bit(argv[++i]).toUInt();
+        } else if (arg == "--no-cover") {
+            options.withCover = false;
+        }
+    }
+
+    if (options.directory.isEmpty() || options.formats.isEmpty()) {
+        QTextStream(stderr) << "Usage: gen_corpus --out DIR [--count N] [--size-kb K]"
+                               " [--formats mp3,flac,m4a] [--seed S] [--no-cover]\n";
+        return 2;
+    }
+
+    const QList<CorpusEntry> entries = CorpusGenerator::generate(options);
+    if (entries.isEmpty()) {
+        return 1;
+    }
+
+    QTextStream(stdout) << "Wrote " << entries.size() << " files (" << options.fileKb
+                        << " KB each) to " << options.directory << "\n";
+    return 0;
+}
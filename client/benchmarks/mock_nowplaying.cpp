@@ -0,0 +1,361 @@
+// NowPlayingFeed against a local mock of the AzuraCast now-playing API.
+//
+// A QTcpServer on 127.0.0.1 stands in for the host: it serves
+// /api/nowplaying/<station> for polls and a scripted Centrifugo SSE stream
+// on /api/live/nowplaying/sse, recording every request it gets. Two
+// scenarios run against the real feed (NowPlayingFeed::forHost()):
+//
+//   live      the stream sends a connect envelope split over two "data:"
+//             lines, a publication split across TCP writes, a ping and half
+//             an event, then drops. Every complete event's "np" object must
+//             arrive byte for byte, the half event must not; the feed must
+//             poll while the stream is down and reconnect with the id of
+//             the last complete event in Last-Event-ID, then go live again.
+//   fallback  the stream answers 503. The feed must stay on polling, keep
+//             polling on the schedule set through setRemainingHint() and
+//             keep retrying the stream.
+//
+// Exit code is 1 on a failed check.
+//
+// Usage: mock_nowplaying
+
+#include "services/nowplayingfeed.h"
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHostAddress>
+#include <QList>
+#include <QNetworkProxy>
+#include <QString>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QTimer>
+#include <QUrlQuery>
+
+#include <functional>
+#include <memory>
+
+namespace {
+
+constexpr char kStation[] = "mock_fm";
+// Reconnects back off from 1 s (plus up to 0.5 s of jitter); the fastest
+// scheduled poll is 2 s away
+constexpr int kStepTimeoutMs = 8000;
+
+QByteArray nowPlaying(const char *title)
+{
+    return QByteArray(R"({"station":{"name":"Mock FM","shortcode":"mock_fm"},)")
+           + R"("now_playing":{"song":{"title":")" + title + R"("},"remaining":120}})";
+}
+
+QByteArray publication(const QByteArray &np, int offset)
+{
+    return R"({"channel":"station:mock_fm","pub":{"data":{"np":)" + np
+           + R"(},"offset":)" + QByteArray::number(offset) + "}}";
+}
+
+// Serves one response per connection and records what was asked for
+class MockServer
+{
+public:
+    struct Request
+    {
+        QByteArray path;
+        QString connectQuery;  // Decoded "cq" of stream requests
+        QByteArray lastEventId;
+    };
+
+    // Called for each stream connection (1, 2, ...) after the headers went out
+    using StreamScript = std::function<void(QTcpSocket *socket, int connection)>;
+
+    bool listen()
+    {
+        QObject::connect(&m_server, &QTcpServer::newConnection, [this]() {
+            while (QTcpSocket *socket = m_server.nextPendingConnection()) {
+                accept(socket);
+            }
+        });
+        return m_server.listen(QHostAddress::LocalHost);
+    }
+
+    QString baseUrl() const
+    {
+        return QString("http://127.0.0.1:%1").arg(m_server.serverPort());
+    }
+
+    QList<Request> streamRequests;
+    int polls = 0;
+
+    bool streamAvailable = true;
+    QByteArray pollBody;
+    StreamScript streamScript;
+
+private:
+    void accept(QTcpSocket *socket)
+    {
+        QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        auto head = std::make_shared<QByteArray>();
+        QObject::connect(socket, &QTcpSocket::readyRead, socket, [this, socket, head]() {
+            head->append(socket->readAll());
+            const qsizetype end = head->indexOf("\r\n\r\n");
+            if (end >= 0) {
+                const QByteArray request = head->left(end);
+                head->clear();
+                respond(socket, request);
+            }
+        });
+    }
+
+    void respond(QTcpSocket *socket, const QByteArray &head)
+    {
+        const QList<QByteArray> lines = head.split('\n');
+        const QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+        const QByteArray target = requestLine.value(1);
+        const qsizetype question = target.indexOf('?');
+        const QByteArray path = question < 0 ? target : target.left(question);
+
+        if (path == "/api/live/nowplaying/sse") {
+            Request request;
+            request.path = path;
+            request.connectQuery = QUrlQuery(QString::fromUtf8(target.mid(question + 1)))
+                                       .queryItemValue("cq", QUrl::FullyDecoded);
+            for (const QByteArray &line : lines) {
+                if (line.toLower().startsWith("last-event-id:")) {
+                    request.lastEventId = line.mid(14).trimmed();
+                }
+            }
+            streamRequests.append(request);
+
+            if (!streamAvailable) {
+                reply(socket, "503 Service Unavailable", "text/plain", "unavailable");
+                return;
+            }
+            socket->write("HTTP/1.1 200 OK\r\n"
+                          "Content-Type: text/event-stream\r\n"
+                          "Cache-Control: no-cache\r\n"
+                          "Connection: close\r\n\r\n");
+            if (streamScript) {
+                streamScript(socket, int(streamRequests.size()));
+            }
+        } else if (path == QByteArray("/api/nowplaying/") + kStation) {
+            ++polls;
+            reply(socket, "200 OK", "application/json", pollBody);
+        } else {
+            reply(socket, "404 Not Found", "text/plain", "not found");
+        }
+    }
+
+    static void reply(QTcpSocket *socket, const QByteArray &status,
+                      const QByteArray &contentType, const QByteArray &body)
+    {
+        socket->write("HTTP/1.1 " + status + "\r\nContent-Type: " + contentType
+                      + "\r\nContent-Length: " + QByteArray::number(body.size())
+                      + "\r\nConnection: close\r\n\r\n" + body);
+        socket->disconnectFromHost();
+    }
+
+    QTcpServer m_server;
+};
+
+// Runs the event loop until done() holds or the step times out
+bool waitFor(const std::function<bool()> &done, int timeoutMs = kStepTimeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!done()) {
+        if (timer.elapsed() > timeoutMs) {
+            return false;
+        }
+        QEventLoop loop;
+        QTimer::singleShot(10, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+    return true;
+}
+
+struct Recorder
+{
+    QList<QByteArray> received;  // nowPlayingReceived payloads, in order
+    QList<NowPlayingFeed::Mode> modes;
+    int foreignStations = 0;
+    // Receiver of the connections below; the feeds outlive the scenarios
+    QObject context;
+
+    void attach(NowPlayingFeed *feed)
+    {
+        QObject::connect(feed, &NowPlayingFeed::nowPlayingReceived, &context,
+                         [this](const QString &stationId, const QByteArray &json) {
+            if (stationId != kStation) {
+                ++foreignStations;
+            }
+            received.append(json);
+        });
+        QObject::connect(feed, &NowPlayingFeed::modeChanged, &context,
+                         [this](NowPlayingFeed::Mode mode) {
+            modes.append(mode);
+        });
+    }
+};
+
+class Checks
+{
+public:
+    explicit Checks(QTextStream &out) : m_out(out) {}
+
+    void check(bool ok, const QString &what)
+    {
+        if (!ok) {
+            m_out << "  failed: " << what << "\n";
+            ++m_failures;
+        }
+    }
+
+    int failures() const { return m_failures; }
+
+private:
+    QTextStream &m_out;
+    int m_failures = 0;
+};
+
+void runLive(Checks &checks, QTextStream &out)
+{
+    const QByteArray polled = nowPlaying("Polled One");
+    const QByteArray live1 = nowPlaying("Live One");
+    const QByteArray live2 = nowPlaying("Live Two");
+    const QByteArray lost = nowPlaying("Never Completed");
+    const QByteArray live3 = nowPlaying("Live Three");
+
+    MockServer server;
+    server.pollBody = polled;
+    server.streamScript = [&](QTcpSocket *socket, int connection) {
+        if (connection == 1) {
+            // Connect envelope over two data lines, CRLF line ends
+            socket->write(": mock\r\n\r\nid: 812\r\ndata: {\"connect\":\r\n"
+                          "data: {\"client\":\"c\",\"version\":\"5.4.0\",\"subs\":{\"station:mock_fm\":"
+                          "{\"recoverable\":true,\"epoch\":\"e\",\"offset\":812,\"publications\":"
+                          "[{\"data\":{\"np\":" + live1 + "},\"offset\":812}]}}}}\r\n\r\n");
+            // A publication split mid-JSON across writes, then a ping
+            // (no id: keeps 813) and an event the drop cuts short
+            const QByteArray pub2 = publication(live2, 813);
+            QTimer::singleShot(50, socket, [socket, pub2]() {
+                socket->write("id: 813\ndata: " + pub2.left(pub2.size() / 2));
+            });
+            QTimer::singleShot(100, socket, [socket, pub2, lost]() {
+                socket->write(pub2.mid(pub2.size() / 2) + "\n\ndata: {}\n\n"
+                              + "id: 814\ndata: " + publication(lost, 814) + "\n");
+            });
+            QTimer::singleShot(150, socket, [socket]() {
+                socket->disconnectFromHost();
+            });
+        } else if (connection == 2) {
+            socket->write("id: 815\ndata: " + publication(live3, 815) + "\n\n");
+        }
+    };
+    if (!server.listen()) {
+        checks.check(false, "live: mock server listens");
+        return;
+    }
+
+    NowPlayingFeed *feed = NowPlayingFeed::forHost(server.baseUrl());
+    Recorder recorder;
+    recorder.attach(feed);
+    feed->subscribe(kStation);
+
+    checks.check(waitFor([&]() {
+        return server.polls >= 1 && recorder.received.contains(live2);
+    }), "live: first poll and both live events arrive");
+    checks.check(feed->mode() == NowPlayingFeed::Mode::Live, "live: feed is live");
+    checks.check(!server.streamRequests.isEmpty()
+                     && server.streamRequests.first().connectQuery.contains("\"station:mock_fm\"")
+                     && server.streamRequests.first().lastEventId.isEmpty(),
+                 "live: first stream request subscribes without Last-Event-ID");
+
+    checks.check(waitFor([&]() {
+        return server.polls >= 2 && server.streamRequests.size() >= 2
+               && recorder.received.contains(live3);
+    }), "live: polls after the drop, reconnects and resumes");
+    checks.check(server.streamRequests.value(1).lastEventId == "813",
+                 QString("live: reconnect sends Last-Event-ID 813 (got \"%1\")")
+                     .arg(QString::fromUtf8(server.streamRequests.value(1).lastEventId)));
+
+    QList<QByteArray> liveEvents;
+    for (const QByteArray &json : std::as_const(recorder.received)) {
+        if (json != polled) {
+            liveEvents.append(json);
+        }
+    }
+    checks.check(liveEvents == QList<QByteArray>({live1, live2, live3}),
+                 "live: exactly the complete events, in order and byte for byte");
+    checks.check(recorder.received.count(polled) >= 2, "live: poll bodies are passed on");
+    checks.check(recorder.foreignStations == 0, "live: every payload is for the subscribed station");
+
+    using Mode = NowPlayingFeed::Mode;
+    checks.check(recorder.modes == QList<Mode>({Mode::Polling, Mode::Live, Mode::Polling, Mode::Live}),
+                 "live: mode goes polling, live, polling, live");
+
+    out << QString("live: %1 stream connections, %2 polls, %3 payloads\n")
+               .arg(server.streamRequests.size()).arg(server.polls).arg(recorder.received.size());
+
+    feed->unsubscribe(kStation);
+    waitFor([&]() { return feed->mode() == Mode::Idle; });
+}
+
+void runFallback(Checks &checks, QTextStream &out)
+{
+    const QByteArray polled = nowPlaying("Polled Only");
+
+    MockServer server;
+    server.streamAvailable = false;
+    server.pollBody = polled;
+    if (!server.listen()) {
+        checks.check(false, "fallback: mock server listens");
+        return;
+    }
+
+    NowPlayingFeed *feed = NowPlayingFeed::forHost(server.baseUrl());
+    Recorder recorder;
+    recorder.attach(feed);
+    // Like RadioService: a song ending now brings the next poll to the minimum
+    QObject::connect(feed, &NowPlayingFeed::nowPlayingReceived, &recorder.context,
+                     [feed](const QString &stationId, const QByteArray &) {
+        feed->setRemainingHint(stationId, 0);
+    });
+    feed->subscribe(kStation);
+
+    checks.check(waitFor([&]() {
+        return server.polls >= 2 && server.streamRequests.size() >= 2;
+    }), "fallback: keeps polling and retrying the stream");
+    checks.check(recorder.received.size() >= 2 && recorder.received.count(polled) == recorder.received.size(),
+                 "fallback: every poll is passed on");
+    checks.check(recorder.modes == QList<NowPlayingFeed::Mode>({NowPlayingFeed::Mode::Polling}),
+                 "fallback: feed stays on polling");
+
+    out << QString("fallback: %1 stream attempts, %2 polls, %3 payloads\n")
+               .arg(server.streamRequests.size()).arg(server.polls).arg(recorder.received.size());
+
+    feed->unsubscribe(kStation);
+    waitFor([&]() { return feed->mode() == NowPlayingFeed::Mode::Idle; });
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    // The mock is local; a system proxy must not get in between
+    QNetworkProxy::setApplicationProxy(QNetworkProxy::NoProxy);
+
+    Checks checks(out);
+    runLive(checks, out);
+    runFallback(checks, out);
+
+    const bool ok = checks.failures() == 0;
+    out << (ok ? "OK\n" : "FAILED\n");
+    out.flush();
+    return ok ? 0 : 1;
+}
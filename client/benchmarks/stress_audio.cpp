@@ -0,0 +1,291 @@
+// Real-time stress test for the radio render path: JitterBuffer ->
+// AudioRenderThread -> the device side of its output ring.
+//
+// A producer thread feeds synthetic PCM into the jitter buffer at the real
+// playback rate, like the decoder does. A device thread pulls one period
+// at a time on a fixed schedule, like QAudioSink does, catching up with
+// several pulls when it woke late. Meanwhile one contention thread per core
+// (by default) allocates, copies and takes a shared mutex in a tight loop.
+//
+// The audio is a frame counter rather than a tone: every sample is
+// non-zero and one more than the previous, so the device thread sees any
+// gap (silence from an underrun, or a dropped piece) as a broken sequence.
+// After the initial prebuffering the run must show:
+//
+//   - no jitter buffer or render ring underruns and no broken sequence
+//   - the clock, fed from the device's pulls, agrees with the audio the
+//     device got (not with what was rendered ahead of it)
+//   - no allocation, free or pthread mutex lock inside the real-time
+//     scopes (RealtimeGuard; built in unless STRESS_WITH_TSAN is on)
+//
+// Run it as a user allowed SCHED_FIFO (RLIMIT_RTPRIO, e.g. via
+// /etc/security/limits.conf) to test the configuration users get with
+// real-time scheduling; it still runs, on ordinary priority, without.
+// Exit code is 1 on a failed check.
+//
+// Usage: stress_audio [--seconds S] [--contention N] [--periods N] [--lock-memory]
+
+#include "services/audiorenderthread.h"
+#include "services/jitterbuffer.h"
+#include "services/mediaclock.h"
+#include "utils/realtimeguard.h"
+
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QList>
+#include <QString>
+#include <QTextStream>
+#include <QThread>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+constexpr int kChannels = 2;
+constexpr int kJitterTargetMs = 200;
+constexpr int kPeriodMs = 10;
+// The producer stays this far ahead of playback: above the target, well
+// below the 3x cap where the jitter buffer starts dropping
+constexpr int kProducerLeadMs = kJitterTargetMs + 150;
+constexpr int kProducerChunkMs = 20;
+constexpr qint16 kCounterWrap = 30000;
+// Slewing keeps the clock this close to the audio pulled
+constexpr qint64 kMaxClockErrorUs = 20000;
+
+struct DeviceStats
+{
+    quint64 pulls = 0;
+    quint64 lateWakeups = 0;
+    quint64 brokenSequences = 0;
+    qint64 framesPlayed = 0;
+    qint64 maxClockErrorUs = 0;
+    QString firstBreak;
+};
+
+QAudioFormat makeFormat()
+{
+    QAudioFormat format;
+    format.setSampleRate(kSampleRate);
+    format.setChannelCount(kChannels);
+    format.setSampleFormat(QAudioFormat::Int16);
+    return format;
+}
+
+// Frame n carries (n % kCounterWrap) + 1 in every channel
+void fillCounter(qint16 *samples, qint64 firstFrame, int frames)
+{
+    for (int i = 0; i < frames; ++i) {
+        const qint16 value = qint16((firstFrame + i) % kCounterWrap + 1);
+        for (int c = 0; c < kChannels; ++c) {
+            samples[i * kChannels + c] = value;
+        }
+    }
+}
+
+qint16 nextCounter(qint16 value)
+{
+    return value == kCounterWrap ? 1 : qint16(value + 1);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int seconds = 10;
+    int contentionCount = QThread::idealThreadCount();
+    int periods = 20;
+    bool lockMemory = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--seconds" && i + 1 < argc) {
+            seconds = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--contention" && i + 1 < argc) {
+            contentionCount = qMax(0, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--periods" && i + 1 < argc) {
+            periods = qMax(2, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--lock-memory") {
+            lockMemory = true;
+        }
+    }
+
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    const QAudioFormat format = makeFormat();
+    const int frameBytes = format.bytesPerFrame();
+    const int periodFrames = format.framesForDuration(qint64(kPeriodMs) * 1000);
+
+    MediaClock clock;
+    JitterBuffer jitterBuffer(format, kJitterTargetMs);
+
+    AudioRenderThread::Options options;
+    options.periodMs = kPeriodMs;
+    options.periods = periods;
+    options.lockMemory = lockMemory;
+    options.lockSourceMemory = [&jitterBuffer]() {
+        return jitterBuffer.lockMemory();
+    };
+    AudioRenderThread renderThread(format, [&jitterBuffer](char *data, qint64 size) {
+        return jitterBuffer.render(data, size);
+    }, options);
+    renderThread.setClock(&clock);
+
+    std::atomic<bool> stop(false);
+    std::atomic<bool> playing(false);
+    std::atomic<quint64> contentionLoops(0);
+    DeviceStats device;
+    // The producer and the device thread come first and run at the
+    // priority their real counterparts get
+    QList<QThread*> threads;
+
+    // Decoder stand-in: never more than kProducerLeadMs ahead of real time
+    threads.append(QThread::create([&]() {
+        const int chunkFrames = format.framesForDuration(qint64(kProducerChunkMs) * 1000);
+        std::vector<qint16> chunk(size_t(chunkFrames) * kChannels);
+        const qint64 leadFrames = format.framesForDuration(qint64(kProducerLeadMs) * 1000);
+        QElapsedTimer timer;
+        timer.start();
+        qint64 frame = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+            const qint64 dueFrames = timer.elapsed() * kSampleRate / 1000 + leadFrames;
+            while (frame < dueFrames) {
+                fillCounter(chunk.data(), frame, chunkFrames);
+                jitterBuffer.appendPcm(reinterpret_cast<const char*>(chunk.data()),
+                                       qint64(chunkFrames) * frameBytes);
+                frame += chunkFrames;
+            }
+            QThread::msleep(kProducerChunkMs / 2);
+        }
+    }));
+
+    // QAudioSink stand-in: one period per period, on an absolute schedule
+    threads.append(QThread::create([&]() {
+        QIODevice *output = renderThread.outputDevice();
+        std::vector<qint16> buffer(size_t(periodFrames) * kChannels);
+        const qint64 periodNs = qint64(kPeriodMs) * 1000000;
+        QElapsedTimer timer;
+        timer.start();
+        qint64 nextPullNs = 0;
+        qint16 expected = 0;  // 0 until the first real frame arrives
+        while (!stop.load(std::memory_order_relaxed)) {
+            const qint64 nowNs = timer.nsecsElapsed();
+            if (nowNs < nextPullNs) {
+                QThread::usleep(qMax<qint64>(100, (nextPullNs - nowNs) / 1000));
+                continue;
+            }
+            if (nowNs - nextPullNs > periodNs) {
+                ++device.lateWakeups;
+            }
+
+            // A device that woke late drains what it missed at once
+            while (nextPullNs <= nowNs) {
+                output->read(reinterpret_cast<char*>(buffer.data()), qint64(buffer.size()) * 2);
+                ++device.pulls;
+                for (int i = 0; i < periodFrames; ++i) {
+                    const qint16 value = buffer[size_t(i) * kChannels];
+                    if (expected == 0) {
+                        if (value == 0) {
+                            continue;  // Still prebuffering
+                        }
+                        expected = value;
+                        playing.store(true, std::memory_order_relaxed);
+                    }
+                    if (value != expected) {
+                        if (device.brokenSequences++ == 0) {
+                            device.firstBreak = QString("frame %1: expected %2, got %3")
+                                                    .arg(device.framesPlayed).arg(expected).arg(value);
+                        }
+                        expected = value == 0 ? expected : value;
+                    }
+                    if (value != 0) {
+                        expected = nextCounter(expected);
+                        ++device.framesPlayed;
+                    }
+                }
+                nextPullNs += periodNs;
+            }
+            if (expected != 0) {
+                const qint64 playedUs = device.framesPlayed * 1000000 / kSampleRate;
+                device.maxClockErrorUs = qMax(device.maxClockErrorUs,
+                                              qAbs(clock.positionUs() - playedUs));
+            }
+        }
+    }));
+
+    std::mutex sharedMutex;
+    quint64 sharedSum = 0;
+    for (int t = 0; t < contentionCount; ++t) {
+        threads.append(QThread::create([&stop, &sharedMutex, &sharedSum, &contentionLoops]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                QByteArray scratch(64 * 1024, Qt::Uninitialized);
+                for (qsizetype i = 0; i < scratch.size(); i += 64) {
+                    scratch[i] = char(i);
+                }
+                {
+                    std::lock_guard<std::mutex> lock(sharedMutex);
+                    sharedSum += quint8(scratch.at(scratch.size() / 2));
+                }
+                contentionLoops.fetch_add(1, std::memory_order_relaxed);
+            }
+        }));
+    }
+
+    RealtimeGuard::reset();
+    renderThread.start(QThread::TimeCriticalPriority);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < threads.size(); ++i) {
+        threads.at(i)->start(i < 2 ? QThread::TimeCriticalPriority : QThread::NormalPriority);
+    }
+    QThread::sleep(seconds);
+    stop.store(true);
+    for (QThread *thread : std::as_const(threads)) {
+        thread->wait();
+        delete thread;
+    }
+    renderThread.stop();
+    const double elapsedSec = timer.nsecsElapsed() / 1e9;
+
+    const AudioRenderThread::Stats render = renderThread.stats();
+    const RealtimeGuard::Violations violations = RealtimeGuard::violations();
+    const quint64 jitterUnderruns = jitterBuffer.underruns();
+    const double playedSec = double(device.framesPlayed) / kSampleRate;
+
+    out << QString("%1 s, %2 contention threads (%3 loops), ring %4 x %5 ms\n")
+               .arg(elapsedSec, 0, 'f', 1).arg(contentionCount).arg(contentionLoops.load())
+               .arg(periods).arg(kPeriodMs);
+    out << QString("render thread: %1, memory %2, %3 periods, slowest %4 us\n")
+               .arg(render.realtimeScheduling ? "real-time scheduling" : "ordinary scheduling")
+               .arg(render.memoryLocked ? "locked" : "not locked")
+               .arg(render.periods).arg(render.maxRenderUs);
+    out << QString("device: %1 pulls, %2 late wake-ups, %3 s played, clock off by up to %4 ms\n")
+               .arg(device.pulls).arg(device.lateWakeups).arg(playedSec, 0, 'f', 2)
+               .arg(device.maxClockErrorUs / 1000.0, 0, 'f', 1);
+    out << QString("underruns: jitter buffer %1, render ring %2; broken sequences %3; dropped %4 ms\n")
+               .arg(jitterUnderruns).arg(render.underruns).arg(device.brokenSequences)
+               .arg(jitterBuffer.droppedMs());
+    if (!device.firstBreak.isEmpty()) {
+        out << "  first break: " << device.firstBreak << "\n";
+    }
+    out << QString("real-time scopes: %1 allocations, %2 frees, %3 mutex locks\n")
+               .arg(violations.allocations).arg(violations.frees).arg(violations.locks);
+
+    const bool ok = playing.load() && jitterUnderruns == 0 && render.underruns == 0
+                    && device.brokenSequences == 0 && violations.total() == 0
+                    && device.maxClockErrorUs <= kMaxClockErrorUs;
+    if (!playing.load()) {
+        out << "playback never started\n";
+    }
+    out << (ok ? "OK\n" : "FAILED\n");
+    out.flush();
+
+    Q_UNUSED(sharedSum);
+    return ok ? 0 : 1;
+}
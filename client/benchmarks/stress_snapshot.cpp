@@ -0,0 +1,223 @@
+// Concurrency stress test for LibrarySnapshotSlot (the library snapshots
+// MusicStorageService publishes for other threads).
+//
+// Writer threads keep publishing new versions through update(): each one
+// moves a random track (never row 0) and stamps row 0's album with the
+// version being published. Reader threads load() in a tight loop and check
+// every version they get:
+//
+//   - versions never go backwards for a reader
+//   - row 0 carries the snapshot's own version (no mixed or torn versions)
+//   - the path index agrees with the track list
+//   - size and the duration total never change (moves only)
+//
+// Readers also hold on to a few old versions while newer ones are swapped
+// in, to exercise snapshot lifetime. Build with -DSTRESS_WITH_TSAN=ON to run
+// under ThreadSanitizer; any report or failed check means a bug. Exit code
+// is 1 on a failed check.
+//
+// Usage: stress_snapshot [--readers N] [--writers N] [--tracks N] [--seconds S]
+
+#include "models/librarysnapshot.h"
+
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QList>
+#include <QRandomGenerator>
+#include <QString>
+#include <QTextStream>
+#include <QThread>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace {
+
+struct ReaderStats
+{
+    quint64 reads = 0;
+    quint64 versionsSeen = 0;
+    quint64 failures = 0;
+    QString firstFailure;
+};
+
+QList<Track> makeTracks(int count)
+{
+    QList<Track> tracks;
+    tracks.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Track track(QString("/music/stress/%1.mp3").arg(i, 6, 10, QChar('0')),
+                    QString("Title %1").arg(i), QString("Artist %1").arg(i % 97),
+                    QString("0"), 1000 + i);
+        tracks.append(track);
+    }
+    return tracks;
+}
+
+qint64 durationTotal(const LibrarySnapshot &snapshot)
+{
+    qint64 total = 0;
+    for (const Track &track : snapshot.tracks()) {
+        total += track.duration();
+    }
+    return total;
+}
+
+// Empty string when the snapshot is consistent
+QString checkSnapshot(const LibrarySnapshot &snapshot, int expectedSize, qint64 expectedTotal,
+                      QRandomGenerator &random)
+{
+    if (snapshot.version() == 0) {
+        return snapshot.isEmpty() ? QString() : QString("version 0 is not empty");
+    }
+    if (snapshot.size() != expectedSize) {
+        return QString("version %1 has %2 tracks").arg(snapshot.version()).arg(snapshot.size());
+    }
+    if (snapshot.trackAt(0).album().toULongLong() != snapshot.version()) {
+        return QString("version %1 carries the stamp of version %2")
+            .arg(snapshot.version()).arg(snapshot.trackAt(0).album());
+    }
+    for (int i = 0; i < 16; ++i) {
+        const int row = random.bounded(snapshot.size());
+        if (snapshot.indexOf(snapshot.trackAt(row).filePath()) != row) {
+            return QString("version %1: index disagrees at row %2").arg(snapshot.version()).arg(row);
+        }
+    }
+    if (durationTotal(snapshot) != expectedTotal) {
+        return QString("version %1: duration total changed").arg(snapshot.version());
+    }
+    return QString();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int readerCount = 4;
+    int writerCount = 2;
+    int trackCount = 2000;
+    int seconds = 5;
+
+    for (int i = 1; i < argc; ++i) {
+        const QString arg = QString::fromLocal8Bit(argv[i]);
+        if (arg == "--readers" && i + 1 < argc) {
+            readerCount = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--writers" && i + 1 < argc) {
+            writerCount = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--tracks" && i + 1 < argc) {
+            trackCount = qMax(2, QString::fromLocal8Bit(argv[++i]).toInt());
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = qMax(1, QString::fromLocal8Bit(argv[++i]).toInt());
+        }
+    }
+
+    // Track holds a QPixmap, which needs a GUI application even when null
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    LibrarySnapshotSlot slot;
+    QList<Track> initial = makeTracks(trackCount);
+    initial[0].setAlbum(QString("1"));
+    slot.publish(initial);
+    const qint64 expectedTotal = durationTotal(*slot.load());
+
+    std::atomic<bool> stop(false);
+    std::atomic<quint64> writes(0);
+    std::vector<ReaderStats> stats(readerCount);
+    QList<QThread*> threads;
+
+    for (int w = 0; w < writerCount; ++w) {
+        threads.append(QThread::create([&slot, &stop, &writes]() {
+            QRandomGenerator random(QRandomGenerator::global()->generate());
+            while (!stop.load(std::memory_order_relaxed)) {
+                slot.update([&slot, &random](QList<Track> &tracks) {
+                    // update() holds the writer lock, so the next version is known
+                    const quint64 next = slot.load()->version() + 1;
+                    const int from = 1 + random.bounded(int(tracks.size()) - 1);
+                    const int to = 1 + random.bounded(int(tracks.size()) - 1);
+                    tracks.move(from, to);
+                    tracks[0].setAlbum(QString::number(next));
+                });
+                writes.fetch_add(1, std::memory_order_relaxed);
+            }
+        }));
+    }
+
+    for (int r = 0; r < readerCount; ++r) {
+        ReaderStats *readerStats = &stats[r];
+        threads.append(QThread::create([&slot, &stop, readerStats, trackCount, expectedTotal]() {
+            QRandomGenerator random(QRandomGenerator::global()->generate());
+            LibrarySnapshotPtr held[8];
+            quint64 lastVersion = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                const LibrarySnapshotPtr snapshot = slot.load();
+                ++readerStats->reads;
+
+                QString failure;
+                if (snapshot->version() < lastVersion) {
+                    failure = QString("version went back from %1 to %2").arg(lastVersion).arg(snapshot->version());
+                } else {
+                    failure = checkSnapshot(*snapshot, trackCount, expectedTotal, random);
+                }
+                if (!failure.isEmpty()) {
+                    if (readerStats->failures++ == 0) {
+                        readerStats->firstFailure = failure;
+                    }
+                }
+
+                if (snapshot->version() != lastVersion) {
+                    ++readerStats->versionsSeen;
+                    lastVersion = snapshot->version();
+                    // Keep some old versions alive past later swaps, and
+                    // look at one again after they were replaced
+                    const int slotIndex = random.bounded(8);
+                    if (held[slotIndex]) {
+                        const QString stale = checkSnapshot(*held[slotIndex], trackCount, expectedTotal, random);
+                        if (!stale.isEmpty() && readerStats->failures++ == 0) {
+                            readerStats->firstFailure = "held " + stale;
+                        }
+                    }
+                    held[slotIndex] = snapshot;
+                }
+            }
+        }));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (QThread *thread : std::as_const(threads)) {
+        thread->start();
+    }
+    QThread::sleep(seconds);
+    stop.store(true);
+    for (QThread *thread : std::as_const(threads)) {
+        thread->wait();
+        delete thread;
+    }
+    const double elapsedSec = timer.nsecsElapsed() / 1e9;
+
+    quint64 reads = 0;
+    quint64 failures = 0;
+    out << QString("%1 writers, %2 readers, %3 tracks, %4 s\n")
+               .arg(writerCount).arg(readerCount).arg(trackCount).arg(elapsedSec, 0, 'f', 1);
+    out << QString("published %1 versions (%2/s)\n")
+               .arg(writes.load()).arg(writes.load() / elapsedSec, 0, 'f', 0);
+    for (int r = 0; r < readerCount; ++r) {
+        const ReaderStats &readerStats = stats[r];
+        reads += readerStats.reads;
+        failures += readerStats.failures;
+        out << QString("reader %1: %2 reads, %3 versions seen, %4 failures\n")
+                   .arg(r).arg(readerStats.reads).arg(readerStats.versionsSeen).arg(readerStats.failures);
+        if (!readerStats.firstFailure.isEmpty()) {
+            out << "  first failure: " << readerStats.firstFailure << "\n";
+        }
+    }
+    out << QString("%1 reads (%2/s), final version %3\n")
+               .arg(reads).arg(reads / elapsedSec, 0, 'f', 0).arg(slot.load()->version());
+    out << (failures == 0 ? "OK\n" : "FAILED\n");
+    out.flush();
+
+    return failures == 0 ? 0 : 1;
+}
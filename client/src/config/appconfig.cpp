@@ -1,4 +1,6 @@
 #include "appconfig.h"
+#include "ui/theme.h"
+#include "utils/startuptrace.h"
 #include <QApplication>
 #include <QFontDatabase>
 #include <QFont>
@@ -27,11 +29,14 @@ AppConfig* AppConfig::instance()
 
 void AppConfig::initializeApp()
 {
+    StartupTrace::Span span("AppConfig::initializeApp");
+
     // Set application metadata
     QApplication::setApplicationName(APP_NAME);
     QApplication::setApplicationVersion(APP_VERSION);
     QApplication::setOrganizationName(ORGANIZATION_NAME);
 
+    const qint64 fontStartNs = StartupTrace::nowNs();
     int fontId = QFontDatabase::addApplicationFont(FONT_PATH);
     if (fontId != -1) {
         QStringList fontFamilies = QFontDatabase::applicationFontFamilies(fontId);
@@ -44,6 +49,12 @@ void AppConfig::initializeApp()
     } else {
         qWarning() << "Failed to load Anime Ace font from resources";
     }
+    StartupTrace::record("fonts", fontStartNs, StartupTrace::nowNs());
+
+    // One application stylesheet, parsed once, instead of per-widget sheets
+    const qint64 themeStartNs = StartupTrace::nowNs();
+    Theme::apply();
+    StartupTrace::record("theme", themeStartNs, StartupTrace::nowNs());
 
     // Initialize instance for settings
     instance();
@@ -98,3 +109,23 @@ void AppConfig::setRadioApiKey(const QString &apiKey)
     m_settings->sync();
     qDebug() << "Radio API key stored securely";
 }
+
+int AppConfig::getRadioBufferMs() const
+{
+    return m_settings->value("radio/buffer_ms", 1500).toInt();
+}
+
+void AppConfig::setRadioBufferMs(int ms)
+{
+    m_settings->setValue("radio/buffer_ms", ms);
+}
+
+bool AppConfig::getRadioLockMemory() const
+{
+    return m_settings->value("radio/lock_memory", false).toBool();
+}
+
+void AppConfig::setRadioLockMemory(bool lock)
+{
+    m_settings->setValue("radio/lock_memory", lock);
+}
@@ -25,6 +25,15 @@ public:
     QString getRadioApiKey() const;
     void setRadioApiKey(const QString &apiKey);
 
+    // Radio stream jitter buffer target in milliseconds
+    int getRadioBufferMs() const;
+    void setRadioBufferMs(int ms);
+
+    // Pin the radio's audio buffers in RAM (mlock); off by default, as it
+    // needs a raised RLIMIT_MEMLOCK on most systems
+    bool getRadioLockMemory() const;
+    void setRadioLockMemory(bool lock);
+
 private:
     AppConfig();
     ~AppConfig();
@@ -2,20 +2,40 @@
 #include "config/appconfig.h"
 #include "ui/loginwindow.h"
 #include "services/musicstorageservice.h"
+#include "services/playbacksession.h"
+#include "utils/startuptrace.h"
+#include "utils/metrics.h"
 
 int main(int argc, char *argv[])
 {
+    const qint64 appStartNs = StartupTrace::nowNs();
     QApplication app(argc, argv);
+    StartupTrace::record("QApplication", appStartNs, StartupTrace::nowNs());
 
     // Initialize application configuration
     AppConfig::initializeApp();
 
     // Initialize music storage service to ensure songs directory exists
+    // (cheap: the library itself loads in the background after login)
     MusicStorageService::instance();
 
+    // Put the last track back before anything else loads, so play resumes
+    // at once even while the library is still loading (the rest of the
+    // queue follows once it has)
+    PlaybackSession::instance()->restore();
+
     // Create and show login window
+    const qint64 loginStartNs = StartupTrace::nowNs();
     LoginWindow loginWindow;
     loginWindow.show();
+    StartupTrace::record("LoginWindow", loginStartNs, StartupTrace::nowNs());
+
+#if defined(EKNM_METRICS_ENABLED)
+    // Hot-path metrics summary (scan/decode rates, HTTP latency, cache hits)
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, []() {
+        Metrics::logSnapshot();
+    });
+#endif
 
     return app.exec();
 }
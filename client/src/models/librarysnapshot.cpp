@@ -0,0 +1,71 @@
+#include "librarysnapshot.h"
+#include <QMutexLocker>
+
+// ========== LibrarySnapshot ==========
+
+LibrarySnapshot::LibrarySnapshot()
+    : m_version(0)
+{
+}
+
+LibrarySnapshot::LibrarySnapshot(quint64 version, const QList<Track> &tracks)
+    : m_version(version)
+    , m_tracks(tracks)
+{
+    // Shares the writer's list unless a pixmap has to go; tracks loaded from
+    // playlist.json never carry one, only freshly extracted files do
+    for (qsizetype i = 0; i < m_tracks.size(); ++i) {
+        if (!m_tracks.at(i).albumArt().isNull()) {
+            m_tracks[i].setAlbumArt(QPixmap());
+        }
+    }
+
+    m_rows.reserve(m_tracks.size());
+    for (qsizetype i = 0; i < m_tracks.size(); ++i) {
+        m_rows.insert(m_tracks.at(i).filePath(), int(i));
+    }
+}
+
+Track LibrarySnapshot::find(const QString &filePath) const
+{
+    const int row = indexOf(filePath);
+    return row >= 0 ? m_tracks.at(row) : Track();
+}
+
+// ========== LibrarySnapshotSlot ==========
+
+// std::atomic<std::shared_ptr> is C++20; the C++17 free functions give the
+// same guarantees for a plain shared_ptr as long as every access uses them
+
+LibrarySnapshotSlot::LibrarySnapshotSlot()
+    : m_current(std::make_shared<const LibrarySnapshot>())
+{
+}
+
+LibrarySnapshotPtr LibrarySnapshotSlot::load() const
+{
+    return std::atomic_load(&m_current);
+}
+
+LibrarySnapshotPtr LibrarySnapshotSlot::publish(const QList<Track> &tracks)
+{
+    QMutexLocker locker(&m_writeMutex);
+    return publishLocked(tracks);
+}
+
+LibrarySnapshotPtr LibrarySnapshotSlot::update(const std::function<void(QList<Track> &tracks)> &mutate)
+{
+    QMutexLocker locker(&m_writeMutex);
+    QList<Track> tracks = std::atomic_load(&m_current)->tracks();
+    mutate(tracks);
+    return publishLocked(tracks);
+}
+
+LibrarySnapshotPtr LibrarySnapshotSlot::publishLocked(const QList<Track> &tracks)
+{
+    // Built completely before the swap, so readers see all of it or none
+    const quint64 version = std::atomic_load(&m_current)->version() + 1;
+    LibrarySnapshotPtr next = std::make_shared<const LibrarySnapshot>(version, tracks);
+    std::atomic_store(&m_current, next);
+    return next;
+}
@@ -0,0 +1,90 @@
+#ifndef LIBRARYSNAPSHOT_H
+#define LIBRARYSNAPSHOT_H
+
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <QMutex>
+#include <functional>
+#include <memory>
+#include "models/track.h"
+
+class LibrarySnapshot;
+using LibrarySnapshotPtr = std::shared_ptr<const LibrarySnapshot>;
+
+/**
+ * @brief One immutable version of the library, safe to read from any thread
+ *
+ * Holds the tracks in library order plus a file path index, both fixed at
+ * construction. Album art pixmaps are dropped (QPixmap belongs to the GUI
+ * thread); albumArtPath is kept, so readers load covers the way the list
+ * delegates already do.
+ *
+ * Nothing in a snapshot changes after it is built, so any number of threads
+ * may use one concurrently without locking; use const access only.
+ * (Copying a Track copies its null QPixmap, which Qt allows off the GUI
+ * thread on every desktop platform.)
+ */
+class LibrarySnapshot
+{
+public:
+    LibrarySnapshot();
+    LibrarySnapshot(quint64 version, const QList<Track> &tracks);
+
+    // 0 for the empty snapshot published before the library is loaded
+    quint64 version() const { return m_version; }
+
+    const QList<Track> &tracks() const { return m_tracks; }
+    int size() const { return m_tracks.size(); }
+    bool isEmpty() const { return m_tracks.isEmpty(); }
+    const Track &trackAt(int row) const { return m_tracks.at(row); }
+
+    // Row of a file path, -1 if it is not in this version
+    int indexOf(const QString &filePath) const { return m_rows.value(filePath, -1); }
+    bool contains(const QString &filePath) const { return m_rows.contains(filePath); }
+    // Invalid Track if the file is not in this version
+    Track find(const QString &filePath) const;
+
+private:
+    quint64 m_version;
+    QList<Track> m_tracks;
+    QHash<QString, int> m_rows;  // File path -> index in m_tracks
+};
+
+/**
+ * @brief The current LibrarySnapshot, swapped atomically (read-copy-update)
+ *
+ * load() may be called from any thread and never waits for a writer's
+ * rebuild: it copies the shared pointer, and the version it got stays
+ * alive for as long as the reader holds it, however many versions are
+ * published since. The copy itself goes through std::atomic_load, which
+ * the standard libraries implement with a small global pool of locks, so a
+ * reader can briefly contend with the swap (never with the rebuild).
+ *
+ * Writers build a complete new version and swap it in; they are serialized
+ * among themselves so versions are strictly increasing. update() lets a
+ * writer derive the new version from the current one (read-modify-write).
+ */
+class LibrarySnapshotSlot
+{
+public:
+    LibrarySnapshotSlot();
+
+    LibrarySnapshotPtr load() const;
+
+    // Publish tracks as the next version and return it
+    LibrarySnapshotPtr publish(const QList<Track> &tracks);
+    // Publish the result of applying mutate to a copy of the current tracks
+    LibrarySnapshotPtr update(const std::function<void(QList<Track> &tracks)> &mutate);
+
+private:
+    LibrarySnapshotSlot(const LibrarySnapshotSlot&) = delete;
+    LibrarySnapshotSlot& operator=(const LibrarySnapshotSlot&) = delete;
+
+    LibrarySnapshotPtr publishLocked(const QList<Track> &tracks);
+
+    LibrarySnapshotPtr m_current;  // Only accessed through std::atomic_load/store
+    QMutex m_writeMutex;           // Serializes writers; readers never take it
+};
+
+#endif // LIBRARYSNAPSHOT_H
@@ -1,7 +1,18 @@
 #include "playlistdata.h"
+#include "utils/rankkey.h"
 #include <QJsonDocument>
 #include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
 #include <QDebug>
+#include <algorithm>
+
+namespace {
+constexpr int kSnapshotVersion = 2;
+// The journal is folded into a new snapshot once it holds more entries
+// than this, or than a quarter of the playlist, whichever is larger
+constexpr int kMinCompactEntries = 256;
+}
 
 // TrackData serialization
 QJsonObject TrackData::toJson() const
@@ -12,9 +23,17 @@ QJsonObject TrackData::toJson() const
     obj["artist"] = artist;
     obj["album"] = album;
     obj["duration"] = duration;
-    obj["orderIndex"] = orderIndex;
+    obj["rank"] = QString::fromLatin1(rank);
     obj["dateAdded"] = dateAdded.toString(Qt::ISODate);
     obj["fileSize"] = fileSize;
+    if (!albumArtPath.isEmpty()) {
+        obj["albumArtPath"] = albumArtPath;
+    }
+    if (!audioFilePath.isEmpty()) {
+        obj["audioFilePath"] = audioFilePath;
+        obj["startMs"] = startMs;
+        obj["endMs"] = endMs;
+    }
     return obj;
 }
 
@@ -26,20 +45,34 @@ TrackData TrackData::fromJson(const QJsonObject &json)
     data.artist = json["artist"].toString();
     data.album = json["album"].toString();
     data.duration = json["duration"].toInteger();
-    data.orderIndex = json["orderIndex"].toInt();
+    data.rank = json["rank"].toString().toLatin1();
     data.dateAdded = QDateTime::fromString(json["dateAdded"].toString(), Qt::ISODate);
     data.fileSize = json["fileSize"].toVariant().toLongLong();
+    data.albumArtPath = json["albumArtPath"].toString();
+    data.audioFilePath = json["audioFilePath"].toString();
+    data.startMs = json["startMs"].toInteger();
+    data.endMs = json["endMs"].toInteger();
     return data;
 }
 
 // PlaylistData implementation
 PlaylistData::PlaylistData()
+    : m_journalEntries(0)
 {
 }
 
+// ========== Tracks ==========
+
 void PlaylistData::setTrackData(const QString &filePath, const TrackData &data)
 {
-    m_tracks[filePath] = data;
+    TrackData stored = data;
+    stored.filePath = filePath;
+    insertTrack(stored);
+
+    QJsonObject entry;
+    entry["op"] = "set";
+    entry["track"] = m_tracks.value(filePath).toJson();
+    m_pendingEntries.append(entry);
 }
 
 TrackData PlaylistData::getTrackData(const QString &filePath) const
@@ -52,51 +85,121 @@ bool PlaylistData::hasTrackData(const QString &filePath) const
     return m_tracks.contains(filePath);
 }
 
-QList<TrackData> PlaylistData::getAllTracksOrdered() const
+QByteArray PlaylistData::trackRank(const QString &filePath) const
 {
-    QList<TrackData> tracks = m_tracks.values();
+    auto it = m_tracks.constFind(filePath);
+    return it != m_tracks.constEnd() ? it->rank : QByteArray();
+}
 
-    // Sort by order index
-    std::sort(tracks.begin(), tracks.end(), [](const TrackData &a, const TrackData &b) {
-        return a.orderIndex < b.orderIndex;
-    });
+QByteArray PlaylistData::lastRank() const
+{
+    return m_order.empty() ? QByteArray() : m_order.rbegin()->first;
+}
 
+QList<TrackData> PlaylistData::getAllTracksOrdered() const
+{
+    QList<TrackData> tracks;
+    tracks.reserve(m_tracks.size());
+    for (const auto &entry : m_order) {
+        tracks.append(m_tracks.value(entry.second));
+    }
     return tracks;
 }
 
-void PlaylistData::updateOrder(const QList<QString> &orderedFilePaths)
+bool PlaylistData::setTrackRank(const QString &filePath, const QByteArray &rank)
 {
-    qDebug() << "PlaylistData::updateOrder called with" << orderedFilePaths.size() << "tracks";
-    qDebug() << "Current m_tracks size:" << m_tracks.size();
+    if (!rerankTrack(filePath, rank)) {
+        return false;
+    }
 
-    for (int i = 0; i < orderedFilePaths.size(); ++i) {
-        const QString &path = orderedFilePaths[i];
-        if (m_tracks.contains(path)) {
-            m_tracks[path].orderIndex = i;
-            qDebug() << "  Updated order for:" << path << "-> index" << i;
-        } else {
-            qDebug() << "  WARNING: Track not found in m_tracks:" << path;
+    QJsonObject entry;
+    entry["op"] = "move";
+    entry["filePath"] = filePath;
+    entry["rank"] = QString::fromLatin1(m_tracks.value(filePath).rank);
+    m_pendingEntries.append(entry);
+    return true;
+}
+
+void PlaylistData::removeTrack(const QString &filePath)
+{
+    if (!eraseTrack(filePath)) {
+        return;
+    }
+
+    QJsonObject entry;
+    entry["op"] = "remove";
+    entry["filePath"] = filePath;
+    m_pendingEntries.append(entry);
+}
+
+void PlaylistData::insertTrack(TrackData data)
+{
+    auto existing = m_tracks.find(data.filePath);
+    if (existing != m_tracks.end()) {
+        if (data.rank.isEmpty()) {
+            data.rank = existing->rank;
         }
+        m_order.erase(existing->rank);
     }
 
-    qDebug() << "After update, m_tracks contains" << m_tracks.size() << "tracks";
+    if (!RankKey::isValid(data.rank)) {
+        data.rank = RankKey::after(lastRank());
+    }
+    data.rank = freeRank(data.rank, data.filePath);
+
+    m_order[data.rank] = data.filePath;
+    m_tracks.insert(data.filePath, data);
 }
 
-void PlaylistData::removeTrack(const QString &filePath)
+bool PlaylistData::rerankTrack(const QString &filePath, const QByteArray &rank)
+{
+    auto it = m_tracks.find(filePath);
+    if (it == m_tracks.end() || !RankKey::isValid(rank)) {
+        qWarning() << "PlaylistData::setTrackRank: cannot move" << filePath << "to" << rank;
+        return false;
+    }
+
+    m_order.erase(it->rank);
+    it->rank = freeRank(rank, filePath);
+    m_order[it->rank] = filePath;
+    return true;
+}
+
+bool PlaylistData::eraseTrack(const QString &filePath)
+{
+    auto it = m_tracks.find(filePath);
+    if (it == m_tracks.end()) {
+        return false;
+    }
+    m_order.erase(it->rank);
+    m_tracks.erase(it);
+    return true;
+}
+
+QByteArray PlaylistData::freeRank(const QByteArray &rank, const QString &filePath) const
 {
-    m_tracks.remove(filePath);
+    // Two tracks can only share a rank through hand-edited or merged files;
+    // the newcomer goes right after the current holder
+    auto it = m_order.find(rank);
+    if (it == m_order.end() || it->second == filePath) {
+        return rank;
+    }
+    auto next = std::next(it);
+    return RankKey::between(rank, next != m_order.end() ? next->first : QByteArray());
 }
 
+// ========== Snapshot ==========
+
 QJsonObject PlaylistData::toJson() const
 {
     QJsonObject obj;
     QJsonArray tracksArray;
 
-    for (const TrackData &track : m_tracks.values()) {
-        tracksArray.append(track.toJson());
+    for (const auto &entry : m_order) {
+        tracksArray.append(m_tracks.value(entry.second).toJson());
     }
 
-    obj["version"] = 1;
+    obj["version"] = kSnapshotVersion;
     obj["tracks"] = tracksArray;
     return obj;
 }
@@ -104,37 +207,74 @@ QJsonObject PlaylistData::toJson() const
 void PlaylistData::fromJson(const QJsonObject &json)
 {
     m_tracks.clear();
+    m_order.clear();
+    m_pendingEntries.clear();
+
+    // Version 1 files store a dense orderIndex instead of a rank; those
+    // tracks get ranks in orderIndex order after the ranked ones
+    QList<QPair<int, TrackData>> unranked;
 
     QJsonArray tracksArray = json["tracks"].toArray();
+    m_tracks.reserve(tracksArray.size());
     for (const QJsonValue &value : tracksArray) {
-        TrackData track = TrackData::fromJson(value.toObject());
-        m_tracks[track.filePath] = track;
+        const QJsonObject object = value.toObject();
+        TrackData track = TrackData::fromJson(object);
+        if (RankKey::isValid(track.rank)) {
+            insertTrack(track);
+        } else {
+            unranked.append(qMakePair(object["orderIndex"].toInt(), track));
+        }
+    }
+
+    std::stable_sort(unranked.begin(), unranked.end(),
+                     [](const QPair<int, TrackData> &a, const QPair<int, TrackData> &b) {
+        return a.first < b.first;
+    });
+    for (QPair<int, TrackData> &entry : unranked) {
+        entry.second.rank.clear();
+        insertTrack(entry.second);
     }
 }
 
-bool PlaylistData::saveToFile(const QString &filePath) const
+bool PlaylistData::saveToFile(const QString &filePath)
 {
     qDebug() << "PlaylistData::saveToFile - Saving" << m_tracks.size() << "tracks to:" << filePath;
 
-    QJsonObject obj = toJson();
-    QJsonDocument doc(obj);
-
-    // Debug: print what we're saving
-    QJsonArray tracksArray = obj["tracks"].toArray();
-    for (int i = 0; i < tracksArray.size(); ++i) {
-        QJsonObject trackObj = tracksArray[i].toObject();
-        qDebug() << "  Track" << i << ":" << trackObj["title"].toString()
-                 << "orderIndex:" << trackObj["orderIndex"].toInt();
+    // A crash between committing the snapshot and removing the journal
+    // leaves the journal to be replayed over the new snapshot. With the
+    // pending changes appended to it first, that replay ends at the
+    // snapshot's state. A journal with no snapshot under it is stale
+    const QString journal = journalPath(filePath);
+    if (!QFile::exists(filePath)) {
+        QFile::remove(journal);
+    } else if (QFile::exists(journal) && !appendToJournal(filePath)) {
+        return false;
     }
 
-    QFile file(filePath);
+    const QByteArray data = QJsonDocument(toJson()).toJson(QJsonDocument::Indented);
+
+    // Replaces the old snapshot only once the new one is complete; until
+    // then the old snapshot plus the journal still describe the playlists
+    QSaveFile file(filePath);
     if (!file.open(QIODevice::WriteOnly)) {
-        qWarning() << "Failed to open file for writing:" << filePath;
+        qWarning() << "Failed to open file for writing:" << filePath << file.errorString();
+        return false;
+    }
+    const qint64 bytesWritten = file.write(data);
+    if (bytesWritten != data.size()) {
+        qWarning() << "Failed to write playlist data:" << filePath << file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    if (!file.commit()) {
+        qWarning() << "Failed to save playlist data:" << filePath << file.errorString();
         return false;
     }
 
-    qint64 bytesWritten = file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    // Everything journaled so far is in the snapshot now
+    QFile::remove(journal);
+    m_journalEntries = 0;
+    m_pendingEntries.clear();
 
     qDebug() << "Playlist data saved successfully!" << bytesWritten << "bytes written";
     return true;
@@ -158,6 +298,97 @@ bool PlaylistData::loadFromFile(const QString &filePath)
     }
 
     fromJson(doc.object());
-    qDebug() << "Playlist data loaded from:" << filePath << "with" << m_tracks.size() << "tracks";
+    m_journalEntries = replayJournal(filePath);
+    qDebug() << "Playlist data loaded from:" << filePath << "with" << m_tracks.size() << "tracks,"
+             << m_journalEntries << "journal entries";
     return true;
 }
+
+// ========== Journal ==========
+
+QString PlaylistData::journalPath(const QString &filePath)
+{
+    const QFileInfo info(filePath);
+    return info.path() + "/" + info.completeBaseName() + ".journal";
+}
+
+bool PlaylistData::saveChanges(const QString &filePath)
+{
+    if (m_pendingEntries.isEmpty()) {
+        return true;
+    }
+
+    // No snapshot to journal against yet, or the journal has grown long
+    // enough that replaying it would cost more than rewriting the snapshot
+    const int compactAt = qMax(kMinCompactEntries, int(m_tracks.size() / 4));
+    if (m_journalEntries + m_pendingEntries.size() > compactAt || !QFile::exists(filePath)) {
+        return saveToFile(filePath);
+    }
+    return appendToJournal(filePath);
+}
+
+bool PlaylistData::appendToJournal(const QString &filePath)
+{
+    QByteArray lines;
+    for (const QJsonObject &entry : std::as_const(m_pendingEntries)) {
+        lines += QJsonDocument(entry).toJson(QJsonDocument::Compact);
+        lines += '\n';
+    }
+
+    QFile journal(journalPath(filePath));
+    if (!journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "Failed to open playlist journal for writing:" << journal.fileName();
+        return false;
+    }
+    if (journal.write(lines) != lines.size()) {
+        qWarning() << "Failed to append to playlist journal:" << journal.fileName();
+        return false;
+    }
+    journal.close();
+
+    m_journalEntries += m_pendingEntries.size();
+    m_pendingEntries.clear();
+    return true;
+}
+
+int PlaylistData::replayJournal(const QString &filePath)
+{
+    QFile journal(journalPath(filePath));
+    if (!journal.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    int entries = 0;
+    while (!journal.atEnd()) {
+        const QByteArray line = journal.readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+
+        // A write cut short by a crash leaves one unparsable line; the
+        // entries appended after it are still good
+        const QJsonDocument doc = QJsonDocument::fromJson(line);
+        if (!doc.isObject()) {
+            qWarning() << "Skipping damaged playlist journal entry in" << journal.fileName();
+            continue;
+        }
+        applyJournalEntry(doc.object());
+        ++entries;
+    }
+    return entries;
+}
+
+void PlaylistData::applyJournalEntry(const QJsonObject &entry)
+{
+    const QString op = entry["op"].toString();
+    if (op == "set") {
+        TrackData track = TrackData::fromJson(entry["track"].toObject());
+        if (!track.filePath.isEmpty()) {
+            insertTrack(track);
+        }
+    } else if (op == "move") {
+        rerankTrack(entry["filePath"].toString(), entry["rank"].toString().toLatin1());
+    } else if (op == "remove") {
+        eraseTrack(entry["filePath"].toString());
+    }
+}
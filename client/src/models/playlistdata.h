@@ -2,10 +2,13 @@
 #define PLAYLISTDATA_H
 
 #include <QString>
+#include <QByteArray>
 #include <QList>
+#include <QHash>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QDateTime>
+#include <map>
 
 struct TrackData
 {
@@ -13,33 +16,59 @@ struct TrackData
     QString title;
     QString artist;
     QString album;
-    qint64 duration;
-    int orderIndex; // Position in the playlist
+    qint64 duration = 0;
+    QByteArray rank; // Position in the playlist (RankKey, compared byte-wise)
     QDateTime dateAdded;
-    qint64 fileSize; // in bytes
+    qint64 fileSize = 0; // in bytes
+    QString albumArtPath; // Extracted or folder cover, if any
+    QString audioFilePath; // CUE sheet tracks: the album file, and the
+    qint64 startMs = 0;    // span in it (see Track::isVirtual())
+    qint64 endMs = 0;
 
     // Serialization
     QJsonObject toJson() const;
     static TrackData fromJson(const QJsonObject &json);
 };
 
+/**
+ * @brief Saved playlist: per-track metadata plus the user's order
+ *
+ * Order is kept as fractional rank keys (see RankKey) indexed in a sorted
+ * map, so moving a track is one O(log N) re-key that leaves every other
+ * entry untouched.
+ *
+ * Persistence is a full snapshot (playlist.json) plus an append-only
+ * journal next to it (playlist.journal). saveChanges() appends only the
+ * entries changed since the last save; the journal is folded into a new
+ * snapshot once it grows past a fraction of the playlist. loadFromFile()
+ * replays the journal over the snapshot. Before compacting, the pending
+ * entries are appended to the journal too, so if a crash leaves the old
+ * journal next to the new snapshot, replaying it in full ends at the
+ * snapshot's state.
+ */
 class PlaylistData
 {
 public:
     PlaylistData();
 
-    // Add or update track data
+    // Add or update track data; an empty rank keeps the track's current
+    // position, or appends a new track at the end
     void setTrackData(const QString &filePath, const TrackData &data);
 
     // Get track data
     TrackData getTrackData(const QString &filePath) const;
     bool hasTrackData(const QString &filePath) const;
+    QByteArray trackRank(const QString &filePath) const;
+    int trackCount() const { return m_tracks.size(); }
 
-    // Get all tracks sorted by order index
+    // Highest rank in use (empty if there are no tracks)
+    QByteArray lastRank() const;
+
+    // Get all tracks in playlist order
     QList<TrackData> getAllTracksOrdered() const;
 
-    // Update order for multiple tracks
-    void updateOrder(const QList<QString> &orderedFilePaths);
+    // Move a track to a new rank (see RankKey::between)
+    bool setTrackRank(const QString &filePath, const QByteArray &rank);
 
     // Remove track data
     void removeTrack(const QString &filePath);
@@ -48,12 +77,27 @@ public:
     QJsonObject toJson() const;
     void fromJson(const QJsonObject &json);
 
-    // Save/Load from file
-    bool saveToFile(const QString &filePath) const;
+    // Save/Load from file. saveToFile() writes a full snapshot and clears
+    // the journal; saveChanges() appends what changed since the last save
+    bool saveToFile(const QString &filePath);
+    bool saveChanges(const QString &filePath);
     bool loadFromFile(const QString &filePath);
 
 private:
-    QMap<QString, TrackData> m_tracks; // filePath -> TrackData
+    void insertTrack(TrackData data);
+    bool rerankTrack(const QString &filePath, const QByteArray &rank);
+    bool eraseTrack(const QString &filePath);
+    QByteArray freeRank(const QByteArray &rank, const QString &filePath) const;
+
+    void applyJournalEntry(const QJsonObject &entry);
+    bool appendToJournal(const QString &filePath);
+    int replayJournal(const QString &filePath);
+    static QString journalPath(const QString &filePath);
+
+    QHash<QString, TrackData> m_tracks;      // filePath -> TrackData
+    std::map<QByteArray, QString> m_order;   // rank -> filePath, in playlist order
+    QList<QJsonObject> m_pendingEntries;     // Changes not yet in the journal
+    int m_journalEntries;                    // Entries in the journal on disk
 };
 
 #endif // PLAYLISTDATA_H
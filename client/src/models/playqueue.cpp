@@ -0,0 +1,72 @@
+#include "playqueue.h"
+#include <QRandomGenerator>
+
+PlayQueue::PlayQueue()
+    : m_currentIndex(-1)
+{
+}
+
+void PlayQueue::setTracks(const QList<Track> &tracks, int startIndex)
+{
+    m_tracks = tracks;
+    m_currentIndex = m_tracks.isEmpty() ? -1 : qBound(0, startIndex, int(m_tracks.size()) - 1);
+}
+
+void PlayQueue::append(const Track &track)
+{
+    m_tracks.append(track);
+}
+
+void PlayQueue::clear()
+{
+    m_tracks.clear();
+    m_currentIndex = -1;
+}
+
+void PlayQueue::setCurrentIndex(int index)
+{
+    m_currentIndex = (index >= 0 && index < m_tracks.size()) ? index : -1;
+}
+
+Track PlayQueue::currentTrack() const
+{
+    return m_currentIndex >= 0 ? m_tracks[m_currentIndex] : Track();
+}
+
+int PlayQueue::nextIndex(bool shuffle, bool wrap) const
+{
+    if (m_tracks.isEmpty()) {
+        return -1;
+    }
+
+    if (shuffle) {
+        // Random track (avoid playing the same track)
+        int randomIndex = QRandomGenerator::global()->bounded(int(m_tracks.size()));
+        if (m_tracks.size() > 1) {
+            while (randomIndex == m_currentIndex) {
+                randomIndex = QRandomGenerator::global()->bounded(int(m_tracks.size()));
+            }
+        }
+        return randomIndex;
+    }
+
+    int nextIndex = m_currentIndex + 1;
+    if (nextIndex >= m_tracks.size()) {
+        return wrap ? 0 : -1; // Loop to beginning or end of playlist
+    }
+    return nextIndex;
+}
+
+int PlayQueue::previousIndex(bool shuffle, bool wrap) const
+{
+    if (m_tracks.isEmpty()) {
+        return -1;
+    }
+
+    int prevIndex = m_currentIndex - 1;
+    if (prevIndex < 0) {
+        // Shuffle always loops; otherwise stay at the beginning unless repeating
+        return (shuffle || wrap) ? int(m_tracks.size()) - 1 : 0;
+    }
+    return prevIndex;
+}
@@ -0,0 +1,42 @@
+#ifndef PLAYQUEUE_H
+#define PLAYQUEUE_H
+
+#include <QList>
+#include "models/track.h"
+
+/**
+ * @brief Ordered list of tracks with a current position
+ *
+ * Pure queue bookkeeping used by PlayerService (no media objects), so
+ * next/previous selection can be reasoned about and benchmarked on its
+ * own. Indices are -1 when there is no current or no next track.
+ */
+class PlayQueue
+{
+public:
+    PlayQueue();
+
+    // Replace the queue; the current position starts at startIndex
+    void setTracks(const QList<Track> &tracks, int startIndex = 0);
+    void append(const Track &track);
+    void clear();
+
+    const QList<Track> &tracks() const { return m_tracks; }
+    int size() const { return m_tracks.size(); }
+    bool isEmpty() const { return m_tracks.isEmpty(); }
+
+    int currentIndex() const { return m_currentIndex; }
+    void setCurrentIndex(int index);
+    Track currentTrack() const;
+
+    // Index to play after/before the current one. shuffle picks a random
+    // other track; wrap (repeat all) loops around the ends
+    int nextIndex(bool shuffle, bool wrap) const;
+    int previousIndex(bool shuffle, bool wrap) const;
+
+private:
+    QList<Track> m_tracks;
+    int m_currentIndex;
+};
+
+#endif // PLAYQUEUE_H
@@ -0,0 +1,163 @@
+#include "radiosonglistmodel.h"
+#include "services/thumbnailcache.h"
+#include "utils/metrics.h"
+#include <QHash>
+#include <QSet>
+
+RadioSongListModel::RadioSongListModel(ThumbnailCache *thumbnails, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_thumbnails(thumbnails)
+{
+    connect(m_thumbnails, &ThumbnailCache::thumbnailReady,
+            this, &RadioSongListModel::onThumbnailReady);
+}
+
+int RadioSongListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rows.size();
+}
+
+QVariant RadioSongListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    const Entry &entry = m_rows[index.row()].entry;
+    switch (role) {
+    case Qt::DisplayRole:
+    case TitleRole:
+        return entry.song.title;
+    case ArtistRole:
+        return entry.song.artist;
+    case SongIdRole:
+        return entry.song.id;
+    case SlotLabelRole:
+        return slotLabel(entry.slot);
+    case IsCurrentRole:
+        return entry.slot == Slot::Current;
+    case Qt::ToolTipRole:
+        return QString("%1\n%2").arg(entry.song.title, entry.song.artist);
+    case Qt::DecorationRole:
+        // Only rows that actually get painted trigger a download
+        return m_thumbnails->thumbnail(entry.song.artUrl);
+    default:
+        return QVariant();
+    }
+}
+
+QString RadioSongListModel::slotLabel(Slot slot)
+{
+    switch (slot) {
+    case Slot::Current: return "NOW PLAYING";
+    case Slot::Next: return "NEXT";
+    case Slot::Previous: break;
+    }
+    return "PREVIOUS";
+}
+
+QModelIndex RadioSongListModel::currentIndex() const
+{
+    for (int row = 0; row < m_rows.size(); ++row) {
+        if (m_rows[row].entry.slot == Slot::Current) {
+            return index(row);
+        }
+    }
+    return QModelIndex();
+}
+
+QList<RadioSongListModel::Row> RadioSongListModel::keyedRows(const QList<Entry> &entries)
+{
+    QList<Row> rows;
+    rows.reserve(entries.size());
+
+    QHash<QString, int> occurrences;
+    for (const Entry &entry : entries) {
+        // AzuraCast song ids are stable hashes; fall back to the text if missing
+        QString key = !entry.song.id.isEmpty()
+            ? entry.song.id
+            : entry.song.artist + QChar(0x1f) + entry.song.title;
+
+        // The same song can legitimately show up twice (e.g. replayed next)
+        int seen = occurrences.value(key, 0);
+        occurrences.insert(key, seen + 1);
+        if (seen > 0) {
+            key += QString("#%1").arg(seen);
+        }
+
+        rows.append({key, entry});
+    }
+    return rows;
+}
+
+int RadioSongListModel::findRow(const QString &key, int from) const
+{
+    // A handful of rows; a linear scan beats maintaining an index
+    for (int row = from; row < m_rows.size(); ++row) {
+        if (m_rows[row].key == key) {
+            return row;
+        }
+    }
+    return -1;
+}
+
+void RadioSongListModel::setEntries(const QList<Entry> &entries)
+{
+    EKNM_METRIC_COUNT(RadioListUpdates, 1);
+
+    const QList<Row> target = keyedRows(entries);
+
+    QSet<QString> targetKeys;
+    for (const Row &row : target) {
+        targetKeys.insert(row.key);
+    }
+
+    // 1. Remove rows that are gone, bottom-up, one call per contiguous run
+    for (int row = m_rows.size() - 1; row >= 0; --row) {
+        if (targetKeys.contains(m_rows[row].key)) {
+            continue;
+        }
+        int last = row;
+        while (row > 0 && !targetKeys.contains(m_rows[row - 1].key)) {
+            --row;
+        }
+        beginRemoveRows(QModelIndex(), row, last);
+        m_rows.remove(row, last - row + 1);
+        endRemoveRows();
+    }
+
+    // 2. Walk the target order: keep, move up or insert each row.
+    //    Every surviving old row is in target, so no row ever moves down.
+    for (int i = 0; i < target.size(); ++i) {
+        const Row &wanted = target[i];
+
+        if (i >= m_rows.size() || m_rows[i].key != wanted.key) {
+            int from = findRow(wanted.key, i + 1);
+            if (from >= 0) {
+                beginMoveRows(QModelIndex(), from, from, QModelIndex(), i);
+                m_rows.move(from, i);
+                endMoveRows();
+            } else {
+                beginInsertRows(QModelIndex(), i, i);
+                m_rows.insert(i, wanted);
+                endInsertRows();
+                continue;
+            }
+        }
+
+        // Same song, possibly in a different slot (NEXT -> NOW PLAYING)
+        if (m_rows[i].entry != wanted.entry) {
+            m_rows[i].entry = wanted.entry;
+            emit dataChanged(index(i), index(i));
+        }
+    }
+}
+
+void RadioSongListModel::onThumbnailReady(const QString &url)
+{
+    for (int row = 0; row < m_rows.size(); ++row) {
+        if (m_rows[row].entry.song.artUrl == url) {
+            emit dataChanged(index(row), index(row), {Qt::DecorationRole});
+        }
+    }
+}
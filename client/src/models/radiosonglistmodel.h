@@ -0,0 +1,77 @@
+#ifndef RADIOSONGLISTMODEL_H
+#define RADIOSONGLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include "models/radiostate.h"
+
+class ThumbnailCache;
+
+/**
+ * @brief List model for the radio page playlist (previous / now playing / next)
+ *
+ * setEntries() diffs the new rows against the current ones by key (the
+ * AzuraCast song id) and applies the minimal set of row removals, moves
+ * and inserts, plus dataChanged() for rows whose content changed. A row
+ * keeps its identity while it travels NEXT -> NOW PLAYING -> PREVIOUS, so
+ * views only repaint what moved and thumbnails are never re-fetched.
+ * Setting identical entries emits nothing.
+ */
+class RadioSongListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum class Slot {
+        Previous,
+        Current,
+        Next
+    };
+
+    enum Roles {
+        SongIdRole = Qt::UserRole + 1,
+        TitleRole,
+        ArtistRole,
+        SlotLabelRole,
+        IsCurrentRole
+    };
+
+    struct Entry {
+        RadioSongInfo song;
+        Slot slot = Slot::Previous;
+
+        bool operator==(const Entry &other) const {
+            return slot == other.slot && song == other.song;
+        }
+        bool operator!=(const Entry &other) const { return !(*this == other); }
+    };
+
+    explicit RadioSongListModel(ThumbnailCache *thumbnails, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // Replace the rows with a minimal keyed diff
+    void setEntries(const QList<Entry> &entries);
+
+    QModelIndex currentIndex() const;
+
+    static QString slotLabel(Slot slot);
+
+private slots:
+    void onThumbnailReady(const QString &url);
+
+private:
+    struct Row {
+        QString key;
+        Entry entry;
+    };
+
+    static QList<Row> keyedRows(const QList<Entry> &entries);
+    int findRow(const QString &key, int from) const;
+
+    ThumbnailCache *m_thumbnails;
+    QList<Row> m_rows;
+};
+
+#endif // RADIOSONGLISTMODEL_H
@@ -0,0 +1,61 @@
+#ifndef RADIOSTATE_H
+#define RADIOSTATE_H
+
+#include <QString>
+#include <QList>
+
+/**
+ * @brief Plain data describing what an AzuraCast station is playing
+ *
+ * Shared by RadioService, the nowplaying parser and the radio pages.
+ * RadioService re-exports these as RadioService::SongInfo etc.
+ */
+struct RadioSongInfo {
+    QString id;
+    QString title;
+    QString artist;
+    QString album;
+    QString artUrl;
+    int duration = 0;
+
+    bool operator==(const RadioSongInfo &other) const {
+        return id == other.id && title == other.title && artist == other.artist
+            && album == other.album && artUrl == other.artUrl && duration == other.duration;
+    }
+    bool operator!=(const RadioSongInfo &other) const { return !(*this == other); }
+};
+
+struct RadioNowPlayingInfo {
+    RadioSongInfo song;
+    QString stationName;
+    int elapsed = 0;
+    int duration = 0;
+    int remaining = 0;
+    int listeners = 0;
+    bool isOnline = false;
+};
+
+// Everything the nowplaying payload describes, parsed in one pass
+struct RadioState {
+    RadioNowPlayingInfo nowPlaying;
+    QList<RadioSongInfo> history;   // Newest first
+    QList<RadioSongInfo> queue;     // Upcoming songs (AzuraCast exposes the next one)
+};
+
+// Consolidated result of diffing a fresh RadioState against the cached one
+struct RadioStateChange {
+    RadioState state;
+    bool songChanged = false;      // Current song differs
+    bool stationChanged = false;   // Name, online flag or listener count differs
+    bool progressChanged = false;  // Elapsed or duration differs
+    bool historyChanged = false;
+    bool queueChanged = false;
+
+    bool listChanged() const { return songChanged || historyChanged || queueChanged; }
+    bool isEmpty() const {
+        return !songChanged && !stationChanged && !progressChanged
+            && !historyChanged && !queueChanged;
+    }
+};
+
+#endif // RADIOSTATE_H
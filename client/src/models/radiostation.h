@@ -0,0 +1,22 @@
+#ifndef RADIOSTATION_H
+#define RADIOSTATION_H
+
+#include <QString>
+
+/**
+ * @brief An AzuraCast station the app can play
+ *
+ * Entries come from StationRegistry (built-in, user settings, or
+ * discovered from a host's /api/stations).
+ */
+struct RadioStation {
+    QString id;             // AzuraCast shortcode, e.g. "eknm_intercom"
+    QString name;           // Display name
+    QString baseUrl;        // AzuraCast host, e.g. "https://radio.eknm.in"
+    QString streamUrl;      // Default listen mount
+    QString publicPageUrl;  // Public player page (song requests)
+
+    bool isValid() const { return !id.isEmpty() && !baseUrl.isEmpty(); }
+};
+
+#endif // RADIOSTATION_H
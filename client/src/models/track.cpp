@@ -4,6 +4,9 @@
 Track::Track()
     : m_duration(0)
     , m_isLiked(false)
+    , m_fileSize(0)
+    , m_startMs(0)
+    , m_endMs(0)
 {
 }
 
@@ -15,6 +18,9 @@ Track::Track(const QString &filePath, const QString &title,
     , m_album(album)
     , m_duration(duration)
     , m_isLiked(false)
+    , m_fileSize(0)
+    , m_startMs(0)
+    , m_endMs(0)
 {
     // If title is empty, use filename
     if (m_title.isEmpty() && !m_filePath.isEmpty()) {
@@ -16,7 +16,10 @@ public:
 
     // Getters
     QString filePath() const { return m_filePath; }
-    QUrl fileUrl() const { return QUrl::fromLocalFile(m_filePath); }
+    // File holding the audio: filePath() itself, or the album file a CUE
+    // sheet's virtual track is cut from
+    QString audioFilePath() const { return m_audioFilePath.isEmpty() ? m_filePath : m_audioFilePath; }
+    QUrl fileUrl() const { return QUrl::fromLocalFile(audioFilePath()); }
     QString title() const { return m_title; }
     QString artist() const { return m_artist; }
     QString album() const { return m_album; }
@@ -26,6 +29,10 @@ public:
     QPixmap albumArt() const { return m_albumArt; }
     QDateTime dateAdded() const { return m_dateAdded; }
     qint64 fileSize() const { return m_fileSize; }
+    // Span of a virtual track in its audio file (endMs 0: to the end)
+    qint64 startMs() const { return m_startMs; }
+    qint64 endMs() const { return m_endMs; }
+    bool isVirtual() const { return !m_audioFilePath.isEmpty(); }
 
     // Setters
     void setFilePath(const QString &path) { m_filePath = path; }
@@ -38,6 +45,12 @@ public:
     void setAlbumArt(const QPixmap &pixmap) { m_albumArt = pixmap; }
     void setDateAdded(const QDateTime &dt) { m_dateAdded = dt; }
     void setFileSize(qint64 size) { m_fileSize = size; }
+    void setAudioSpan(const QString &audioFilePath, qint64 startMs, qint64 endMs)
+    {
+        m_audioFilePath = audioFilePath;
+        m_startMs = startMs;
+        m_endMs = endMs;
+    }
 
     // Helper methods
     QString formattedDuration() const;
@@ -54,6 +67,9 @@ private:
     QPixmap m_albumArt;
     QDateTime m_dateAdded;
     qint64 m_fileSize; // in bytes
+    QString m_audioFilePath; // Virtual tracks only
+    qint64 m_startMs;
+    qint64 m_endMs;
 };
 
 #endif // TRACK_H
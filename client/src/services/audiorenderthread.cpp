@@ -0,0 +1,267 @@
+#include "audiorenderthread.h"
+#include "mediaclock.h"
+#include "utils/realtimeguard.h"
+#include <QIODevice>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <cstring>
+
+#if defined(Q_OS_UNIX)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+#if defined(Q_OS_MACOS)
+#include <pthread/qos.h>
+#endif
+
+namespace {
+constexpr int kMinPeriodMs = 2;
+constexpr int kMinPeriods = 2;
+// Above ordinary SCHED_FIFO users, below the kernel's own threads
+constexpr int kFifoPriority = 10;
+// Touched before the first period so growing the stack never faults later
+constexpr size_t kStackPrefaultBytes = 64 * 1024;
+
+// Sink side of the ring: pulls only copy bytes, short pulls are padded,
+// and the audio among what was pulled drives the clock
+class RenderOutputDevice : public QIODevice
+{
+public:
+    RenderOutputDevice(PcmRingBuffer *ring, const qint64 *periodAudio, qint64 periodBytes,
+                       const QAudioFormat &format)
+        : m_ring(ring)
+        , m_periodAudio(periodAudio)
+        , m_periodBytes(periodBytes)
+        , m_periods(ring->capacity() / periodBytes)
+        , m_format(format)
+        , m_frameBytes(qMax(1, format.bytesPerFrame()))
+        , m_silence(format.sampleFormat() == QAudioFormat::UInt8 ? char(0x80) : char(0))
+        , m_clock(nullptr)
+        , m_primed(false)
+        , m_underruns(0)
+    {
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    quint64 underruns() const { return m_underruns.load(std::memory_order_relaxed); }
+    void setClock(MediaClock *clock) { m_clock = clock; }
+
+    bool isSequential() const override { return true; }
+
+    qint64 bytesAvailable() const override
+    {
+        // Always readable: a ring that ran dry is served as silence
+        return m_ring->capacity() + QIODevice::bytesAvailable();
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        RealtimeGuard::Scope scope;
+        maxSize -= maxSize % m_frameBytes;
+        if (maxSize <= 0) {
+            return 0;
+        }
+
+        // Period slots are reused as soon as the read position passes them,
+        // so the clock looks at them before the read
+        const qint64 count = qMin(maxSize, m_ring->readable());
+        if (m_clock) {
+            feedClock(m_ring->totalRead(), count, count == maxSize);
+        }
+        m_ring->read(data, count);
+        if (count < maxSize) {
+            std::memset(data + count, m_silence, size_t(maxSize - count));
+            // Before the first full pull the renderer is still filling up
+            if (m_primed) {
+                m_underruns.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            m_primed = true;
+        }
+        return maxSize;
+    }
+
+    qint64 writeData(const char *data, qint64 maxSize) override
+    {
+        Q_UNUSED(data);
+        Q_UNUSED(maxSize);
+        return -1;
+    }
+
+private:
+    // Advance the clock by the audio in ring bytes [start, start + count);
+    // it keeps running only if the last byte the device got was audio
+    void feedClock(qint64 start, qint64 count, bool filled)
+    {
+        qint64 audioBytes = 0;
+        bool endsInAudio = false;
+        for (qint64 pos = start; pos < start + count;) {
+            const qint64 period = pos / m_periodBytes;
+            const qint64 periodEnd = qMin(start + count, (period + 1) * m_periodBytes);
+            const qint64 audioEnd = period * m_periodBytes + m_periodAudio[period % m_periods];
+            audioBytes += qMax<qint64>(0, qMin(periodEnd, audioEnd) - pos);
+            endsInAudio = periodEnd <= audioEnd;
+            pos = periodEnd;
+        }
+        const qint64 audioUs = audioBytes > 0 ? m_format.durationForBytes(qint32(audioBytes)) : 0;
+        m_clock->feed(audioUs, filled && endsInAudio);
+    }
+
+    PcmRingBuffer *m_ring;
+    const qint64 *m_periodAudio;
+    qint64 m_periodBytes;
+    qint64 m_periods;
+    QAudioFormat m_format;
+    qint64 m_frameBytes;
+    char m_silence;
+    MediaClock *m_clock;
+    bool m_primed;
+    std::atomic<quint64> m_underruns;
+};
+
+Q_NEVER_INLINE void prefaultStack()
+{
+    volatile char stack[kStackPrefaultBytes];
+    for (size_t i = 0; i < kStackPrefaultBytes; i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+qint64 periodBytesFor(const QAudioFormat &format, int periodMs)
+{
+    const qint32 frames = format.framesForDuration(qint64(qMax(kMinPeriodMs, periodMs)) * 1000);
+    return qMax<qint64>(1, format.bytesForFrames(frames));
+}
+}
+
+AudioRenderThread::AudioRenderThread(const QAudioFormat &format, RenderFunction render,
+                                     const Options &options, QObject *parent)
+    : QThread(parent)
+    , m_format(format)
+    , m_render(std::move(render))
+    , m_options(options)
+    , m_periodBytes(periodBytesFor(format, options.periodMs))
+    , m_period(new char[size_t(m_periodBytes)])
+    , m_ring(m_periodBytes * qMax(kMinPeriods, options.periods))
+    , m_periodAudio(new qint64[size_t(qMax(kMinPeriods, options.periods))]())
+    , m_output(new RenderOutputDevice(&m_ring, m_periodAudio.get(), m_periodBytes, format))
+    , m_stopRequested(false)
+    , m_periodsRendered(0)
+    , m_maxRenderNs(0)
+    , m_realtimeScheduling(false)
+    , m_memoryLocked(false)
+    , m_periodLocked(false)
+{
+    std::memset(m_period.get(), 0, size_t(m_periodBytes));
+    setObjectName("AudioRender");
+}
+
+AudioRenderThread::~AudioRenderThread()
+{
+    stop();
+    m_ring.unlockMemory();
+#if defined(Q_OS_UNIX)
+    if (m_periodLocked) {
+        munlock(m_period.get(), size_t(m_periodBytes));
+    }
+#endif
+}
+
+QIODevice *AudioRenderThread::outputDevice() const
+{
+    return m_output.get();
+}
+
+void AudioRenderThread::setClock(MediaClock *clock)
+{
+    static_cast<RenderOutputDevice*>(m_output.get())->setClock(clock);
+}
+
+void AudioRenderThread::stop()
+{
+    m_stopRequested.store(true, std::memory_order_release);
+    wait();
+}
+
+AudioRenderThread::Stats AudioRenderThread::stats() const
+{
+    Stats stats;
+    stats.periods = m_periodsRendered.load(std::memory_order_relaxed);
+    stats.underruns = static_cast<RenderOutputDevice*>(m_output.get())->underruns();
+    stats.maxRenderUs = m_maxRenderNs.load(std::memory_order_relaxed) / 1000;
+    stats.realtimeScheduling = m_realtimeScheduling.load(std::memory_order_relaxed);
+    stats.memoryLocked = m_memoryLocked.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// ========== Render Loop ==========
+
+void AudioRenderThread::run()
+{
+    raisePriority();
+
+    if (m_options.lockMemory) {
+#if defined(Q_OS_UNIX)
+        m_periodLocked = mlock(m_period.get(), size_t(m_periodBytes)) == 0;
+#endif
+        bool locked = m_ring.lockMemory() && m_periodLocked;
+        if (m_options.lockSourceMemory) {
+            locked = m_options.lockSourceMemory() && locked;
+        }
+        m_memoryLocked.store(locked, std::memory_order_relaxed);
+        if (!locked) {
+            qDebug() << "AudioRenderThread: cannot lock audio buffers in memory (RLIMIT_MEMLOCK)";
+        }
+    }
+    prefaultStack();
+
+    // Wake twice per period: the ring is topped up well before it drains
+    const unsigned long sleepUs = qMax(1000, qMax(kMinPeriodMs, m_options.periodMs) * 500);
+    while (!m_stopRequested.load(std::memory_order_acquire)) {
+        renderAvailablePeriods();
+        // Logging allocates, so it happens here, outside the scope
+        RealtimeGuard::reportNew("audio render");
+        QThread::usleep(sleepUs);
+    }
+}
+
+void AudioRenderThread::renderAvailablePeriods()
+{
+    const qint64 periods = m_ring.capacity() / m_periodBytes;
+    QElapsedTimer timer;
+    while (m_ring.writable() >= m_periodBytes) {
+        timer.start();
+        {
+            RealtimeGuard::Scope scope;
+            const qint64 audioBytes = m_render(m_period.get(), m_periodBytes);
+            // The slot is free: the sink has taken the period that used it
+            m_periodAudio[(m_ring.totalWritten() / m_periodBytes) % periods] = audioBytes;
+            m_ring.write(m_period.get(), m_periodBytes);
+        }
+        const qint64 elapsedNs = timer.nsecsElapsed();
+        if (elapsedNs > m_maxRenderNs.load(std::memory_order_relaxed)) {
+            m_maxRenderNs.store(elapsedNs, std::memory_order_relaxed);
+        }
+        m_periodsRendered.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void AudioRenderThread::raisePriority()
+{
+    bool realtime = false;
+#if defined(Q_OS_LINUX)
+    sched_param param {};
+    param.sched_priority = qMin(sched_get_priority_min(SCHED_FIFO) + kFifoPriority,
+                                sched_get_priority_max(SCHED_FIFO));
+    realtime = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    if (!realtime) {
+        qDebug() << "AudioRenderThread: SCHED_FIFO not permitted, using"
+                 << "TimeCriticalPriority only";
+    }
+#elif defined(Q_OS_MACOS)
+    realtime = pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) == 0;
+#endif
+    m_realtimeScheduling.store(realtime, std::memory_order_relaxed);
+}
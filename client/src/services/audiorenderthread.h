@@ -0,0 +1,105 @@
+#ifndef AUDIORENDERTHREAD_H
+#define AUDIORENDERTHREAD_H
+
+#include "utils/pcmringbuffer.h"
+#include <QThread>
+#include <QAudioFormat>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class QIODevice;
+class MediaClock;
+
+/**
+ * @brief Dedicated high-priority thread that renders audio ahead of the sink
+ *
+ * The render function is called on this thread for one period at a time
+ * and its output queued in a PcmRingBuffer a few periods deep. QAudioSink
+ * pulls from outputDevice(), which only copies out of that ring. Neither
+ * side allocates, locks or waits once started, so a busy GUI thread or
+ * decoder can't make the device run dry; both run inside a
+ * RealtimeGuard::Scope, so builds with ENABLE_RT_CHECKS report it if they
+ * ever do.
+ *
+ * The thread asks for TimeCriticalPriority and, on Linux, SCHED_FIFO where
+ * the user is permitted to (RLIMIT_RTPRIO); macOS gets the
+ * user-interactive QoS class. Without those it still runs, only with
+ * ordinary scheduling. With Options::lockMemory the buffers are pinned in
+ * RAM so the audio path can't page-fault.
+ *
+ * The ring runs up to a few hundred milliseconds ahead of the device, so
+ * an optional MediaClock is fed from the sink's pulls rather than from
+ * rendering: each period slot remembers how much of it is real audio, and
+ * only audio the sink actually took advances the clock.
+ */
+class AudioRenderThread : public QThread
+{
+    Q_OBJECT
+
+public:
+    struct Options
+    {
+        int periodMs = 10;        // Rendered per call of the render function
+        int periods = 20;         // Depth of the ring the sink pulls from
+        bool lockMemory = false;  // mlock the period buffer and the ring
+        // With lockMemory: pins what the render function reads, on the
+        // render thread before the first period; false if it couldn't
+        std::function<bool()> lockSourceMemory;
+    };
+
+    // Fills all size bytes and returns how many of them, from the start,
+    // are audio rather than silence; called on the render thread only
+    using RenderFunction = std::function<qint64(char *data, qint64 size)>;
+
+    struct Stats
+    {
+        quint64 periods = 0;          // Periods rendered
+        quint64 underruns = 0;        // Sink pulls the ring couldn't fill
+        qint64 maxRenderUs = 0;       // Slowest call of the render function
+        bool realtimeScheduling = false;
+        bool memoryLocked = false;
+    };
+
+    AudioRenderThread(const QAudioFormat &format, RenderFunction render,
+                      const Options &options, QObject *parent = nullptr);
+    ~AudioRenderThread() override;
+
+    // For QAudioSink::start() (pull mode); owned by this object
+    QIODevice *outputDevice() const;
+    // Clock fed from the sink's pulls; set before the sink starts
+    void setClock(MediaClock *clock);
+
+    // Start with start(QThread::TimeCriticalPriority); stop() joins
+    void stop();
+
+    Stats stats() const;
+
+protected:
+    void run() override;
+
+private:
+    void raisePriority();
+    void renderAvailablePeriods();
+
+    QAudioFormat m_format;
+    RenderFunction m_render;
+    Options m_options;
+    qint64 m_periodBytes;
+
+    std::unique_ptr<char[]> m_period;
+    PcmRingBuffer m_ring;
+    // Audio bytes at the start of each period slot of the ring, written
+    // before the period is published and read once the sink takes it
+    std::unique_ptr<qint64[]> m_periodAudio;
+    std::unique_ptr<QIODevice> m_output;
+
+    std::atomic<bool> m_stopRequested;
+    std::atomic<quint64> m_periodsRendered;
+    std::atomic<qint64> m_maxRenderNs;
+    std::atomic<bool> m_realtimeScheduling;
+    std::atomic<bool> m_memoryLocked;
+    bool m_periodLocked;
+};
+
+#endif // AUDIORENDERTHREAD_H
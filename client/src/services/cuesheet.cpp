@@ -0,0 +1,168 @@
+#include "cuesheet.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringDecoder>
+#include <QStringList>
+#include <QDebug>
+
+namespace {
+// INDEX times are mm:ss:ff with 75 CD frames per second
+constexpr int kFramesPerSecond = 75;
+// Sheets are a few KiB; anything much larger is not one
+constexpr qint64 kMaxSheetBytes = 256 * 1024;
+
+// Words of one command line; quoted words may hold spaces
+QStringList splitWords(QStringView line)
+{
+    QStringList words;
+    qsizetype i = 0;
+    while (i < line.size()) {
+        while (i < line.size() && line.at(i).isSpace()) {
+            ++i;
+        }
+        if (i >= line.size()) {
+            break;
+        }
+        if (line.at(i) == u'"') {
+            const qsizetype close = line.indexOf(u'"', i + 1);
+            const qsizetype end = close < 0 ? line.size() : close;
+            words.append(line.mid(i + 1, end - i - 1).toString());
+            i = end + 1;
+        } else {
+            qsizetype end = i;
+            while (end < line.size() && !line.at(end).isSpace()) {
+                ++end;
+            }
+            words.append(line.mid(i, end - i).toString());
+            i = end;
+        }
+    }
+    return words;
+}
+
+QString decodeText(QByteArrayView data)
+{
+    if (data.startsWith("\xEF\xBB\xBF")) {
+        data = data.mid(3);
+    }
+    QStringDecoder utf8(QStringDecoder::Utf8);
+    const QString text = utf8.decode(data);
+    return utf8.hasError() ? QString::fromLatin1(data) : text;
+}
+}
+
+// ========== Parsing ==========
+
+CueSheet CueSheet::read(const QString &cuePath)
+{
+    QFile file(cuePath);
+    if (!file.open(QIODevice::ReadOnly) || file.size() > kMaxSheetBytes) {
+        return CueSheet();
+    }
+
+    CueSheet sheet = parse(file.readAll());
+    if (!sheet.m_audioFile.isEmpty()) {
+        // Rippers write Windows separators even in sheets used elsewhere
+        const QString audioFile = QString(sheet.m_audioFile).replace(u'\\', u'/');
+        sheet.m_audioFile = QFileInfo(audioFile).isAbsolute()
+            ? audioFile
+            : QFileInfo(cuePath).dir().filePath(audioFile);
+    }
+    return sheet;
+}
+
+CueSheet CueSheet::parse(QByteArrayView data)
+{
+    CueSheet sheet;
+    const QString text = decodeText(data);
+
+    int files = 0;
+    Entry *entry = nullptr;  // Null before the first TRACK and in skipped ones
+    bool inTrack = false;    // Past the first TRACK, so no album-level fields
+    bool entryHasStart = false;
+    for (QStringView line : QStringView(text).split(u'\n', Qt::SkipEmptyParts)) {
+        const QStringList words = splitWords(line.trimmed());
+        if (words.isEmpty()) {
+            continue;
+        }
+        const QString command = words.first().toUpper();
+        const QString argument = words.value(1);
+
+        if (command == "FILE") {
+            if (++files > 1) {
+                qDebug() << "CueSheet: more than one FILE, not a single-file rip";
+                return CueSheet();
+            }
+            sheet.m_audioFile = argument;
+        } else if (command == "TRACK") {
+            // A track without an INDEX 01 can't be placed
+            if (entry && !entryHasStart) {
+                return CueSheet();
+            }
+            // Data tracks of mixed-mode discs are not in the rip
+            inTrack = true;
+            entry = nullptr;
+            if (files == 1 && words.value(2).toUpper() == "AUDIO") {
+                entry = &sheet.m_entries.emplace_back();
+                entry->number = argument.toInt();
+                entryHasStart = false;
+            }
+        } else if (command == "TITLE") {
+            // A skipped track's own fields are dropped with it
+            if (entry) {
+                entry->title = argument;
+            } else if (!inTrack) {
+                sheet.m_title = argument;
+            }
+        } else if (command == "PERFORMER") {
+            if (entry) {
+                entry->performer = argument;
+            } else if (!inTrack) {
+                sheet.m_performer = argument;
+            }
+        } else if (command == "INDEX" && entry && argument.toInt() == 1) {
+            const qint64 startMs = parseTimestamp(words.value(2));
+            if (startMs < 0) {
+                return CueSheet();
+            }
+            entry->startMs = startMs;
+            entryHasStart = true;
+        }
+    }
+    if (entry && !entryHasStart) {
+        return CueSheet();
+    }
+
+    // Spans: each track runs up to the start of the next one
+    for (qsizetype i = 0; i < sheet.m_entries.size(); ++i) {
+        Entry &current = sheet.m_entries[i];
+        if (current.performer.isEmpty()) {
+            current.performer = sheet.m_performer;
+        }
+        if (i + 1 < sheet.m_entries.size()) {
+            current.endMs = sheet.m_entries.at(i + 1).startMs;
+            if (current.endMs <= current.startMs) {
+                qDebug() << "CueSheet: track" << current.number << "has no length";
+                return CueSheet();
+            }
+        }
+    }
+    return sheet;
+}
+
+qint64 CueSheet::parseTimestamp(QStringView text)
+{
+    const QList<QStringView> parts = text.split(u':');
+    if (parts.size() != 3) {
+        return -1;
+    }
+    bool minutesOk = false, secondsOk = false, framesOk = false;
+    const qint64 minutes = parts.at(0).toLongLong(&minutesOk);
+    const int seconds = parts.at(1).toInt(&secondsOk);
+    const int frames = parts.at(2).toInt(&framesOk);
+    if (!minutesOk || !secondsOk || !framesOk || seconds >= 60 || frames >= kFramesPerSecond) {
+        return -1;
+    }
+    return (minutes * 60 + seconds) * 1000 + frames * 1000 / kFramesPerSecond;
+}
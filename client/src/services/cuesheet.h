@@ -0,0 +1,57 @@
+#ifndef CUESHEET_H
+#define CUESHEET_H
+
+#include <QByteArrayView>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief Track list of a single-file album rip (.cue)
+ *
+ * Reads the commands that describe where each track starts in the album
+ * file: FILE, TRACK, INDEX 01, plus TITLE and PERFORMER at album and track
+ * level. Everything else (REM, FLAGS, ISRC, INDEX 00 pregaps...) is
+ * skipped. A track ends where the next one starts; the last one runs to
+ * the end of the file (endMs 0).
+ *
+ * Only sheets that describe one audio file are valid: in multi-file sheets
+ * every track is a file of its own, which the library lists anyway.
+ *
+ * Sheets are usually UTF-8, but older rippers wrote the local 8-bit code
+ * page; text that is not valid UTF-8 is read as Latin-1.
+ */
+class CueSheet
+{
+public:
+    struct Entry
+    {
+        int number = 0;
+        QString title;
+        QString performer;   // The album performer if the track has none
+        qint64 startMs = 0;
+        qint64 endMs = 0;    // 0: to the end of the file
+    };
+
+    CueSheet() = default;
+
+    // Sheet at cuePath; its FILE is resolved relative to the sheet's folder
+    static CueSheet read(const QString &cuePath);
+    static CueSheet parse(QByteArrayView data);
+
+    bool isValid() const { return !m_audioFile.isEmpty() && !m_entries.isEmpty(); }
+
+    QString audioFile() const { return m_audioFile; }
+    QString title() const { return m_title; }
+    QString performer() const { return m_performer; }
+    const QList<Entry> &entries() const { return m_entries; }
+
+private:
+    static qint64 parseTimestamp(QStringView text);
+
+    QString m_audioFile;
+    QString m_title;
+    QString m_performer;
+    QList<Entry> m_entries;
+};
+
+#endif // CUESHEET_H
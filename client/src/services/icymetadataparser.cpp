@@ -0,0 +1,95 @@
+#include "icymetadataparser.h"
+
+IcyMetadataParser::IcyMetadataParser()
+{
+    reset(0);
+}
+
+void IcyMetadataParser::reset(int metaInterval)
+{
+    m_state = State::Audio;
+    m_metaInterval = qMax(0, metaInterval);
+    m_audioRemaining = m_metaInterval;
+    m_metaRemaining = 0;
+    m_metadata.clear();
+}
+
+void IcyMetadataParser::feed(const QByteArray &data, QByteArray &audio, QList<QByteArray> &metadata)
+{
+    if (m_metaInterval == 0) {
+        audio.append(data);
+        return;
+    }
+
+    qsizetype pos = 0;
+    const qsizetype size = data.size();
+
+    while (pos < size) {
+        switch (m_state) {
+        case State::Audio: {
+            qsizetype count = qMin<qsizetype>(m_audioRemaining, size - pos);
+            audio.append(data.constData() + pos, count);
+            pos += count;
+            m_audioRemaining -= static_cast<int>(count);
+            if (m_audioRemaining == 0) {
+                m_state = State::Length;
+            }
+            break;
+        }
+        case State::Length: {
+            int length = static_cast<unsigned char>(data[pos++]) * 16;
+            if (length == 0) {
+                // Title unchanged since the last block
+                m_state = State::Audio;
+                m_audioRemaining = m_metaInterval;
+            } else {
+                m_metaRemaining = length;
+                m_metadata.clear();
+                m_state = State::Metadata;
+            }
+            break;
+        }
+        case State::Metadata: {
+            qsizetype count = qMin<qsizetype>(m_metaRemaining, size - pos);
+            m_metadata.append(data.constData() + pos, count);
+            pos += count;
+            m_metaRemaining -= static_cast<int>(count);
+            if (m_metaRemaining == 0) {
+                metadata.append(m_metadata);
+                m_state = State::Audio;
+                m_audioRemaining = m_metaInterval;
+            }
+            break;
+        }
+        }
+    }
+}
+
+QString IcyMetadataParser::streamTitle(const QByteArray &metadata)
+{
+    static const QByteArray key = "StreamTitle='";
+
+    qsizetype start = metadata.indexOf(key);
+    if (start < 0) {
+        return QString();
+    }
+    start += key.size();
+
+    // The value may itself contain quotes; it ends at "';"
+    qsizetype end = metadata.indexOf("';", start);
+    if (end < 0) {
+        end = metadata.indexOf('\0', start);
+        if (end < 0) {
+            end = metadata.size();
+        }
+    }
+
+    QByteArray value = metadata.mid(start, end - start);
+
+    // Most servers send UTF-8; older ones send Latin-1
+    QString title = QString::fromUtf8(value);
+    if (title.contains(QChar::ReplacementCharacter)) {
+        title = QString::fromLatin1(value);
+    }
+    return title.trimmed();
+}
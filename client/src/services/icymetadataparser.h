@@ -0,0 +1,45 @@
+#ifndef ICYMETADATAPARSER_H
+#define ICYMETADATAPARSER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief Splits an Icecast/SHOUTcast stream into audio and ICY metadata
+ *
+ * When a client sends "Icy-MetaData: 1", the server interleaves a
+ * metadata block after every icy-metaint bytes of audio: one length byte
+ * (x16) followed by text such as "StreamTitle='Artist - Title';",
+ * zero-padded. The parser is incremental, so network chunks can split
+ * blocks anywhere.
+ */
+class IcyMetadataParser
+{
+public:
+    IcyMetadataParser();
+
+    // Start a new stream; metaInterval 0 means the stream carries no metadata
+    void reset(int metaInterval);
+
+    // Append the audio bytes of data to audio and any completed metadata blocks to metadata
+    void feed(const QByteArray &data, QByteArray &audio, QList<QByteArray> &metadata);
+
+    // "StreamTitle" value of a metadata block (empty if absent)
+    static QString streamTitle(const QByteArray &metadata);
+
+private:
+    enum class State {
+        Audio,
+        Length,
+        Metadata
+    };
+
+    State m_state;
+    int m_metaInterval;
+    int m_audioRemaining;
+    int m_metaRemaining;
+    QByteArray m_metadata;
+};
+
+#endif // ICYMETADATAPARSER_H
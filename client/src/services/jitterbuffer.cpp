@@ -0,0 +1,140 @@
+#include "jitterbuffer.h"
+#include <cstring>
+
+namespace {
+constexpr int kMinTargetMs = 100;
+constexpr int kMaxTargetMs = 10000;
+constexpr int kCapacityFactor = 3;  // Buffer holds at most 3x the target
+}
+
+JitterBuffer::JitterBuffer(const QAudioFormat &format, int maxTargetMs)
+    : m_format(format)
+    , m_frameBytes(qMax(1, format.bytesPerFrame()))
+    , m_silence(format.sampleFormat() == QAudioFormat::UInt8 ? char(0x80) : char(0))
+    , m_maxTargetMs(qBound(kMinTargetMs, maxTargetMs, kMaxTargetMs))
+    // Room for the largest target allowed, so changing it never reallocates
+    , m_ring(alignToFrame(bytesForMs(m_maxTargetMs * kCapacityFactor)))
+    , m_targetMs(m_maxTargetMs)
+    , m_prebuffering(true)
+    , m_underruns(0)
+    , m_droppedBytes(0)
+    , m_clearUpTo(0)
+    , m_dropUpTo(0)
+    , m_clearedUpTo(0)
+{
+}
+
+void JitterBuffer::setTargetMs(int ms)
+{
+    m_targetMs.store(qBound(kMinTargetMs, ms, m_maxTargetMs), std::memory_order_relaxed);
+}
+
+int JitterBuffer::targetMs() const
+{
+    return m_targetMs.load(std::memory_order_relaxed);
+}
+
+qint64 JitterBuffer::bytesForMs(int ms) const
+{
+    return m_format.bytesForDuration(qint64(ms) * 1000);
+}
+
+int JitterBuffer::msForBytes(qint64 bytes) const
+{
+    return static_cast<int>(m_format.durationForBytes(static_cast<qint32>(bytes)) / 1000);
+}
+
+qint64 JitterBuffer::alignToFrame(qint64 bytes) const
+{
+    return ((bytes + m_frameBytes - 1) / m_frameBytes) * m_frameBytes;
+}
+
+// ========== Producer ==========
+
+void JitterBuffer::appendPcm(const char *data, qint64 size)
+{
+    if (size <= 0) {
+        return;
+    }
+
+    // Only a target at the maximum and a stalled renderer can fill the
+    // ring itself; what doesn't fit is the newest audio
+    const qint64 written = m_ring.write(data, size);
+    if (written < size) {
+        m_droppedBytes.fetch_add(size - written, std::memory_order_relaxed);
+    }
+
+    // Keep latency bounded: have render() drop the oldest whole frames
+    // beyond capacity
+    const qint64 capacity = bytesForMs(targetMs() * kCapacityFactor);
+    const qint64 keepFrom = alignToFrame(m_ring.totalWritten() - capacity);
+    if (keepFrom > m_dropUpTo.load(std::memory_order_relaxed)) {
+        m_dropUpTo.store(keepFrom, std::memory_order_release);
+    }
+}
+
+void JitterBuffer::clear()
+{
+    m_clearUpTo.store(m_ring.totalWritten(), std::memory_order_release);
+    m_prebuffering.store(true, std::memory_order_relaxed);
+}
+
+// ========== Consumer ==========
+
+qint64 JitterBuffer::render(char *data, qint64 size)
+{
+    size -= size % m_frameBytes;
+    if (size <= 0) {
+        return 0;
+    }
+
+    const qint64 clearUpTo = m_clearUpTo.load(std::memory_order_acquire);
+    if (clearUpTo > m_clearedUpTo) {
+        m_clearedUpTo = clearUpTo;
+        m_ring.discard(clearUpTo - m_ring.totalRead());
+        m_prebuffering.store(true, std::memory_order_relaxed);
+    }
+    const qint64 excess = m_dropUpTo.load(std::memory_order_acquire) - m_ring.totalRead();
+    if (excess > 0) {
+        m_droppedBytes.fetch_add(m_ring.discard(excess), std::memory_order_relaxed);
+    }
+
+    if (m_prebuffering.load(std::memory_order_relaxed)) {
+        if (m_ring.readable() < bytesForMs(targetMs())) {
+            std::memset(data, m_silence, size_t(size));
+            return 0;
+        }
+        m_prebuffering.store(false, std::memory_order_relaxed);
+    }
+
+    const qint64 count = m_ring.read(data, size);
+    if (count < size) {
+        // Pad with silence and refill to the target before resuming
+        std::memset(data + count, m_silence, size_t(size - count));
+        m_prebuffering.store(true, std::memory_order_relaxed);
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+// ========== Statistics ==========
+
+int JitterBuffer::bufferedMs() const
+{
+    return msForBytes(m_ring.readable());
+}
+
+bool JitterBuffer::isPrebuffering() const
+{
+    return m_prebuffering.load(std::memory_order_relaxed);
+}
+
+quint64 JitterBuffer::underruns() const
+{
+    return m_underruns.load(std::memory_order_relaxed);
+}
+
+qint64 JitterBuffer::droppedMs() const
+{
+    return msForBytes(m_droppedBytes.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,84 @@
+#ifndef JITTERBUFFER_H
+#define JITTERBUFFER_H
+
+#include "utils/pcmringbuffer.h"
+#include <QAudioFormat>
+#include <atomic>
+
+/**
+ * @brief Lock-free PCM jitter buffer between the decoder and the renderer
+ *
+ * Decoded audio is pushed with appendPcm() and the audio render thread
+ * pulls it with render(). Playback only starts (or resumes after an
+ * underrun) once targetMs of audio is buffered; until then silence is
+ * rendered, so the output never stops and a network stall or reconnect
+ * shows up as a short gap rather than a restart.
+ *
+ * The buffer is capped at a few times the target: if the server delivers
+ * faster than the sound card plays (clock drift, burst-on-connect), the
+ * oldest audio is dropped to keep latency bounded.
+ *
+ * The two sides share a PcmRingBuffer sized for the largest target the
+ * buffer is built for (a few times maxTargetMs), so neither allocates or
+ * locks after construction. Requests that move the
+ * read position (clear(), dropping the oldest audio) are posted by the
+ * producer and carried out by render(), the ring's only consumer.
+ *
+ * render() reports how much of what it produced is real audio, so the
+ * stage that hands it to the device can drive a MediaClock (see
+ * AudioRenderThread::setClock()).
+ */
+class JitterBuffer
+{
+public:
+    // setTargetMs() is bounded by maxTargetMs; the ring is sized for it
+    JitterBuffer(const QAudioFormat &format, int maxTargetMs);
+    JitterBuffer(const JitterBuffer&) = delete;
+    JitterBuffer& operator=(const JitterBuffer&) = delete;
+
+    void setTargetMs(int ms);
+    int targetMs() const;
+    int maxTargetMs() const { return m_maxTargetMs; }
+
+    // Producer side (decoder)
+    void appendPcm(const char *data, qint64 size);
+    void clear();  // Drop everything and prebuffer again
+
+    // Consumer side (render thread): fills all size bytes and returns how
+    // many of them, from the start, are audio (the rest is silence); never
+    // allocates, locks or waits
+    qint64 render(char *data, qint64 size);
+
+    // Pin the ring render() reads in RAM (see PcmRingBuffer::lockMemory())
+    bool lockMemory() { return m_ring.lockMemory(); }
+
+    // Statistics
+    int bufferedMs() const;
+    bool isPrebuffering() const;
+    quint64 underruns() const;
+    qint64 droppedMs() const;
+
+private:
+    qint64 bytesForMs(int ms) const;
+    int msForBytes(qint64 bytes) const;
+    qint64 alignToFrame(qint64 bytes) const;
+
+    QAudioFormat m_format;
+    qint64 m_frameBytes;
+    char m_silence;
+    int m_maxTargetMs;
+    PcmRingBuffer m_ring;
+
+    std::atomic<int> m_targetMs;
+    std::atomic<bool> m_prebuffering;
+    std::atomic<quint64> m_underruns;
+    std::atomic<qint64> m_droppedBytes;
+
+    // Ring positions posted by the producer and applied by render(); both
+    // only grow, so a late or repeated read never drops too much
+    std::atomic<qint64> m_clearUpTo;  // Discard, then prebuffer again
+    std::atomic<qint64> m_dropUpTo;   // Discard as dropped (over capacity)
+    qint64 m_clearedUpTo;             // Consumer only
+};
+
+#endif // JITTERBUFFER_H
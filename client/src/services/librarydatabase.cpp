@@ -0,0 +1,248 @@
+#include "librarydatabase.h"
+#include "musicstorageservice.h"
+#include "utils/startuptrace.h"
+#include <QCoreApplication>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+
+namespace {
+const char *const kConnectionName = "library";
+constexpr int kSchemaVersion = 1;
+// Bound parameters per "IN (...)" lookup; SQLite's default limit is 999
+constexpr int kMaxLookupIds = 500;
+
+// Ranks are RankKey strings; SQLite's default BINARY collation orders
+// them byte-wise, exactly like RankKey
+const char *const kSchema[] = {
+    "CREATE TABLE IF NOT EXISTS tracks ("
+    "  id INTEGER PRIMARY KEY,"
+    "  file_path TEXT NOT NULL UNIQUE)",
+
+    "CREATE TABLE IF NOT EXISTS playlists ("
+    "  id INTEGER PRIMARY KEY,"
+    "  name TEXT NOT NULL,"
+    "  kind INTEGER NOT NULL DEFAULT 0,"
+    "  created_at TEXT NOT NULL)",
+
+    // Membership is the primary key, order is a second index
+    "CREATE TABLE IF NOT EXISTS playlist_entries ("
+    "  playlist_id INTEGER NOT NULL REFERENCES playlists(id) ON DELETE CASCADE,"
+    "  track_id INTEGER NOT NULL REFERENCES tracks(id) ON DELETE CASCADE,"
+    "  rank TEXT NOT NULL,"
+    "  PRIMARY KEY (playlist_id, track_id)) WITHOUT ROWID",
+
+    "CREATE UNIQUE INDEX IF NOT EXISTS playlist_entries_order"
+    "  ON playlist_entries (playlist_id, rank)",
+
+    "CREATE INDEX IF NOT EXISTS playlist_entries_track"
+    "  ON playlist_entries (track_id)",
+};
+}
+
+LibraryDatabase* LibraryDatabase::s_instance = nullptr;
+
+LibraryDatabase::LibraryDatabase(QObject *parent)
+    : QObject(parent)
+    , m_open(false)
+    , m_trackIdsLoaded(false)
+{
+    StartupTrace::Span span("LibraryDatabase");
+    const QString filePath = MusicStorageService::instance()->metadataDirectory() + "/library.db";
+    m_open = open(filePath);
+}
+
+LibraryDatabase::~LibraryDatabase()
+{
+    if (QSqlDatabase::contains(kConnectionName)) {
+        QSqlDatabase::database(kConnectionName, false).close();
+    }
+}
+
+LibraryDatabase* LibraryDatabase::instance()
+{
+    if (!s_instance) {
+        s_instance = new LibraryDatabase(qApp);
+    }
+    return s_instance;
+}
+
+QSqlDatabase LibraryDatabase::database() const
+{
+    return QSqlDatabase::database(kConnectionName, false);
+}
+
+// ========== Setup ==========
+
+bool LibraryDatabase::open(const QString &filePath)
+{
+    if (!QSqlDatabase::isDriverAvailable("QSQLITE")) {
+        qWarning() << "LibraryDatabase: the QSQLITE driver is not available, playlists are disabled";
+        return false;
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", kConnectionName);
+    db.setDatabaseName(filePath);
+    if (!db.open()) {
+        qWarning() << "LibraryDatabase: cannot open" << filePath << db.lastError().text();
+        return false;
+    }
+
+    // WAL keeps single-row commits cheap; foreign keys drive the cascades
+    QSqlQuery pragma(db);
+    pragma.exec("PRAGMA journal_mode = WAL");
+    pragma.exec("PRAGMA synchronous = NORMAL");
+    pragma.exec("PRAGMA foreign_keys = ON");
+
+    if (!createSchema()) {
+        db.close();
+        return false;
+    }
+
+    qDebug() << "Library database opened:" << filePath;
+    return true;
+}
+
+bool LibraryDatabase::createSchema()
+{
+    QSqlDatabase db = database();
+    QSqlQuery query(db);
+
+    query.exec("PRAGMA user_version");
+    const int version = query.next() ? query.value(0).toInt() : 0;
+    if (version > kSchemaVersion) {
+        qWarning() << "LibraryDatabase: schema version" << version << "is newer than this build";
+        return false;
+    }
+    if (version == kSchemaVersion) {
+        return true;
+    }
+
+    db.transaction();
+    for (const char *statement : kSchema) {
+        if (!query.exec(statement)) {
+            qWarning() << "LibraryDatabase: schema statement failed:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    query.exec(QString("PRAGMA user_version = %1").arg(kSchemaVersion));
+    return db.commit();
+}
+
+void LibraryDatabase::loadTrackIds()
+{
+    if (m_trackIdsLoaded || !m_open) {
+        return;
+    }
+    m_trackIdsLoaded = true;
+
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT id, file_path FROM tracks")) {
+        qWarning() << "LibraryDatabase: cannot read tracks:" << query.lastError().text();
+        return;
+    }
+
+    while (query.next()) {
+        const qint64 id = query.value(0).toLongLong();
+        const QString filePath = query.value(1).toString();
+        m_trackIds.insert(filePath, id);
+        m_trackPaths.insert(id, filePath);
+    }
+}
+
+// ========== Track IDs ==========
+
+qint64 LibraryDatabase::trackId(const QString &filePath)
+{
+    loadTrackIds();
+    const qint64 existing = m_trackIds.value(filePath, 0);
+    if (existing != 0 || !m_open || filePath.isEmpty()) {
+        return existing;
+    }
+
+    QSqlQuery query(database());
+    query.prepare("INSERT INTO tracks (file_path) VALUES (?)");
+    query.addBindValue(filePath);
+    if (!query.exec()) {
+        qWarning() << "LibraryDatabase: cannot add track" << filePath << query.lastError().text();
+        return 0;
+    }
+
+    const qint64 id = query.lastInsertId().toLongLong();
+    m_trackIds.insert(filePath, id);
+    m_trackPaths.insert(id, filePath);
+    return id;
+}
+
+QList<qint64> LibraryDatabase::trackIds(const QStringList &filePaths)
+{
+    loadTrackIds();
+    QList<qint64> ids;
+    ids.reserve(filePaths.size());
+
+    // One commit for all new paths instead of one per INSERT
+    bool inTransaction = false;
+    for (const QString &filePath : filePaths) {
+        if (!inTransaction && m_open && !m_trackIds.contains(filePath)) {
+            inTransaction = database().transaction();
+        }
+        ids.append(trackId(filePath));
+    }
+    if (inTransaction && !database().commit()) {
+        qWarning() << "LibraryDatabase: cannot commit track IDs:" << database().lastError().text();
+    }
+    return ids;
+}
+
+qint64 LibraryDatabase::findTrackId(const QString &filePath)
+{
+    loadTrackIds();
+    return m_trackIds.value(filePath, 0);
+}
+
+QString LibraryDatabase::trackPath(qint64 trackId)
+{
+    loadTrackIds();
+    return m_trackPaths.value(trackId);
+}
+
+QHash<qint64, QString> LibraryDatabase::trackPaths(const QList<qint64> &trackIds) const
+{
+    QHash<qint64, QString> paths;
+    paths.reserve(trackIds.size());
+    if (m_trackIdsLoaded) {
+        for (qint64 trackId : trackIds) {
+            const auto it = m_trackPaths.constFind(trackId);
+            if (it != m_trackPaths.constEnd()) {
+                paths.insert(trackId, it.value());
+            }
+        }
+        return paths;
+    }
+    if (!m_open) {
+        return paths;
+    }
+
+    QSqlQuery query(database());
+    query.setForwardOnly(true);
+    for (qsizetype start = 0; start < trackIds.size(); start += kMaxLookupIds) {
+        const QList<qint64> chunk = trackIds.mid(start, kMaxLookupIds);
+        QStringList placeholders;
+        placeholders.fill(QStringLiteral("?"), chunk.size());
+        query.prepare(QString("SELECT id, file_path FROM tracks WHERE id IN (%1)")
+                          .arg(placeholders.join(',')));
+        for (qint64 trackId : chunk) {
+            query.addBindValue(trackId);
+        }
+        if (!query.exec()) {
+            qWarning() << "LibraryDatabase: cannot look up tracks:" << query.lastError().text();
+            break;
+        }
+        while (query.next()) {
+            paths.insert(query.value(0).toLongLong(), query.value(1).toString());
+        }
+    }
+    return paths;
+}
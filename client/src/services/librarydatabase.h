@@ -0,0 +1,66 @@
+#ifndef LIBRARYDATABASE_H
+#define LIBRARYDATABASE_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QSqlDatabase>
+
+/**
+ * @brief SQLite library database (metadata/library.db)
+ *
+ * Gives every file path a stable track ID and stores the user's playlists
+ * as (playlist, track, rank) rows. The schema is indexed so that every
+ * per-track statement (membership, insert, delete, re-rank, neighbour
+ * lookup) is a B-tree probe, and listing a playlist in order is one index
+ * range scan with no sort.
+ *
+ * The track ID map is read on first use and then kept in memory, so
+ * path <-> ID lookups never touch the database again. It grows with the
+ * library, so startup code resolves the few IDs it needs with trackPaths()
+ * instead. Like the other services this lives on the GUI thread; the
+ * connection must not be used from other threads.
+ */
+class LibraryDatabase : public QObject
+{
+    Q_OBJECT
+
+public:
+    static LibraryDatabase* instance();
+
+    bool isOpen() const { return m_open; }
+    QSqlDatabase database() const;
+
+    // Stable ID for a file path, created on first use; 0 if the database
+    // is unavailable
+    qint64 trackId(const QString &filePath);
+    // IDs of many paths at once; missing ones are created in one transaction
+    QList<qint64> trackIds(const QStringList &filePaths);
+    // Existing ID only (0 if the path has none)
+    qint64 findTrackId(const QString &filePath);
+    QString trackPath(qint64 trackId);
+    // Paths of the given IDs (unknown ones left out); one query for all of
+    // them unless the ID map is already loaded, which this doesn't load
+    QHash<qint64, QString> trackPaths(const QList<qint64> &trackIds) const;
+
+private:
+    explicit LibraryDatabase(QObject *parent = nullptr);
+    ~LibraryDatabase();
+    LibraryDatabase(const LibraryDatabase&) = delete;
+    LibraryDatabase& operator=(const LibraryDatabase&) = delete;
+
+    bool open(const QString &filePath);
+    bool createSchema();
+    void loadTrackIds();  // Once, on first use of the ID map
+
+    static LibraryDatabase *s_instance;
+
+    bool m_open;
+    bool m_trackIdsLoaded;
+    QHash<QString, qint64> m_trackIds;   // File path -> track ID
+    QHash<qint64, QString> m_trackPaths; // Track ID -> file path
+};
+
+#endif // LIBRARYDATABASE_H
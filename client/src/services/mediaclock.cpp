@@ -0,0 +1,226 @@
+#include "mediaclock.h"
+#include <QMutexLocker>
+#include <chrono>
+
+namespace {
+constexpr qint64 kNominalRatePpm = 1000000;
+// Errors beyond this are seeks or glitches, not drift: re-anchor
+constexpr qint64 kResyncThresholdUs = 250000;
+// Drift is slewed out over roughly this much wall time...
+constexpr qint64 kSlewWindowUs = 2000000;
+// ...but the rate never strays more than 10% from nominal
+constexpr qint64 kMaxSlewPpm = 100000;
+}
+
+MediaClock::MediaClock()
+    : m_sequence(0)
+    , m_positionUs(0)
+    , m_timeNs(0)
+    , m_ratePpm(0)
+    , m_durationUs(0)
+    , m_targetUs(0)
+    , m_running(false)
+    , m_pendingUs(0)
+    , m_pendingRunning(-1)
+{
+}
+
+qint64 MediaClock::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ========== Seqlock ==========
+
+MediaClock::Anchor MediaClock::load() const
+{
+    Anchor anchor;
+    for (;;) {
+        const quint64 before = m_sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;  // Writer in progress
+        }
+
+        anchor.positionUs = m_positionUs.load(std::memory_order_relaxed);
+        anchor.timeNs = m_timeNs.load(std::memory_order_relaxed);
+        anchor.ratePpm = m_ratePpm.load(std::memory_order_relaxed);
+        anchor.durationUs = m_durationUs.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_sequence.load(std::memory_order_relaxed) == before) {
+            return anchor;
+        }
+    }
+}
+
+void MediaClock::publish(const Anchor &anchor)
+{
+    // Called with m_writeMutex held, so there is a single writer here
+    const quint64 sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    m_positionUs.store(anchor.positionUs, std::memory_order_relaxed);
+    m_timeNs.store(anchor.timeNs, std::memory_order_relaxed);
+    m_ratePpm.store(anchor.ratePpm, std::memory_order_relaxed);
+    m_durationUs.store(anchor.durationUs, std::memory_order_relaxed);
+
+    m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+qint64 MediaClock::project(const Anchor &anchor, qint64 nowNs)
+{
+    qint64 position = anchor.positionUs;
+    if (anchor.ratePpm > 0 && nowNs > anchor.timeNs) {
+        const qint64 elapsedUs = (nowNs - anchor.timeNs) / 1000;
+        position += elapsedUs * anchor.ratePpm / kNominalRatePpm;
+    }
+
+    if (anchor.durationUs > 0 && position > anchor.durationUs) {
+        position = anchor.durationUs;
+    }
+    return qMax<qint64>(0, position);
+}
+
+// ========== Readers ==========
+
+qint64 MediaClock::positionUs() const
+{
+    return project(load(), nowNs());
+}
+
+qint64 MediaClock::durationUs() const
+{
+    return load().durationUs;
+}
+
+bool MediaClock::isRunning() const
+{
+    return load().ratePpm > 0;
+}
+
+// ========== Writers ==========
+
+void MediaClock::sync(qint64 positionUs, bool running)
+{
+    QMutexLocker locker(&m_writeMutex);
+    anchorAt(positionUs, running);
+}
+
+void MediaClock::rebase(qint64 positionUs)
+{
+    QMutexLocker locker(&m_writeMutex);
+    anchorAt(positionUs, m_running);
+}
+
+void MediaClock::anchorAt(qint64 positionUs, bool running)
+{
+    m_running = running;
+    m_targetUs = positionUs;
+    m_anchor.positionUs = positionUs;
+    m_anchor.timeNs = nowNs();
+    m_anchor.ratePpm = running ? kNominalRatePpm : 0;
+    publish(m_anchor);
+}
+
+void MediaClock::setRunning(bool running)
+{
+    QMutexLocker locker(&m_writeMutex);
+    applyPending();
+    applyRunning(running);
+}
+
+void MediaClock::applyRunning(bool running)
+{
+    if (running == m_running) {
+        return;
+    }
+
+    const qint64 now = nowNs();
+    m_running = running;
+    m_anchor.positionUs = project(m_anchor, now);
+    m_anchor.timeNs = now;
+    m_anchor.ratePpm = running ? kNominalRatePpm : 0;
+    m_targetUs = m_anchor.positionUs;
+    publish(m_anchor);
+}
+
+void MediaClock::setDuration(qint64 durationUs)
+{
+    QMutexLocker locker(&m_writeMutex);
+    m_anchor.durationUs = qMax<qint64>(0, durationUs);
+    publish(m_anchor);
+}
+
+void MediaClock::reset()
+{
+    QMutexLocker locker(&m_writeMutex);
+    m_running = false;
+    m_targetUs = 0;
+    m_anchor = Anchor();
+    m_anchor.timeNs = nowNs();
+    publish(m_anchor);
+}
+
+void MediaClock::report(qint64 positionUs)
+{
+    QMutexLocker locker(&m_writeMutex);
+    applyPending();
+    m_targetUs = positionUs;
+    correctTo(m_targetUs);
+}
+
+void MediaClock::advance(qint64 consumedUs)
+{
+    QMutexLocker locker(&m_writeMutex);
+    applyPending();
+    m_targetUs += consumedUs;
+    correctTo(m_targetUs);
+}
+
+void MediaClock::feed(qint64 consumedUs, bool running)
+{
+    m_pendingUs.fetch_add(consumedUs, std::memory_order_relaxed);
+    m_pendingRunning.store(running ? 1 : 0, std::memory_order_relaxed);
+    if (!m_writeMutex.tryLock()) {
+        return;  // The next writer applies it
+    }
+    applyPending();
+    m_writeMutex.unlock();
+}
+
+void MediaClock::applyPending()
+{
+    // Stopping first leaves the clock exactly at the consumed position
+    const int running = m_pendingRunning.exchange(-1, std::memory_order_relaxed);
+    if (running >= 0) {
+        applyRunning(running != 0);
+    }
+    const qint64 consumed = m_pendingUs.exchange(0, std::memory_order_relaxed);
+    if (consumed > 0) {
+        m_targetUs += consumed;
+        correctTo(m_targetUs);
+    }
+}
+
+void MediaClock::correctTo(qint64 targetUs)
+{
+    const qint64 now = nowNs();
+    const qint64 projected = project(m_anchor, now);
+    const qint64 error = targetUs - projected;
+
+    m_anchor.timeNs = now;
+    if (!m_running || qAbs(error) > kResyncThresholdUs) {
+        // Stopped clocks and real jumps take the reported position as is
+        m_anchor.positionUs = targetUs;
+        m_anchor.ratePpm = m_running ? kNominalRatePpm : 0;
+    } else {
+        // Continue from where readers already are and lean towards the
+        // source, so the position stays smooth and monotonic
+        const qint64 slewPpm = qBound(-kMaxSlewPpm, error * kNominalRatePpm / kSlewWindowUs, kMaxSlewPpm);
+        m_anchor.positionUs = projected;
+        m_anchor.ratePpm = kNominalRatePpm + slewPpm;
+    }
+    publish(m_anchor);
+}
@@ -0,0 +1,98 @@
+#ifndef MEDIACLOCK_H
+#define MEDIACLOCK_H
+
+#include <QtGlobal>
+#include <QMutex>
+#include <atomic>
+
+/**
+ * @brief Playback position clock with lock-free readers
+ *
+ * The clock publishes an anchor (position at a monotonic timestamp, plus a
+ * rate) and readers project it to "now", so the position moves smoothly
+ * between the sparse reports of the underlying source. The anchor is
+ * published through a sequence lock: readers on any thread never block and
+ * simply retry if they raced with a writer.
+ *
+ * Sources feed it either absolute reports (report(), e.g. QMediaPlayer
+ * positions) or the amount of audio actually handed to the sink
+ * (advance(), feed(), e.g. the radio render path as the sink pulls). Small
+ * disagreements between the projected and the reported position are
+ * slewed out by adjusting the rate, so the position never jumps backwards;
+ * large ones (seeks, glitches) re-anchor.
+ *
+ * Writers may run on different threads (GUI and audio); they are
+ * serialized with a mutex that readers never touch. Real-time threads
+ * use feed(), which only ever tries the mutex. When another writer holds
+ * it, the consumed audio and the running state are left in atomics and
+ * applied by the next writer that takes the mutex (feed(), report(),
+ * advance() or setRunning()), so a sink's last pull still stops the
+ * clock.
+ */
+class MediaClock
+{
+public:
+    MediaClock();
+
+    // ---- Readers (any thread, lock-free) ----
+
+    qint64 positionUs() const;
+    qint64 positionMs() const { return positionUs() / 1000; }
+    qint64 durationUs() const;
+    qint64 durationMs() const { return durationUs() / 1000; }
+    bool isRunning() const;
+
+    // ---- Writers ----
+
+    // Hard anchor: position is positionUs right now
+    void sync(qint64 positionUs, bool running);
+    // Hard anchor at positionUs, keeping the running state
+    void rebase(qint64 positionUs);
+    // Freeze or resume at the current projected position
+    void setRunning(bool running);
+    void setDuration(qint64 durationUs);
+    void reset();
+
+    // Soft correction from a source that reports absolute positions
+    void report(qint64 positionUs);
+    // Soft correction from a source that counts consumed audio
+    void advance(qint64 consumedUs);
+    // advance() plus setRunning() for real-time threads: never blocks
+    void feed(qint64 consumedUs, bool running);
+
+    // Monotonic time base of the clock
+    static qint64 nowNs();
+
+private:
+    struct Anchor {
+        qint64 positionUs = 0;
+        qint64 timeNs = 0;
+        qint64 ratePpm = 0;     // Position µs per 10^6 µs of wall time; 0 = stopped
+        qint64 durationUs = 0;  // 0 = unknown (no clamping)
+    };
+
+    Anchor load() const;
+    void publish(const Anchor &anchor);
+    static qint64 project(const Anchor &anchor, qint64 nowNs);
+    void anchorAt(qint64 positionUs, bool running);
+    void applyRunning(bool running);
+    void applyPending();
+    void correctTo(qint64 targetUs);
+
+    // Published state (seqlock); odd sequence = write in progress
+    std::atomic<quint64> m_sequence;
+    std::atomic<qint64> m_positionUs;
+    std::atomic<qint64> m_timeNs;
+    std::atomic<qint64> m_ratePpm;
+    std::atomic<qint64> m_durationUs;
+
+    // Writer-side state
+    QMutex m_writeMutex;
+    Anchor m_anchor;
+    qint64 m_targetUs;   // Where the source says we are
+    bool m_running;
+    std::atomic<qint64> m_pendingUs;  // Consumed audio feed() could not apply yet
+    std::atomic<int> m_pendingRunning; // Its running state: 0, 1, or -1 for none
+};
+
+#endif // MEDIACLOCK_H
@@ -1,46 +1,177 @@
 #include "metadataextractor.h"
-#include <QEventLoop>
 #include <QTimer>
 #include <QFileInfo>
 #include <QBuffer>
 #include <QImage>
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QMediaMetaData>
+#include <QtConcurrentRun>
+
+namespace {
+// Files the backend cannot open within this time get file name metadata
+constexpr int kLoadTimeoutMs = 3000;
+}
 
 MetadataExtractor::MetadataExtractor(QObject *parent)
     : QObject(parent)
     , m_player(new QMediaPlayer(this))
     , m_audioOutput(new QAudioOutput(this))
-    , m_metadataReady(false)
+    , m_timeoutTimer(new QTimer(this))
+    , m_currentWatcher(new QFutureWatcher<Track>(this))
 {
     m_player->setAudioOutput(m_audioOutput);
     m_audioOutput->setVolume(0.0); // Mute during metadata extraction
 
-    connect(m_player, &QMediaPlayer::metaDataChanged,
-            this, &MetadataExtractor::onMetadataChanged);
+    m_timeoutTimer->setSingleShot(true);
+    m_timeoutTimer->setInterval(kLoadTimeoutMs);
+
     connect(m_player, &QMediaPlayer::mediaStatusChanged,
             this, &MetadataExtractor::onMediaStatusChanged);
     connect(m_player, &QMediaPlayer::errorOccurred,
             this, &MetadataExtractor::onErrorOccurred);
+    connect(m_timeoutTimer, &QTimer::timeout, this, [this]() {
+        finishCurrent(false);
+    });
+    connect(m_currentWatcher, &QFutureWatcherBase::canceled,
+            this, &MetadataExtractor::onCurrentCanceled);
 }
 
 MetadataExtractor::~MetadataExtractor()
 {
+    // Unfinished promises cancel their futures when they are destroyed
+    m_queue.clear();
+    m_current = Request();
 }
 
-Track MetadataExtractor::extractMetadata(const QString &filePath)
+// ========== Requests ==========
+
+QFuture<Track> MetadataExtractor::extract(const QString &filePath)
 {
-    QFileInfo fileInfo(filePath);
-    if (!fileInfo.exists()) {
+    Request request;
+    request.filePath = filePath;
+    request.promise = std::make_shared<QPromise<Track>>();
+    request.promise->start();
+    QFuture<Track> future = request.promise->future();
+
+    if (!QFileInfo::exists(filePath)) {
         qWarning() << "File does not exist:" << filePath;
-        return Track();
+        request.promise->addResult(Track());
+        request.promise->finish();
+        return future;
+    }
+
+    // Tags are parsed in place from the file's mapping off the GUI thread;
+    // page faults on a cold file must not stall the UI
+    QtConcurrent::run([filePath]() {
+        return TagReader::read(filePath);
+    }).then(this, [this, request](const TagInfo &tags) {
+        onTagsRead(request, tags);
+    });
+    return future;
+}
+
+void MetadataExtractor::onTagsRead(const Request &request, const TagInfo &tags)
+{
+    if (request.promise->isCanceled()) {
+        request.promise->finish();
+        return;
     }
 
-    // Reset state
-    m_currentFilePath = filePath;
-    m_metadataReady = false;
-    m_albumArt = QPixmap();
+    if (tags.isValid() && tags.durationMs > 0) {
+        request.promise->addResult(buildTrack(request.filePath, tags));
+        request.promise->finish();
+        return;
+    }
+
+    // Not a format TagReader knows; let the backend have a go
+    m_queue.append(request);
+    if (!isBusy()) {
+        startNext();
+    }
+}
+
+void MetadataExtractor::startNext()
+{
+    if (isBusy()) {
+        return;
+    }
+
+    while (!m_queue.isEmpty()) {
+        Request request = m_queue.takeFirst();
+        if (request.promise->isCanceled()) {
+            request.promise->finish();
+            continue;
+        }
+
+        m_current = request;
+        m_albumArt = QPixmap();
+        m_currentWatcher->setFuture(request.promise->future());
+        m_timeoutTimer->start();
+
+        // Loading is asynchronous; onMediaStatusChanged() picks it up
+        m_player->setSource(QUrl::fromLocalFile(request.filePath));
+        return;
+    }
+}
+
+void MetadataExtractor::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
+{
+    if (!isBusy()) {
+        return;
+    }
+
+    if (status == QMediaPlayer::LoadedMedia) {
+        finishCurrent(true);
+    } else if (status == QMediaPlayer::InvalidMedia) {
+        finishCurrent(false);
+    }
+}
+
+void MetadataExtractor::finishCurrent(bool loaded)
+{
+    if (!isBusy()) {
+        return;
+    }
+    m_timeoutTimer->stop();
+
+    const Track track = buildTrack(m_current.filePath, loaded);
+
+    // Cleared before the player is reset, whose status change must not
+    // finish anything
+    const Request finished = m_current;
+    m_current = Request();
+    m_player->setSource(QUrl());
+
+    finished.promise->addResult(track);
+    finished.promise->finish();
+
+    // Next file on a fresh event-loop turn, never from inside a
+    // QMediaPlayer signal or a continuation of the request just finished
+    QTimer::singleShot(0, this, &MetadataExtractor::startNext);
+}
+
+void MetadataExtractor::onCurrentCanceled()
+{
+    if (!isBusy() || !m_current.promise->isCanceled()) {
+        return;
+    }
+    m_timeoutTimer->stop();
+
+    const Request canceled = m_current;
+    m_current = Request();
+    m_player->setSource(QUrl());
+    canceled.promise->finish();
+
+    QTimer::singleShot(0, this, &MetadataExtractor::startNext);
+}
+
+// ========== Metadata ==========
+
+Track MetadataExtractor::buildTrack(const QString &filePath, bool loaded)
+{
+    QFileInfo fileInfo(filePath);
 
     // Set default values from filename
     QString title = fileInfo.completeBaseName();
@@ -48,33 +179,8 @@ Track MetadataExtractor::extractMetadata(const QString &filePath)
     QString album = "Unknown Album";
     qint64 duration = 0;
 
-    // Load the media file
-    m_player->setSource(QUrl::fromLocalFile(filePath));
-
-    // Wait for metadata to be loaded (with timeout)
-    QEventLoop loop;
-    QTimer timeoutTimer;
-    timeoutTimer.setSingleShot(true);
-    timeoutTimer.setInterval(3000); // 3 seconds timeout
-
-    connect(&timeoutTimer, &QTimer::timeout, &loop, &QEventLoop::quit);
-    connect(this, &MetadataExtractor::destroyed, &loop, &QEventLoop::quit);
-
-    // Connect signals to exit event loop
-    connect(m_player, &QMediaPlayer::mediaStatusChanged, [&](QMediaPlayer::MediaStatus status) {
-        if (status == QMediaPlayer::LoadedMedia ||
-            status == QMediaPlayer::InvalidMedia ||
-            status == QMediaPlayer::NoMedia) {
-            m_metadataReady = true;
-            loop.quit();
-        }
-    });
-
-    timeoutTimer.start();
-    loop.exec();
-
     // Extract metadata if loaded successfully
-    if (m_metadataReady && m_player->mediaStatus() == QMediaPlayer::LoadedMedia) {
+    if (loaded) {
         extractMetadataFromPlayer();
 
         // Get title
@@ -104,9 +210,6 @@ Track MetadataExtractor::extractMetadata(const QString &filePath)
         qWarning() << "Failed to load metadata for:" << filePath;
     }
 
-    // Clear the player
-    m_player->setSource(QUrl());
-
     // Create track with extracted metadata
     Track track(filePath, title, artist, album, duration);
 
@@ -114,42 +217,91 @@ Track MetadataExtractor::extractMetadata(const QString &filePath)
     track.setFileSize(fileInfo.size());
     track.setDateAdded(fileInfo.lastModified());
 
-    // Save album art if extracted
     if (!m_albumArt.isNull()) {
-        // IMPORTANT: Set the QPixmap directly for immediate use
-        track.setAlbumArt(m_albumArt);
-
-        // Also save to file for future use
-        QString albumArtPath = fileInfo.absolutePath() + "/." +
-                               fileInfo.completeBaseName() + "_cover.jpg";
-        if (m_albumArt.save(albumArtPath, "JPEG", 90)) {
-            track.setAlbumArtPath(albumArtPath);
-        }
+        setCover(track, fileInfo, m_albumArt);
     } else {
-        // Look for cover in directory
-        QDir dir = fileInfo.dir();
-        QStringList imageFilters;
-        imageFilters << "cover.jpg" << "cover.png" << "folder.jpg" << "folder.png";
-
-        QStringList imageFiles = dir.entryList(imageFilters, QDir::Files);
-        if (!imageFiles.isEmpty()) {
-            QString artPath = dir.absoluteFilePath(imageFiles.first());
-            track.setAlbumArtPath(artPath);
-            // Load and set the pixmap
-            QPixmap coverArt(artPath);
-            if (!coverArt.isNull()) {
-                track.setAlbumArt(coverArt);
-            }
-        }
+        setFolderCover(track, fileInfo);
     }
 
     return track;
 }
 
-QPixmap MetadataExtractor::extractAlbumArt(const QString &filePath)
+Track MetadataExtractor::buildTrack(const QString &filePath, const TagInfo &tags)
 {
-    Track track = extractMetadata(filePath);
-    return m_albumArt;
+    QFileInfo fileInfo(filePath);
+
+    QString artist = !tags.artist.isEmpty() ? tags.artist : tags.albumArtist;
+    Track track(filePath,
+                tags.title.isEmpty() ? fileInfo.completeBaseName() : tags.title,
+                artist.isEmpty() ? QString("Unknown Artist") : artist,
+                tags.album.isEmpty() ? QString("Unknown Album") : tags.album,
+                tags.durationMs);
+    track.setFileSize(fileInfo.size());
+    track.setDateAdded(fileInfo.lastModified());
+
+    // Decoded straight from the mapping; a JPEG cover is also saved from
+    // there without re-encoding
+    QPixmap art;
+    if (!tags.cover.isEmpty()) {
+        art.loadFromData(reinterpret_cast<const uchar*>(tags.cover.data()), uint(tags.cover.size()));
+    }
+    if (!art.isNull()) {
+        const bool jpeg = tags.cover.startsWith("\xFF\xD8\xFF");
+        setCover(track, fileInfo, art, jpeg ? tags.cover : QByteArrayView());
+    } else {
+        setFolderCover(track, fileInfo);
+    }
+
+    return track;
+}
+
+void MetadataExtractor::setCover(Track &track, const QFileInfo &fileInfo, const QPixmap &art,
+                                 QByteArrayView encodedJpeg)
+{
+    // IMPORTANT: Set the QPixmap directly for immediate use
+    track.setAlbumArt(art);
+
+    // Also save to file for future use
+    const QString albumArtPath = coverPathFor(fileInfo);
+    bool saved = false;
+    if (!encodedJpeg.isEmpty()) {
+        QFile file(albumArtPath);
+        saved = file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+             && file.write(encodedJpeg.data(), encodedJpeg.size()) == encodedJpeg.size();
+    } else {
+        saved = art.save(albumArtPath, "JPEG", 90);
+    }
+    if (saved) {
+        track.setAlbumArtPath(albumArtPath);
+    }
+}
+
+void MetadataExtractor::setFolderCover(Track &track, const QFileInfo &fileInfo)
+{
+    const QString artPath = folderCoverPath(fileInfo.dir());
+    if (!artPath.isEmpty()) {
+        track.setAlbumArtPath(artPath);
+        // Load and set the pixmap
+        QPixmap coverArt(artPath);
+        if (!coverArt.isNull()) {
+            track.setAlbumArt(coverArt);
+        }
+    }
+}
+
+QString MetadataExtractor::coverPathFor(const QFileInfo &fileInfo)
+{
+    return fileInfo.absolutePath() + "/." + fileInfo.completeBaseName() + "_cover.jpg";
+}
+
+QString MetadataExtractor::folderCoverPath(const QDir &dir)
+{
+    // Look for cover in directory
+    QStringList imageFilters;
+    imageFilters << "cover.jpg" << "cover.png" << "folder.jpg" << "folder.png";
+
+    const QStringList imageFiles = dir.entryList(imageFilters, QDir::Files);
+    return imageFiles.isEmpty() ? QString() : dir.absoluteFilePath(imageFiles.first());
 }
 
 void MetadataExtractor::extractMetadataFromPlayer()
@@ -162,11 +314,9 @@ void MetadataExtractor::extractMetadataFromPlayer()
             QImage image = coverArtData.value<QImage>();
             if (!image.isNull()) {
                 m_albumArt = QPixmap::fromImage(image);
-                qDebug() << "Album art extracted:" << m_albumArt.size();
             }
         } else if (coverArtData.canConvert<QPixmap>()) {
             m_albumArt = coverArtData.value<QPixmap>();
-            qDebug() << "Album art extracted:" << m_albumArt.size();
         }
     }
 
@@ -177,23 +327,12 @@ void MetadataExtractor::extractMetadataFromPlayer()
             QImage image = thumbData.value<QImage>();
             if (!image.isNull()) {
                 m_albumArt = QPixmap::fromImage(image);
-                qDebug() << "Thumbnail extracted:" << m_albumArt.size();
             }
         }
     }
 }
 
-void MetadataExtractor::onMetadataChanged()
-{
-    qDebug() << "Metadata changed for:" << m_currentFilePath;
-}
-
-void MetadataExtractor::onMediaStatusChanged(QMediaPlayer::MediaStatus status)
-{
-    qDebug() << "Media status changed:" << status << "for" << m_currentFilePath;
-}
-
 void MetadataExtractor::onErrorOccurred(QMediaPlayer::Error error, const QString &errorString)
 {
-    qWarning() << "Media player error:" << error << errorString << "for" << m_currentFilePath;
+    qWarning() << "Media player error:" << error << errorString << "for" << m_current.filePath;
 }
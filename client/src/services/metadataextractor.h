@@ -3,12 +3,33 @@
 
 #include <QObject>
 #include <QString>
+#include <QList>
 #include <QPixmap>
+#include <QTimer>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QPromise>
 #include <QMediaPlayer>
 #include <QAudioOutput>
 #include <QMediaMetaData>
+#include <memory>
 #include "models/track.h"
+#include "services/tagreader.h"
 
+class QDir;
+class QFileInfo;
+
+/**
+ * @brief Reads tags and cover art of local audio files
+ *
+ * extract() never blocks. TagReader parses the file's tags in place from
+ * its memory mapping on a worker thread; files it cannot handle (or whose
+ * duration it cannot tell) are handed to a muted QMediaPlayer instead, and
+ * the future is fulfilled from its status signals (or after a timeout,
+ * with file name metadata). Backend requests are served one at a time in
+ * call order. cancel() on a future drops a queued request or abandons the
+ * file being loaded. Must be used on the GUI thread.
+ */
 class MetadataExtractor : public QObject
 {
     Q_OBJECT
@@ -17,27 +38,49 @@ public:
     explicit MetadataExtractor(QObject *parent = nullptr);
     ~MetadataExtractor();
 
-    // Extract metadata from audio file
-    Track extractMetadata(const QString &filePath);
+    // Metadata of an audio file; an invalid Track if the file is missing
+    QFuture<Track> extract(const QString &filePath);
 
-    // Extract only album art
-    QPixmap extractAlbumArt(const QString &filePath);
+    // Where the cover extracted from an audio file is saved
+    static QString coverPathFor(const QFileInfo &fileInfo);
+    // cover.jpg / folder.jpg style image next to the audio files, if any;
+    // file system only, so usable off the GUI thread
+    static QString folderCoverPath(const QDir &dir);
 
 private slots:
-    void onMetadataChanged();
     void onMediaStatusChanged(QMediaPlayer::MediaStatus status);
     void onErrorOccurred(QMediaPlayer::Error error, const QString &errorString);
+    void onCurrentCanceled();
 
 private:
+    struct Request
+    {
+        QString filePath;
+        std::shared_ptr<QPromise<Track>> promise;
+    };
+
+    bool isBusy() const { return m_current.promise != nullptr; }
+    void onTagsRead(const Request &request, const TagInfo &tags);
+    void startNext();
+    void finishCurrent(bool loaded);
+    Track buildTrack(const QString &filePath, bool loaded);
+    Track buildTrack(const QString &filePath, const TagInfo &tags);
+    void extractMetadataFromPlayer();
+
+    // Cover handling shared by both paths; encodedJpeg, when given, is
+    // written out as is instead of re-encoding art
+    static void setCover(Track &track, const QFileInfo &fileInfo, const QPixmap &art,
+                         QByteArrayView encodedJpeg = QByteArrayView());
+    static void setFolderCover(Track &track, const QFileInfo &fileInfo);
+
     QMediaPlayer *m_player;
     QAudioOutput *m_audioOutput;
+    QTimer *m_timeoutTimer;
+    QFutureWatcher<Track> *m_currentWatcher;  // Reports cancel() of the current request
 
-    QString m_currentFilePath;
-    Track m_extractedTrack;
+    QList<Request> m_queue;
+    Request m_current;   // File being loaded (no promise when idle)
     QPixmap m_albumArt;
-    bool m_metadataReady;
-
-    void extractMetadataFromPlayer();
 };
 
 #endif // METADATAEXTRACTOR_H
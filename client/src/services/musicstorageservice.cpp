@@ -1,20 +1,65 @@
 #include "musicstorageservice.h"
 #include "metadataextractor.h"
+#include "cuesheet.h"
+#include "tagreader.h"
+#include "utils/startuptrace.h"
+#include "utils/metrics.h"
+#include "utils/rankkey.h"
 #include <QStandardPaths>
 #include <QFileInfo>
 #include <QFile>
 #include <QDirIterator>
 #include <QRegularExpression>
 #include <QBuffer>
+#include <QImage>
+#include <QThread>
+#include <QtConcurrentRun>
 #include <QDebug>
 
+namespace {
+// Quiet period before a burst of scan results is announced to the UI
+constexpr int kTracksChangedDelayMs = 200;
+// Snapshot batching while extraction changes the library on every turn
+constexpr int kSnapshotScanDelayMs = 100;
+// Extensions tried when a CUE sheet's FILE is missing: rips are often
+// re-encoded without updating the sheet
+const char *const kAudioSuffixes[] = { "flac", "wav", "mp3", "m4a", "ogg" };
+}
+
 MusicStorageService* MusicStorageService::s_instance = nullptr;
 
 MusicStorageService::MusicStorageService(QObject *parent)
     : QObject(parent)
+    , m_trackRowsDirty(true)
+    , m_extractor(nullptr)
+    , m_extractWatcher(new QFutureWatcher<Track>(this))
+    , m_scanWatcher(new QFutureWatcher<void>(this))
+    , m_changeTimer(new QTimer(this))
+    , m_snapshotTimer(new QTimer(this))
+    , m_libraryLoading(false)
+    , m_libraryLoaded(false)
+    , m_listingPending(false)
+    , m_scanning(false)
+    , m_scanDirty(false)
+    , m_scanStartNs(0)
 {
+    StartupTrace::Span span("MusicStorageService");
+
+    // Only make sure the folder exists; the library itself is loaded
+    // in the background by loadLibrary()
     initializeMusicDirectory();
-    loadPlaylistData();
+
+    m_changeTimer->setSingleShot(true);
+    m_changeTimer->setInterval(kTracksChangedDelayMs);
+    connect(m_changeTimer, &QTimer::timeout, this, &MusicStorageService::tracksChanged);
+
+    m_snapshotTimer->setSingleShot(true);
+    connect(m_snapshotTimer, &QTimer::timeout, this, &MusicStorageService::publishSnapshot);
+
+    connect(m_extractWatcher, &QFutureWatcherBase::finished,
+            this, &MusicStorageService::onTrackExtracted);
+    connect(m_scanWatcher, &QFutureWatcherBase::canceled,
+            this, &MusicStorageService::onScanCanceled);
 }
 
 MusicStorageService::~MusicStorageService()
@@ -54,130 +99,609 @@ bool MusicStorageService::ensureMusicDirectoryExists()
     return true;
 }
 
-QList<Track> MusicStorageService::getDownloadedTracks()
+// ========== Library Loading ==========
+
+QFuture<void> MusicStorageService::loadLibrary()
 {
-    QList<Track> tracks;
+    if (m_libraryLoading || m_libraryLoaded) {
+        return scanFuture();
+    }
+    m_libraryLoading = true;
+    m_scanStartNs = StartupTrace::nowNs();
+    setScanning(true);
+
+    // Parse the snapshot and walk the folder off the GUI thread; results are
+    // handed back as queued calls so all state changes happen on our thread
+    const QString snapshotPath = playlistDataFilePath();
+    const QString directory = m_musicDirectory;
+    m_listingPending = true;
+
+    QThread *worker = QThread::create([this, snapshotPath, directory]() {
+        PlaylistData snapshot;
+        {
+            StartupTrace::Span span("library.readSnapshot");
+            snapshot.loadFromFile(snapshotPath);
+        }
+        QMetaObject::invokeMethod(this, [this, snapshot]() {
+            applySnapshot(snapshot);
+        }, Qt::QueuedConnection);
+
+        const DirectoryListing listing = listMusicFiles(directory);
+        QMetaObject::invokeMethod(this, [this, listing]() {
+            applyDirectoryListing(listing);
+        }, Qt::QueuedConnection);
+    });
+    connect(worker, &QThread::finished, worker, &QObject::deleteLater);
+    worker->start(QThread::LowPriority);
+    return scanFuture();
+}
 
-    if (!ensureMusicDirectoryExists()) {
-        return tracks;
+QFuture<void> MusicStorageService::rescanLibrary()
+{
+    if (!m_libraryLoaded) {
+        return loadLibrary();
+    }
+    if (m_scanning) {
+        return scanFuture();
     }
 
-    // First, scan the directory for all music files
-    QMap<QString, Track> filePathToTrack;
-    QDir musicDir(m_musicDirectory);
+    m_scanStartNs = StartupTrace::nowNs();
+    setScanning(true);
+    startDirectoryScan();
+    return scanFuture();
+}
+
+QFuture<void> MusicStorageService::scanFuture() const
+{
+    return m_scanPromise ? m_scanPromise->future() : QtFuture::makeReadyVoidFuture();
+}
+
+void MusicStorageService::startDirectoryScan()
+{
+    const QString directory = m_musicDirectory;
+    m_listingPending = true;
+
+    QThread *worker = QThread::create([this, directory]() {
+        const DirectoryListing listing = listMusicFiles(directory);
+        QMetaObject::invokeMethod(this, [this, listing]() {
+            applyDirectoryListing(listing);
+        }, Qt::QueuedConnection);
+    });
+    connect(worker, &QThread::finished, worker, &QObject::deleteLater);
+    worker->start(QThread::LowPriority);
+}
+
+MusicStorageService::DirectoryListing MusicStorageService::listMusicFiles(const QString &directory)
+{
+    // Runs on a worker thread: file system only, no service state
+    StartupTrace::Span span("library.listFiles");
+    DirectoryListing listing;
+
     QStringList filters;
-    filters << "*.mp3" << "*.flac" << "*.wav" << "*.ogg" << "*.m4a";
+    filters << "*.mp3" << "*.flac" << "*.wav" << "*.ogg" << "*.m4a" << "*.cue";
 
-    QDirIterator it(m_musicDirectory, filters,
+    QDirIterator it(directory, filters,
                     QDir::Files | QDir::NoDotAndDotDot,
                     QDirIterator::Subdirectories);
 
+    QStringList cueSheets;
     while (it.hasNext()) {
-        QString filePath = it.next();
-        Track track = extractMetadataFromFile(filePath);
-        if (track.isValid()) {
-            filePathToTrack[filePath] = track;
-
-            // Update playlist data with current metadata if not exists
-            if (!m_playlistData.hasTrackData(filePath)) {
-                updateTrackMetadata(filePath, track);
-            }
+        it.next();
+        if (it.fileInfo().suffix().compare("cue", Qt::CaseInsensitive) == 0) {
+            cueSheets.append(it.filePath());
+        } else {
+            listing.files.insert(it.filePath(), it.fileInfo().size());
+        }
+    }
+
+    // An album file with a sheet is listed as the sheet's tracks only
+    for (const QString &cuePath : std::as_const(cueSheets)) {
+        const QList<Track> tracks = readCueTracks(cuePath);
+        if (tracks.isEmpty()) {
+            continue;
+        }
+        listing.files.remove(tracks.first().audioFilePath());
+        for (const Track &track : tracks) {
+            listing.files.insert(track.filePath(), track.fileSize());
+            listing.cueTracks.insert(track.filePath(), track);
         }
     }
 
-    // Get ordered list from playlist data
-    QList<TrackData> orderedData = m_playlistData.getAllTracksOrdered();
+    return listing;
+}
 
-    // First add tracks in saved order
-    for (const TrackData &data : orderedData) {
-        if (filePathToTrack.contains(data.filePath)) {
-            Track track = filePathToTrack[data.filePath];
-            // Use saved metadata if available
-            if (!data.title.isEmpty()) {
-                track.setTitle(data.title);
-            }
-            if (!data.artist.isEmpty()) {
-                track.setArtist(data.artist);
+QList<Track> MusicStorageService::readCueTracks(const QString &cuePath)
+{
+    const CueSheet sheet = CueSheet::read(cuePath);
+    if (!sheet.isValid()) {
+        return {};
+    }
+
+    QFileInfo audioInfo(sheet.audioFile());
+    for (const char *suffix : kAudioSuffixes) {
+        if (audioInfo.exists()) {
+            break;
+        }
+        audioInfo.setFile(audioInfo.dir().filePath(audioInfo.completeBaseName() + "." + suffix));
+    }
+    if (!audioInfo.exists()) {
+        qDebug() << "CUE sheet without its audio file:" << cuePath;
+        return {};
+    }
+    // Same form as the folder walk's paths, so the album file's own entry
+    // can be dropped from the listing
+    const QString audioPath = QDir::cleanPath(audioInfo.filePath());
+
+    // The album file is read once for all of its tracks: header pages
+    // only, for the length of the last track and the shared cover
+    const TagInfo tags = TagReader::read(audioPath);
+    QString coverPath;
+    if (!tags.cover.isEmpty()) {
+        coverPath = MetadataExtractor::coverPathFor(audioInfo);
+        const QFileInfo coverInfo(coverPath);
+        if (!coverInfo.exists() || coverInfo.lastModified() < audioInfo.lastModified()) {
+            bool saved = false;
+            if (tags.cover.startsWith("\xFF\xD8\xFF")) {
+                QFile file(coverPath);
+                saved = file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+                     && file.write(tags.cover.data(), tags.cover.size()) == tags.cover.size();
+            } else {
+                // QImage, unlike QPixmap, may be used off the GUI thread
+                const QImage art = QImage::fromData(tags.cover);
+                saved = !art.isNull() && art.save(coverPath, "JPEG", 90);
             }
-            if (!data.album.isEmpty()) {
-                track.setAlbum(data.album);
+            if (!saved) {
+                coverPath.clear();
             }
-            if (data.dateAdded.isValid()) {
-                track.setDateAdded(data.dateAdded);
+        }
+    }
+    if (coverPath.isEmpty()) {
+        coverPath = MetadataExtractor::folderCoverPath(audioInfo.dir());
+    }
+
+    // Editing either file refreshes the tracks on the next scan
+    const QFileInfo cueInfo(cuePath);
+    const QDateTime modified = qMax(cueInfo.lastModified(), audioInfo.lastModified());
+
+    QList<Track> tracks;
+    tracks.reserve(sheet.entries().size());
+    for (const CueSheet::Entry &entry : sheet.entries()) {
+        const qint64 endMs = entry.endMs > 0 ? entry.endMs : tags.durationMs;
+        Track track(cuePath + QString("#%1").arg(entry.number, 2, 10, QChar('0')),
+                    entry.title.isEmpty() ? QString("Track %1").arg(entry.number) : entry.title,
+                    entry.performer.isEmpty() ? tags.artist : entry.performer,
+                    sheet.title().isEmpty() ? tags.album : sheet.title(),
+                    qMax<qint64>(0, endMs - entry.startMs));
+        track.setAudioSpan(audioPath, entry.startMs, entry.endMs);
+        track.setFileSize(audioInfo.size());
+        track.setDateAdded(modified);
+        track.setAlbumArtPath(coverPath);
+        tracks.append(track);
+    }
+    return tracks;
+}
+
+void MusicStorageService::applySnapshot(const PlaylistData &snapshot)
+{
+    StartupTrace::Span span("library.applySnapshot");
+    m_playlistData = snapshot;
+
+    // Show the saved library right away; the directory listing that follows
+    // drops files that are gone and queues the ones the snapshot lacks
+    const QList<TrackData> orderedData = m_playlistData.getAllTracksOrdered();
+    m_tracks.clear();
+    m_tracks.reserve(orderedData.size());
+    for (const TrackData &data : orderedData) {
+        m_tracks.append(trackFromData(data));
+    }
+
+    m_trackRowsDirty = true;
+    m_placeholderRanks.clear();
+
+    m_libraryLoading = false;
+    m_libraryLoaded = true;
+    qDebug() << "Library snapshot loaded with" << m_tracks.size() << "tracks";
+
+    publishSnapshot();
+    emit libraryLoaded();
+    emit tracksChanged();
+}
+
+void MusicStorageService::applyDirectoryListing(const DirectoryListing &listing)
+{
+    m_listingPending = false;
+    const QHash<QString, qint64> &filesOnDisk = listing.files;
+
+    // Forget tracks whose files were removed outside the app
+    int removed = 0;
+    for (int i = m_tracks.size() - 1; i >= 0; --i) {
+        const QString filePath = m_tracks.at(i).filePath();
+        if (!filesOnDisk.contains(filePath)) {
+            m_playlistData.removeTrack(filePath);
+            m_placeholderRanks.remove(filePath);
+            m_tracks.removeAt(i);
+            ++removed;
+        }
+    }
+    if (removed > 0) {
+        m_trackRowsDirty = true;
+        m_scanDirty = true;
+    }
+
+    // Only new or modified files need a (slow) metadata extraction. New
+    // files are listed immediately under a file name placeholder
+    QStringList paths = filesOnDisk.keys();
+    paths.sort();
+    int added = 0;
+    for (const QString &filePath : std::as_const(paths)) {
+        // CUE tracks arrive with their metadata; only changed ones are stored
+        if (listing.cueTracks.contains(filePath)) {
+            const Track &track = listing.cueTracks[filePath];
+            const TrackData data = m_playlistData.getTrackData(filePath);
+            const bool known = m_playlistData.hasTrackData(filePath);
+            if (!known || data.fileSize != track.fileSize() || data.startMs != track.startMs()
+                || data.endMs != track.endMs() || data.audioFilePath != track.audioFilePath()
+                || data.dateAdded.toSecsSinceEpoch() != track.dateAdded().toSecsSinceEpoch()) {
+                if (!known && rowOfTrack(filePath) < 0) {
+                    ++added;
+                }
+                applyExtractedTrack(filePath, track);
             }
-            if (data.fileSize > 0) {
-                track.setFileSize(data.fileSize);
+            continue;
+        }
+
+        if (!m_playlistData.hasTrackData(filePath)) {
+            if (rowOfTrack(filePath) < 0) {
+                Track placeholder = trackFromFileName(filePath);
+                placeholder.setFileSize(filesOnDisk.value(filePath));
+                m_placeholderRanks.insert(filePath, nextTailRank());
+                m_trackRows.insert(filePath, m_tracks.size());
+                m_tracks.append(placeholder);
+                ++added;
             }
-            tracks.append(track);
-            filePathToTrack.remove(data.filePath);
+            enqueueScan(filePath);
+            continue;
+        }
+
+        const TrackData data = m_playlistData.getTrackData(filePath);
+        if (data.title.isEmpty() || (data.fileSize > 0 && data.fileSize != filesOnDisk.value(filePath))) {
+            enqueueScan(filePath);
         }
     }
 
-    // Add any new tracks not in saved order (at the end)
-    for (const Track &track : filePathToTrack.values()) {
-        tracks.append(track);
-        updateTrackMetadata(track.filePath(), track);
+    qDebug() << "Library scan:" << filesOnDisk.size() << "files," << removed << "removed,"
+             << added << "added," << m_scanPending.size() << "to extract";
+
+    if (removed > 0 || added > 0) {
+        scheduleSnapshot();
+        m_changeTimer->stop();
+        emit tracksChanged();
     }
 
-    return tracks;
+    if (m_scanPending.isEmpty()) {
+        finishScan();
+    } else {
+        QTimer::singleShot(0, this, &MusicStorageService::scanNextFile);
+    }
 }
 
-Track MusicStorageService::extractMetadataFromFile(const QString &filePath)
+void MusicStorageService::enqueueScan(const QString &filePath)
 {
-    QFileInfo fileInfo(filePath);
+    // A canceled scan takes no new files; the next scan finds them
+    if (m_scanPending.contains(filePath) || isScanCanceled()) {
+        return;
+    }
+    m_scanPending.insert(filePath);
+    m_scanQueue.append(filePath);
 
-    if (!fileInfo.exists()) {
-        qWarning() << "File does not exist:" << filePath;
-        return Track();
+    if (!m_scanning) {
+        m_scanStartNs = StartupTrace::nowNs();
+        setScanning(true);
+        QTimer::singleShot(0, this, &MusicStorageService::scanNextFile);
     }
+}
 
-    qDebug() << "Extracting metadata from:" << filePath;
+void MusicStorageService::prioritizeTracks(const QStringList &filePaths)
+{
+    // The latest request reflects what is on screen now; older ones are moot
+    m_priorityQueue.clear();
+    for (const QString &filePath : filePaths) {
+        if (m_scanPending.contains(filePath)) {
+            m_priorityQueue.append(filePath);
+        }
+    }
+}
 
-    // Use MetadataExtractor to get real metadata from the audio file
-    MetadataExtractor extractor;
-    Track track = extractor.extractMetadata(filePath);
+QString MusicStorageService::takeNextScanPath()
+{
+    // Entries leave m_scanPending when extracted or deleted, so both queues
+    // may still hold paths that are no longer due
+    while (!m_priorityQueue.isEmpty()) {
+        const QString filePath = m_priorityQueue.takeFirst();
+        if (m_scanPending.remove(filePath)) {
+            return filePath;
+        }
+    }
+    while (!m_scanQueue.isEmpty()) {
+        const QString filePath = m_scanQueue.takeFirst();
+        if (m_scanPending.remove(filePath)) {
+            return filePath;
+        }
+    }
+    return QString();
+}
 
-    if (!track.isValid()) {
-        qWarning() << "Failed to extract metadata, using filename fallback";
+void MusicStorageService::scanNextFile()
+{
+    // One extraction at a time; the next one starts when it has finished
+    if (!m_extractingPath.isEmpty()) {
+        return;
+    }
+    if (isScanCanceled()) {
+        m_scanQueue.clear();
+        m_priorityQueue.clear();
+        m_scanPending.clear();
+        finishScan();
+        return;
+    }
+
+    const QString filePath = takeNextScanPath();
+    if (filePath.isEmpty()) {
+        finishScan();
+        return;
+    }
+
+    m_extractingPath = filePath;
+    m_extractTimer.start();
+    m_extractWatcher->setFuture(extractMetadata(filePath));
+}
+
+void MusicStorageService::onTrackExtracted()
+{
+    const QString filePath = m_extractingPath;
+    m_extractingPath.clear();
+
+    // Canceled when the file was deleted or the scan stopped meanwhile
+    const QFuture<Track> future = m_extractWatcher->future();
+    if (!future.isCanceled() && future.resultCount() > 0) {
+        EKNM_METRIC_RECORD(LibraryExtractNs, m_extractTimer.nsecsElapsed());
+        EKNM_METRIC_COUNT(LibraryFilesScanned, 1);
+        applyExtractedTrack(filePath, future.result());
+    }
 
-        // Fallback: Parse filename for basic metadata
-        QString title = fileInfo.completeBaseName();
-        QString artist = "Unknown Artist";
-        QString album = "Unknown Album";
+    if (m_scanPending.isEmpty()) {
+        finishScan();
+    } else {
+        QTimer::singleShot(0, this, &MusicStorageService::scanNextFile);
+    }
+}
 
-        QStringList parts = title.split(QRegularExpression(" [-–] "));
-        if (parts.size() >= 2) {
-            artist = parts[0].trimmed();
-            title = parts[1].trimmed();
+void MusicStorageService::applyExtractedTrack(const QString &filePath, const Track &track)
+{
+    const int existing = rowOfTrack(filePath);
+    if (track.isValid()) {
+        if (existing >= 0) {
+            // Placeholder or stale entry: same row and rank, new metadata
+            m_playlistData.setTrackData(filePath, dataFromTrack(track, rankOf(filePath)));
+            m_placeholderRanks.remove(filePath);
+            m_tracks[existing] = track;
+            scheduleSnapshot();
+            emit trackUpdated(track);
+        } else {
+            m_playlistData.setTrackData(filePath, dataFromTrack(track, nextTailRank()));
+            m_trackRows.insert(filePath, m_tracks.size());
+            m_tracks.append(track);
+            scheduleSnapshot();
+            scheduleTracksChanged();
         }
+        m_scanDirty = true;
+    } else if (existing >= 0 && !m_playlistData.hasTrackData(filePath)) {
+        // Placeholder of a file that vanished before it was read
+        m_placeholderRanks.remove(filePath);
+        m_tracks.removeAt(existing);
+        m_trackRowsDirty = true;
+        scheduleSnapshot();
+        scheduleTracksChanged();
+    }
+}
+
+void MusicStorageService::onScanCanceled()
+{
+    // Unread files keep their placeholders; the next scan picks them up
+    m_scanQueue.clear();
+    m_priorityQueue.clear();
+    m_scanPending.clear();
+    if (!m_extractingPath.isEmpty()) {
+        m_extractWatcher->cancel();
+    } else {
+        QTimer::singleShot(0, this, &MusicStorageService::scanNextFile);
+    }
+}
+
+void MusicStorageService::finishScan()
+{
+    // The file being extracted and a pending folder listing still belong
+    // to this scan
+    if (!m_extractingPath.isEmpty() || m_listingPending) {
+        return;
+    }
+
+    // Save once per scan instead of once per file
+    if (m_scanDirty) {
+        savePlaylistData();
+        m_scanDirty = false;
+    }
+
+    // The last batch is published before anyone hears the scan is over
+    if (m_snapshotTimer->isActive()) {
+        publishSnapshot();
+    }
+
+    if (m_changeTimer->isActive()) {
+        m_changeTimer->stop();
+        emit tracksChanged();
+    }
+
+    if (m_scanning) {
+        StartupTrace::record("library.scan", m_scanStartNs, StartupTrace::nowNs());
+        StartupTrace::flush();
+    }
+    setScanning(false);
+}
+
+void MusicStorageService::setScanning(bool scanning)
+{
+    if (m_scanning == scanning) {
+        return;
+    }
+    m_scanning = scanning;
+
+    if (scanning) {
+        m_scanPromise = std::make_unique<QPromise<void>>();
+        m_scanPromise->start();
+        m_scanWatcher->setFuture(m_scanPromise->future());
+    } else if (m_scanPromise) {
+        // Released first: continuations may start the next scan
+        const std::unique_ptr<QPromise<void>> finished = std::move(m_scanPromise);
+        finished->finish();
+    }
+
+    emit scanningChanged(scanning);
+}
+
+void MusicStorageService::scheduleTracksChanged()
+{
+    if (!m_changeTimer->isActive()) {
+        m_changeTimer->start();
+    }
+}
+
+// ========== Snapshots ==========
+
+void MusicStorageService::scheduleSnapshot()
+{
+    // Every change of m_tracks lands here; all changes made before the timer
+    // fires end up in one version
+    if (!m_snapshotTimer->isActive()) {
+        m_snapshotTimer->start(m_scanning ? kSnapshotScanDelayMs : 0);
+    }
+}
 
-        track = Track(filePath, title, artist, album, 0);
+void MusicStorageService::publishSnapshot()
+{
+    m_snapshotTimer->stop();
 
-        // Look for cover in directory as fallback
-        QDir dir = fileInfo.dir();
-        QStringList imageFilters;
-        imageFilters << "cover.jpg" << "cover.png" << "folder.jpg" << "folder.png";
+    // The copy shares m_tracks' storage; the next edit here detaches it
+    const LibrarySnapshotPtr published = m_snapshots.publish(m_tracks);
+    emit snapshotPublished(published->version());
+}
 
-        QStringList imageFiles = dir.entryList(imageFilters, QDir::Files);
-        if (!imageFiles.isEmpty()) {
-            track.setAlbumArtPath(dir.absoluteFilePath(imageFiles.first()));
+Track MusicStorageService::findTrack(const QString &filePath)
+{
+    const int row = rowOfTrack(filePath);
+    return row >= 0 ? m_tracks.at(row) : Track();
+}
+
+int MusicStorageService::rowOfTrack(const QString &filePath)
+{
+    if (m_trackRowsDirty) {
+        m_trackRows.clear();
+        m_trackRows.reserve(m_tracks.size());
+        for (int i = 0; i < m_tracks.size(); ++i) {
+            m_trackRows.insert(m_tracks.at(i).filePath(), i);
         }
+        m_trackRowsDirty = false;
     }
+    return m_trackRows.value(filePath, -1);
+}
 
-    qDebug() << "Extracted track:" << track.title() << "by" << track.artist();
+QByteArray MusicStorageService::rankOf(const QString &filePath) const
+{
+    // Placeholders reserve their rank when listed; it is saved with their
+    // metadata once extracted
+    if (m_playlistData.hasTrackData(filePath)) {
+        return m_playlistData.trackRank(filePath);
+    }
+    return m_placeholderRanks.value(filePath);
+}
+
+QByteArray MusicStorageService::nextTailRank() const
+{
+    // m_tracks is in rank order, so the last row holds the highest rank
+    return RankKey::after(m_tracks.isEmpty() ? QByteArray() : rankOf(m_tracks.last().filePath()));
+}
+
+Track MusicStorageService::trackFromData(const TrackData &data)
+{
+    Track track(data.filePath, data.title, data.artist, data.album, data.duration);
+    if (!data.audioFilePath.isEmpty()) {
+        track.setAudioSpan(data.audioFilePath, data.startMs, data.endMs);
+    }
+    track.setDateAdded(data.dateAdded);
+    track.setFileSize(data.fileSize);
+    track.setAlbumArtPath(data.albumArtPath);
     return track;
 }
 
-bool MusicStorageService::saveTrack(const QString &sourceFilePath,
-                                     const Track &trackInfo)
+TrackData MusicStorageService::dataFromTrack(const Track &track, const QByteArray &rank)
+{
+    TrackData data;
+    data.filePath = track.filePath();
+    data.title = track.title();
+    data.artist = track.artist();
+    data.album = track.album();
+    data.duration = track.duration();
+    data.rank = rank;
+    data.dateAdded = track.dateAdded();
+    data.fileSize = track.fileSize();
+    data.albumArtPath = track.albumArtPath();
+    if (track.isVirtual()) {
+        data.audioFilePath = track.audioFilePath();
+        data.startMs = track.startMs();
+        data.endMs = track.endMs();
+    }
+    return data;
+}
+
+// ========== Track Management ==========
+
+QFuture<Track> MusicStorageService::extractMetadata(const QString &filePath)
+{
+    // Created on first use: a media player is not free to set up, and a
+    // library that matches its snapshot never needs one
+    if (!m_extractor) {
+        m_extractor = new MetadataExtractor(this);
+    }
+    return m_extractor->extract(filePath);
+}
+
+Track MusicStorageService::trackFromFileName(const QString &filePath)
+{
+    static const QRegularExpression separator(" [-–] ");
+
+    QString title = QFileInfo(filePath).completeBaseName();
+    QString artist = "Unknown Artist";
+    QString album = "Unknown Album";
+
+    QStringList parts = title.split(separator);
+    if (parts.size() >= 2) {
+        artist = parts[0].trimmed();
+        title = parts[1].trimmed();
+    }
+
+    return Track(filePath, title, artist, album, 0);
+}
+
+QFuture<bool> MusicStorageService::saveTrack(const QString &sourceFilePath,
+                                              const Track &trackInfo)
 {
     if (!ensureMusicDirectoryExists()) {
-        return false;
+        return QtFuture::makeReadyValueFuture(false);
     }
 
     QFileInfo sourceInfo(sourceFilePath);
     if (!sourceInfo.exists()) {
-        return false;
+        return QtFuture::makeReadyValueFuture(false);
     }
 
     // Create destination filename
@@ -188,44 +712,68 @@ bool MusicStorageService::saveTrack(const QString &sourceFilePath,
     // Sanitize filename (remove invalid characters)
     filename.replace(QRegularExpression("[<>:\"/\\|?*]"), "_");
 
-    QString destPath = m_musicDirectory + "/" + filename;
+    const QString destPath = m_musicDirectory + "/" + filename;
 
-    // Copy file
-    QFile::remove(destPath); // Remove if exists
-    bool success = QFile::copy(sourceFilePath, destPath);
-
-    if (success) {
-        emit tracksChanged();
-    }
-
-    return success;
+    // Copy on the thread pool, account for the file back on our thread
+    return QtConcurrent::run([sourceFilePath, destPath]() {
+        QFile::remove(destPath); // Remove if exists
+        return QFile::copy(sourceFilePath, destPath);
+    }).then(this, [this, destPath](bool success) {
+        // A loading library picks the file up from its directory listing
+        if (success && m_libraryLoaded) {
+            enqueueScan(destPath);
+        }
+        return success;
+    });
 }
 
-bool MusicStorageService::deleteTrack(const QString &filePath)
+QFuture<bool> MusicStorageService::deleteTrack(const QString &filePath)
 {
-    // Also delete the album art file if it exists
-    QFileInfo fileInfo(filePath);
-    QString albumArtPath = fileInfo.absolutePath() + "/." +
-                           fileInfo.completeBaseName() + "_cover.jpg";
-
-    // Remove album art file (silently fail if doesn't exist)
-    QFile::remove(albumArtPath);
-
-    // Remove the main track file
-    bool success = QFile::remove(filePath);
-
-    if (success) {
-        // Remove from playlist data
-        m_playlistData.removeTrack(filePath);
-        savePlaylistData();
+    // A CUE track is a span of an album file the other tracks still play
+    if (findTrack(filePath).isVirtual()) {
+        qWarning() << "Cannot delete a track of a CUE sheet album:" << filePath;
+        return QtFuture::makeReadyValueFuture(false);
+    }
 
-        emit tracksChanged();
+    // Stop reading the file first; the result would bring the track back
+    m_scanPending.remove(filePath);
+    if (filePath == m_extractingPath) {
+        m_extractWatcher->cancel();
     }
 
-    return success;
+    // Also delete the album art file if it exists
+    const QString albumArtPath = MetadataExtractor::coverPathFor(QFileInfo(filePath));
+
+    return QtConcurrent::run([filePath, albumArtPath]() {
+        // Remove album art file (silently fail if doesn't exist)
+        QFile::remove(albumArtPath);
+
+        // Remove the main track file
+        return QFile::remove(filePath);
+    }).then(this, [this, filePath](bool success) {
+        if (success) {
+            // Remove from playlist data
+            m_playlistData.removeTrack(filePath);
+            m_placeholderRanks.remove(filePath);
+            savePlaylistData();
+
+            const int row = rowOfTrack(filePath);
+            if (row >= 0) {
+                m_tracks.removeAt(row);
+                m_trackRowsDirty = true;
+                scheduleSnapshot();
+            }
+
+            emit trackDeleted(filePath);
+            emit tracksChanged();
+        } else {
+            qWarning() << "Failed to delete" << filePath;
+        }
+        return success;
+    });
 }
 
-QString MusicStorageService::playlistDataFilePath() const
+QString MusicStorageService::metadataDirectory() const
 {
     // Get parent directory (one level up from songs folder)
     QDir musicDir(m_musicDirectory);
@@ -236,28 +784,61 @@ QString MusicStorageService::playlistDataFilePath() const
     // Ensure metadata directory exists
     QDir().mkpath(metadataDir);
 
-    return metadataDir + "/playlist.json";
+    return metadataDir;
+}
+
+QString MusicStorageService::playlistDataFilePath() const
+{
+    return metadataDirectory() + "/playlist.json";
 }
 
 void MusicStorageService::savePlaylistData()
 {
     QString filePath = playlistDataFilePath();
-    if (!m_playlistData.saveToFile(filePath)) {
+    // Appends the changed entries to the journal; compacts when due
+    if (!m_playlistData.saveChanges(filePath)) {
         qWarning() << "Failed to save playlist data";
     }
 }
 
 void MusicStorageService::loadPlaylistData()
 {
+    StartupTrace::Span span("loadPlaylistData");
     QString filePath = playlistDataFilePath();
     m_playlistData.loadFromFile(filePath);
 }
 
-void MusicStorageService::updateTrackOrder(const QList<QString> &orderedFilePaths)
+void MusicStorageService::moveTrack(const QString &filePath, int toRow)
 {
-    m_playlistData.updateOrder(orderedFilePaths);
-    savePlaylistData();
-    qDebug() << "Track order updated and saved";
+    const int fromRow = rowOfTrack(filePath);
+    if (fromRow < 0 || toRow < 0 || toRow >= m_tracks.size() || fromRow == toRow) {
+        return;
+    }
+
+    m_tracks.move(fromRow, toRow);
+    scheduleSnapshot();
+    if (!m_trackRowsDirty) {
+        // Only the rows between the old and the new position shift
+        for (int i = qMin(fromRow, toRow); i <= qMax(fromRow, toRow); ++i) {
+            m_trackRows.insert(m_tracks.at(i).filePath(), i);
+        }
+    }
+
+    // The moved track gets a rank between its new neighbours; no other
+    // track is touched, and only this one entry is written to disk
+    const QByteArray before = toRow > 0 ? rankOf(m_tracks.at(toRow - 1).filePath()) : QByteArray();
+    const QByteArray after = toRow + 1 < m_tracks.size() ? rankOf(m_tracks.at(toRow + 1).filePath()) : QByteArray();
+    const QByteArray rank = RankKey::between(before, after);
+    if (rank.isEmpty()) {
+        return;
+    }
+
+    if (m_playlistData.hasTrackData(filePath)) {
+        m_playlistData.setTrackRank(filePath, rank);
+        savePlaylistData();
+    } else {
+        m_placeholderRanks.insert(filePath, rank);
+    }
 }
 
 void MusicStorageService::updateTrackMetadata(const QString &filePath, const Track &track)
@@ -270,16 +851,30 @@ void MusicStorageService::updateTrackMetadata(const QString &filePath, const Tra
     data.duration = track.duration();
     data.dateAdded = track.dateAdded();
     data.fileSize = track.fileSize();
-
-    // Preserve existing order index if available
-    if (m_playlistData.hasTrackData(filePath)) {
-        data.orderIndex = m_playlistData.getTrackData(filePath).orderIndex;
-    } else {
-        // New track, add at the end
-        data.orderIndex = m_playlistData.getAllTracksOrdered().size();
+    data.albumArtPath = track.albumArtPath();
+
+    // CUE tracks keep their span of the album file
+    const Track stored = findTrack(filePath);
+    if (stored.isVirtual()) {
+        data.audioFilePath = stored.audioFilePath();
+        data.startMs = stored.startMs();
+        data.endMs = stored.endMs();
     }
 
+    // Keep the track's place; an unknown track is appended at the end
+    data.rank = rankOf(filePath);
+    m_placeholderRanks.remove(filePath);
+
     m_playlistData.setTrackData(filePath, data);
     savePlaylistData();
+
+    const int row = rowOfTrack(filePath);
+    if (row >= 0) {
+        Track &cached = m_tracks[row];
+        cached.setTitle(track.title());
+        cached.setArtist(track.artist());
+        cached.setAlbum(track.album());
+        scheduleSnapshot();
+    }
     qDebug() << "Track metadata updated and saved:" << track.title();
 }
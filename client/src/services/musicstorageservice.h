@@ -5,9 +5,59 @@
 #include <QString>
 #include <QList>
 #include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QPromise>
+#include <QElapsedTimer>
+#include <memory>
 #include "models/track.h"
 #include "models/playlistdata.h"
+#include "models/librarysnapshot.h"
 
+class MetadataExtractor;
+
+/**
+ * @brief Downloaded songs on disk plus their saved order and metadata
+ *
+ * The library is loaded asynchronously: loadLibrary() reads the
+ * playlist.json snapshot on a worker thread and publishes it as soon as
+ * it is parsed, then walks the songs folder in the background and only
+ * extracts metadata for files the snapshot doesn't know (or whose size
+ * changed), one file at a time without blocking the event loop. Startup
+ * cost is therefore independent of library size.
+ *
+ * Files the snapshot doesn't know are listed right away with a title and
+ * artist derived from the file name; their real metadata replaces the
+ * placeholder in place (trackUpdated) once extracted. Views can pull the
+ * rows they show to the front of the extraction queue with
+ * prioritizeTracks().
+ *
+ * A single-file album rip with a CUE sheet is listed as the sheet's
+ * tracks instead of one long file: virtual tracks keyed "<sheet>#NN" that
+ * play a span of the shared album file (see Track::isVirtual()). The
+ * folder walk reads the album file's tags once for all of them (duration
+ * of the last track, cover), so they never go through the extraction
+ * queue.
+ *
+ * The user's order is stored as rank keys: moveTrack() re-keys only the
+ * moved track and journals that single entry (see PlaylistData).
+ *
+ * All state lives on the service's (GUI) thread. Other threads read the
+ * library through snapshot(): an immutable, versioned copy that is
+ * republished once per batch of changes (per event-loop turn, at most a
+ * few times per second during a scan).
+ *
+ * Long operations return a QFuture that finishes on the service's thread:
+ * loadLibrary() / rescanLibrary() when the scan is over (cancel() stops
+ * extracting; unread files keep their file name placeholder until the next
+ * scan), extractMetadata() with the track, saveTrack() / deleteTrack() with
+ * the outcome of the file operation, which runs on the thread pool and
+ * always completes once started.
+ */
 class MusicStorageService : public QObject
 {
     Q_OBJECT
@@ -19,23 +69,52 @@ public:
     QString musicDirectory() const { return m_musicDirectory; }
     bool ensureMusicDirectoryExists();
 
-    // Track management
-    QList<Track> getDownloadedTracks();
-    bool saveTrack(const QString &sourceFilePath, const Track &trackInfo);
-    bool deleteTrack(const QString &filePath);
+    // Library loading (asynchronous, idempotent); the future finishes with
+    // the scan, and is shared by every caller while the scan runs
+    QFuture<void> loadLibrary();
+    QFuture<void> rescanLibrary();
+    bool isLibraryLoaded() const { return m_libraryLoaded; }
+    bool isScanning() const { return m_scanning; }
+
+    // Track management (ordered in-memory library, empty until loaded)
+    QList<Track> getDownloadedTracks() const { return m_tracks; }
+    // Library track for a file path (invalid Track if not in the library)
+    Track findTrack(const QString &filePath);
+    // Latest published version of the library; callable from any thread,
+    // may lag the GUI-thread state above by one batch
+    LibrarySnapshotPtr snapshot() const { return m_snapshots.load(); }
+    QFuture<bool> saveTrack(const QString &sourceFilePath, const Track &trackInfo);
+    QFuture<bool> deleteTrack(const QString &filePath);
 
-    // Metadata
-    Track extractMetadataFromFile(const QString &filePath);
+    // Metadata (queued behind the scan's own extraction)
+    QFuture<Track> extractMetadata(const QString &filePath);
+    // "Artist - Title.mp3" style guess, used until tags are read
+    static Track trackFromFileName(const QString &filePath);
+    // Extract these files next (rows in or near a viewport); replaces the
+    // previous request, files that are not pending are ignored
+    void prioritizeTracks(const QStringList &filePaths);
 
     // Playlist data (order and custom metadata)
     void savePlaylistData();
     void loadPlaylistData();
-    void updateTrackOrder(const QList<QString> &orderedFilePaths);
+    // Move one track to row toRow of the library (drag and drop)
+    void moveTrack(const QString &filePath, int toRow);
     void updateTrackMetadata(const QString &filePath, const Track &track);
     QString playlistDataFilePath() const;
+    // Where playlist.json and the library database live (created on demand)
+    QString metadataDirectory() const;
 
 signals:
     void tracksChanged();
+    // Metadata of one track changed in place (same position in the library)
+    void trackUpdated(const Track &track);
+    // The user deleted this track's file (not emitted for files that
+    // merely went missing from the folder)
+    void trackDeleted(const QString &filePath);
+    void libraryLoaded();
+    void scanningChanged(bool scanning);
+    // A new snapshot() version is available
+    void snapshotPublished(quint64 version);
 
 private:
     explicit MusicStorageService(QObject *parent = nullptr);
@@ -46,9 +125,65 @@ private:
     void initializeMusicDirectory();
     QString getStandardMusicPath();
 
+    // Result of a folder walk, built on a worker thread
+    struct DirectoryListing
+    {
+        QHash<QString, qint64> files;    // Path -> size, CUE tracks included
+        QHash<QString, Track> cueTracks; // Virtual tracks, metadata complete
+    };
+
+    // Background loading steps (run on the service's thread)
+    void applySnapshot(const PlaylistData &snapshot);
+    void applyDirectoryListing(const DirectoryListing &listing);
+    void startDirectoryScan();
+    void enqueueScan(const QString &filePath);
+    QString takeNextScanPath();
+    void scanNextFile();
+    void onTrackExtracted();
+    void applyExtractedTrack(const QString &filePath, const Track &track);
+    void onScanCanceled();
+    bool isScanCanceled() const { return m_scanPromise && m_scanPromise->isCanceled(); }
+    void finishScan();
+    QFuture<void> scanFuture() const;
+    void setScanning(bool scanning);
+    void scheduleTracksChanged();
+    void scheduleSnapshot();
+    void publishSnapshot();
+    int rowOfTrack(const QString &filePath);
+    QByteArray rankOf(const QString &filePath) const;
+    QByteArray nextTailRank() const;
+
+    static Track trackFromData(const TrackData &data);
+    static TrackData dataFromTrack(const Track &track, const QByteArray &rank);
+    static DirectoryListing listMusicFiles(const QString &directory);
+    static QList<Track> readCueTracks(const QString &cuePath);
+
     static MusicStorageService *s_instance;
     QString m_musicDirectory;
     PlaylistData m_playlistData;
+
+    QList<Track> m_tracks;       // Library in playlist order
+    QHash<QString, int> m_trackRows;  // File path -> index in m_tracks
+    bool m_trackRowsDirty;
+    QHash<QString, QByteArray> m_placeholderRanks; // Ranks of listed but not yet extracted files
+    QStringList m_scanQueue;     // Files waiting for metadata extraction, in folder order
+    QStringList m_priorityQueue; // Files a view asked for, extracted first
+    QSet<QString> m_scanPending; // Files still to extract (queues may hold stale entries)
+    MetadataExtractor *m_extractor;
+    QFutureWatcher<Track> *m_extractWatcher; // The scan's extraction in flight
+    QString m_extractingPath;    // Its file, empty when none
+    QElapsedTimer m_extractTimer;
+    std::unique_ptr<QPromise<void>> m_scanPromise; // Backs loadLibrary()/rescanLibrary() while scanning
+    QFutureWatcher<void> *m_scanWatcher;     // Reports cancel() of the scan future
+    QTimer *m_changeTimer;       // Coalesces tracksChanged during scans
+    QTimer *m_snapshotTimer;     // Batches m_tracks changes into one snapshot version
+    LibrarySnapshotSlot m_snapshots;
+    bool m_libraryLoading;
+    bool m_libraryLoaded;
+    bool m_listingPending;       // A folder listing is on its way from a worker
+    bool m_scanning;
+    bool m_scanDirty;
+    qint64 m_scanStartNs;        // StartupTrace timestamp of the current scan
 };
 
 #endif // MUSICSTORAGESERVICE_H
@@ -0,0 +1,423 @@
+#include "nowplayingfeed.h"
+#include "nowplayingparser.h"
+#include "utils/metrics.h"
+#include "utils/networkfuture.h"
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUrlQuery>
+#include <QRandomGenerator>
+#include <QDebug>
+
+namespace {
+// Centrifugo pings every 25 s; two missed pings means the connection is dead
+constexpr int kWatchdogTimeoutMs = 60000;
+constexpr int kReconnectBaseDelayMs = 1000;
+constexpr int kReconnectMaxDelayMs = 30000;
+constexpr int kPollMinDelayMs = 2000;
+constexpr int kPollMaxDelayMs = 30000;
+constexpr int kPollDefaultDelayMs = 15000;
+}
+
+QHash<QString, NowPlayingFeed*> NowPlayingFeed::s_feeds;
+
+NowPlayingFeed* NowPlayingFeed::forHost(const QString &baseUrl)
+{
+    NowPlayingFeed *feed = s_feeds.value(baseUrl);
+    if (!feed) {
+        // Owned by the application, so it is torn down with it rather
+        // than leaked past it
+        feed = new NowPlayingFeed(baseUrl, QCoreApplication::instance());
+        s_feeds.insert(baseUrl, feed);
+        connect(feed, &QObject::destroyed, [baseUrl]() {
+            s_feeds.remove(baseUrl);
+        });
+    }
+    return feed;
+}
+
+NowPlayingFeed::NowPlayingFeed(const QString &baseUrl, QObject *parent)
+    : QObject(parent)
+    , m_networkManager(new QNetworkAccessManager(this))
+    , m_reconnectTimer(new QTimer(this))
+    , m_pollTimer(new QTimer(this))
+    , m_watchdogTimer(new QTimer(this))
+    , m_subscriptionTimer(new QTimer(this))
+    , m_baseUrl(baseUrl)
+    , m_mode(Mode::Idle)
+    , m_running(false)
+    , m_reconnectAttempts(0)
+{
+    m_reconnectTimer->setSingleShot(true);
+    connect(m_reconnectTimer, &QTimer::timeout, this, &NowPlayingFeed::openStream);
+
+    m_pollTimer->setSingleShot(true);
+    connect(m_pollTimer, &QTimer::timeout, this, &NowPlayingFeed::poll);
+
+    m_watchdogTimer->setSingleShot(true);
+    m_watchdogTimer->setInterval(kWatchdogTimeoutMs);
+    connect(m_watchdogTimer, &QTimer::timeout, this, &NowPlayingFeed::onWatchdogTimeout);
+
+    // Batches subscription changes made in the same event loop pass
+    // (e.g. every station registering at startup) into one reconnect
+    m_subscriptionTimer->setSingleShot(true);
+    m_subscriptionTimer->setInterval(0);
+    connect(m_subscriptionTimer, &QTimer::timeout, this, &NowPlayingFeed::applySubscriptions);
+}
+
+NowPlayingFeed::~NowPlayingFeed()
+{
+    stop();
+}
+
+void NowPlayingFeed::subscribe(const QString &stationId)
+{
+    if (stationId.isEmpty() || m_stations.contains(stationId)) {
+        return;
+    }
+    m_stations.append(stationId);
+    m_subscriptionTimer->start();
+}
+
+void NowPlayingFeed::unsubscribe(const QString &stationId)
+{
+    if (!m_stations.removeOne(stationId)) {
+        return;
+    }
+    m_remainingHints.remove(stationId);
+    m_subscriptionTimer->start();
+}
+
+void NowPlayingFeed::applySubscriptions()
+{
+    if (m_stations.isEmpty()) {
+        stop();
+        return;
+    }
+
+    if (!m_running) {
+        start();
+        return;
+    }
+
+    // A unidirectional SSE connection can't change its subscriptions;
+    // reconnect with the new set and cover the gap with one poll
+    qDebug() << "Now playing feed resubscribing:" << m_stations;
+    closeStream();
+    m_lastEventId.clear();  // Event ids belong to the old subscription set
+    m_reconnectTimer->stop();
+    m_reconnectAttempts = 0;
+    setMode(Mode::Polling);
+    poll();
+    openStream();
+}
+
+void NowPlayingFeed::setRemainingHint(const QString &stationId, int seconds)
+{
+    m_remainingHints.insert(stationId, seconds);
+}
+
+void NowPlayingFeed::start()
+{
+    if (m_running) {
+        return;
+    }
+
+    m_running = true;
+    m_reconnectAttempts = 0;
+
+    // Poll once so the UI has data before the live feed delivers its first event
+    setMode(Mode::Polling);
+    poll();
+    openStream();
+
+    qDebug() << "Now playing feed started for" << m_baseUrl << "stations:" << m_stations;
+}
+
+void NowPlayingFeed::stop()
+{
+    if (!m_running) {
+        return;
+    }
+
+    m_running = false;
+    m_reconnectTimer->stop();
+    m_pollTimer->stop();
+    m_watchdogTimer->stop();
+    closeStream();
+
+    // Aborts an in-flight poll; its handler does not run
+    m_poll.cancel();
+    m_lastEventId.clear();
+
+    setMode(Mode::Idle);
+    qDebug() << "Now playing feed stopped for" << m_baseUrl;
+}
+
+void NowPlayingFeed::refreshNow()
+{
+    poll();
+}
+
+void NowPlayingFeed::setMode(Mode mode)
+{
+    if (m_mode == mode) {
+        return;
+    }
+    m_mode = mode;
+    emit modeChanged(mode);
+}
+
+QUrl NowPlayingFeed::streamUrl() const
+{
+    // cq = {"subs":{"station:<id>":{"recover":true}, ...}}
+    QJsonObject channel;
+    channel["recover"] = true;
+    QJsonObject subs;
+    for (const QString &stationId : m_stations) {
+        subs[QString("station:%1").arg(stationId)] = channel;
+    }
+    QJsonObject connectQuery;
+    connectQuery["subs"] = subs;
+
+    QUrl url(m_baseUrl + "/api/live/nowplaying/sse");
+    QUrlQuery query;
+    query.addQueryItem("cq", QString::fromUtf8(QJsonDocument(connectQuery).toJson(QJsonDocument::Compact)));
+    url.setQuery(query);
+    return url;
+}
+
+QUrl NowPlayingFeed::pollUrl() const
+{
+    // One station: its own (smaller) payload; several: one request for all
+    if (m_stations.size() == 1) {
+        return QUrl(QString("%1/api/nowplaying/%2").arg(m_baseUrl, m_stations.first()));
+    }
+    return QUrl(QString("%1/api/nowplaying").arg(m_baseUrl));
+}
+
+// ========== Live (SSE) connection ==========
+
+void NowPlayingFeed::openStream()
+{
+    if (!m_running || m_streamReply) {
+        return;
+    }
+
+    QNetworkRequest request(streamUrl());
+    request.setHeader(QNetworkRequest::UserAgentHeader, "EKNMusic/1.0");
+    request.setRawHeader("Accept", "text/event-stream");
+    request.setRawHeader("Cache-Control", "no-cache");
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+    if (!m_lastEventId.isEmpty()) {
+        request.setRawHeader("Last-Event-ID", m_lastEventId);
+    }
+
+    m_streamBuffer.clear();
+    m_eventData.clear();
+    m_eventId = m_lastEventId;
+
+    m_streamReply = m_networkManager->get(request);
+    connect(m_streamReply, &QNetworkReply::readyRead, this, &NowPlayingFeed::onStreamReadyRead);
+    connect(m_streamReply, &QNetworkReply::finished, this, &NowPlayingFeed::onStreamFinished);
+
+    m_watchdogTimer->start();
+    qDebug() << "Connecting to now playing feed:" << m_streamReply->url();
+}
+
+void NowPlayingFeed::closeStream()
+{
+    if (!m_streamReply) {
+        return;
+    }
+
+    QNetworkReply *reply = m_streamReply;
+    m_streamReply = nullptr;
+    reply->disconnect(this);
+    reply->abort();
+    reply->deleteLater();
+}
+
+void NowPlayingFeed::onStreamReadyRead()
+{
+    if (!m_streamReply) {
+        return;
+    }
+
+    m_watchdogTimer->start();
+    m_streamBuffer.append(m_streamReply->readAll());
+    processStreamBuffer();
+}
+
+void NowPlayingFeed::processStreamBuffer()
+{
+    // Server-sent events: "data:" lines accumulate, a blank line dispatches the event
+    qsizetype lineStart = 0;
+    qsizetype newline;
+    while ((newline = m_streamBuffer.indexOf('\n', lineStart)) != -1) {
+        QByteArray line = m_streamBuffer.mid(lineStart, newline - lineStart);
+        lineStart = newline + 1;
+
+        if (line.endsWith('\r')) {
+            line.chop(1);
+        }
+
+        if (line.isEmpty()) {
+            // The id counts once its event is complete, data or not
+            m_lastEventId = m_eventId;
+            if (!m_eventData.isEmpty()) {
+                handleEventData(m_eventData);
+                m_eventData.clear();
+            }
+        } else if (line.startsWith("data:")) {
+            QByteArray value = line.mid(5);
+            if (value.startsWith(' ')) {
+                value.remove(0, 1);
+            }
+            if (!m_eventData.isEmpty()) {
+                m_eventData.append('\n');
+            }
+            m_eventData.append(value);
+        } else if (line.startsWith("id:")) {
+            QByteArray value = line.mid(3);
+            if (value.startsWith(' ')) {
+                value.remove(0, 1);
+            }
+            if (!value.contains('\0')) {
+                m_eventId = value;
+            }
+        }
+        // Comments (":") and the event/retry fields are not used
+    }
+
+    m_streamBuffer.remove(0, lineStart);
+}
+
+void NowPlayingFeed::handleEventData(const QByteArray &data)
+{
+    // Any message, pings ("{}") included, proves the connection is alive
+    if (m_mode != Mode::Live) {
+        qDebug() << "Now playing feed is live for" << m_baseUrl;
+        m_reconnectAttempts = 0;
+        m_pollTimer->stop();
+        setMode(Mode::Live);
+    }
+
+    // Slice each station's "np" object out of the envelope without parsing the rest
+    QList<NowPlayingPayload> payloads;
+    NowPlayingParser::extractFeedPayloads(data, payloads);
+    for (const NowPlayingPayload &payload : payloads) {
+        emit nowPlayingReceived(payload.stationId, payload.json.toByteArray());
+    }
+}
+
+void NowPlayingFeed::onStreamFinished()
+{
+    if (!m_streamReply) {
+        return;
+    }
+
+    qWarning() << "Now playing feed disconnected:" << m_streamReply->errorString();
+    closeStream();
+    m_watchdogTimer->stop();
+
+    if (!m_running) {
+        return;
+    }
+
+    // Cover the gap with polling until the live feed is back
+    if (m_mode != Mode::Polling) {
+        setMode(Mode::Polling);
+        poll();
+    }
+    scheduleReconnect();
+}
+
+void NowPlayingFeed::onWatchdogTimeout()
+{
+    if (m_streamReply) {
+        qWarning() << "Now playing feed silent for" << kWatchdogTimeoutMs / 1000 << "s, reconnecting";
+        // abort() emits finished(), which runs the normal reconnect path
+        m_streamReply->abort();
+    }
+}
+
+void NowPlayingFeed::scheduleReconnect()
+{
+    int exponent = qMin(m_reconnectAttempts, 5);
+    int delay = qMin(kReconnectBaseDelayMs << exponent, kReconnectMaxDelayMs);
+    delay += QRandomGenerator::global()->bounded(500); // Jitter so clients don't reconnect in lockstep
+    ++m_reconnectAttempts;
+
+    qDebug() << "Reconnecting now playing feed in" << delay << "ms (attempt" << m_reconnectAttempts << ")";
+    m_reconnectTimer->start(delay);
+}
+
+// ========== Polling fallback ==========
+
+void NowPlayingFeed::poll()
+{
+    if (m_poll.isRunning()) {
+        return; // A poll is already in flight
+    }
+
+    QNetworkRequest request(pollUrl());
+    request.setHeader(QNetworkRequest::UserAgentHeader, "EKNMusic/1.0");
+
+    QNetworkReply *reply = m_networkManager->get(request);
+    EKNM_METRIC_HTTP(reply);
+    m_poll = NetworkFuture::fromReply(reply, this, [this](QNetworkReply *reply) {
+        if (reply->error() != QNetworkReply::NoError) {
+            qWarning() << "Failed to poll now playing:" << reply->errorString();
+            if (m_running && m_mode == Mode::Polling) {
+                schedulePoll(kPollDefaultDelayMs);
+            }
+            return false;
+        }
+
+        // Consumers update the remaining hints synchronously from this signal
+        m_remainingHints.clear();
+
+        QByteArray body = reply->readAll();
+        if (QByteArrayView(body).trimmed().startsWith('[')) {
+            QList<NowPlayingPayload> payloads;
+            NowPlayingParser::splitNowPlayingList(body, payloads);
+            for (const NowPlayingPayload &payload : payloads) {
+                if (m_stations.contains(payload.stationId)) {
+                    emit nowPlayingReceived(payload.stationId, payload.json.toByteArray());
+                }
+            }
+        } else {
+            QString stationId = NowPlayingParser::stationShortcode(body);
+            if (m_stations.contains(stationId)) {
+                emit nowPlayingReceived(stationId, body);
+            }
+        }
+
+        if (m_running && m_mode == Mode::Polling) {
+            schedulePoll(nextPollDelayMs());
+        }
+        return true;
+    });
+}
+
+void NowPlayingFeed::schedulePoll(int delayMs)
+{
+    m_pollTimer->start(delayMs);
+}
+
+int NowPlayingFeed::nextPollDelayMs() const
+{
+    // Wake up just after the first of the current songs ends rather than on a fixed tick
+    int soonest = -1;
+    for (auto it = m_remainingHints.constBegin(); it != m_remainingHints.constEnd(); ++it) {
+        if (it.value() >= 0 && (soonest < 0 || it.value() < soonest)) {
+            soonest = it.value();
+        }
+    }
+
+    if (soonest < 0) {
+        return kPollDefaultDelayMs;
+    }
+    return qBound(kPollMinDelayMs, (soonest + 1) * 1000, kPollMaxDelayMs);
+}
@@ -0,0 +1,114 @@
+#ifndef NOWPLAYINGFEED_H
+#define NOWPLAYINGFEED_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QFuture>
+#include <QTimer>
+#include <QPointer>
+#include <QHash>
+#include <QStringList>
+
+/**
+ * @brief Push-based "now playing" feed for the stations of one AzuraCast host
+ *
+ * One feed exists per host (see forHost()) and multiplexes every
+ * subscribed station over a single Centrifugo SSE connection
+ * (/api/live/nowplaying/sse with one "subs" entry per station), emitting
+ * each station's nowplaying payload as soon as the server publishes it.
+ *
+ * When the live connection drops it reconnects with exponential backoff,
+ * sending the id of the last event it saw as Last-Event-ID so a server
+ * that tags its events can resume where the stream broke off.
+ * While the live feed is down it falls back to a single poll of the
+ * nowplaying endpoint covering all subscribed stations, timed to the end
+ * of the soonest-ending song instead of a fixed interval.
+ */
+class NowPlayingFeed : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Mode {
+        Idle,
+        Live,
+        Polling
+    };
+
+    // Shared feed for an AzuraCast host (e.g. "https://radio.eknm.in")
+    static NowPlayingFeed* forHost(const QString &baseUrl);
+
+    // Stations tracked by this feed; the feed runs while any are subscribed
+    void subscribe(const QString &stationId);
+    void unsubscribe(const QString &stationId);
+    bool isSubscribed(const QString &stationId) const { return m_stations.contains(stationId); }
+    QStringList stations() const { return m_stations; }
+
+    bool isRunning() const { return m_running; }
+    Mode mode() const { return m_mode; }
+
+    // Request an immediate one-shot poll (e.g. the user pressed play)
+    void refreshNow();
+
+    // Seconds left in a station's current song, as parsed by the consumer
+    // of nowPlayingReceived(); schedules the next fallback poll
+    void setRemainingHint(const QString &stationId, int seconds);
+
+signals:
+    // Raw nowplaying JSON (the "np" object of a publication, or a poll body)
+    void nowPlayingReceived(const QString &stationId, const QByteArray &nowPlaying);
+    void modeChanged(NowPlayingFeed::Mode mode);
+
+private slots:
+    void onStreamReadyRead();
+    void onStreamFinished();
+    void onWatchdogTimeout();
+    void applySubscriptions();
+
+private:
+    explicit NowPlayingFeed(const QString &baseUrl, QObject *parent = nullptr);
+    ~NowPlayingFeed();
+
+    void start();
+    void stop();
+    void openStream();
+    void closeStream();
+    void scheduleReconnect();
+    void schedulePoll(int delayMs);
+    void poll();
+    void setMode(Mode mode);
+
+    void processStreamBuffer();
+    void handleEventData(const QByteArray &data);
+    int nextPollDelayMs() const;
+
+    QUrl streamUrl() const;
+    QUrl pollUrl() const;
+
+    static QHash<QString, NowPlayingFeed*> s_feeds;
+
+    QNetworkAccessManager *m_networkManager;
+    QPointer<QNetworkReply> m_streamReply;
+    QFuture<bool> m_poll;  // Last poll; cancel() aborts it
+
+    QTimer *m_reconnectTimer;
+    QTimer *m_pollTimer;
+    QTimer *m_watchdogTimer;
+    QTimer *m_subscriptionTimer;
+
+    QString m_baseUrl;
+    QStringList m_stations;
+    QHash<QString, int> m_remainingHints;
+
+    QByteArray m_streamBuffer;
+    QByteArray m_eventData;
+    QByteArray m_eventId;      // "id:" of the event being received
+    QByteArray m_lastEventId;  // Of the last complete event; sent on reconnect
+
+    Mode m_mode;
+    bool m_running;
+    int m_reconnectAttempts;
+};
+
+#endif // NOWPLAYINGFEED_H
@@ -0,0 +1,262 @@
+#include "nowplayingparser.h"
+#include "utils/jsonpullreader.h"
+
+RadioSongInfo NowPlayingParser::readSong(JsonPullReader &reader)
+{
+    RadioSongInfo info;
+    info.title = QStringLiteral("Unknown");
+    info.artist = QStringLiteral("Unknown");
+
+    if (!reader.enterObject()) {
+        return info;
+    }
+
+    QByteArrayView key;
+    while (reader.nextKey(key)) {
+        if (key == "id") {
+            info.id = reader.readString();
+        } else if (key == "title") {
+            info.title = reader.readString(info.title);
+        } else if (key == "artist") {
+            info.artist = reader.readString(info.artist);
+        } else if (key == "album") {
+            info.album = reader.readString();
+        } else if (key == "art") {
+            info.artUrl = reader.readString();
+        } else if (key == "duration") {
+            info.duration = static_cast<int>(reader.readInt(0));
+        } else {
+            reader.skipValue();
+        }
+    }
+    return info;
+}
+
+RadioSongInfo NowPlayingParser::readSongItem(JsonPullReader &reader, bool useRequestId)
+{
+    RadioSongInfo info;
+    QString requestId;
+
+    if (!reader.enterObject()) {
+        return info;
+    }
+
+    QByteArrayView key;
+    while (reader.nextKey(key)) {
+        if (key == "song") {
+            info = readSong(reader);
+        } else if (useRequestId && key == "request_id") {
+            requestId = reader.readString();
+        } else {
+            reader.skipValue();
+        }
+    }
+
+    if (useRequestId) {
+        info.id = requestId;
+    }
+    return info;
+}
+
+bool NowPlayingParser::parseNowPlaying(QByteArrayView json, RadioState &state)
+{
+    JsonPullReader reader(json);
+    if (!reader.enterObject()) {
+        return false;
+    }
+
+    // Left empty when the payload has no station: the caller knows which
+    // station it asked for
+    RadioNowPlayingInfo &info = state.nowPlaying;
+
+    QByteArrayView key;
+    while (reader.nextKey(key)) {
+        if (key == "station") {
+            QByteArrayView stationKey;
+            if (reader.enterObject()) {
+                while (reader.nextKey(stationKey)) {
+                    if (stationKey == "name") {
+                        info.stationName = reader.readString(info.stationName);
+                    } else if (stationKey == "is_online") {
+                        info.isOnline = reader.readBool(info.isOnline);
+                    } else {
+                        reader.skipValue(); // mounts, remotes, urls...
+                    }
+                }
+            }
+        } else if (key == "is_online") {
+            info.isOnline = reader.readBool(info.isOnline);
+        } else if (key == "listeners") {
+            QByteArrayView listenersKey;
+            if (reader.enterObject()) {
+                while (reader.nextKey(listenersKey)) {
+                    if (listenersKey == "current") {
+                        info.listeners = static_cast<int>(reader.readInt(0));
+                    } else {
+                        reader.skipValue();
+                    }
+                }
+            }
+        } else if (key == "now_playing") {
+            QByteArrayView nowKey;
+            if (reader.enterObject()) {
+                while (reader.nextKey(nowKey)) {
+                    if (nowKey == "song") {
+                        info.song = readSong(reader);
+                    } else if (nowKey == "elapsed") {
+                        info.elapsed = static_cast<int>(reader.readInt(0));
+                    } else if (nowKey == "duration") {
+                        info.duration = static_cast<int>(reader.readInt(0));
+                    } else if (nowKey == "remaining") {
+                        info.remaining = static_cast<int>(reader.readInt(0));
+                    } else {
+                        reader.skipValue();
+                    }
+                }
+            }
+        } else if (key == "playing_next") {
+            // Object or null
+            if (reader.peek() == JsonPullReader::ValueType::Object) {
+                state.queue.append(readSongItem(reader, false));
+            } else {
+                reader.skipValue();
+            }
+        } else if (key == "song_history") {
+            if (reader.enterArray()) {
+                while (reader.nextElement()) {
+                    state.history.append(readSongItem(reader, false));
+                }
+            }
+        } else {
+            reader.skipValue();
+        }
+    }
+
+    return !reader.hasError();
+}
+
+bool NowPlayingParser::parseSongList(QByteArrayView json, QList<RadioSongInfo> &songs, bool useRequestId)
+{
+    JsonPullReader reader(json);
+    if (!reader.enterArray()) {
+        return false;
+    }
+
+    while (reader.nextElement()) {
+        songs.append(readSongItem(reader, useRequestId));
+    }
+
+    return !reader.hasError();
+}
+
+bool NowPlayingParser::extractPublicationPayload(QByteArrayView publication, QByteArrayView &nowPlaying)
+{
+    // {"data": {"np": {...}, "current_time": ...}, "offset": N}
+    JsonPullReader reader(publication);
+    if (!reader.findKey("data") || !reader.findKey("np")) {
+        return false;
+    }
+
+    nowPlaying = reader.skipValue();
+    return !reader.hasError() && !nowPlaying.isEmpty();
+}
+
+QString NowPlayingParser::stationFromChannel(QByteArrayView channel)
+{
+    // "station:<shortcode>"
+    constexpr QByteArrayView prefix("station:");
+    if (channel.startsWith(prefix)) {
+        channel = channel.sliced(prefix.size());
+    }
+    return QString::fromUtf8(channel);
+}
+
+QString NowPlayingParser::stationShortcode(QByteArrayView nowPlaying)
+{
+    JsonPullReader reader(nowPlaying);
+    if (!reader.findKey("station") || !reader.findKey("shortcode")) {
+        return QString();
+    }
+    return reader.readString();
+}
+
+bool NowPlayingParser::extractFeedPayloads(QByteArrayView message, QList<NowPlayingPayload> &payloads)
+{
+    JsonPullReader reader(message);
+    if (!reader.enterObject()) {
+        return false;
+    }
+
+    QByteArrayView channel;
+    QByteArrayView publication;
+
+    QByteArrayView key;
+    while (reader.nextKey(key)) {
+        if (key == "channel") {
+            // Raw span including quotes; shortcodes never need unescaping
+            QByteArrayView raw = reader.skipValue();
+            if (raw.size() >= 2) {
+                channel = raw.sliced(1, raw.size() - 2);
+            }
+        } else if (key == "pub") {
+            // Live publication: {"channel": "station:x", "pub": {"data": {"np": ...}}}
+            publication = reader.skipValue();
+        } else if (key == "connect") {
+            // Initial message: {"connect": {"subs": {"station:x": {"publications": [...]}}}}
+            if (!reader.findKey("subs") || !reader.enterObject()) {
+                return false;
+            }
+
+            QByteArrayView subChannel;
+            while (reader.nextKey(subChannel)) {
+                if (!reader.findKey("publications")) {
+                    continue;
+                }
+
+                QByteArrayView latest;
+                if (reader.enterArray()) {
+                    while (reader.nextElement()) {
+                        latest = reader.skipValue();
+                    }
+                }
+                reader.leaveContainer(); // Rest of this subscription object
+
+                QByteArrayView nowPlaying;
+                if (!latest.isEmpty() && extractPublicationPayload(latest, nowPlaying)) {
+                    payloads.append({stationFromChannel(subChannel), nowPlaying});
+                }
+            }
+            return !payloads.isEmpty();
+        } else {
+            reader.skipValue();
+        }
+    }
+
+    QByteArrayView nowPlaying;
+    if (publication.isEmpty() || !extractPublicationPayload(publication, nowPlaying)) {
+        return false;
+    }
+
+    // Older servers omit the channel on single-subscription connections
+    QString stationId = channel.isEmpty() ? stationShortcode(nowPlaying) : stationFromChannel(channel);
+    payloads.append({stationId, nowPlaying});
+    return true;
+}
+
+bool NowPlayingParser::splitNowPlayingList(QByteArrayView json, QList<NowPlayingPayload> &payloads)
+{
+    JsonPullReader reader(json);
+    if (!reader.enterArray()) {
+        return false;
+    }
+
+    while (reader.nextElement()) {
+        QByteArrayView nowPlaying = reader.skipValue();
+        QString stationId = stationShortcode(nowPlaying);
+        if (!stationId.isEmpty()) {
+            payloads.append({stationId, nowPlaying});
+        }
+    }
+
+    return !reader.hasError();
+}
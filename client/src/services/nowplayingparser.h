@@ -0,0 +1,52 @@
+#ifndef NOWPLAYINGPARSER_H
+#define NOWPLAYINGPARSER_H
+
+#include <QByteArrayView>
+#include <QList>
+#include "models/radiostate.h"
+
+class JsonPullReader;
+
+// A station's raw nowplaying object inside a larger message
+struct NowPlayingPayload {
+    QString stationId;      // Station shortcode
+    QByteArrayView json;    // Points into the parsed buffer
+};
+
+/**
+ * @brief Streaming parser for AzuraCast radio payloads
+ *
+ * Pulls only the fields RadioState needs straight out of the response
+ * bytes using JsonPullReader. Everything else in the payload (mounts,
+ * remotes, playlists, per-song custom fields...) is skipped without being
+ * materialized, unlike a QJsonDocument round trip.
+ */
+class NowPlayingParser
+{
+public:
+    // GET /api/nowplaying/{station}
+    static bool parseNowPlaying(QByteArrayView json, RadioState &state);
+
+    // GET /api/station/{id}/history, /queue and /requests: arrays of items
+    // holding a "song" object. With useRequestId the item's request_id
+    // replaces the song id (what submitSongRequest() expects).
+    static bool parseSongList(QByteArrayView json, QList<RadioSongInfo> &songs,
+                              bool useRequestId = false);
+
+    // Centrifugo SSE message -> latest "np" payload of each station channel it carries
+    static bool extractFeedPayloads(QByteArrayView message, QList<NowPlayingPayload> &payloads);
+
+    // GET /api/nowplaying (all stations) -> one payload per station
+    static bool splitNowPlayingList(QByteArrayView json, QList<NowPlayingPayload> &payloads);
+
+    // Station shortcode of a nowplaying object
+    static QString stationShortcode(QByteArrayView nowPlaying);
+
+private:
+    static RadioSongInfo readSong(JsonPullReader &reader);
+    static RadioSongInfo readSongItem(JsonPullReader &reader, bool useRequestId);
+    static bool extractPublicationPayload(QByteArrayView publication, QByteArrayView &nowPlaying);
+    static QString stationFromChannel(QByteArrayView channel);
+};
+
+#endif // NOWPLAYINGPARSER_H
@@ -0,0 +1,273 @@
+#include "playbacksession.h"
+#include "playerservice.h"
+#include "musicstorageservice.h"
+#include "librarydatabase.h"
+#include "utils/startuptrace.h"
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+#include <utility>
+
+namespace {
+constexpr quint32 kMagic = 0x454B5353; // "EKSS"
+constexpr quint16 kFormatVersion = 1;
+constexpr QDataStream::Version kStreamVersion = QDataStream::Qt_6_5;
+
+// Settles bursts of changes (skipping through tracks, dragging the volume)
+constexpr int kSaveDelayMs = 1000;
+// Position only: losing a few seconds of it on a crash is fine
+constexpr int kPlayingSaveIntervalMs = 5000;
+}
+
+PlaybackSession* PlaybackSession::s_instance = nullptr;
+
+PlaybackSession::PlaybackSession(QObject *parent)
+    : QObject(parent)
+    , m_saveTimer(new QTimer(this))
+    , m_queueDirty(true)
+    , m_restoring(false)
+    , m_savedIndex(-1)
+    , m_queuePending(false)
+{
+    m_saveTimer->setSingleShot(true);
+    connect(m_saveTimer, &QTimer::timeout, this, &PlaybackSession::save);
+
+    PlayerService *player = PlayerService::instance();
+    connect(player, &PlayerService::playlistChanged, this, &PlaybackSession::onPlaylistChanged);
+    connect(player, &PlayerService::trackChanged, this, [this]() {
+        scheduleSave(kSaveDelayMs);
+    });
+    connect(player, &PlayerService::playbackModeChanged, this, [this]() {
+        scheduleSave(kSaveDelayMs);
+    });
+    connect(player, &PlayerService::volumeChanged, this, [this]() {
+        scheduleSave(kSaveDelayMs);
+    });
+    connect(player, &PlayerService::mutedChanged, this, [this]() {
+        scheduleSave(kSaveDelayMs);
+    });
+    // Pausing keeps the position it paused at
+    connect(player, &PlayerService::playbackStateChanged, this, [this]() {
+        scheduleSave(kSaveDelayMs);
+    });
+    connect(player, &PlayerService::positionChanged, this, [this]() {
+        scheduleSave(kPlayingSaveIntervalMs);
+    });
+
+    connect(MusicStorageService::instance(), &MusicStorageService::libraryLoaded,
+            this, &PlaybackSession::onLibraryLoaded);
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &PlaybackSession::save);
+}
+
+PlaybackSession::~PlaybackSession()
+{
+}
+
+PlaybackSession* PlaybackSession::instance()
+{
+    if (!s_instance) {
+        s_instance = new PlaybackSession();
+    }
+    return s_instance;
+}
+
+// ========== Restore ==========
+
+void PlaybackSession::restore()
+{
+    StartupTrace::Span span("session.restore");
+
+    QFile file(sessionFilePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;  // First launch
+    }
+    QDataStream in(file.readAll());
+    in.setVersion(kStreamVersion);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != kMagic || version != kFormatVersion) {
+        qWarning() << "PlaybackSession: ignoring unknown session file" << file.fileName();
+        return;
+    }
+
+    qint32 index = -1;
+    qint64 positionMs = 0;
+    qint8 mode = 0;
+    qint8 volume = 0;
+    bool muted = false;
+    in >> index >> positionMs >> mode >> volume >> muted;
+
+    QString filePath, title, artist, album, albumArtPath, audioFilePath;
+    qint64 durationMs = 0, startMs = 0, endMs = 0, fileSize = 0;
+    in >> filePath >> title >> artist >> album >> albumArtPath >> audioFilePath
+       >> durationMs >> startMs >> endMs >> fileSize;
+
+    quint32 count = 0;
+    in >> count;
+    QList<qint64> trackIds;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        qint64 trackId = 0;
+        in >> trackId;
+        trackIds.append(trackId);
+    }
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "PlaybackSession: truncated session file" << file.fileName();
+        return;
+    }
+
+    PlayerService *player = PlayerService::instance();
+    m_restoring = true;
+    player->setVolume(volume);
+    player->setMuted(muted);
+    player->setPlaybackMode(PlayerService::PlaybackMode(qBound<int>(0, mode, PlayerService::RepeatAll)));
+
+    Track current(filePath, title, artist, album, durationMs);
+    if (!audioFilePath.isEmpty()) {
+        current.setAudioSpan(audioFilePath, startMs, endMs);
+    }
+    current.setAlbumArtPath(albumArtPath);
+    current.setFileSize(fileSize);
+
+    // The queue only makes sense around its current track, which is all
+    // that goes back now; the rest waits for onLibraryLoaded()
+    if (current.isValid() && QFileInfo::exists(current.audioFilePath())) {
+        player->restoreSession({current}, 0, positionMs);
+        m_savedQueue = trackIds;
+        m_savedIndex = index;
+        m_queuePending = true;
+        m_queueData = encodeQueue(trackIds);
+        m_queueDirty = false;
+    }
+    m_restoring = false;
+
+    // What was just read is what the file holds
+    m_saveTimer->stop();
+    if (m_queuePending && MusicStorageService::instance()->isLibraryLoaded()) {
+        onLibraryLoaded();
+    }
+}
+
+void PlaybackSession::onLibraryLoaded()
+{
+    if (!m_queuePending) {
+        return;
+    }
+    m_queuePending = false;
+    const QList<qint64> trackIds = std::exchange(m_savedQueue, {});
+
+    PlayerService *player = PlayerService::instance();
+    MusicStorageService *storage = MusicStorageService::instance();
+    const Track current = player->currentTrack();
+    const Track currentInLibrary = storage->findTrack(current.filePath());
+
+    // Only the saved IDs are looked up, not the whole ID map
+    const QHash<qint64, QString> paths = LibraryDatabase::instance()->trackPaths(trackIds);
+    QList<Track> tracks;
+    tracks.reserve(trackIds.size() + 1);
+    int currentRow = -1;
+    for (int i = 0; i < trackIds.size(); ++i) {
+        if (i == m_savedIndex) {
+            currentRow = tracks.size();
+            tracks.append(currentInLibrary.isValid() ? currentInLibrary : current);
+            continue;
+        }
+        const QString queuedPath = paths.value(trackIds.at(i));
+        if (queuedPath.isEmpty()) {
+            continue;
+        }
+        const Track track = storage->findTrack(queuedPath);
+        tracks.append(track.isValid() ? track : MusicStorageService::trackFromFileName(queuedPath));
+    }
+    if (currentRow < 0) {
+        currentRow = tracks.size();
+        tracks.append(currentInLibrary.isValid() ? currentInLibrary : current);
+    }
+
+    // Tracks that no longer resolve shift the index: the queue is saved
+    // again from what the player now holds
+    m_restoring = true;
+    player->refreshPlaylist(tracks, currentRow);
+    m_restoring = false;
+}
+
+// ========== Saving ==========
+
+void PlaybackSession::onPlaylistChanged()
+{
+    m_queueDirty = true;
+    if (!m_restoring) {
+        // A queue the user picked replaces the restored one
+        m_queuePending = false;
+        m_savedQueue.clear();
+        scheduleSave(kSaveDelayMs);
+    }
+}
+
+void PlaybackSession::scheduleSave(int delayMs)
+{
+    if (m_restoring) {
+        return;
+    }
+    // Never postpones a save that is already due sooner
+    if (!m_saveTimer->isActive() || m_saveTimer->remainingTime() > delayMs) {
+        m_saveTimer->start(delayMs);
+    }
+}
+
+void PlaybackSession::save()
+{
+    m_saveTimer->stop();
+    PlayerService *player = PlayerService::instance();
+
+    // Only the queue can be large; it is re-encoded when it changes
+    if (m_queueDirty) {
+        QStringList filePaths;
+        filePaths.reserve(player->playlist().size());
+        for (const Track &track : player->playlist()) {
+            filePaths.append(track.filePath());
+        }
+        m_queueData = encodeQueue(LibraryDatabase::instance()->trackIds(filePaths));
+        m_queueDirty = false;
+    }
+
+    // A queue still waiting for the library is saved as it was read
+    const qint32 index = m_queuePending ? m_savedIndex : player->playlistIndex();
+    const Track current = player->currentTrack();
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(kStreamVersion);
+    out << kMagic << kFormatVersion
+        << index << qint64(player->position())
+        << qint8(player->playbackMode()) << qint8(player->volume()) << player->isMuted();
+    out << current.filePath() << current.title() << current.artist() << current.album()
+        << current.albumArtPath() << (current.isVirtual() ? current.audioFilePath() : QString())
+        << current.duration() << current.startMs() << current.endMs() << current.fileSize();
+    data.append(m_queueData);
+
+    QSaveFile file(sessionFilePath());
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "PlaybackSession: cannot save" << file.fileName() << file.errorString();
+    }
+}
+
+QByteArray PlaybackSession::encodeQueue(const QList<qint64> &trackIds)
+{
+    QByteArray data;
+    QDataStream queue(&data, QIODevice::WriteOnly);
+    queue.setVersion(kStreamVersion);
+    queue << quint32(trackIds.size());
+    for (qint64 trackId : trackIds) {
+        queue << trackId;
+    }
+    return data;
+}
+
+QString PlaybackSession::sessionFilePath() const
+{
+    return MusicStorageService::instance()->metadataDirectory() + "/session.bin";
+}
@@ -0,0 +1,63 @@
+#ifndef PLAYBACKSESSION_H
+#define PLAYBACKSESSION_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QTimer>
+#include "models/track.h"
+
+/**
+ * @brief Player state saved across restarts (metadata/session.bin)
+ *
+ * Holds the queue as library track IDs (see LibraryDatabase), the current
+ * index and position, the playback mode and the volume. The current track
+ * is also stored in full, so restore() can hand it to PlayerService before
+ * the library has loaded: its file is mapped and opened by the backend
+ * paused at the saved position, and pressing play starts at once. The rest
+ * of the queue can be as large as the library, so it is only resolved and
+ * put back around the current track once the library has loaded; startup
+ * costs the same whatever its size.
+ *
+ * Saves are debounced: a second after the queue, track, mode or volume
+ * changed, every few seconds during playback, and on exit. Each save is a
+ * few hundred bytes plus the queue, which is only re-encoded when it
+ * changes, written through QSaveFile so a crash never leaves a torn file.
+ */
+class PlaybackSession : public QObject
+{
+    Q_OBJECT
+
+public:
+    static PlaybackSession* instance();
+
+    // Restore the last session into PlayerService; call once at startup
+    void restore();
+    // Write the session now
+    void save();
+
+private:
+    explicit PlaybackSession(QObject *parent = nullptr);
+    ~PlaybackSession();
+    PlaybackSession(const PlaybackSession&) = delete;
+    PlaybackSession& operator=(const PlaybackSession&) = delete;
+
+    static QByteArray encodeQueue(const QList<qint64> &trackIds);
+    void scheduleSave(int delayMs);
+    void onPlaylistChanged();
+    void onLibraryLoaded();
+    QString sessionFilePath() const;
+
+    static PlaybackSession *s_instance;
+
+    QTimer *m_saveTimer;
+    QByteArray m_queueData;  // Encoded track IDs of the current queue
+    bool m_queueDirty;
+    bool m_restoring;        // Don't save the half-restored state
+
+    // Saved queue waiting for the library; until then it is what gets saved
+    QList<qint64> m_savedQueue;
+    int m_savedIndex;
+    bool m_queuePending;
+};
+
+#endif // PLAYBACKSESSION_H
@@ -1,16 +1,31 @@
 #include "playerservice.h"
 #include "mediastatemanager.h"
-#include <QRandomGenerator>
+#include "seekindexcache.h"
+#include "utils/mappedfiledevice.h"
+#include "utils/metrics.h"
 #include <QStandardPaths>
 #include <QDir>
 
+namespace {
+// Paged in ahead of a seek target so the backend's first read doesn't wait
+// for the disk
+constexpr qint64 kSeekPrefetchBytes = 256 * 1024;
+// Position reports are a few dozen ms apart; a larger jump across the end
+// of a CUE track is a seek, not playback running into the next track
+constexpr qint64 kMaxPlaybackStepMs = 1000;
+}
+
 PlayerService* PlayerService::s_instance = nullptr;
 
 PlayerService::PlayerService(QObject *parent)
     : QObject(parent)
     , m_mediaPlayer(new QMediaPlayer(this))
     , m_audioOutput(new QAudioOutput(this))
-    , m_currentTrackIndex(-1)
+    , m_sourceDevice(nullptr)
+    , m_sourceOffsetMs(0)
+    , m_pendingSeekMs(-1)
+    , m_lastFilePositionMs(0)
+    , m_reopening(false)
     , m_playbackMode(Sequential)
 {
     m_mediaPlayer->setAudioOutput(m_audioOutput);
@@ -36,19 +51,69 @@ PlayerService* PlayerService::instance()
 
 void PlayerService::setupConnections()
 {
+    // Feed the clock first so slots of the forwarded signals already see
+    // the new position. Positions are of the track, not of the source:
+    // after an indexed seek the source starts m_sourceOffsetMs into the
+    // file, and a CUE track starts startMs() into it
     connect(m_mediaPlayer, &QMediaPlayer::playbackStateChanged,
-            this, &PlayerService::playbackStateChanged);
-    connect(m_mediaPlayer, &QMediaPlayer::positionChanged,
-            this, &PlayerService::positionChanged);
-    connect(m_mediaPlayer, &QMediaPlayer::durationChanged,
-            this, &PlayerService::durationChanged);
+            this, [this](QMediaPlayer::PlaybackState state) {
+        if (m_reopening) {
+            return;  // seek() restores the state right after
+        }
+        if (state == QMediaPlayer::PlayingState) {
+            if (m_startTimer.isValid()) {
+                EKNM_METRIC_RECORD(PlaybackStartNs, m_startTimer.nsecsElapsed());
+                m_startTimer.invalidate();
+            }
+            m_clock.setRunning(true);
+        } else {
+            m_clock.sync(position() * 1000, false);
+        }
+        emit playbackStateChanged(state);
+    });
+    connect(m_mediaPlayer, &QMediaPlayer::positionChanged, this, [this](qint64) {
+        const qint64 filePositionMs = filePosition();
+        const qint64 previousMs = m_lastFilePositionMs;
+        m_lastFilePositionMs = filePositionMs;
+        const qint64 endMs = m_currentTrack.endMs();
+        if (endMs > 0 && previousMs < endMs && filePositionMs >= endMs
+            && filePositionMs - previousMs < kMaxPlaybackStepMs) {
+            onSpanEnded();
+            return;
+        }
+        m_clock.report(position() * 1000);
+        emit positionChanged(position());
+    });
+    connect(m_mediaPlayer, &QMediaPlayer::durationChanged, this, [this](qint64) {
+        m_clock.setDuration(duration() * 1000);
+        emit durationChanged(duration());
+    });
+
+    // A frame scan finishing mid-track makes the next seek exact
+    connect(SeekIndexCache::instance(), &SeekIndexCache::indexReady,
+            this, [this](const QString &filePath) {
+        if (filePath == m_currentTrack.audioFilePath()) {
+            m_seekIndex = SeekIndexCache::instance()->index(filePath);
+        }
+    });
 
     // Auto-play next track when current track finishes
     connect(m_mediaPlayer, &QMediaPlayer::mediaStatusChanged,
             this, [this](QMediaPlayer::MediaStatus status) {
+        // Seeks asked for while the backend was loading (CUE track starts)
+        if (m_pendingSeekMs >= 0 && status != QMediaPlayer::LoadingMedia) {
+            const qint64 pendingMs = m_pendingSeekMs;
+            m_pendingSeekMs = -1;
+            if (status == QMediaPlayer::LoadedMedia || status == QMediaPlayer::BufferingMedia
+                || status == QMediaPlayer::BufferedMedia) {
+                m_mediaPlayer->setPosition(pendingMs - m_sourceOffsetMs);
+                m_lastFilePositionMs = pendingMs;
+            }
+        }
+
         if (status == QMediaPlayer::EndOfMedia) {
             if (m_playbackMode == RepeatOne) {
-                m_mediaPlayer->setPosition(0);
+                seek(0);
                 m_mediaPlayer->play();
             } else {
                 next();
@@ -62,6 +127,10 @@ void PlayerService::play()
     if (m_currentTrack.isValid()) {
         // Request playback from media state manager (will stop radio if active)
         MediaStateManager::instance()->requestPlayback(MediaStateManager::MediaSource::MusicPlayer);
+        // Resuming a paused or restored track should be near instant
+        if (!isPlaying()) {
+            m_startTimer.start();
+        }
         m_mediaPlayer->play();
     }
 }
@@ -75,6 +144,12 @@ void PlayerService::stop()
 {
     m_mediaPlayer->stop();
 
+    // Stopping rewinds to the start of the track, not of a seek's source
+    // or of the album file a CUE track is part of
+    if (m_sourceOffsetMs > 0 || m_currentTrack.startMs() > 0) {
+        seekFile(m_currentTrack.startMs());
+    }
+
     // Notify media state manager that music player stopped
     MediaStateManager::instance()->notifyStopped(MediaStateManager::MediaSource::MusicPlayer);
 }
@@ -90,20 +165,16 @@ void PlayerService::togglePlayPause()
 
 void PlayerService::next()
 {
-    if (m_playlist.isEmpty()) {
-        return;
-    }
-
-    int nextIndex = getNextTrackIndex();
-    if (nextIndex >= 0 && nextIndex < m_playlist.size()) {
-        m_currentTrackIndex = nextIndex;
-        playTrack(m_playlist[m_currentTrackIndex]);
+    int nextIndex = m_queue.nextIndex(m_playbackMode == Shuffle, m_playbackMode == RepeatAll);
+    if (nextIndex >= 0) {
+        m_queue.setCurrentIndex(nextIndex);
+        playTrack(m_queue.currentTrack());
     }
 }
 
 void PlayerService::previous()
 {
-    if (m_playlist.isEmpty()) {
+    if (m_queue.isEmpty()) {
         return;
     }
 
@@ -113,16 +184,65 @@ void PlayerService::previous()
         return;
     }
 
-    int prevIndex = getPreviousTrackIndex();
-    if (prevIndex >= 0 && prevIndex < m_playlist.size()) {
-        m_currentTrackIndex = prevIndex;
-        playTrack(m_playlist[m_currentTrackIndex]);
+    int prevIndex = m_queue.previousIndex(m_playbackMode == Shuffle, m_playbackMode == RepeatAll);
+    if (prevIndex >= 0) {
+        m_queue.setCurrentIndex(prevIndex);
+        playTrack(m_queue.currentTrack());
     }
 }
 
 void PlayerService::seek(qint64 position)
 {
-    m_mediaPlayer->setPosition(position);
+    seekFile(m_currentTrack.startMs() + qMax<qint64>(0, position));
+}
+
+void PlayerService::seekFile(qint64 fileMs)
+{
+    m_lastFilePositionMs = fileMs;
+
+    // Backends estimate MP3 seek targets from the bitrate or the coarse
+    // Xing TOC, which is far off in long VBR files. With a frame index the
+    // source is restarted at the exact frame instead
+    if (m_seekIndex && m_seekIndex->isFrameAccurate() && m_sourceFile) {
+        const SeekIndex::Point point = m_seekIndex->locate(fileMs * 1000, m_sourceFile);
+        const QMediaPlayer::PlaybackState state = m_mediaPlayer->playbackState();
+
+        m_reopening = true;
+        m_pendingSeekMs = -1;
+        if (fileMs == 0) {
+            openSource(0, 0);  // Whole file again, tags included
+        } else {
+            m_sourceFile->advise(MappedFile::Access::WillNeed, point.offset, kSeekPrefetchBytes);
+            openSource(point.offset, point.timeUs / 1000);
+        }
+        if (state == QMediaPlayer::PlayingState) {
+            m_mediaPlayer->play();
+        } else if (state == QMediaPlayer::PausedState) {
+            m_mediaPlayer->pause();
+        }
+        m_reopening = false;
+
+        m_clock.rebase(this->position() * 1000);
+        emit positionChanged(this->position());
+        return;
+    }
+
+    // Other formats seek accurately in the backend (FLAC SEEKTABLE, MP4
+    // sample tables); the index only gets the target's pages read in
+    if (m_seekIndex && m_sourceFile) {
+        const SeekIndex::Point point = m_seekIndex->locate(fileMs * 1000);
+        m_sourceFile->advise(MappedFile::Access::WillNeed, point.offset, kSeekPrefetchBytes);
+    }
+    // A source that is still loading can't seek yet; mediaStatusChanged
+    // applies the position once it can
+    const QMediaPlayer::MediaStatus status = m_mediaPlayer->mediaStatus();
+    if (status == QMediaPlayer::LoadingMedia || status == QMediaPlayer::NoMedia) {
+        m_pendingSeekMs = fileMs;
+    } else {
+        m_pendingSeekMs = -1;
+        m_mediaPlayer->setPosition(fileMs - m_sourceOffsetMs);
+    }
+    m_clock.rebase(position() * 1000);
 }
 
 void PlayerService::setVolume(int volume)
@@ -154,110 +274,194 @@ void PlayerService::playTrack(const Track &track)
         return;
     }
 
+    // Another track of the album file being played: the decoder stays,
+    // only the position moves
+    const bool sameSource = track.isVirtual() && m_sourceFile
+                         && track.audioFilePath() == m_currentTrack.audioFilePath();
+
     m_currentTrack = track;
-    m_mediaPlayer->setSource(track.fileUrl());
+    m_clock.sync(0, false);
+    m_clock.setDuration(track.duration() * 1000);
+
+    // Stream from the shared mapping (the one the tag reader used), so the
+    // file is not opened and buffered a second time
+    if (!sameSource) {
+        m_sourceFile = MappedFile::open(track.audioFilePath());
+        m_seekIndex = SeekIndexCache::instance()->index(track.audioFilePath());
+        m_pendingSeekMs = -1;
+        openSource(0, 0);
+    }
     m_mediaPlayer->play();
+    if (sameSource || track.startMs() > 0) {
+        seekFile(track.startMs());
+    }
     emit trackChanged(track);
+    if (sameSource) {
+        emit durationChanged(duration());
+    }
+}
+
+void PlayerService::onSpanEnded()
+{
+    if (m_playbackMode == RepeatOne) {
+        seek(0);
+        return;
+    }
+
+    const int nextIndex = m_queue.nextIndex(m_playbackMode == Shuffle, m_playbackMode == RepeatAll);
+    if (nextIndex < 0) {
+        stop();
+        return;
+    }
+    m_queue.setCurrentIndex(nextIndex);
+    const Track next = m_queue.currentTrack();
+
+    // The next track of the album plays on from here: same source, no
+    // seek, no gap; only what the track is called changes
+    if (next.isVirtual() && next.audioFilePath() == m_currentTrack.audioFilePath()
+        && next.startMs() == m_currentTrack.endMs()) {
+        m_currentTrack = next;
+        m_clock.setDuration(next.duration() * 1000);
+        m_clock.rebase(position() * 1000);
+        emit trackChanged(next);
+        emit durationChanged(duration());
+        emit positionChanged(position());
+        return;
+    }
+    playTrack(next);
+}
+
+void PlayerService::openSource(qint64 offset, qint64 offsetMs)
+{
+    QIODevice *previousDevice = m_sourceDevice;
+    m_sourceDevice = nullptr;
+    if (m_sourceFile) {
+        MappedFileDevice *device = new MappedFileDevice(m_sourceFile, offset, this);
+        if (device->isOpen()) {
+            m_sourceDevice = device;
+        } else {
+            delete device;
+        }
+    }
+
+    // The backend still gets the URL, for format detection
+    m_sourceOffsetMs = m_sourceDevice ? offsetMs : 0;
+    m_lastFilePositionMs = m_sourceOffsetMs;
+    if (m_sourceDevice) {
+        m_mediaPlayer->setSourceDevice(m_sourceDevice, m_currentTrack.fileUrl());
+    } else {
+        m_mediaPlayer->setSource(m_currentTrack.fileUrl());
+    }
+    // The player has let go of the old device now
+    if (previousDevice) {
+        previousDevice->deleteLater();
+    }
 }
 
-void PlayerService::setPlaylist(const QList<Track> &tracks)
+void PlayerService::setPlaylist(const QList<Track> &tracks, int startIndex)
 {
-    m_playlist = tracks;
-    m_currentTrackIndex = -1;
+    m_queue.setTracks(tracks, startIndex);
+    emit playlistChanged();
 
-    if (!m_playlist.isEmpty()) {
-        m_currentTrackIndex = 0;
-        playTrack(m_playlist[0]);
+    if (!m_queue.isEmpty()) {
+        playTrack(m_queue.currentTrack());
     }
 }
 
 void PlayerService::addToPlaylist(const Track &track)
 {
-    m_playlist.append(track);
+    m_queue.append(track);
+    emit playlistChanged();
 }
 
 void PlayerService::clearPlaylist()
 {
-    m_playlist.clear();
-    m_currentTrackIndex = -1;
+    m_queue.clear();
     stop();
+    emit playlistChanged();
 }
 
-QMediaPlayer::PlaybackState PlayerService::playbackState() const
+void PlayerService::restoreSession(const QList<Track> &tracks, int index, qint64 position)
 {
-    return m_mediaPlayer->playbackState();
+    m_queue.setTracks(tracks, index);
+    emit playlistChanged();
+
+    const Track track = m_queue.currentTrack();
+    if (!track.isValid()) {
+        return;
+    }
+
+    // What playTrack() does, minus play(): the file is mapped, the backend
+    // loads it and the pages under the resume point are read ahead now
+    m_currentTrack = track;
+    m_sourceFile = MappedFile::open(track.audioFilePath());
+    m_seekIndex = SeekIndexCache::instance()->index(track.audioFilePath());
+    m_pendingSeekMs = -1;
+    openSource(0, 0);
+    if (position > 0 || track.startMs() > 0) {
+        seekFile(track.startMs() + position);
+    }
+
+    m_clock.sync(this->position() * 1000, false);
+    m_clock.setDuration(track.duration() * 1000);
+    emit trackChanged(track);
+    emit positionChanged(this->position());
 }
 
-qint64 PlayerService::position() const
+void PlayerService::refreshPlaylist(const QList<Track> &tracks, int index)
 {
-    return m_mediaPlayer->position();
+    if (index < 0 || index >= tracks.size()
+        || tracks.at(index).filePath() != m_queue.currentTrack().filePath()) {
+        return;
+    }
+    m_queue.setTracks(tracks, index);
+    emit playlistChanged();
 }
 
-qint64 PlayerService::duration() const
+QMediaPlayer::PlaybackState PlayerService::playbackState() const
 {
-    return m_mediaPlayer->duration();
+    return m_mediaPlayer->playbackState();
 }
 
-bool PlayerService::isPlaying() const
+qint64 PlayerService::position() const
 {
-    return m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState;
+    return qMax<qint64>(0, filePosition() - m_currentTrack.startMs());
 }
 
-void PlayerService::setPlaybackMode(PlaybackMode mode)
+qint64 PlayerService::duration() const
 {
-    m_playbackMode = mode;
-    emit playbackModeChanged(mode);
+    if (m_currentTrack.isVirtual()) {
+        const qint64 endMs = m_currentTrack.endMs() > 0 ? m_currentTrack.endMs() : fileDuration();
+        return qMax<qint64>(0, endMs - m_currentTrack.startMs());
+    }
+    return fileDuration();
 }
 
-int PlayerService::getNextTrackIndex()
+qint64 PlayerService::filePosition() const
 {
-    if (m_playlist.isEmpty()) {
-        return -1;
+    // Until a pending seek is applied, it is where playback will start
+    if (m_pendingSeekMs >= 0) {
+        return m_pendingSeekMs;
     }
+    return m_sourceOffsetMs + m_mediaPlayer->position();
+}
 
-    if (m_playbackMode == Shuffle) {
-        // Random track (avoid playing the same track)
-        int randomIndex = QRandomGenerator::global()->bounded(m_playlist.size());
-        if (m_playlist.size() > 1) {
-            while (randomIndex == m_currentTrackIndex) {
-                randomIndex = QRandomGenerator::global()->bounded(m_playlist.size());
-            }
-        }
-        return randomIndex;
-    } else {
-        // Sequential or repeat
-        int nextIndex = m_currentTrackIndex + 1;
-        if (nextIndex >= m_playlist.size()) {
-            if (m_playbackMode == RepeatAll) {
-                return 0; // Loop to beginning
-            }
-            return -1; // End of playlist
-        }
-        return nextIndex;
+qint64 PlayerService::fileDuration() const
+{
+    // A frame scan counts every frame; the backend may only estimate
+    if (m_seekIndex && m_seekIndex->isFrameAccurate()) {
+        return m_seekIndex->durationUs() / 1000;
     }
+    return m_sourceOffsetMs + m_mediaPlayer->duration();
 }
 
-int PlayerService::getPreviousTrackIndex()
+bool PlayerService::isPlaying() const
 {
-    if (m_playlist.isEmpty()) {
-        return -1;
-    }
+    return m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState;
+}
 
-    if (m_playbackMode == Shuffle) {
-        // For simplicity, just go to previous in list
-        int prevIndex = m_currentTrackIndex - 1;
-        if (prevIndex < 0) {
-            return m_playlist.size() - 1;
-        }
-        return prevIndex;
-    } else {
-        int prevIndex = m_currentTrackIndex - 1;
-        if (prevIndex < 0) {
-            if (m_playbackMode == RepeatAll) {
-                return m_playlist.size() - 1; // Loop to end
-            }
-            return 0; // Stay at beginning
-        }
-        return prevIndex;
-    }
+void PlayerService::setPlaybackMode(PlaybackMode mode)
+{
+    m_playbackMode = mode;
+    emit playbackModeChanged(mode);
 }
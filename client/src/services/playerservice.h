@@ -5,7 +5,14 @@
 #include <QMediaPlayer>
 #include <QAudioOutput>
 #include <QList>
+#include <QElapsedTimer>
 #include "models/track.h"
+#include "models/playqueue.h"
+#include "mediaclock.h"
+#include "seekindex.h"
+#include "utils/mappedfile.h"
+
+class QIODevice;
 
 class PlayerService : public QObject
 {
@@ -38,9 +45,20 @@ public:
 
     // Track management
     void playTrack(const Track &track);
-    void setPlaylist(const QList<Track> &tracks);
+    // Replace the playlist and start playing the track at startIndex
+    void setPlaylist(const QList<Track> &tracks, int startIndex = 0);
     void addToPlaylist(const Track &track);
     void clearPlaylist();
+    const QList<Track> &playlist() const { return m_queue.tracks(); }
+    int playlistIndex() const { return m_queue.currentIndex(); }
+
+    // Put a saved session back: the queue, with the track at index opened,
+    // positioned and paused, so play() starts without loading anything
+    void restoreSession(const QList<Track> &tracks, int index, qint64 position);
+    // Replace the queue around the current track without touching
+    // playback (e.g. a restored queue once the library has loaded); the
+    // current track must be at index in tracks
+    void refreshPlaylist(const QList<Track> &tracks, int index);
 
     // State getters
     Track currentTrack() const { return m_currentTrack; }
@@ -49,6 +67,10 @@ public:
     qint64 duration() const;
     bool isPlaying() const;
 
+    // Smooth position for readers on any thread (interpolated between
+    // QMediaPlayer reports); position() is the last raw report
+    const MediaClock& clock() const { return m_clock; }
+
     // Playback mode
     void setPlaybackMode(PlaybackMode mode);
     PlaybackMode playbackMode() const { return m_playbackMode; }
@@ -61,6 +83,7 @@ signals:
     void volumeChanged(int volume);
     void mutedChanged(bool muted);
     void playbackModeChanged(PlaybackMode mode);
+    void playlistChanged();
 
 private:
     explicit PlayerService(QObject *parent = nullptr);
@@ -69,17 +92,32 @@ private:
     PlayerService& operator=(const PlayerService&) = delete;
 
     void setupConnections();
-    int getNextTrackIndex();
-    int getPreviousTrackIndex();
+    // Make the current track's file the player's source, from byte offset
+    // on (offsetMs into the file)
+    void openSource(qint64 offset, qint64 offsetMs);
+    // Positions in the audio file; a CUE track is a span of it
+    void seekFile(qint64 fileMs);
+    qint64 filePosition() const;
+    qint64 fileDuration() const;
+    // Playback crossed the end of the current CUE track
+    void onSpanEnded();
 
     static PlayerService *s_instance;
 
     QMediaPlayer *m_mediaPlayer;
     QAudioOutput *m_audioOutput;
+    QIODevice *m_sourceDevice;  // Mapping of the current file, if playing from one
+    MappedFilePtr m_sourceFile;
+    SeekIndexPtr m_seekIndex;   // Of the current track, nullptr if none (yet)
+    qint64 m_sourceOffsetMs;    // File time at which the source starts
+    qint64 m_pendingSeekMs;     // File time to seek to once loaded, -1 if none
+    qint64 m_lastFilePositionMs; // Last position seen, to catch CUE track ends
+    bool m_reopening;           // seek() is switching sources
+    QElapsedTimer m_startTimer; // play() until the backend is playing
     Track m_currentTrack;
-    QList<Track> m_playlist;
-    int m_currentTrackIndex;
+    PlayQueue m_queue;
     PlaybackMode m_playbackMode;
+    MediaClock m_clock;
 };
 
 #endif // PLAYERSERVICE_H
@@ -0,0 +1,444 @@
+#include "playlistservice.h"
+#include "librarydatabase.h"
+#include "musicstorageservice.h"
+#include "utils/rankkey.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+
+namespace {
+constexpr int kUserPlaylist = 0;
+constexpr int kLikedPlaylist = 1;
+const char *const kLikedName = "Liked Songs";
+}
+
+PlaylistService* PlaylistService::s_instance = nullptr;
+
+PlaylistService::PlaylistService(QObject *parent)
+    : QObject(parent)
+    , m_likedId(0)
+{
+    loadPlaylists();
+
+    // Entries of tracks the user deletes go with the file
+    connect(MusicStorageService::instance(), &MusicStorageService::trackDeleted,
+            this, &PlaylistService::onTrackDeleted);
+}
+
+PlaylistService::~PlaylistService()
+{
+}
+
+PlaylistService* PlaylistService::instance()
+{
+    if (!s_instance) {
+        s_instance = new PlaylistService(qApp);
+    }
+    return s_instance;
+}
+
+// ========== Playlists ==========
+
+void PlaylistService::loadPlaylists()
+{
+    LibraryDatabase *library = LibraryDatabase::instance();
+    if (!library->isOpen()) {
+        return;
+    }
+
+    QSqlQuery query(library->database());
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT id, name, kind FROM playlists ORDER BY id")) {
+        qWarning() << "PlaylistService: cannot read playlists:" << query.lastError().text();
+        return;
+    }
+    while (query.next()) {
+        PlaylistInfo info;
+        info.id = query.value(0).toLongLong();
+        info.name = query.value(1).toString();
+        info.isLiked = query.value(2).toInt() == kLikedPlaylist;
+        m_playlists.insert(info.id, info);
+        if (info.isLiked && m_likedId == 0) {
+            m_likedId = info.id;
+        }
+    }
+
+    // Counts come from the membership index, no row is read
+    if (query.exec("SELECT playlist_id, COUNT(*) FROM playlist_entries GROUP BY playlist_id")) {
+        while (query.next()) {
+            auto it = m_playlists.find(query.value(0).toLongLong());
+            if (it != m_playlists.end()) {
+                it->trackCount = query.value(1).toInt();
+            }
+        }
+    }
+
+    if (m_likedId == 0) {
+        m_likedId = insertPlaylist(kLikedName, true);
+    }
+}
+
+qint64 PlaylistService::insertPlaylist(const QString &name, bool liked)
+{
+    LibraryDatabase *library = LibraryDatabase::instance();
+    if (!library->isOpen()) {
+        return 0;
+    }
+
+    QSqlQuery query(library->database());
+    query.prepare("INSERT INTO playlists (name, kind, created_at) VALUES (?, ?, ?)");
+    query.addBindValue(name);
+    query.addBindValue(liked ? kLikedPlaylist : kUserPlaylist);
+    query.addBindValue(QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    if (!query.exec()) {
+        qWarning() << "PlaylistService: cannot create playlist" << name << query.lastError().text();
+        return 0;
+    }
+
+    PlaylistInfo info;
+    info.id = query.lastInsertId().toLongLong();
+    info.name = name;
+    info.isLiked = liked;
+    m_playlists.insert(info.id, info);
+    m_members.insert(info.id, QSet<qint64>());
+    return info.id;
+}
+
+QList<PlaylistInfo> PlaylistService::playlists() const
+{
+    QList<PlaylistInfo> result;
+    result.reserve(m_playlists.size());
+    if (m_playlists.contains(m_likedId)) {
+        result.append(m_playlists.value(m_likedId));
+    }
+    for (const PlaylistInfo &info : m_playlists) {
+        if (info.id != m_likedId) {
+            result.append(info);
+        }
+    }
+    return result;
+}
+
+qint64 PlaylistService::createPlaylist(const QString &name)
+{
+    const QString trimmed = name.trimmed();
+    if (trimmed.isEmpty()) {
+        return 0;
+    }
+
+    const qint64 playlistId = insertPlaylist(trimmed, false);
+    if (playlistId != 0) {
+        emit playlistsChanged();
+    }
+    return playlistId;
+}
+
+bool PlaylistService::renamePlaylist(qint64 playlistId, const QString &name)
+{
+    const QString trimmed = name.trimmed();
+    auto it = m_playlists.find(playlistId);
+    if (it == m_playlists.end() || it->isLiked || trimmed.isEmpty()) {
+        return false;
+    }
+
+    QSqlQuery query(LibraryDatabase::instance()->database());
+    query.prepare("UPDATE playlists SET name = ? WHERE id = ?");
+    query.addBindValue(trimmed);
+    query.addBindValue(playlistId);
+    if (!query.exec()) {
+        qWarning() << "PlaylistService: cannot rename playlist" << playlistId << query.lastError().text();
+        return false;
+    }
+
+    it->name = trimmed;
+    emit playlistsChanged();
+    return true;
+}
+
+bool PlaylistService::deletePlaylist(qint64 playlistId)
+{
+    if (!m_playlists.contains(playlistId) || playlistId == m_likedId) {
+        return false;
+    }
+
+    // Entries go with it (ON DELETE CASCADE)
+    QSqlQuery query(LibraryDatabase::instance()->database());
+    query.prepare("DELETE FROM playlists WHERE id = ?");
+    query.addBindValue(playlistId);
+    if (!query.exec()) {
+        qWarning() << "PlaylistService: cannot delete playlist" << playlistId << query.lastError().text();
+        return false;
+    }
+
+    m_playlists.remove(playlistId);
+    m_members.remove(playlistId);
+    emit playlistsChanged();
+    return true;
+}
+
+// ========== Membership ==========
+
+const QSet<qint64>& PlaylistService::members(qint64 playlistId) const
+{
+    auto it = m_members.find(playlistId);
+    if (it != m_members.end()) {
+        return it.value();
+    }
+
+    // One primary key range scan, then every test is a hash lookup
+    QSet<qint64> &set = m_members[playlistId];
+    set.reserve(m_playlists.value(playlistId).trackCount);
+
+    QSqlQuery query(LibraryDatabase::instance()->database());
+    query.setForwardOnly(true);
+    query.prepare("SELECT track_id FROM playlist_entries WHERE playlist_id = ?");
+    query.addBindValue(playlistId);
+    if (query.exec()) {
+        while (query.next()) {
+            set.insert(query.value(0).toLongLong());
+        }
+    } else {
+        qWarning() << "PlaylistService: cannot read playlist" << playlistId << query.lastError().text();
+    }
+    return set;
+}
+
+bool PlaylistService::contains(qint64 playlistId, const QString &filePath) const
+{
+    const qint64 trackId = LibraryDatabase::instance()->findTrackId(filePath);
+    return trackId != 0 && m_playlists.contains(playlistId) && members(playlistId).contains(trackId);
+}
+
+// ========== Ranks ==========
+
+QByteArray PlaylistService::entryRank(qint64 playlistId, qint64 trackId) const
+{
+    QSqlQuery query(LibraryDatabase::instance()->database());
+    query.prepare("SELECT rank FROM playlist_entries WHERE playlist_id = ? AND track_id = ?");
+    query.addBindValue(playlistId);
+    query.addBindValue(trackId);
+    return query.exec() && query.next() ? query.value(0).toString().toLatin1() : QByteArray();
+}
+
+QByteArray PlaylistService::lastRank(qint64 playlistId) const
+{
+    QSqlQuery query(LibraryDatabase::instance()->database());
+    query.prepare("SELECT rank FROM playlist_entries WHERE playlist_id = ? ORDER BY rank DESC LIMIT 1");
+    query.addBindValue(playlistId);
+    return query.exec() && query.next() ? query.value(0).toString().toLatin1() : QByteArray();
+}
+
+QByteArray PlaylistService::rankBefore(qint64 playlistId, const QByteArray &rank) const
+{
+    QSqlQuery query(LibraryDatabase::instance()->database());
+    query.prepare("SELECT rank FROM playlist_entries WHERE playlist_id = ? AND rank < ?"
+                  " ORDER BY rank DESC LIMIT 1");
+    query.addBindValue(playlistId);
+    query.addBindValue(QString::fromLatin1(rank));
+    return query.exec() && query.next() ? query.value(0).toString().toLatin1() : QByteArray();
+}
+
+// ========== Editing ==========
+
+bool PlaylistService::addTrack(qint64 playlistId, const QString &filePath)
+{
+    if (!m_playlists.contains(playlistId) || filePath.isEmpty()) {
+        return false;
+    }
+
+    LibraryDatabase *library = LibraryDatabase::instance();
+    const qint64 trackId = library->trackId(filePath);
+    if (trackId == 0) {
+        return false;
+    }
+    if (members(playlistId).contains(trackId)) {
+        return true;
+    }
+
+    const QByteArray rank = RankKey::after(lastRank(playlistId));
+    QSqlQuery query(library->database());
+    query.prepare("INSERT INTO playlist_entries (playlist_id, track_id, rank) VALUES (?, ?, ?)");
+    query.addBindValue(playlistId);
+    query.addBindValue(trackId);
+    query.addBindValue(QString::fromLatin1(rank));
+    if (rank.isEmpty() || !query.exec()) {
+        qWarning() << "PlaylistService: cannot add" << filePath << "to playlist" << playlistId
+                   << query.lastError().text();
+        return false;
+    }
+
+    m_members[playlistId].insert(trackId);
+    ++m_playlists[playlistId].trackCount;
+    emit membershipChanged(playlistId, filePath, true);
+    emit playlistChanged(playlistId);
+    return true;
+}
+
+bool PlaylistService::removeTrack(qint64 playlistId, const QString &filePath)
+{
+    const qint64 trackId = LibraryDatabase::instance()->findTrackId(filePath);
+    if (trackId == 0 || !m_playlists.contains(playlistId) || !members(playlistId).contains(trackId)) {
+        return false;
+    }
+
+    QSqlQuery query(LibraryDatabase::instance()->database());
+    query.prepare("DELETE FROM playlist_entries WHERE playlist_id = ? AND track_id = ?");
+    query.addBindValue(playlistId);
+    query.addBindValue(trackId);
+    if (!query.exec()) {
+        qWarning() << "PlaylistService: cannot remove" << filePath << "from playlist" << playlistId
+                   << query.lastError().text();
+        return false;
+    }
+
+    m_members[playlistId].remove(trackId);
+    --m_playlists[playlistId].trackCount;
+    emit membershipChanged(playlistId, filePath, false);
+    emit playlistChanged(playlistId);
+    return true;
+}
+
+bool PlaylistService::moveTrack(qint64 playlistId, const QString &filePath, const QString &beforeFilePath)
+{
+    LibraryDatabase *library = LibraryDatabase::instance();
+    const qint64 trackId = library->findTrackId(filePath);
+    if (trackId == 0 || !m_playlists.contains(playlistId) || !members(playlistId).contains(trackId)) {
+        return false;
+    }
+
+    // New rank between the target neighbours; the other entries keep theirs
+    const QByteArray current = entryRank(playlistId, trackId);
+    QByteArray lower;
+    QByteArray upper;
+    if (beforeFilePath.isEmpty()) {
+        lower = lastRank(playlistId);
+    } else {
+        const qint64 beforeId = library->findTrackId(beforeFilePath);
+        if (beforeId == 0 || beforeId == trackId || !members(playlistId).contains(beforeId)) {
+            return false;
+        }
+        upper = entryRank(playlistId, beforeId);
+        lower = rankBefore(playlistId, upper);
+    }
+    if (lower == current) {
+        return true;  // Already there
+    }
+
+    const QByteArray rank = RankKey::between(lower, upper);
+    if (rank.isEmpty()) {
+        return false;
+    }
+
+    QSqlQuery query(library->database());
+    query.prepare("UPDATE playlist_entries SET rank = ? WHERE playlist_id = ? AND track_id = ?");
+    query.addBindValue(QString::fromLatin1(rank));
+    query.addBindValue(playlistId);
+    query.addBindValue(trackId);
+    if (!query.exec()) {
+        qWarning() << "PlaylistService: cannot move" << filePath << "in playlist" << playlistId
+                   << query.lastError().text();
+        return false;
+    }
+
+    emit playlistChanged(playlistId);
+    return true;
+}
+
+bool PlaylistService::setLiked(const QString &filePath, bool liked)
+{
+    if (liked) {
+        return addTrack(m_likedId, filePath);
+    }
+    return removeTrack(m_likedId, filePath) || !isLiked(filePath);
+}
+
+// ========== Contents ==========
+
+QStringList PlaylistService::filePaths(qint64 playlistId) const
+{
+    QStringList result;
+    if (!m_playlists.contains(playlistId)) {
+        return result;
+    }
+
+    // Walks the (playlist_id, rank) index: already in order, no sort
+    LibraryDatabase *library = LibraryDatabase::instance();
+    QSqlQuery query(library->database());
+    query.setForwardOnly(true);
+    query.prepare("SELECT track_id FROM playlist_entries WHERE playlist_id = ? ORDER BY rank");
+    query.addBindValue(playlistId);
+    if (!query.exec()) {
+        qWarning() << "PlaylistService: cannot list playlist" << playlistId << query.lastError().text();
+        return result;
+    }
+
+    result.reserve(m_playlists.value(playlistId).trackCount);
+    while (query.next()) {
+        const QString filePath = library->trackPath(query.value(0).toLongLong());
+        if (!filePath.isEmpty()) {
+            result.append(filePath);
+        }
+    }
+    return result;
+}
+
+QList<Track> PlaylistService::tracks(qint64 playlistId) const
+{
+    MusicStorageService *storage = MusicStorageService::instance();
+    const QStringList paths = filePaths(playlistId);
+
+    QList<Track> result;
+    result.reserve(paths.size());
+    for (const QString &filePath : paths) {
+        const Track track = storage->findTrack(filePath);
+        if (track.isValid()) {
+            result.append(track);
+        }
+    }
+    return result;
+}
+
+void PlaylistService::onTrackDeleted(const QString &filePath)
+{
+    LibraryDatabase *library = LibraryDatabase::instance();
+    const qint64 trackId = library->findTrackId(filePath);
+    if (trackId == 0) {
+        return;
+    }
+
+    // Both statements use the track_id index
+    QSqlQuery query(library->database());
+    query.prepare("SELECT playlist_id FROM playlist_entries WHERE track_id = ?");
+    query.addBindValue(trackId);
+    QList<qint64> affected;
+    if (query.exec()) {
+        while (query.next()) {
+            affected.append(query.value(0).toLongLong());
+        }
+    }
+    if (affected.isEmpty()) {
+        return;
+    }
+
+    query.prepare("DELETE FROM playlist_entries WHERE track_id = ?");
+    query.addBindValue(trackId);
+    if (!query.exec()) {
+        qWarning() << "PlaylistService: cannot drop entries of" << filePath << query.lastError().text();
+        return;
+    }
+
+    for (qint64 playlistId : std::as_const(affected)) {
+        auto members = m_members.find(playlistId);
+        if (members != m_members.end()) {
+            members->remove(trackId);
+        }
+        auto info = m_playlists.find(playlistId);
+        if (info != m_playlists.end()) {
+            --info->trackCount;
+        }
+        emit membershipChanged(playlistId, filePath, false);
+        emit playlistChanged(playlistId);
+    }
+}
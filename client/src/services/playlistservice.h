@@ -0,0 +1,96 @@
+#ifndef PLAYLISTSERVICE_H
+#define PLAYLISTSERVICE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include "models/track.h"
+
+struct PlaylistInfo
+{
+    qint64 id = 0;
+    QString name;
+    bool isLiked = false;
+    int trackCount = 0;
+
+    bool isValid() const { return id != 0; }
+};
+
+/**
+ * @brief User playlists, including Liked Songs, stored in the library database
+ *
+ * A playlist is an ordered list of track IDs (see LibraryDatabase); a
+ * track appears at most once per playlist. Order uses the same RankKey
+ * scheme as the downloads list, so adding, removing and moving a track are
+ * each a few indexed statements, independent of playlist size.
+ *
+ * Membership of a playlist is loaded into a set the first time it is
+ * asked about and then kept in step with every edit, so views can call
+ * contains() / isLiked() per row while painting.
+ */
+class PlaylistService : public QObject
+{
+    Q_OBJECT
+
+public:
+    static PlaylistService* instance();
+
+    // Liked Songs first, then user playlists in creation order
+    QList<PlaylistInfo> playlists() const;
+    PlaylistInfo playlist(qint64 playlistId) const { return m_playlists.value(playlistId); }
+    qint64 likedPlaylistId() const { return m_likedId; }
+
+    qint64 createPlaylist(const QString &name);
+    bool renamePlaylist(qint64 playlistId, const QString &name);
+    // Liked Songs cannot be deleted
+    bool deletePlaylist(qint64 playlistId);
+
+    // Membership, O(1) once the playlist's set is loaded
+    bool contains(qint64 playlistId, const QString &filePath) const;
+    bool isLiked(const QString &filePath) const { return contains(m_likedId, filePath); }
+
+    // Editing; adding a track that is already in the playlist does nothing
+    bool addTrack(qint64 playlistId, const QString &filePath);
+    bool removeTrack(qint64 playlistId, const QString &filePath);
+    // Move filePath in front of beforeFilePath (empty = to the end)
+    bool moveTrack(qint64 playlistId, const QString &filePath, const QString &beforeFilePath);
+    bool setLiked(const QString &filePath, bool liked);
+
+    // Contents in playlist order; tracks() skips files not in the library
+    QStringList filePaths(qint64 playlistId) const;
+    QList<Track> tracks(qint64 playlistId) const;
+
+signals:
+    void playlistsChanged();
+    // Contents or order of one playlist changed
+    void playlistChanged(qint64 playlistId);
+    void membershipChanged(qint64 playlistId, const QString &filePath, bool member);
+
+private slots:
+    void onTrackDeleted(const QString &filePath);
+
+private:
+    explicit PlaylistService(QObject *parent = nullptr);
+    ~PlaylistService();
+    PlaylistService(const PlaylistService&) = delete;
+    PlaylistService& operator=(const PlaylistService&) = delete;
+
+    void loadPlaylists();
+    qint64 insertPlaylist(const QString &name, bool liked);
+    const QSet<qint64>& members(qint64 playlistId) const;
+    QByteArray entryRank(qint64 playlistId, qint64 trackId) const;
+    QByteArray lastRank(qint64 playlistId) const;
+    QByteArray rankBefore(qint64 playlistId, const QByteArray &rank) const;
+
+    static PlaylistService *s_instance;
+
+    QMap<qint64, PlaylistInfo> m_playlists;           // By ID, i.e. creation order
+    mutable QHash<qint64, QSet<qint64>> m_members;    // Playlist ID -> track IDs, loaded on demand
+    qint64 m_likedId;
+};
+
+#endif // PLAYLISTSERVICE_H
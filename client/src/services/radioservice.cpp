@@ -1,30 +1,39 @@
 #include "radioservice.h"
+#include "nowplayingparser.h"
+#include "stationregistry.h"
 #include "config/appconfig.h"
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QJsonValue>
+#include "utils/metrics.h"
+#include "utils/networkfuture.h"
 #include <QDebug>
 #include <QUrl>
 
-RadioService* RadioService::s_instance = nullptr;
+namespace {
+// Server elapsed time is whole seconds; smaller disagreements are rounding
+constexpr qint64 kServerElapsedToleranceUs = 1500000;
+}
+
+QHash<QString, RadioService*> RadioService::s_instances;
 
-RadioService::RadioService(QObject *parent)
+RadioService::RadioService(const RadioStation &station, QObject *parent)
     : QObject(parent)
     , m_networkManager(new QNetworkAccessManager(this))
-    , m_mediaPlayer(new QMediaPlayer(this))
-    , m_audioOutput(new QAudioOutput(this))
+    , m_nowPlayingFeed(NowPlayingFeed::forHost(station.baseUrl))
+    , m_streamClient(new RadioStreamClient(m_networkManager, this))
+    , m_station(station)
 {
     // Load configuration
-    m_baseUrl = "https://radio.eknm.in";
-    m_stationId = "eknm_intercom";
-    m_streamUrl = "https://radio.eknm.in/listen/eknm_intercom/radio.mp3";
+    m_baseUrl = station.baseUrl;
+    m_stationId = station.id;
+    m_streamUrl = station.streamUrl;
 
     // Load API key from config (will be stored securely)
     m_apiKey = AppConfig::instance()->getRadioApiKey();
 
-    // Setup media player
-    m_mediaPlayer->setAudioOutput(m_audioOutput);
-    m_audioOutput->setVolume(0.75); // Default 75% volume
+    // Setup stream client
+    m_streamClient->setStreamUrl(m_streamUrl);
+    m_streamClient->setBufferTargetMs(AppConfig::instance()->getRadioBufferMs());
+    m_streamClient->setLockMemory(AppConfig::instance()->getRadioLockMemory());
+    m_streamClient->setVolume(0.75f); // Default 75% volume
 
     setupConnections();
 
@@ -41,23 +50,62 @@ RadioService::~RadioService()
 
 RadioService* RadioService::instance()
 {
-    if (!s_instance) {
-        s_instance = new RadioService();
+    return forStation(StationRegistry::instance()->defaultStationId());
+}
+
+RadioService* RadioService::forStation(const QString &stationId)
+{
+    RadioService *service = s_instances.value(stationId);
+    if (service) {
+        return service;
     }
-    return s_instance;
+
+    RadioStation station = StationRegistry::instance()->station(stationId);
+    if (!station.isValid()) {
+        qWarning() << "Unknown radio station:" << stationId;
+        return nullptr;
+    }
+
+    service = new RadioService(station);
+    s_instances.insert(stationId, service);
+    return service;
 }
 
 void RadioService::setupConnections()
 {
-    // Media player connections
-    connect(m_mediaPlayer, &QMediaPlayer::playbackStateChanged, this, [this](QMediaPlayer::PlaybackState state) {
-        emit playbackStateChanged(state == QMediaPlayer::PlayingState);
-    });
+    // Stream client connections
+    connect(m_streamClient, &RadioStreamClient::playingChanged,
+            this, &RadioService::playbackStateChanged);
 
-    connect(m_mediaPlayer, &QMediaPlayer::errorOccurred, this, [this](QMediaPlayer::Error error, const QString &errorString) {
-        qWarning() << "Media player error:" << errorString;
+    connect(m_streamClient, &RadioStreamClient::errorOccurred, this, [this](const QString &errorString) {
+        qWarning() << "Radio stream error:" << errorString;
         emit errorOccurred(errorString);
     });
+
+    connect(m_streamClient, &RadioStreamClient::statsChanged,
+            this, &RadioService::streamStatsChanged);
+
+    connect(m_streamClient, &RadioStreamClient::streamTitleChanged, this, [this](const QString &title) {
+        emit streamTitleChanged(title);
+
+        // The stream announces song changes first; pull the full metadata now
+        // unless the live feed is about to push it anyway
+        if (!isReceivingLiveUpdates()) {
+            if (m_nowPlayingFeed->isSubscribed(m_stationId)) {
+                m_nowPlayingFeed->refreshNow();
+            } else {
+                refreshState();
+            }
+        }
+    });
+
+    // Now playing pushes from the shared live feed (or its polling fallback)
+    connect(m_nowPlayingFeed, &NowPlayingFeed::nowPlayingReceived,
+            this, [this](const QString &stationId, const QByteArray &payload) {
+        if (stationId == m_stationId) {
+            applyNowPlaying(payload);
+        }
+    });
 }
 
 // ========== Playback Controls ==========
@@ -69,21 +117,32 @@ void RadioService::playRadio()
         return;
     }
 
+    // Only one station plays at a time
+    for (RadioService *other : std::as_const(s_instances)) {
+        if (other != this && other->isPlaying()) {
+            other->stopRadio();
+        }
+    }
+
     // Request playback from media state manager (will stop music player if active)
     MediaStateManager::instance()->requestPlayback(MediaStateManager::MediaSource::RadioStream);
 
     qDebug() << "Starting radio stream:" << m_streamUrl;
-    m_mediaPlayer->setSource(QUrl(m_streamUrl));
-    m_mediaPlayer->play();
+    m_streamClient->setStreamUrl(m_streamUrl);
+    m_streamClient->start();
 
-    // Start fetching now playing info
-    fetchNowPlaying();
+    // Make sure the now playing info is fresh when playback starts
+    if (m_nowPlayingFeed->isSubscribed(m_stationId)) {
+        m_nowPlayingFeed->refreshNow();
+    } else {
+        refreshState();
+    }
 }
 
 void RadioService::stopRadio()
 {
     qDebug() << "Stopping radio stream";
-    m_mediaPlayer->stop();
+    m_streamClient->stop();
 
     // Notify media state manager that radio stopped
     MediaStateManager::instance()->notifyStopped(MediaStateManager::MediaSource::RadioStream);
@@ -100,7 +159,7 @@ void RadioService::togglePlayPause()
 
 bool RadioService::isPlaying() const
 {
-    return m_mediaPlayer->playbackState() == QMediaPlayer::PlayingState;
+    return m_streamClient->isPlaying();
 }
 
 // ========== Volume Controls ==========
@@ -108,24 +167,63 @@ bool RadioService::isPlaying() const
 void RadioService::setVolume(int volume)
 {
     float normalizedVolume = qBound(0, volume, 100) / 100.0f;
-    m_audioOutput->setVolume(normalizedVolume);
+    m_streamClient->setVolume(normalizedVolume);
     emit volumeChanged(volume);
 }
 
 int RadioService::volume() const
 {
-    return static_cast<int>(m_audioOutput->volume() * 100);
+    return static_cast<int>(m_streamClient->volume() * 100);
 }
 
 void RadioService::setMuted(bool muted)
 {
-    m_audioOutput->setMuted(muted);
+    m_streamClient->setMuted(muted);
     emit mutedChanged(muted);
 }
 
 bool RadioService::isMuted() const
 {
-    return m_audioOutput->isMuted();
+    return m_streamClient->isMuted();
+}
+
+void RadioService::setStreamBufferMs(int ms)
+{
+    m_streamClient->setBufferTargetMs(ms);
+    AppConfig::instance()->setRadioBufferMs(ms);
+}
+
+int RadioService::streamBufferMs() const
+{
+    return m_streamClient->bufferTargetMs();
+}
+
+RadioStreamStats RadioService::streamStats() const
+{
+    return m_streamClient->stats();
+}
+
+QString RadioService::streamTitle() const
+{
+    return m_streamClient->streamTitle();
+}
+
+// ========== Live Updates ==========
+
+void RadioService::startNowPlayingUpdates()
+{
+    m_nowPlayingFeed->subscribe(m_stationId);
+}
+
+void RadioService::stopNowPlayingUpdates()
+{
+    m_nowPlayingFeed->unsubscribe(m_stationId);
+}
+
+bool RadioService::isReceivingLiveUpdates() const
+{
+    return m_nowPlayingFeed->isSubscribed(m_stationId)
+        && m_nowPlayingFeed->mode() == NowPlayingFeed::Mode::Live;
 }
 
 // ========== API Methods ==========
@@ -147,31 +245,39 @@ QNetworkRequest RadioService::createAuthenticatedRequest(const QString &endpoint
     return request;
 }
 
-void RadioService::fetchNowPlaying()
+QFuture<bool> RadioService::refreshState()
 {
+    // The nowplaying payload already carries song_history and playing_next
     QString endpoint = QString("/api/nowplaying/%1").arg(m_stationId);
     QNetworkRequest request = createRequest(endpoint);
 
     QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onNowPlayingReceived(reply);
+    EKNM_METRIC_HTTP(reply);
+    qDebug() << "Refreshing radio state from:" << request.url();
+
+    return NetworkFuture::fromReply(reply, this, [this](QNetworkReply *reply) {
+        return onNowPlayingReceived(reply);
     });
+}
 
-    qDebug() << "Fetching now playing from:" << request.url();
+QFuture<bool> RadioService::fetchNowPlaying()
+{
+    return refreshState();
 }
 
-void RadioService::fetchSongHistory(int limit)
+QFuture<QList<RadioService::SongInfo>> RadioService::fetchSongHistory(int limit)
 {
     QString endpoint = QString("/api/station/%1/history?limit=%2").arg(m_stationId).arg(limit);
     QNetworkRequest request = createAuthenticatedRequest(endpoint);
 
     QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onSongHistoryReceived(reply);
+    EKNM_METRIC_HTTP(reply);
+    return NetworkFuture::fromReply(reply, this, [this](QNetworkReply *reply) {
+        return onSongHistoryReceived(reply);
     });
 }
 
-void RadioService::fetchRequestableSongs(const QString &search)
+QFuture<QList<RadioService::SongInfo>> RadioService::fetchRequestableSongs(const QString &search)
 {
     QString endpoint = QString("/api/station/%1/requests").arg(m_stationId);
     if (!search.isEmpty()) {
@@ -181,98 +287,120 @@ void RadioService::fetchRequestableSongs(const QString &search)
     QNetworkRequest request = createAuthenticatedRequest(endpoint);
 
     QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onRequestableSongsReceived(reply);
+    EKNM_METRIC_HTTP(reply);
+    return NetworkFuture::fromReply(reply, this, [this](QNetworkReply *reply) {
+        return onRequestableSongsReceived(reply);
     });
 }
 
-void RadioService::submitSongRequest(const QString &requestId)
+QFuture<bool> RadioService::submitSongRequest(const QString &requestId)
 {
     QString endpoint = QString("/api/station/%1/request/%2").arg(m_stationId, requestId);
     QNetworkRequest request = createAuthenticatedRequest(endpoint);
 
     QNetworkReply *reply = m_networkManager->post(request, QByteArray());
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onSongRequestSubmitted(reply);
-    });
-
+    EKNM_METRIC_HTTP(reply);
     qDebug() << "Submitting song request:" << requestId;
+
+    return NetworkFuture::fromReply(reply, this, [this](QNetworkReply *reply) {
+        return onSongRequestSubmitted(reply);
+    });
 }
 
-void RadioService::fetchQueue()
+QFuture<QList<RadioService::SongInfo>> RadioService::fetchQueue()
 {
     QString endpoint = QString("/api/station/%1/queue").arg(m_stationId);
     QNetworkRequest request = createAuthenticatedRequest(endpoint);
 
     QNetworkReply *reply = m_networkManager->get(request);
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        onQueueReceived(reply);
+    EKNM_METRIC_HTTP(reply);
+    return NetworkFuture::fromReply(reply, this, [this](QNetworkReply *reply) {
+        return onQueueReceived(reply);
     });
 }
 
 // ========== Response Handlers ==========
 
-RadioService::SongInfo RadioService::parseSongInfo(const QJsonObject &songObj)
+bool RadioService::applyNowPlaying(const QByteArray &payload)
 {
-    SongInfo info;
-    info.id = songObj["id"].toString();
-    info.title = songObj["title"].toString("Unknown");
-    info.artist = songObj["artist"].toString("Unknown");
-    info.album = songObj["album"].toString();
-    info.artUrl = songObj["art"].toString();
-    info.duration = songObj["duration"].toInt(0);
-    return info;
-}
+    RadioStateChange change;
+    if (!NowPlayingParser::parseNowPlaying(payload, change.state)) {
+        qWarning() << "Malformed now playing payload (" << payload.size() << "bytes)";
+        return false;
+    }
+    if (change.state.nowPlaying.stationName.isEmpty()) {
+        change.state.nowPlaying.stationName = m_station.name;
+    }
 
-void RadioService::onNowPlayingReceived(QNetworkReply *reply)
-{
-    if (reply->error() == QNetworkReply::NoError) {
-        QByteArray responseData = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
-        QJsonObject obj = doc.object();
+    // Lets the polling fallback wake up right after the current song ends
+    m_nowPlayingFeed->setRemainingHint(m_stationId, change.state.nowPlaying.remaining);
 
-        NowPlayingInfo info;
+    const NowPlayingInfo &oldInfo = m_state.nowPlaying;
+    const NowPlayingInfo &newInfo = change.state.nowPlaying;
 
-        // Parse station info
-        QJsonObject station = obj["station"].toObject();
-        info.stationName = station["name"].toString("EKNM Intercom");
-        info.isOnline = station["is_online"].toBool(false);
+    change.songChanged = oldInfo.song != newInfo.song;
+    change.stationChanged = oldInfo.stationName != newInfo.stationName
+                         || oldInfo.isOnline != newInfo.isOnline
+                         || oldInfo.listeners != newInfo.listeners;
+    change.progressChanged = oldInfo.elapsed != newInfo.elapsed
+                          || oldInfo.duration != newInfo.duration;
+    change.historyChanged = m_state.history != change.state.history;
+    change.queueChanged = m_state.queue != change.state.queue;
 
-        // Parse now playing
-        QJsonObject nowPlaying = obj["now_playing"].toObject();
-        info.song = parseSongInfo(nowPlaying["song"].toObject());
-        info.elapsed = nowPlaying["elapsed"].toInt(0);
-        info.duration = nowPlaying["duration"].toInt(0);
+    if (change.isEmpty()) {
+        return true;
+    }
 
-        // Parse listeners
-        QJsonObject listeners = obj["listeners"].toObject();
-        info.listeners = listeners["current"].toInt(0);
+    syncClock(newInfo, change.songChanged);
 
-        m_nowPlayingInfo = info;
-        emit nowPlayingUpdated(info);
+    m_state = change.state;
+    m_songHistory = m_state.history;
+    m_queue = m_state.queue;
 
-        qDebug() << "Now playing:" << info.song.artist << "-" << info.song.title;
-    } else {
+    emit stateChanged(change);
+    emit nowPlayingUpdated(newInfo);
+
+    if (change.songChanged) {
+        qDebug() << "Now playing:" << newInfo.song.artist << "-" << newInfo.song.title;
+    }
+    return true;
+}
+
+void RadioService::syncClock(const NowPlayingInfo &info, bool songChanged)
+{
+    MediaClock *clock = m_streamClient->clock();
+    clock->setDuration(qint64(info.duration) * 1000000);
+
+    // The server reports what it is sending now; the listener hears that
+    // only after the jitter buffer has drained
+    qint64 heardUs = qint64(info.elapsed) * 1000000;
+    if (m_streamClient->isPlaying()) {
+        heardUs -= qint64(m_streamClient->stats().bufferedMs) * 1000;
+    }
+    heardUs = qMax<qint64>(0, heardUs);
+
+    // Server elapsed time has one second resolution; within a song the
+    // played audio is the better reference, so only re-anchor on real jumps
+    if (songChanged || qAbs(clock->positionUs() - heardUs) > kServerElapsedToleranceUs) {
+        clock->rebase(heardUs);
+    }
+}
+
+bool RadioService::onNowPlayingReceived(QNetworkReply *reply)
+{
+    if (reply->error() != QNetworkReply::NoError) {
         qWarning() << "Failed to fetch now playing:" << reply->errorString();
         emit errorOccurred(reply->errorString());
+        return false;
     }
-
-    reply->deleteLater();
+    return applyNowPlaying(reply->readAll());
 }
 
-void RadioService::onSongHistoryReceived(QNetworkReply *reply)
+QList<RadioService::SongInfo> RadioService::onSongHistoryReceived(QNetworkReply *reply)
 {
+    QList<SongInfo> history;
     if (reply->error() == QNetworkReply::NoError) {
-        QByteArray responseData = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
-        QJsonArray arr = doc.array();
-
-        QList<SongInfo> history;
-        for (const QJsonValue &val : arr) {
-            QJsonObject item = val.toObject();
-            SongInfo song = parseSongInfo(item["song"].toObject());
-            history.append(song);
-        }
+        NowPlayingParser::parseSongList(reply->readAll(), history);
 
         m_songHistory = history;
         emit songHistoryUpdated(history);
@@ -282,25 +410,15 @@ void RadioService::onSongHistoryReceived(QNetworkReply *reply)
         qWarning() << "Failed to fetch song history:" << reply->errorString();
         emit errorOccurred(reply->errorString());
     }
-
-    reply->deleteLater();
+    return history;
 }
 
-void RadioService::onRequestableSongsReceived(QNetworkReply *reply)
+QList<RadioService::SongInfo> RadioService::onRequestableSongsReceived(QNetworkReply *reply)
 {
+    QList<SongInfo> songs;
     if (reply->error() == QNetworkReply::NoError) {
-        QByteArray responseData = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
-        QJsonArray arr = doc.array();
-
-        QList<SongInfo> songs;
-        for (const QJsonValue &val : arr) {
-            QJsonObject item = val.toObject();
-            SongInfo song = parseSongInfo(item["song"].toObject());
-            // Store request_id in the id field for later use
-            song.id = item["request_id"].toString();
-            songs.append(song);
-        }
+        // Store request_id in the id field for later use
+        NowPlayingParser::parseSongList(reply->readAll(), songs, true);
 
         m_requestableSongs = songs;
         emit requestableSongsUpdated(songs);
@@ -310,46 +428,37 @@ void RadioService::onRequestableSongsReceived(QNetworkReply *reply)
         qWarning() << "Failed to fetch requestable songs:" << reply->errorString();
         emit errorOccurred(reply->errorString());
     }
-
-    reply->deleteLater();
+    return songs;
 }
 
-void RadioService::onSongRequestSubmitted(QNetworkReply *reply)
+bool RadioService::onSongRequestSubmitted(QNetworkReply *reply)
 {
     if (reply->error() == QNetworkReply::NoError) {
         emit songRequestSubmitted(true, "Song requested successfully!");
         qDebug() << "Song request submitted successfully";
-    } else {
-        QString errorMsg = "Failed to request song";
+        return true;
+    }
 
-        int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    QString errorMsg = "Failed to request song";
 
-        if (reply->error() == QNetworkReply::ContentNotFoundError || statusCode == 404) {
-            errorMsg = "Song not available for requests";
-        } else if (statusCode == 429) {
-            errorMsg = "Too many requests. Please wait before requesting another song.";
-        }
+    int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
-        emit songRequestSubmitted(false, errorMsg);
-        qWarning() << "Song request failed:" << reply->errorString();
+    if (reply->error() == QNetworkReply::ContentNotFoundError || statusCode == 404) {
+        errorMsg = "Song not available for requests";
+    } else if (statusCode == 429) {
+        errorMsg = "Too many requests. Please wait before requesting another song.";
     }
 
-    reply->deleteLater();
+    emit songRequestSubmitted(false, errorMsg);
+    qWarning() << "Song request failed:" << reply->errorString();
+    return false;
 }
 
-void RadioService::onQueueReceived(QNetworkReply *reply)
+QList<RadioService::SongInfo> RadioService::onQueueReceived(QNetworkReply *reply)
 {
+    QList<SongInfo> queue;
     if (reply->error() == QNetworkReply::NoError) {
-        QByteArray responseData = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
-        QJsonArray arr = doc.array();
-
-        QList<SongInfo> queue;
-        for (const QJsonValue &val : arr) {
-            QJsonObject item = val.toObject();
-            SongInfo song = parseSongInfo(item["song"].toObject());
-            queue.append(song);
-        }
+        NowPlayingParser::parseSongList(reply->readAll(), queue);
 
         m_queue = queue;
         emit queueUpdated(queue);
@@ -359,6 +468,5 @@ void RadioService::onQueueReceived(QNetworkReply *reply)
         qWarning() << "Failed to fetch queue:" << reply->errorString();
         emit errorOccurred(reply->errorString());
     }
-
-    reply->deleteLater();
+    return queue;
 }
@@ -4,47 +4,51 @@
 #include <QObject>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
-#include <QJsonObject>
-#include <QJsonArray>
+#include <QFuture>
 #include <QTimer>
-#include <QMediaPlayer>
-#include <QAudioOutput>
+#include <QHash>
 #include "mediastatemanager.h"
+#include "nowplayingfeed.h"
+#include "radiostreamclient.h"
+#include "models/radiostate.h"
+#include "models/radiostation.h"
 
 /**
  * @brief Service for managing radio streaming and AzuraCast API interactions
  *
+ * One instance per station (see forStation()); instance() is the default
+ * station. Now playing updates for all stations of a host share one
+ * NowPlayingFeed, so every station that has started updates stays warm.
+ *
  * Handles:
- * - Radio stream playback
- * - Now playing information
+ * - Radio stream playback (jitter-buffered, see RadioStreamClient)
+ * - Now playing information (pushed live, with polling fallback)
  * - Song history
  * - Song requests
  * - Queue management
+ *
+ * API requests return a QFuture of their result, delivered on the service's
+ * thread; cancel() on the future aborts the request. The matching signals
+ * below still fire for every completed request, so views can either chain
+ * on the future or just listen.
  */
 class RadioService : public QObject
 {
     Q_OBJECT
 
 public:
-    struct SongInfo {
-        QString id;
-        QString title;
-        QString artist;
-        QString album;
-        QString artUrl;
-        int duration = 0;
-    };
-
-    struct NowPlayingInfo {
-        SongInfo song;
-        QString stationName;
-        int elapsed = 0;
-        int duration = 0;
-        int listeners = 0;
-        bool isOnline = false;
-    };
+    using SongInfo = RadioSongInfo;
+    using NowPlayingInfo = RadioNowPlayingInfo;
+    using RadioState = ::RadioState;
+    using RadioStateChange = ::RadioStateChange;
 
+    // Service of the registry's default station
     static RadioService* instance();
+    // Service of a StationRegistry station (nullptr if unknown)
+    static RadioService* forStation(const QString &stationId);
+
+    RadioStation station() const { return m_station; }
+    QString stationId() const { return m_stationId; }
 
     // Playback controls
     void playRadio();
@@ -58,20 +62,43 @@ public:
     void setMuted(bool muted);
     bool isMuted() const;
 
-    // API methods
-    void fetchNowPlaying();
-    void fetchSongHistory(int limit = 10);
-    void fetchRequestableSongs(const QString &search = QString());
-    void submitSongRequest(const QString &requestId);
-    void fetchQueue();
+    // Stream buffering (latency vs. resilience) and its statistics
+    void setStreamBufferMs(int ms);
+    int streamBufferMs() const;
+    RadioStreamStats streamStats() const;
+
+    // Position in the current song as heard: server elapsed time advanced by
+    // the audio actually played since (readable from any thread)
+    const MediaClock& clock() const { return *m_streamClient->clock(); }
+
+    // Title from the stream's ICY metadata (arrives before the API catches up)
+    QString streamTitle() const;
+
+    // Live now playing updates (SSE push with adaptive polling fallback)
+    void startNowPlayingUpdates();
+    void stopNowPlayingUpdates();
+    bool isReceivingLiveUpdates() const;
+
+    // Refresh now playing, history and queue with a single request
+    // (false if the request failed or the payload was malformed)
+    QFuture<bool> refreshState();
+
+    // API methods; failed requests yield false / an empty list
+    QFuture<bool> fetchNowPlaying();
+    QFuture<QList<SongInfo>> fetchSongHistory(int limit = 10);
+    QFuture<QList<SongInfo>> fetchRequestableSongs(const QString &search = QString());
+    QFuture<bool> submitSongRequest(const QString &requestId);
+    QFuture<QList<SongInfo>> fetchQueue();
 
     // Getters
-    NowPlayingInfo currentNowPlaying() const { return m_nowPlayingInfo; }
+    RadioState currentState() const { return m_state; }
+    NowPlayingInfo currentNowPlaying() const { return m_state.nowPlaying; }
     QList<SongInfo> songHistory() const { return m_songHistory; }
     QList<SongInfo> requestableSongs() const { return m_requestableSongs; }
     QList<SongInfo> queue() const { return m_queue; }
 
 signals:
+    void stateChanged(const RadioStateChange &change);
     void nowPlayingUpdated(const NowPlayingInfo &info);
     void songHistoryUpdated(const QList<SongInfo> &history);
     void requestableSongsUpdated(const QList<SongInfo> &songs);
@@ -81,18 +108,13 @@ signals:
     void playbackStateChanged(bool isPlaying);
     void volumeChanged(int volume);
     void mutedChanged(bool muted);
+    void streamTitleChanged(const QString &title);
+    void streamStatsChanged(const RadioStreamStats &stats);
 
     void errorOccurred(const QString &error);
 
-private slots:
-    void onNowPlayingReceived(QNetworkReply *reply);
-    void onSongHistoryReceived(QNetworkReply *reply);
-    void onRequestableSongsReceived(QNetworkReply *reply);
-    void onSongRequestSubmitted(QNetworkReply *reply);
-    void onQueueReceived(QNetworkReply *reply);
-
 private:
-    explicit RadioService(QObject *parent = nullptr);
+    explicit RadioService(const RadioStation &station, QObject *parent = nullptr);
     ~RadioService();
     RadioService(const RadioService&) = delete;
     RadioService& operator=(const RadioService&) = delete;
@@ -100,25 +122,34 @@ private:
     void setupConnections();
     QNetworkRequest createRequest(const QString &endpoint);
     QNetworkRequest createAuthenticatedRequest(const QString &endpoint);
-    SongInfo parseSongInfo(const QJsonObject &songObj);
+    bool applyNowPlaying(const QByteArray &payload);
+
+    // Reply handlers: update the cache, emit, and produce the future's result
+    bool onNowPlayingReceived(QNetworkReply *reply);
+    QList<SongInfo> onSongHistoryReceived(QNetworkReply *reply);
+    QList<SongInfo> onRequestableSongsReceived(QNetworkReply *reply);
+    bool onSongRequestSubmitted(QNetworkReply *reply);
+    QList<SongInfo> onQueueReceived(QNetworkReply *reply);
+    void syncClock(const NowPlayingInfo &info, bool songChanged);
 
-    static RadioService *s_instance;
+    static QHash<QString, RadioService*> s_instances;
 
     // Network
     QNetworkAccessManager *m_networkManager;
+    NowPlayingFeed *m_nowPlayingFeed;
 
     // Media playback
-    QMediaPlayer *m_mediaPlayer;
-    QAudioOutput *m_audioOutput;
+    RadioStreamClient *m_streamClient;
 
     // Configuration
+    RadioStation m_station;
     QString m_baseUrl;
     QString m_apiKey;
     QString m_stationId;
     QString m_streamUrl;
 
     // Cached data
-    NowPlayingInfo m_nowPlayingInfo;
+    RadioState m_state;
     QList<SongInfo> m_songHistory;
     QList<SongInfo> m_requestableSongs;
     QList<SongInfo> m_queue;
@@ -0,0 +1,398 @@
+#include "radiostreamclient.h"
+#include "streamsourcedevice.h"
+#include "jitterbuffer.h"
+#include "audiorenderthread.h"
+#include "utils/metrics.h"
+#include <QMediaDevices>
+#include <QAudioDevice>
+#include <QAudioBuffer>
+#include <QDebug>
+
+namespace {
+// Let the decoder probe a few MP3 frames before it starts
+constexpr qint64 kDecoderStartBytes = 16 * 1024;
+// Icecast sends audio continuously; this much silence means the connection is dead
+constexpr int kStallTimeoutMs = 8000;
+constexpr int kReconnectBaseDelayMs = 250;
+constexpr int kReconnectMaxDelayMs = 5000;
+constexpr int kStatsIntervalMs = 500;
+// The sink never asks for more than it buffers, and the render thread
+// keeps twice that ready
+constexpr int kSinkBufferMs = 100;
+constexpr int kRenderPeriodMs = 10;
+constexpr int kRenderPeriods = 2 * kSinkBufferMs / kRenderPeriodMs;
+}
+
+RadioStreamClient::RadioStreamClient(QNetworkAccessManager *networkManager, QObject *parent)
+    : QObject(parent)
+    , m_networkManager(networkManager)
+    , m_sourceDevice(new StreamSourceDevice(this))
+    , m_decoder(new QAudioDecoder(this))
+    , m_jitterBuffer(nullptr)
+    , m_renderThread(nullptr)
+    , m_audioSink(nullptr)
+    , m_reconnectTimer(new QTimer(this))
+    , m_stallTimer(new QTimer(this))
+    , m_statsTimer(new QTimer(this))
+    , m_bufferTargetMs(1500)
+    , m_lockMemory(false)
+    , m_volume(0.75f)
+    , m_muted(false)
+    , m_running(false)
+    , m_receivedData(false)
+    , m_reconnectAttempts(0)
+    , m_reconnects(0)
+    , m_bytesReceived(0)
+{
+    qRegisterMetaType<RadioStreamStats>();
+
+    m_reconnectTimer->setSingleShot(true);
+    connect(m_reconnectTimer, &QTimer::timeout, this, &RadioStreamClient::openConnection);
+
+    m_stallTimer->setSingleShot(true);
+    m_stallTimer->setInterval(kStallTimeoutMs);
+    connect(m_stallTimer, &QTimer::timeout, this, &RadioStreamClient::onStallTimeout);
+
+    m_statsTimer->setInterval(kStatsIntervalMs);
+    connect(m_statsTimer, &QTimer::timeout, this, [this]() {
+        emit statsChanged(stats());
+    });
+
+    connect(m_decoder, &QAudioDecoder::bufferReady, this, &RadioStreamClient::onDecoderBufferReady);
+    connect(m_decoder, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error),
+            this, &RadioStreamClient::onDecoderError);
+    connect(m_decoder, &QAudioDecoder::finished, this, &RadioStreamClient::onDecoderFinished);
+}
+
+RadioStreamClient::~RadioStreamClient()
+{
+    stop();
+}
+
+void RadioStreamClient::setBufferTargetMs(int ms)
+{
+    m_bufferTargetMs = ms;
+    if (m_jitterBuffer) {
+        m_jitterBuffer->setTargetMs(ms);
+    }
+}
+
+// ========== Lifecycle ==========
+
+void RadioStreamClient::start()
+{
+    if (m_running) {
+        return;
+    }
+
+    if (m_streamUrl.isEmpty()) {
+        emit errorOccurred("Stream URL not configured");
+        return;
+    }
+
+    QAudioDevice device = QMediaDevices::defaultAudioOutput();
+    if (device.isNull()) {
+        emit errorOccurred("No audio output device available");
+        return;
+    }
+
+    // 16-bit stereo keeps the buffer small; fall back to whatever the device prefers
+    m_format.setSampleRate(44100);
+    m_format.setChannelCount(2);
+    m_format.setSampleFormat(QAudioFormat::Int16);
+    if (!device.isFormatSupported(m_format)) {
+        m_format = device.preferredFormat();
+    }
+
+    m_jitterBuffer = new JitterBuffer(m_format, m_bufferTargetMs);
+
+    AudioRenderThread::Options options;
+    options.periodMs = kRenderPeriodMs;
+    options.periods = kRenderPeriods;
+    options.lockMemory = m_lockMemory;
+    JitterBuffer *jitterBuffer = m_jitterBuffer;
+    options.lockSourceMemory = [jitterBuffer]() {
+        return jitterBuffer->lockMemory();
+    };
+    m_renderThread = new AudioRenderThread(m_format, [jitterBuffer](char *data, qint64 size) {
+        return jitterBuffer->render(data, size);
+    }, options, this);
+    m_renderThread->setClock(&m_clock);
+    m_renderThread->start(QThread::TimeCriticalPriority);
+
+    m_audioSink = new QAudioSink(device, m_format, this);
+    m_audioSink->setBufferSize(m_format.bytesForDuration(qint64(kSinkBufferMs) * 1000));
+    applyVolume();
+    m_audioSink->start(m_renderThread->outputDevice());
+
+    m_sourceDevice->reset();
+    m_icyParser.reset(0);
+    m_reconnectAttempts = 0;
+    m_reconnects = 0;
+    m_bytesReceived = 0;
+    m_running = true;
+
+    openConnection();
+    m_statsTimer->start();
+
+    qDebug() << "Radio stream started:" << m_streamUrl << "buffer target" << m_bufferTargetMs << "ms";
+    emit playingChanged(true);
+}
+
+void RadioStreamClient::stop()
+{
+    if (!m_running) {
+        return;
+    }
+
+    m_running = false;
+    m_reconnectTimer->stop();
+    m_stallTimer->stop();
+    m_statsTimer->stop();
+
+    closeConnection();
+    stopDecoder();
+
+    if (m_audioSink) {
+        m_audioSink->stop();
+        delete m_audioSink;
+        m_audioSink = nullptr;
+    }
+    // The render thread is the jitter buffer's consumer: it goes first
+    if (m_renderThread) {
+        m_renderThread->stop();
+        delete m_renderThread;
+        m_renderThread = nullptr;
+    }
+    if (m_jitterBuffer) {
+        delete m_jitterBuffer;
+        m_jitterBuffer = nullptr;
+    }
+    m_clock.setRunning(false);
+
+    qDebug() << "Radio stream stopped";
+    emit playingChanged(false);
+}
+
+// ========== Network ==========
+
+void RadioStreamClient::openConnection()
+{
+    if (!m_running || m_reply) {
+        return;
+    }
+
+    QNetworkRequest request{QUrl(m_streamUrl)};
+    request.setHeader(QNetworkRequest::UserAgentHeader, "EKNMusic/1.0");
+    request.setRawHeader("Icy-MetaData", "1");
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+
+    m_receivedData = false;
+    m_reply = m_networkManager->get(request);
+    connect(m_reply, &QNetworkReply::readyRead, this, &RadioStreamClient::onReadyRead);
+    connect(m_reply, &QNetworkReply::finished, this, &RadioStreamClient::onReplyFinished);
+
+    m_stallTimer->start();
+}
+
+void RadioStreamClient::closeConnection()
+{
+    if (!m_reply) {
+        return;
+    }
+
+    QNetworkReply *reply = m_reply;
+    m_reply = nullptr;
+    reply->disconnect(this);
+    reply->abort();
+    reply->deleteLater();
+}
+
+void RadioStreamClient::onReadyRead()
+{
+    if (!m_reply) {
+        return;
+    }
+
+    if (!m_receivedData) {
+        // A new connection restarts the metadata interval
+        m_receivedData = true;
+        m_icyParser.reset(m_reply->rawHeader("icy-metaint").toInt());
+
+        if (m_bytesReceived > 0) {
+            ++m_reconnects;
+            qDebug() << "Radio stream reconnected, buffered" << m_jitterBuffer->bufferedMs() << "ms";
+        }
+        m_reconnectAttempts = 0;
+    }
+
+    m_stallTimer->start();
+
+    QByteArray data = m_reply->readAll();
+    m_bytesReceived += data.size();
+    EKNM_METRIC_COUNT(StreamBytes, data.size());
+
+    QByteArray audio;
+    QList<QByteArray> metadata;
+    m_icyParser.feed(data, audio, metadata);
+    m_sourceDevice->appendData(audio);
+
+    for (const QByteArray &block : metadata) {
+        QString title = IcyMetadataParser::streamTitle(block);
+        if (!title.isEmpty() && title != m_streamTitle) {
+            m_streamTitle = title;
+            qDebug() << "Stream title:" << title;
+            emit streamTitleChanged(title);
+        }
+    }
+
+    if (!m_decoder->isDecoding() && m_sourceDevice->bufferedBytes() >= kDecoderStartBytes) {
+        startDecoder();
+    }
+}
+
+void RadioStreamClient::onReplyFinished()
+{
+    if (!m_reply) {
+        return;
+    }
+
+    qWarning() << "Radio stream connection ended:" << m_reply->errorString();
+    closeConnection();
+    m_stallTimer->stop();
+
+    if (m_running) {
+        // Decoder and sink keep playing the buffer meanwhile
+        scheduleReconnect();
+    }
+}
+
+void RadioStreamClient::onStallTimeout()
+{
+    if (m_reply) {
+        qWarning() << "Radio stream stalled for" << kStallTimeoutMs / 1000 << "s, reconnecting";
+        // abort() emits finished(), which runs the normal reconnect path
+        m_reply->abort();
+    }
+}
+
+void RadioStreamClient::scheduleReconnect()
+{
+    // First retry is immediate so a dropped connection is usually back
+    // before the jitter buffer drains
+    int delay = 0;
+    if (m_reconnectAttempts > 0) {
+        int exponent = qMin(m_reconnectAttempts - 1, 5);
+        delay = qMin(kReconnectBaseDelayMs << exponent, kReconnectMaxDelayMs);
+    }
+    ++m_reconnectAttempts;
+
+    qDebug() << "Reconnecting radio stream in" << delay << "ms (attempt" << m_reconnectAttempts << ")";
+    m_reconnectTimer->start(delay);
+}
+
+// ========== Decoding ==========
+
+void RadioStreamClient::startDecoder()
+{
+    m_decoder->setAudioFormat(m_format);
+    m_decoder->setSourceDevice(m_sourceDevice);
+    m_decoder->start();
+}
+
+void RadioStreamClient::stopDecoder()
+{
+    // Wake a decoder thread blocked on the source before stopping it
+    m_sourceDevice->finish();
+    m_decoder->stop();
+    m_sourceDevice->reset();
+}
+
+void RadioStreamClient::onDecoderBufferReady()
+{
+    EKNM_METRIC_SCOPED_TIMER(DecodeNs);
+
+    while (m_decoder->bufferAvailable()) {
+        QAudioBuffer buffer = m_decoder->read();
+        if (!buffer.isValid() || !m_jitterBuffer) {
+            continue;
+        }
+
+        if (buffer.format() != m_format) {
+            // Backend ignored setAudioFormat(); appending would play garbage
+            qWarning() << "Decoder output format" << buffer.format() << "differs from sink format" << m_format;
+            continue;
+        }
+
+        m_jitterBuffer->appendPcm(buffer.constData<char>(), buffer.byteCount());
+        EKNM_METRIC_COUNT(DecodedFrames, buffer.frameCount());
+    }
+}
+
+void RadioStreamClient::onDecoderError(QAudioDecoder::Error error)
+{
+    Q_UNUSED(error);
+    qWarning() << "Radio stream decoder error:" << m_decoder->errorString();
+
+    if (!m_running) {
+        return;
+    }
+
+    // Drop the undecodable backlog; the decoder restarts once fresh data arrives
+    stopDecoder();
+}
+
+void RadioStreamClient::onDecoderFinished()
+{
+    // Only happens if the source ran dry long enough to look like EOF;
+    // onReadyRead() restarts the decoder when data flows again
+    if (m_running) {
+        qDebug() << "Radio stream decoder drained, waiting for data";
+    }
+}
+
+// ========== Volume ==========
+
+void RadioStreamClient::setVolume(float volume)
+{
+    m_volume = qBound(0.0f, volume, 1.0f);
+    applyVolume();
+}
+
+void RadioStreamClient::setMuted(bool muted)
+{
+    m_muted = muted;
+    applyVolume();
+}
+
+void RadioStreamClient::applyVolume()
+{
+    if (m_audioSink) {
+        m_audioSink->setVolume(m_muted ? 0.0 : m_volume);
+    }
+}
+
+// ========== Statistics ==========
+
+RadioStreamStats RadioStreamClient::stats() const
+{
+    RadioStreamStats stats;
+    stats.connected = m_reply && m_receivedData;
+    stats.targetMs = m_bufferTargetMs;
+    stats.reconnects = m_reconnects;
+    stats.bytesReceived = m_bytesReceived;
+
+    if (m_jitterBuffer) {
+        stats.buffering = m_jitterBuffer->isPrebuffering();
+        stats.bufferedMs = m_jitterBuffer->bufferedMs();
+        stats.underruns = m_jitterBuffer->underruns();
+        stats.droppedMs = m_jitterBuffer->droppedMs();
+        if (stats.targetMs > 0) {
+            stats.fillPercent = stats.bufferedMs * 100 / stats.targetMs;
+        }
+    }
+    if (m_renderThread) {
+        stats.renderUnderruns = m_renderThread->stats().underruns;
+    }
+    return stats;
+}
@@ -0,0 +1,142 @@
+#ifndef RADIOSTREAMCLIENT_H
+#define RADIOSTREAMCLIENT_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QTimer>
+#include <QAudioDecoder>
+#include <QAudioSink>
+#include <QAudioFormat>
+#include "icymetadataparser.h"
+#include "mediaclock.h"
+
+class StreamSourceDevice;
+class JitterBuffer;
+class AudioRenderThread;
+
+// Snapshot of the stream client's buffering state
+struct RadioStreamStats {
+    bool connected = false;     // Network stream currently open
+    bool buffering = false;     // Jitter buffer refilling (sink is fed silence)
+    int bufferedMs = 0;         // Decoded audio waiting to be played
+    int targetMs = 0;           // Jitter buffer target
+    int fillPercent = 0;        // bufferedMs relative to targetMs (0-100+)
+    quint64 underruns = 0;      // Times the buffer ran dry while playing
+    quint64 renderUnderruns = 0; // Times the device found no rendered audio
+    qint64 droppedMs = 0;       // Audio discarded to keep latency bounded
+    int reconnects = 0;         // Successful reconnects since start()
+    qint64 bytesReceived = 0;   // Compressed bytes since start()
+};
+
+/**
+ * @brief Plays an Icecast/AzuraCast MP3 stream through a jitter buffer
+ *
+ * Pipeline: QNetworkReply (streamed, with Icy-MetaData) -> ICY metadata
+ * split -> StreamSourceDevice -> QAudioDecoder -> JitterBuffer ->
+ * AudioRenderThread -> QAudioSink (pull mode). Everything after the
+ * jitter buffer is lock-free and allocation-free, so a busy GUI thread
+ * (where the network and decoder run) can't starve the device.
+ *
+ * StreamTitle metadata is reported the moment it arrives in the stream.
+ * When the connection drops, the decoder and sink keep running on the
+ * buffered audio while a new connection is opened; the fresh bytes are
+ * appended to the same decoder input, so playback continues without a
+ * restart (at worst a short silence if the buffer runs dry).
+ */
+class RadioStreamClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RadioStreamClient(QNetworkAccessManager *networkManager, QObject *parent = nullptr);
+    ~RadioStreamClient();
+
+    void setStreamUrl(const QString &url) { m_streamUrl = url; }
+    QString streamUrl() const { return m_streamUrl; }
+
+    // Jitter buffer target: latency vs. resilience to network hiccups. The
+    // buffer is sized for the target at start(); raising it while playing
+    // takes full effect on the next start()
+    void setBufferTargetMs(int ms);
+    int bufferTargetMs() const { return m_bufferTargetMs; }
+
+    // mlock the audio buffers from the next start() (see AudioRenderThread)
+    void setLockMemory(bool lock) { m_lockMemory = lock; }
+    bool lockMemory() const { return m_lockMemory; }
+
+    void start();
+    void stop();
+    bool isPlaying() const { return m_running; }
+
+    // 0.0 - 1.0
+    void setVolume(float volume);
+    float volume() const { return m_volume; }
+    void setMuted(bool muted);
+    bool isMuted() const { return m_muted; }
+
+    QString streamTitle() const { return m_streamTitle; }
+    RadioStreamStats stats() const;
+
+    // Advanced by the audio the sink actually pulls out of the jitter
+    // buffer; RadioService anchors it to the server's elapsed time
+    MediaClock* clock() { return &m_clock; }
+    const MediaClock* clock() const { return &m_clock; }
+
+signals:
+    void playingChanged(bool playing);
+    void streamTitleChanged(const QString &title);
+    void statsChanged(const RadioStreamStats &stats);
+    void errorOccurred(const QString &error);
+
+private slots:
+    void onReadyRead();
+    void onReplyFinished();
+    void onDecoderBufferReady();
+    void onDecoderError(QAudioDecoder::Error error);
+    void onDecoderFinished();
+    void onStallTimeout();
+
+private:
+    void openConnection();
+    void closeConnection();
+    void scheduleReconnect();
+    void startDecoder();
+    void stopDecoder();
+    void applyVolume();
+
+    QNetworkAccessManager *m_networkManager;
+    QPointer<QNetworkReply> m_reply;
+
+    StreamSourceDevice *m_sourceDevice;
+    QAudioDecoder *m_decoder;
+    JitterBuffer *m_jitterBuffer;
+    AudioRenderThread *m_renderThread;
+    QAudioSink *m_audioSink;
+    QAudioFormat m_format;
+
+    IcyMetadataParser m_icyParser;
+    MediaClock m_clock;
+
+    QTimer *m_reconnectTimer;
+    QTimer *m_stallTimer;
+    QTimer *m_statsTimer;
+
+    QString m_streamUrl;
+    QString m_streamTitle;
+    int m_bufferTargetMs;
+    bool m_lockMemory;
+    float m_volume;
+    bool m_muted;
+
+    bool m_running;
+    bool m_receivedData;
+    int m_reconnectAttempts;
+    int m_reconnects;
+    qint64 m_bytesReceived;
+};
+
+Q_DECLARE_METATYPE(RadioStreamStats)
+
+#endif // RADIOSTREAMCLIENT_H
@@ -0,0 +1,501 @@
+#include "seekindex.h"
+#include "utils/containerreader.h"
+#include "utils/mpegframeheader.h"
+#include <algorithm>
+
+namespace {
+// How far past the ID3v2 tag the first MPEG frame is looked for
+constexpr qint64 kMpegSyncSearchBytes = 64 * 1024;
+// Frame scans check for cancellation this often (frames)
+constexpr quint64 kCancelCheckFrames = 4096;
+// MP4 chunks closer together than this share a point
+constexpr qint64 kMinMp4PointSpacingUs = 250 * 1000;
+// Serialized form: magic, then LEB128 varints
+constexpr char kDataMagic[] = "EKSI";
+constexpr quint64 kDataVersion = 1;
+
+void appendVarint(QByteArray &data, quint64 value)
+{
+    do {
+        quint8 byte = value & 0x7F;
+        value >>= 7;
+        if (value) {
+            byte |= 0x80;
+        }
+        data.append(char(byte));
+    } while (value);
+}
+
+bool readVarint(QByteArrayView data, qint64 &pos, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+        const quint8 byte = quint8(data[pos++]);
+        value |= quint64(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Deltas may be negative (MP4 chunk offsets need not increase)
+quint64 zigzag(qint64 value)
+{
+    return (quint64(value) << 1) ^ quint64(value >> 63);
+}
+
+qint64 unzigzag(quint64 value)
+{
+    return qint64(value >> 1) ^ -qint64(value & 1);
+}
+
+bool isFlac(QByteArrayView bytes)
+{
+    const qint64 start = ContainerReader::id3v2Size(bytes);
+    return start + 4 <= bytes.size() && bytes.sliced(start, 4) == "fLaC";
+}
+
+bool isMp4(QByteArrayView bytes)
+{
+    return bytes.size() >= 12 && bytes.sliced(4, 4) == "ftyp";
+}
+}
+
+SeekIndex::SeekIndex()
+    : m_source(Source::None)
+    , m_durationUs(0)
+    , m_audioStart(0)
+    , m_audioEnd(0)
+    , m_fileSize(-1)
+    , m_fileModifiedMs(0)
+    , m_sampleRate(0)
+    , m_samplesPerFrame(0)
+{
+}
+
+// ========== Building ==========
+
+SeekIndex SeekIndex::fromHeaders(const MappedFilePtr &file)
+{
+    if (!file || file->isEmpty()) {
+        return SeekIndex();
+    }
+
+    const QByteArrayView bytes = file->bytes();
+    SeekIndex index;
+    if (isFlac(bytes)) {
+        index = fromFlacSeekTable(bytes);
+    } else if (isMp4(bytes)) {
+        index = fromMp4SampleTable(bytes);
+    } else {
+        index = fromXingToc(bytes);
+    }
+    index.setFile(*file);
+    return index;
+}
+
+bool SeekIndex::canScanFrames(const MappedFilePtr &file)
+{
+    if (!file || file->isEmpty()) {
+        return false;
+    }
+    const QByteArrayView bytes = file->bytes();
+    if (isFlac(bytes) || isMp4(bytes)) {
+        return false;
+    }
+    const qint64 start = ContainerReader::id3v2Size(bytes);
+    return MpegFrameHeader::findFirst(bytes, start, MpegFrameHeader::streamEnd(bytes, start),
+                                      kMpegSyncSearchBytes) >= 0;
+}
+
+SeekIndex SeekIndex::scanMpegFrames(const MappedFilePtr &file, const std::function<bool()> &canceled)
+{
+    if (!canScanFrames(file)) {
+        return SeekIndex();
+    }
+
+    const QByteArrayView bytes = file->bytes();
+    const qint64 start = ContainerReader::id3v2Size(bytes);
+    const qint64 end = MpegFrameHeader::streamEnd(bytes, start);
+    qint64 pos = MpegFrameHeader::findFirst(bytes, start, end, kMpegSyncSearchBytes);
+    const MpegFrameHeader first = MpegFrameHeader::parse(bytes, pos);
+
+    // The Xing/Info frame decodes to nothing; the timeline starts after it
+    if (MpegFrameHeader::isInfoFrame(bytes, pos, first)) {
+        pos += first.frameBytes;
+    }
+
+    // Every header is read once, front to back
+    file->advise(MappedFile::Access::Sequential, pos);
+
+    SeekIndex index;
+    index.m_source = Source::MpegFrames;
+    index.m_sampleRate = first.sampleRate;
+    index.m_samplesPerFrame = first.samplesPerFrame;
+    index.m_audioStart = pos;
+    index.m_audioEnd = end;
+
+    const qint64 frameUsNumerator = qint64(first.samplesPerFrame) * 1000000;
+    quint64 frames = 0;
+    while (pos + 4 <= end) {
+        if (frames % kCancelCheckFrames == 0 && canceled && canceled()) {
+            return SeekIndex();
+        }
+
+        const MpegFrameHeader header = MpegFrameHeader::parse(bytes, pos);
+        if (!header.isValid() || header.sampleRate != first.sampleRate) {
+            // Junk or a damaged frame: carry on at the next real frame,
+            // the way decoders resynchronize
+            pos = MpegFrameHeader::findFirst(bytes, pos + 1, end);
+            if (pos < 0) {
+                break;
+            }
+            continue;
+        }
+
+        if (frames % kFramesPerPoint == 0) {
+            index.m_points.append({qint64(frames) * frameUsNumerator / first.sampleRate, pos});
+        }
+        pos += header.frameBytes;
+        ++frames;
+    }
+
+    index.m_durationUs = qint64(frames) * frameUsNumerator / first.sampleRate;
+    index.setFile(*file);
+    return index;
+}
+
+SeekIndex SeekIndex::fromXingToc(QByteArrayView bytes)
+{
+    const qint64 start = ContainerReader::id3v2Size(bytes);
+    const qint64 end = MpegFrameHeader::streamEnd(bytes, start);
+    const qint64 first = MpegFrameHeader::findFirst(bytes, start, end, kMpegSyncSearchBytes);
+    if (first < 0) {
+        return SeekIndex();
+    }
+    const MpegFrameHeader header = MpegFrameHeader::parse(bytes, first);
+    if (!MpegFrameHeader::isInfoFrame(bytes, first, header)) {
+        return SeekIndex();
+    }
+
+    // "Xing"/"Info", flags, then the fields the flags announce: frame
+    // count, stream bytes, 100 byte TOC
+    qint64 pos = first + header.sideInfoEnd() + 4;
+    if (pos + 4 > bytes.size()) {
+        return SeekIndex();
+    }
+    const quint32 flags = ContainerReader::be32(bytes, pos);
+    pos += 4;
+    quint32 frames = 0;
+    qint64 streamBytes = 0;
+    if (flags & 0x01) {
+        if (pos + 4 > bytes.size()) {
+            return SeekIndex();
+        }
+        frames = ContainerReader::be32(bytes, pos);
+        pos += 4;
+    }
+    if (flags & 0x02) {
+        if (pos + 4 > bytes.size()) {
+            return SeekIndex();
+        }
+        streamBytes = ContainerReader::be32(bytes, pos);
+        pos += 4;
+    }
+    if (!(flags & 0x04) || frames == 0 || pos + 100 > bytes.size()) {
+        return SeekIndex();
+    }
+    if (streamBytes <= 0 || streamBytes > end - first) {
+        streamBytes = end - first;
+    }
+
+    SeekIndex index;
+    index.m_source = Source::XingToc;
+    index.m_durationUs = qint64(frames) * header.samplesPerFrame * 1000000 / header.sampleRate;
+    index.m_audioStart = first + header.frameBytes;
+    index.m_audioEnd = end;
+
+    // Entry i: where i% of the duration starts, in 256ths of the stream
+    index.m_points.reserve(100);
+    for (int i = 0; i < 100; ++i) {
+        const qint64 offset = first + ContainerReader::u8(bytes, pos + i) * streamBytes / 256;
+        index.m_points.append({index.m_durationUs * i / 100, qMax(offset, index.m_audioStart)});
+    }
+    return index;
+}
+
+SeekIndex SeekIndex::fromFlacSeekTable(QByteArrayView bytes)
+{
+    qint64 pos = ContainerReader::id3v2Size(bytes) + 4;
+    quint32 sampleRate = 0;
+    quint64 totalSamples = 0;
+    QByteArrayView table;
+
+    bool last = false;
+    while (!last && pos + 4 <= bytes.size()) {
+        last = ContainerReader::u8(bytes, pos) & 0x80;
+        const int type = ContainerReader::u8(bytes, pos) & 0x7F;
+        const qint64 length = ContainerReader::be24(bytes, pos + 1);
+        pos += 4;
+        if (length > bytes.size() - pos) {
+            return SeekIndex();
+        }
+        const QByteArrayView block = bytes.sliced(pos, length);
+        pos += length;
+
+        if (type == 0 && block.size() >= 18) {
+            sampleRate = (ContainerReader::u8(block, 10) << 12)
+                       | (ContainerReader::u8(block, 11) << 4)
+                       | (ContainerReader::u8(block, 12) >> 4);
+            totalSamples = (quint64(ContainerReader::u8(block, 13) & 0x0F) << 32)
+                         | ContainerReader::be32(block, 14);
+        } else if (type == 3) {
+            table = block;
+        }
+    }
+    if (!last || sampleRate == 0 || table.isEmpty()) {
+        return SeekIndex();
+    }
+
+    // Seek point offsets count from the first frame, right after the
+    // last metadata block
+    SeekIndex index;
+    index.m_source = Source::FlacSeekTable;
+    index.m_durationUs = qint64(totalSamples * 1000000 / sampleRate);
+    index.m_audioStart = pos;
+    index.m_audioEnd = bytes.size();
+
+    constexpr qint64 kSeekPointBytes = 18;
+    constexpr quint64 kPlaceholder = ~quint64(0);
+    index.m_points.reserve(table.size() / kSeekPointBytes);
+    for (qint64 entry = 0; entry + kSeekPointBytes <= table.size(); entry += kSeekPointBytes) {
+        const quint64 sample = ContainerReader::be64(table, entry);
+        const quint64 offset = ContainerReader::be64(table, entry + 8);
+        if (sample == kPlaceholder || offset >= quint64(bytes.size() - pos)) {
+            continue;
+        }
+        index.m_points.append({qint64(sample * 1000000 / sampleRate), pos + qint64(offset)});
+    }
+    return index;
+}
+
+SeekIndex SeekIndex::fromMp4SampleTable(QByteArrayView bytes)
+{
+    const QByteArrayView moov = ContainerReader::findMp4Box(bytes, "moov");
+
+    // First audio track
+    QByteArrayView mdia;
+    qint64 pos = 0;
+    QByteArrayView type;
+    QByteArrayView trak;
+    while (ContainerReader::nextMp4Box(moov, pos, type, trak)) {
+        if (type != "trak") {
+            continue;
+        }
+        const QByteArrayView candidate = ContainerReader::findMp4Box(trak, "mdia");
+        const QByteArrayView hdlr = ContainerReader::findMp4Box(candidate, "hdlr");
+        if (hdlr.size() >= 12 && hdlr.sliced(8, 4) == "soun") {
+            mdia = candidate;
+            break;
+        }
+    }
+
+    const QByteArrayView mdhd = ContainerReader::findMp4Box(mdia, "mdhd");
+    const QByteArrayView stbl = ContainerReader::findMp4Box(ContainerReader::findMp4Box(mdia, "minf"), "stbl");
+    const QByteArrayView stts = ContainerReader::findMp4Box(stbl, "stts");
+    const QByteArrayView stsc = ContainerReader::findMp4Box(stbl, "stsc");
+    QByteArrayView chunks = ContainerReader::findMp4Box(stbl, "stco");
+    const bool wideOffsets = chunks.isEmpty();
+    if (wideOffsets) {
+        chunks = ContainerReader::findMp4Box(stbl, "co64");
+    }
+    if (mdhd.size() < 20 || stts.size() < 8 || stsc.size() < 8 || chunks.size() < 8) {
+        return SeekIndex();
+    }
+
+    // mdhd version 1 has 64 bit times and duration
+    const bool wide = ContainerReader::u8(mdhd, 0) == 1;
+    if (wide && mdhd.size() < 32) {
+        return SeekIndex();
+    }
+    const quint32 timescale = ContainerReader::be32(mdhd, wide ? 20 : 12);
+    const quint64 duration = wide ? ContainerReader::be64(mdhd, 24) : ContainerReader::be32(mdhd, 16);
+    if (timescale == 0) {
+        return SeekIndex();
+    }
+
+    // Full boxes: version and flags, entry count, entries
+    const qint64 sttsCount = qMin<qint64>(ContainerReader::be32(stts, 4), (stts.size() - 8) / 8);
+    const qint64 stscCount = qMin<qint64>(ContainerReader::be32(stsc, 4), (stsc.size() - 8) / 12);
+    const int offsetBytes = wideOffsets ? 8 : 4;
+    const qint64 chunkCount = qMin<qint64>(ContainerReader::be32(chunks, 4), (chunks.size() - 8) / offsetBytes);
+    if (sttsCount == 0 || stscCount == 0 || chunkCount == 0) {
+        return SeekIndex();
+    }
+
+    SeekIndex index;
+    index.m_source = Source::Mp4SampleTable;
+    index.m_durationUs = qint64(duration * 1000000 / timescale);
+    index.m_audioEnd = bytes.size();
+
+    // Walk chunks in order, tracking which stsc run they are in and the
+    // decode time of their first sample through stts
+    qint64 stscIndex = 0;
+    qint64 sttsIndex = 0;
+    quint64 sttsLeft = ContainerReader::be32(stts, 8);
+    quint64 time = 0;
+    for (qint64 chunk = 0; chunk < chunkCount; ++chunk) {
+        while (stscIndex + 1 < stscCount
+               && qint64(ContainerReader::be32(stsc, 8 + (stscIndex + 1) * 12)) - 1 <= chunk) {
+            ++stscIndex;
+        }
+        const quint32 samplesPerChunk = ContainerReader::be32(stsc, 8 + stscIndex * 12 + 4);
+        const qint64 offset = wideOffsets ? qint64(ContainerReader::be64(chunks, 8 + chunk * 8))
+                                          : qint64(ContainerReader::be32(chunks, 8 + chunk * 4));
+
+        const qint64 timeUs = qint64(time * 1000000 / timescale);
+        if (offset >= 0 && offset < bytes.size()
+            && (index.m_points.isEmpty() || timeUs - index.m_points.last().timeUs >= kMinMp4PointSpacingUs)) {
+            index.m_points.append({timeUs, offset});
+        }
+
+        quint64 samples = samplesPerChunk;
+        while (samples > 0 && sttsIndex < sttsCount) {
+            const quint64 take = qMin(samples, sttsLeft);
+            time += take * ContainerReader::be32(stts, 8 + sttsIndex * 8 + 4);
+            samples -= take;
+            sttsLeft -= take;
+            if (sttsLeft == 0 && ++sttsIndex < sttsCount) {
+                sttsLeft = ContainerReader::be32(stts, 8 + sttsIndex * 8);
+            }
+        }
+    }
+
+    if (!index.m_points.isEmpty()) {
+        index.m_audioStart = index.m_points.first().offset;
+    }
+    return index;
+}
+
+void SeekIndex::setFile(const MappedFile &file)
+{
+    m_fileSize = file.size();
+    m_fileModifiedMs = file.modified().toMSecsSinceEpoch();
+}
+
+// ========== Lookup ==========
+
+SeekIndex::Point SeekIndex::locate(qint64 timeUs, const MappedFilePtr &file) const
+{
+    if (!isValid()) {
+        return Point();
+    }
+    timeUs = qBound<qint64>(0, timeUs, qMax<qint64>(0, m_durationUs));
+
+    // Last point at or before timeUs
+    auto it = std::upper_bound(m_points.cbegin(), m_points.cend(), timeUs,
+                               [](qint64 time, const Point &point) { return time < point.timeUs; });
+    if (it != m_points.cbegin()) {
+        --it;
+    }
+    Point point = *it;
+    if (!isFrameAccurate() || !file || !matches(*file)) {
+        return point;
+    }
+
+    // Point i is frame i * kFramesPerPoint; step through the frame headers
+    // up to the frame that contains timeUs
+    const QByteArrayView bytes = file->bytes();
+    const qint64 frameUsNumerator = qint64(m_samplesPerFrame) * 1000000;
+    qint64 frame = qint64(it - m_points.cbegin()) * kFramesPerPoint;
+    const qint64 target = timeUs * m_sampleRate / frameUsNumerator;
+    while (frame < target) {
+        const MpegFrameHeader header = MpegFrameHeader::parse(bytes, point.offset);
+        const qint64 next = point.offset + header.frameBytes;
+        if (!header.isValid() || next >= m_audioEnd || !MpegFrameHeader::parse(bytes, next).isValid()) {
+            break;  // Damaged stream: the last good frame before it
+        }
+        point.offset = next;
+        ++frame;
+    }
+    point.timeUs = frame * frameUsNumerator / m_sampleRate;
+    return point;
+}
+
+bool SeekIndex::matches(const MappedFile &file) const
+{
+    return file.size() == m_fileSize && file.modified().toMSecsSinceEpoch() == m_fileModifiedMs;
+}
+
+// ========== Serialization ==========
+
+QByteArray SeekIndex::toData() const
+{
+    QByteArray data(kDataMagic, 4);
+    data.reserve(64 + m_points.size() * 4);
+    appendVarint(data, kDataVersion);
+    appendVarint(data, quint64(m_source));
+    appendVarint(data, quint64(m_fileSize));
+    appendVarint(data, zigzag(m_fileModifiedMs));
+    appendVarint(data, quint64(m_durationUs));
+    appendVarint(data, quint64(m_audioStart));
+    appendVarint(data, quint64(m_audioEnd));
+    appendVarint(data, quint64(m_sampleRate));
+    appendVarint(data, quint64(m_samplesPerFrame));
+    appendVarint(data, quint64(m_points.size()));
+
+    Point previous;
+    for (const Point &point : m_points) {
+        appendVarint(data, zigzag(point.timeUs - previous.timeUs));
+        appendVarint(data, zigzag(point.offset - previous.offset));
+        previous = point;
+    }
+    return data;
+}
+
+SeekIndex SeekIndex::fromData(const QByteArray &data)
+{
+    if (!data.startsWith(QByteArrayView(kDataMagic, 4))) {
+        return SeekIndex();
+    }
+
+    qint64 pos = 4;
+    quint64 fields[10];
+    for (quint64 &field : fields) {
+        if (!readVarint(data, pos, field)) {
+            return SeekIndex();
+        }
+    }
+    if (fields[0] != kDataVersion || fields[1] > quint64(Source::Mp4SampleTable)) {
+        return SeekIndex();
+    }
+
+    SeekIndex index;
+    index.m_source = Source(fields[1]);
+    index.m_fileSize = qint64(fields[2]);
+    index.m_fileModifiedMs = unzigzag(fields[3]);
+    index.m_durationUs = qint64(fields[4]);
+    index.m_audioStart = qint64(fields[5]);
+    index.m_audioEnd = qint64(fields[6]);
+    index.m_sampleRate = int(fields[7]);
+    index.m_samplesPerFrame = int(fields[8]);
+    const quint64 count = fields[9];
+    if (count > quint64(data.size()) || (index.isFrameAccurate() && index.m_sampleRate <= 0)) {
+        return SeekIndex();
+    }
+
+    index.m_points.reserve(qsizetype(count));
+    Point point;
+    for (quint64 i = 0; i < count; ++i) {
+        quint64 timeDelta = 0;
+        quint64 offsetDelta = 0;
+        if (!readVarint(data, pos, timeDelta) || !readVarint(data, pos, offsetDelta)) {
+            return SeekIndex();
+        }
+        point.timeUs += unzigzag(timeDelta);
+        point.offset += unzigzag(offsetDelta);
+        index.m_points.append(point);
+    }
+    return index;
+}
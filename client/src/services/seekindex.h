@@ -0,0 +1,103 @@
+#ifndef SEEKINDEX_H
+#define SEEKINDEX_H
+
+#include <QByteArray>
+#include <QList>
+#include <functional>
+#include <memory>
+#include "utils/mappedfile.h"
+
+class SeekIndex;
+using SeekIndexPtr = std::shared_ptr<const SeekIndex>;
+
+/**
+ * @brief Time to byte offset table of one audio file
+ *
+ * Built from what the file already carries where possible:
+ *  - MP3: the Xing/Info TOC (100 entries, so about 1% of the duration
+ *    apart); without one, or for frame accuracy, scanMpegFrames() walks
+ *    every frame header once and keeps the offset of every
+ *    kFramesPerPoint-th frame
+ *  - FLAC: the SEEKTABLE block
+ *  - MP4/M4A: the sample table (stbl) of the first audio track, one point
+ *    per chunk
+ *
+ * locate() returns the last point at or before a time. For a frame scan it
+ * then walks the (at most kFramesPerPoint - 1) frame headers from there,
+ * so the point it returns is the exact frame that contains the time.
+ *
+ * An index never changes after it is built and may be read from any
+ * thread; it stays valid for the file version it was built from (see
+ * matches()).
+ */
+class SeekIndex
+{
+public:
+    enum class Source {
+        None,
+        XingToc,
+        MpegFrames,
+        FlacSeekTable,
+        Mp4SampleTable
+    };
+
+    struct Point
+    {
+        qint64 timeUs = 0;
+        qint64 offset = 0;   // Absolute byte offset in the file
+    };
+
+    // Frames between two points of a frame scan (about 0.8 s at 44.1 kHz)
+    static constexpr int kFramesPerPoint = 32;
+
+    SeekIndex();
+
+    // Index from the tables stored in the file itself; None if it has none
+    static SeekIndex fromHeaders(const MappedFilePtr &file);
+    // Frame-accurate index of an MP3 file (reads every frame header);
+    // stops early, returning an invalid index, once canceled returns true
+    static SeekIndex scanMpegFrames(const MappedFilePtr &file,
+                                    const std::function<bool()> &canceled = {});
+    // Whether file is an MPEG audio stream scanMpegFrames() can index
+    static bool canScanFrames(const MappedFilePtr &file);
+
+    bool isValid() const { return m_source != Source::None && !m_points.isEmpty(); }
+    Source source() const { return m_source; }
+    // Whether locate() lands on the exact frame (a frame scan)
+    bool isFrameAccurate() const { return m_source == Source::MpegFrames; }
+
+    qint64 durationUs() const { return m_durationUs; }
+    qint64 audioStart() const { return m_audioStart; }
+    qint64 audioEnd() const { return m_audioEnd; }
+    const QList<Point> &points() const { return m_points; }
+
+    // Seek target for timeUs; needs the file the index was built from for
+    // frame-accurate lookups (without it, the closest stored point)
+    Point locate(qint64 timeUs, const MappedFilePtr &file = nullptr) const;
+
+    // Whether the index was built from this version of the file
+    bool matches(const MappedFile &file) const;
+
+    // Compact serialized form (delta-encoded points) for the on-disk
+    // cache; fromData() returns an invalid index for anything it can't read
+    QByteArray toData() const;
+    static SeekIndex fromData(const QByteArray &data);
+
+private:
+    static SeekIndex fromXingToc(QByteArrayView bytes);
+    static SeekIndex fromFlacSeekTable(QByteArrayView bytes);
+    static SeekIndex fromMp4SampleTable(QByteArrayView bytes);
+    void setFile(const MappedFile &file);
+
+    Source m_source;
+    QList<Point> m_points;
+    qint64 m_durationUs;
+    qint64 m_audioStart;
+    qint64 m_audioEnd;
+    qint64 m_fileSize;       // Version of the file the index is for
+    qint64 m_fileModifiedMs;
+    int m_sampleRate;        // Frame scans only: for walking frames in locate()
+    int m_samplesPerFrame;
+};
+
+#endif // SEEKINDEX_H
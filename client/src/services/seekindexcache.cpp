@@ -0,0 +1,144 @@
+#include "seekindexcache.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QPromise>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrentRun>
+#include <QDebug>
+
+namespace {
+// Memory budget for cached indexes; a frame index of a 3-hour MP3 takes
+// about 200 KiB
+constexpr int kMaxCachedKiB = 8 * 1024;
+}
+
+SeekIndexCache* SeekIndexCache::s_instance = nullptr;
+
+SeekIndexCache::SeekIndexCache(QObject *parent)
+    : QObject(parent)
+    , m_nextScanSerial(1)
+{
+    m_cache.setMaxCost(kMaxCachedKiB);
+
+    m_diskDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/seekindex";
+    QDir().mkpath(m_diskDirectory);
+}
+
+SeekIndexCache::~SeekIndexCache()
+{
+    for (Scan &scan : m_scans) {
+        scan.future.cancel();
+    }
+}
+
+SeekIndexCache* SeekIndexCache::instance()
+{
+    if (!s_instance) {
+        s_instance = new SeekIndexCache();
+    }
+    return s_instance;
+}
+
+// ========== Lookup ==========
+
+SeekIndexPtr SeekIndexCache::index(const QString &filePath)
+{
+    const MappedFilePtr file = MappedFile::open(filePath);
+    if (!file) {
+        return nullptr;
+    }
+
+    SeekIndexPtr index;
+    if (SeekIndexPtr *cached = m_cache.object(filePath); cached && (*cached)->matches(*file)) {
+        index = *cached;
+    }
+
+    // An earlier session may have scanned what only has a TOC in memory
+    if (!index || !index->isFrameAccurate()) {
+        QFile stored(diskPath(filePath));
+        if (stored.open(QIODevice::ReadOnly)) {
+            const SeekIndex loaded = SeekIndex::fromData(stored.readAll());
+            if (loaded.isValid() && loaded.matches(*file)) {
+                index = std::make_shared<const SeekIndex>(loaded);
+            }
+        }
+    }
+
+    if (!index) {
+        const SeekIndex fromHeaders = SeekIndex::fromHeaders(file);
+        if (fromHeaders.isValid()) {
+            index = std::make_shared<const SeekIndex>(fromHeaders);
+        }
+    }
+
+    if (index) {
+        insert(filePath, index);
+    }
+    if ((!index || !index->isFrameAccurate()) && SeekIndex::canScanFrames(file)) {
+        startScan(filePath, file);
+    }
+    return index;
+}
+
+void SeekIndexCache::insert(const QString &filePath, const SeekIndexPtr &index)
+{
+    const int cost = int(index->points().size() * sizeof(SeekIndex::Point) / 1024) + 1;
+    m_cache.insert(filePath, new SeekIndexPtr(index), cost);
+}
+
+// ========== Frame Scans ==========
+
+void SeekIndexCache::startScan(const QString &filePath, const MappedFilePtr &file)
+{
+    if (m_scans.contains(filePath)) {
+        return;
+    }
+
+    // Only the file being played needs its scan
+    for (auto it = m_scans.begin(); it != m_scans.end();) {
+        it.value().future.cancel();
+        it = m_scans.erase(it);
+    }
+
+    const QString diskPath = this->diskPath(filePath);
+    QFuture<SeekIndexPtr> scan = QtConcurrent::run([file, diskPath](QPromise<SeekIndexPtr> &promise) {
+        const SeekIndex index = SeekIndex::scanMpegFrames(file, [&promise]() {
+            return promise.isCanceled();
+        });
+        if (!index.isValid()) {
+            return;
+        }
+
+        // Stored off the GUI thread, where the index was built anyway
+        QSaveFile stored(diskPath);
+        if (stored.open(QIODevice::WriteOnly)) {
+            stored.write(index.toData());
+            if (!stored.commit()) {
+                qWarning() << "SeekIndexCache: cannot store" << diskPath << stored.errorString();
+            }
+        }
+        promise.addResult(std::make_shared<const SeekIndex>(index));
+    });
+    const quint64 serial = m_nextScanSerial++;
+    m_scans.insert(filePath, Scan{scan, serial});
+
+    scan.then(this, [this, filePath, serial](QFuture<SeekIndexPtr> finished) {
+        // A canceled scan was already dropped, maybe replaced by a new one
+        if (m_scans.value(filePath).serial == serial) {
+            m_scans.remove(filePath);
+        }
+        if (finished.isCanceled() || finished.resultCount() == 0) {
+            return;
+        }
+        insert(filePath, finished.result());
+        emit indexReady(filePath);
+    });
+}
+
+QString SeekIndexCache::diskPath(const QString &filePath) const
+{
+    const QByteArray key = QCryptographicHash::hash(filePath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return m_diskDirectory + "/" + QString::fromLatin1(key) + ".idx";
+}
@@ -0,0 +1,61 @@
+#ifndef SEEKINDEXCACHE_H
+#define SEEKINDEXCACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QFuture>
+#include <QHash>
+#include <QString>
+#include "seekindex.h"
+
+/**
+ * @brief Seek indexes of recently played files, in memory and on disk
+ *
+ * index() answers at once with the best index known for a file: a cached
+ * one, else the one stored on disk by an earlier session, else one built
+ * from the file's own tables (SeekIndex::fromHeaders()). MP3 files whose
+ * index is not frame-accurate get a frame scan in the background;
+ * indexReady() announces the result, which is also written to the disk
+ * cache so no file is scanned twice. Only the latest file asked for is
+ * scanned: starting a scan cancels the others.
+ *
+ * Must be used on the GUI thread.
+ */
+class SeekIndexCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SeekIndexCache* instance();
+
+    // Best index for filePath right now; nullptr if there is none (yet)
+    SeekIndexPtr index(const QString &filePath);
+
+signals:
+    void indexReady(const QString &filePath);
+
+private:
+    explicit SeekIndexCache(QObject *parent = nullptr);
+    ~SeekIndexCache();
+    SeekIndexCache(const SeekIndexCache&) = delete;
+    SeekIndexCache& operator=(const SeekIndexCache&) = delete;
+
+    struct Scan
+    {
+        QFuture<SeekIndexPtr> future;
+        quint64 serial = 0;
+    };
+
+    void insert(const QString &filePath, const SeekIndexPtr &index);
+    void startScan(const QString &filePath, const MappedFilePtr &file);
+    QString diskPath(const QString &filePath) const;
+
+    static SeekIndexCache *s_instance;
+
+    QCache<QString, SeekIndexPtr> m_cache;          // Cost: KiB of points
+    QHash<QString, Scan> m_scans;                   // Frame scans in flight
+    quint64 m_nextScanSerial;
+    QString m_diskDirectory;
+};
+
+#endif // SEEKINDEXCACHE_H
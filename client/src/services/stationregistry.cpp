@@ -0,0 +1,182 @@
+#include "stationregistry.h"
+#include "config/appconfig.h"
+#include "utils/jsonpullreader.h"
+#include "utils/metrics.h"
+#include "utils/networkfuture.h"
+#include <QNetworkReply>
+#include <QSettings>
+#include <QSet>
+#include <QDebug>
+
+StationRegistry* StationRegistry::s_instance = nullptr;
+
+StationRegistry::StationRegistry(QObject *parent)
+    : QObject(parent)
+    , m_networkManager(new QNetworkAccessManager(this))
+    , m_discoveryStarted(false)
+{
+    loadBuiltInStations();
+    loadConfiguredStations();
+
+    qDebug() << "StationRegistry initialized with" << m_stations.size() << "stations";
+}
+
+StationRegistry::~StationRegistry()
+{
+}
+
+StationRegistry* StationRegistry::instance()
+{
+    if (!s_instance) {
+        s_instance = new StationRegistry();
+    }
+    return s_instance;
+}
+
+void StationRegistry::loadBuiltInStations()
+{
+    RadioStation intercom;
+    intercom.id = "eknm_intercom";
+    intercom.name = "EKNM Intercom";
+    intercom.baseUrl = "https://radio.eknm.in";
+    intercom.streamUrl = "https://radio.eknm.in/listen/eknm_intercom/radio.mp3";
+    intercom.publicPageUrl = "https://radio.eknm.in/public/eknm_intercom";
+    m_stations.append(intercom);
+}
+
+void StationRegistry::loadConfiguredStations()
+{
+    QSettings settings(AppConfig::ORGANIZATION_NAME, AppConfig::APP_NAME);
+
+    int count = settings.beginReadArray("radio/stations");
+    for (int i = 0; i < count; ++i) {
+        settings.setArrayIndex(i);
+
+        RadioStation station;
+        station.id = settings.value("id").toString();
+        station.name = settings.value("name", station.id).toString();
+        station.baseUrl = settings.value("base_url").toString();
+        station.streamUrl = settings.value("stream_url").toString();
+        station.publicPageUrl = settings.value("public_url").toString();
+
+        if (station.streamUrl.isEmpty()) {
+            station.streamUrl = QString("%1/listen/%2/radio.mp3").arg(station.baseUrl, station.id);
+        }
+        if (station.publicPageUrl.isEmpty()) {
+            station.publicPageUrl = QString("%1/public/%2").arg(station.baseUrl, station.id);
+        }
+
+        if (station.isValid()) {
+            addStation(station);
+        } else {
+            qWarning() << "Ignoring invalid configured radio station at index" << i;
+        }
+    }
+    settings.endArray();
+}
+
+RadioStation StationRegistry::station(const QString &stationId) const
+{
+    for (const RadioStation &station : m_stations) {
+        if (station.id == stationId) {
+            return station;
+        }
+    }
+    return RadioStation();
+}
+
+bool StationRegistry::contains(const QString &stationId) const
+{
+    return station(stationId).isValid();
+}
+
+QString StationRegistry::defaultStationId() const
+{
+    return m_stations.isEmpty() ? QString() : m_stations.first().id;
+}
+
+bool StationRegistry::addStation(const RadioStation &station)
+{
+    if (!station.isValid() || contains(station.id)) {
+        return false;
+    }
+
+    m_stations.append(station);
+    emit stationAdded(station);
+    return true;
+}
+
+// ========== Discovery ==========
+
+void StationRegistry::discoverStations()
+{
+    // Stations don't come and go during a session; once is enough
+    if (m_discoveryStarted) {
+        return;
+    }
+    m_discoveryStarted = true;
+
+    QSet<QString> hosts;
+    for (const RadioStation &station : m_stations) {
+        hosts.insert(station.baseUrl);
+    }
+    for (const QString &host : hosts) {
+        discoverHost(host);
+    }
+}
+
+QFuture<int> StationRegistry::discoverHost(const QString &baseUrl)
+{
+    QNetworkRequest request(QUrl(baseUrl + "/api/stations"));
+    request.setHeader(QNetworkRequest::UserAgentHeader, "EKNMusic/1.0");
+
+    QNetworkReply *reply = m_networkManager->get(request);
+    EKNM_METRIC_HTTP(reply);
+    return NetworkFuture::fromReply(reply, this, [this, baseUrl](QNetworkReply *reply) {
+        if (reply->error() != QNetworkReply::NoError) {
+            qWarning() << "Station discovery failed for" << baseUrl << ":" << reply->errorString();
+            return 0;
+        }
+
+        const QByteArray body = reply->readAll();
+        JsonPullReader reader(body);
+        if (!reader.enterArray()) {
+            return 0;
+        }
+
+        int added = 0;
+        while (reader.nextElement()) {
+            if (!reader.enterObject()) {
+                continue;
+            }
+
+            RadioStation station;
+            station.baseUrl = baseUrl;
+            bool isPublic = true;
+
+            QByteArrayView key;
+            while (reader.nextKey(key)) {
+                if (key == "shortcode") {
+                    station.id = reader.readString();
+                } else if (key == "name") {
+                    station.name = reader.readString();
+                } else if (key == "listen_url") {
+                    station.streamUrl = reader.readString();
+                } else if (key == "public_player_url") {
+                    station.publicPageUrl = reader.readString();
+                } else if (key == "is_public") {
+                    isPublic = reader.readBool(true);
+                } else {
+                    reader.skipValue();
+                }
+            }
+
+            if (isPublic && !station.streamUrl.isEmpty() && addStation(station)) {
+                ++added;
+            }
+        }
+
+        qDebug() << "Discovered" << added << "new stations on" << baseUrl;
+        return added;
+    });
+}
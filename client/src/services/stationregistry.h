@@ -0,0 +1,57 @@
+#ifndef STATIONREGISTRY_H
+#define STATIONREGISTRY_H
+
+#include <QObject>
+#include <QList>
+#include <QFuture>
+#include <QNetworkAccessManager>
+#include "models/radiostation.h"
+
+/**
+ * @brief Known radio stations
+ *
+ * Starts with the built-in EKNM station plus any stations stored in
+ * settings ("radio/stations"), and can discover the other public
+ * stations of each known AzuraCast host via /api/stations. Order is
+ * stable: built-in first, then settings, then discovered stations.
+ */
+class StationRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    static StationRegistry* instance();
+
+    QList<RadioStation> stations() const { return m_stations; }
+    RadioStation station(const QString &stationId) const;
+    bool contains(const QString &stationId) const;
+    QString defaultStationId() const;
+
+    // Add a station (ignored if the id is already known)
+    bool addStation(const RadioStation &station);
+
+    // Ask every known host for its public stations
+    void discoverStations();
+
+signals:
+    void stationAdded(const RadioStation &station);
+
+private:
+    explicit StationRegistry(QObject *parent = nullptr);
+    ~StationRegistry();
+    StationRegistry(const StationRegistry&) = delete;
+    StationRegistry& operator=(const StationRegistry&) = delete;
+
+    void loadBuiltInStations();
+    void loadConfiguredStations();
+    // Number of stations added from the host
+    QFuture<int> discoverHost(const QString &baseUrl);
+
+    static StationRegistry *s_instance;
+
+    QNetworkAccessManager *m_networkManager;
+    QList<RadioStation> m_stations;
+    bool m_discoveryStarted;
+};
+
+#endif // STATIONREGISTRY_H
@@ -0,0 +1,99 @@
+#include "streamsourcedevice.h"
+#include <QMutexLocker>
+#include <QThread>
+#include <cstring>
+
+namespace {
+// Long enough to cover a quick reconnect, short enough that stop() is never stuck on it
+constexpr unsigned long kReadWaitMs = 250;
+// Compact the buffer once this much has been consumed
+constexpr qsizetype kCompactThreshold = 64 * 1024;
+}
+
+StreamSourceDevice::StreamSourceDevice(QObject *parent)
+    : QIODevice(parent)
+    , m_readPos(0)
+    , m_finished(false)
+{
+    open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+void StreamSourceDevice::appendData(const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_data.append(data);
+    }
+    m_dataAvailable.wakeAll();
+    emit readyRead();
+}
+
+void StreamSourceDevice::finish()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_finished = true;
+    }
+    m_dataAvailable.wakeAll();
+}
+
+void StreamSourceDevice::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_data.clear();
+    m_readPos = 0;
+    m_finished = false;
+}
+
+qint64 StreamSourceDevice::bufferedBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_data.size() - m_readPos;
+}
+
+qint64 StreamSourceDevice::bytesAvailable() const
+{
+    return bufferedBytes() + QIODevice::bytesAvailable();
+}
+
+bool StreamSourceDevice::atEnd() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_finished && m_readPos >= m_data.size();
+}
+
+qint64 StreamSourceDevice::readData(char *data, qint64 maxSize)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Only block on a worker thread; the network side appends from ours
+    if (m_readPos >= m_data.size() && !m_finished && QThread::currentThread() != thread()) {
+        m_dataAvailable.wait(&m_mutex, kReadWaitMs);
+    }
+
+    qint64 available = m_data.size() - m_readPos;
+    if (available <= 0) {
+        return m_finished ? -1 : 0;
+    }
+
+    qint64 count = qMin(maxSize, available);
+    std::memcpy(data, m_data.constData() + m_readPos, count);
+    m_readPos += count;
+
+    if (m_readPos >= kCompactThreshold) {
+        m_data.remove(0, m_readPos);
+        m_readPos = 0;
+    }
+    return count;
+}
+
+qint64 StreamSourceDevice::writeData(const char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1; // Use appendData()
+}
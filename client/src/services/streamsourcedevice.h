@@ -0,0 +1,49 @@
+#ifndef STREAMSOURCEDEVICE_H
+#define STREAMSOURCEDEVICE_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QMutex>
+#include <QWaitCondition>
+
+/**
+ * @brief Sequential device that feeds compressed network audio to QAudioDecoder
+ *
+ * The network side appends bytes with appendData(); the decoder reads
+ * them. Because a live stream is never "at end" while it is playing, a
+ * read that finds the device empty waits briefly for more data when it
+ * happens on the decoder's worker thread, instead of reporting EOF. This
+ * is what lets the decoder ride through a reconnect untouched.
+ */
+class StreamSourceDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit StreamSourceDevice(QObject *parent = nullptr);
+
+    // Network side
+    void appendData(const QByteArray &data);
+    void finish();   // No more data will arrive; reads drain and then hit EOF
+    void reset();    // Drop buffered data and reopen for a new stream
+
+    qint64 bufferedBytes() const;
+
+    // QIODevice
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+    bool atEnd() const override;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    mutable QMutex m_mutex;
+    QWaitCondition m_dataAvailable;
+    QByteArray m_data;
+    qsizetype m_readPos;
+    bool m_finished;
+};
+
+#endif // STREAMSOURCEDEVICE_H
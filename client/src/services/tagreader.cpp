@@ -0,0 +1,527 @@
+#include "tagreader.h"
+#include "utils/containerreader.h"
+#include "utils/mpegframeheader.h"
+#include <QStringDecoder>
+
+namespace {
+// How far past the ID3v2 tag the first MPEG frame is looked for
+constexpr qint64 kMpegSyncSearchBytes = 64 * 1024;
+// ID3v1 tag at the end of an MP3 file
+constexpr qint64 kId3v1Size = 128;
+// APIC / PICTURE type of the front cover, preferred over any other image
+constexpr int kFrontCoverType = 3;
+}
+
+// ========== Entry Points ==========
+
+TagInfo TagReader::read(const QString &filePath)
+{
+    return read(MappedFile::open(filePath));
+}
+
+TagInfo TagReader::read(const MappedFilePtr &file)
+{
+    if (!file || file->isEmpty()) {
+        return TagInfo();
+    }
+
+    // Tags are looked up, not streamed; don't make the kernel read ahead
+    // through the audio data
+    file->advise(MappedFile::Access::Random);
+
+    TagInfo info;
+    info.file = file;
+    const QByteArrayView bytes = file->bytes();
+
+    if (readFlac(bytes, info) || readMp4(bytes, info) || readMp3(bytes, info)) {
+        return info;
+    }
+    return TagInfo();
+}
+
+// ========== MP3 ==========
+
+bool TagReader::readMp3(QByteArrayView bytes, TagInfo &info)
+{
+    const qint64 audioStart = readId3v2(bytes, info);
+    if (audioStart == 0 && !MpegFrameHeader::parse(bytes, 0).isValid()) {
+        return false;  // Neither a tag nor a frame: not an MP3 file
+    }
+    info.format = TagInfo::Format::Mp3;
+
+    if (info.title.isEmpty()) {
+        readId3v1(bytes, info);
+    }
+    if (info.durationMs <= 0) {
+        info.durationMs = estimateMpegDuration(bytes, audioStart);
+    }
+    return true;
+}
+
+qint64 TagReader::readId3v2(QByteArrayView bytes, TagInfo &info)
+{
+    const qint64 tagSize = ContainerReader::id3v2Size(bytes);
+    if (tagSize == 0) {
+        return 0;
+    }
+
+    const int major = ContainerReader::u8(bytes, 3);
+    const int flags = ContainerReader::u8(bytes, 5);
+    if (major < 2 || major > 4 || (major == 2 && (flags & 0x40))) {
+        return tagSize;  // Unknown version, or a compressed v2.2 tag
+    }
+
+    QByteArrayView tag = bytes.sliced(10, qMin(tagSize, bytes.size()) - 10);
+    if (major < 4 && (flags & 0x80)) {
+        // Unsynchronised before v2.4 means the whole tag; v2.4 flags it
+        // per frame instead
+        info.storage = removeUnsynchronisation(tag);
+        tag = info.storage;
+    }
+
+    qint64 pos = 0;
+    if (major >= 3 && (flags & 0x40) && tag.size() >= 4) {
+        // Extended header: v2.3 size excludes its own size field
+        pos = major == 3 ? qint64(ContainerReader::be32(tag, 0)) + 4
+                         : qint64(ContainerReader::syncsafe32(tag, 0));
+    }
+
+    const int idBytes = major == 2 ? 3 : 4;
+    const int headerBytes = major == 2 ? 6 : 10;
+    bool frontCover = false;
+
+    while (pos + headerBytes <= tag.size()) {
+        if (tag[pos] == '\0') {
+            break;  // Padding
+        }
+        const QByteArrayView id = tag.sliced(pos, idBytes);
+        const qint64 frameSize = major == 2 ? ContainerReader::be24(tag, pos + 3)
+                               : major == 3 ? ContainerReader::be32(tag, pos + 4)
+                                            : ContainerReader::syncsafe32(tag, pos + 4);
+        const int frameFlags = major == 2 ? 0 : int(ContainerReader::u8(tag, pos + 9));
+        pos += headerBytes;
+        if (frameSize <= 0 || frameSize > tag.size() - pos) {
+            break;
+        }
+        QByteArrayView body = tag.sliced(pos, frameSize);
+        pos += frameSize;
+
+        bool unsynchronised = false;
+        if (major == 3) {
+            if (frameFlags & 0xC0) {
+                continue;  // Compressed or encrypted
+            }
+            if (frameFlags & 0x20) {
+                body = body.sliced(qMin<qint64>(1, body.size()));  // Group id
+            }
+        } else if (major == 4) {
+            if (frameFlags & 0x0C) {
+                continue;  // Compressed or encrypted
+            }
+            if (frameFlags & 0x40) {
+                body = body.sliced(qMin<qint64>(1, body.size()));  // Group id
+            }
+            if (frameFlags & 0x01) {
+                body = body.sliced(qMin<qint64>(4, body.size()));  // Data length
+            }
+            unsynchronised = frameFlags & 0x02;
+        }
+
+        if (unsynchronised) {
+            const QByteArray decoded = removeUnsynchronisation(body);
+            const char *coverBefore = info.cover.data();
+            readId3v2Frame(id, decoded, info, frontCover);
+            if (info.cover.data() != coverBefore) {
+                info.storage = decoded;  // Shares the bytes cover points to
+            }
+        } else {
+            readId3v2Frame(id, body, info, frontCover);
+        }
+    }
+
+    return tagSize;
+}
+
+void TagReader::readId3v2Frame(QByteArrayView id, QByteArrayView body, TagInfo &info,
+                               bool &frontCover)
+{
+    if (body.isEmpty()) {
+        return;
+    }
+    const int encoding = ContainerReader::u8(body, 0);
+
+    if (id == "TIT2" || id == "TT2") {
+        info.title = decodeId3Text(body.sliced(1), encoding);
+    } else if (id == "TPE1" || id == "TP1") {
+        info.artist = decodeId3Text(body.sliced(1), encoding);
+    } else if (id == "TPE2" || id == "TP2") {
+        info.albumArtist = decodeId3Text(body.sliced(1), encoding);
+    } else if (id == "TALB" || id == "TAL") {
+        info.album = decodeId3Text(body.sliced(1), encoding);
+    } else if (id == "TLEN" || id == "TLE") {
+        info.durationMs = decodeId3Text(body.sliced(1), encoding).toLongLong();
+    } else if ((id == "APIC" || id == "PIC") && !frontCover) {
+        // APIC: encoding, MIME type, picture type, description, data;
+        // v2.2 PIC has a three letter image format instead of the MIME type
+        qint64 pos = 1;
+        QByteArray mimeType;
+        if (id == "APIC") {
+            const qint64 end = body.indexOf('\0', pos);
+            if (end < 0) {
+                return;
+            }
+            mimeType = body.sliced(pos, end - pos).toByteArray().toLower();
+            pos = end + 1;
+        } else {
+            if (body.size() < 4) {
+                return;
+            }
+            const QByteArray format = body.sliced(1, 3).toByteArray().toUpper();
+            mimeType = format == "PNG" ? "image/png" : format == "JPG" ? "image/jpeg" : QByteArray();
+            pos = 4;
+        }
+        if (pos >= body.size()) {
+            return;
+        }
+        const int pictureType = ContainerReader::u8(body, pos++);
+
+        // Description, terminated by one null byte or, in UTF-16, two
+        // aligned ones
+        const bool wide = encoding == 1 || encoding == 2;
+        while (pos < body.size()) {
+            if (wide) {
+                if (pos + 1 >= body.size()) {
+                    return;
+                }
+                pos += 2;
+                if (body[pos - 2] == '\0' && body[pos - 1] == '\0') {
+                    break;
+                }
+            } else if (body[pos++] == '\0') {
+                break;
+            }
+        }
+        if (pos >= body.size()) {
+            return;
+        }
+
+        if (info.cover.isEmpty() || pictureType == kFrontCoverType) {
+            info.cover = body.sliced(pos);
+            info.coverMimeType = mimeType;
+            frontCover = pictureType == kFrontCoverType;
+        }
+    }
+}
+
+void TagReader::readId3v1(QByteArrayView bytes, TagInfo &info)
+{
+    if (bytes.size() < kId3v1Size) {
+        return;
+    }
+    const QByteArrayView tag = bytes.sliced(bytes.size() - kId3v1Size);
+    if (!tag.startsWith("TAG")) {
+        return;
+    }
+
+    // Fixed 30 byte Latin-1 fields, null or space padded
+    auto field = [&tag](qint64 offset) {
+        QByteArrayView text = tag.sliced(offset, 30);
+        const qint64 end = text.indexOf('\0');
+        return QString::fromLatin1(end < 0 ? text : text.first(end)).trimmed();
+    };
+    info.title = field(3);
+    if (info.artist.isEmpty()) {
+        info.artist = field(33);
+    }
+    if (info.album.isEmpty()) {
+        info.album = field(63);
+    }
+}
+
+qint64 TagReader::estimateMpegDuration(QByteArrayView bytes, qint64 audioStart)
+{
+    const qint64 audioEnd = MpegFrameHeader::streamEnd(bytes, audioStart);
+    const qint64 first = MpegFrameHeader::findFirst(bytes, audioStart, audioEnd, kMpegSyncSearchBytes);
+    if (first < 0) {
+        return 0;
+    }
+    MpegFrameHeader header = MpegFrameHeader::parse(bytes, first);
+
+    // VBR encoders announce the frame count in their first frame, whose own
+    // bitrate says nothing about the rest of the stream
+    const qint64 frames = MpegFrameHeader::announcedFrames(bytes, first, header);
+    if (frames > 0) {
+        return frames * header.samplesPerFrame * 1000 / header.sampleRate;
+    }
+
+    // Only constant bitrate streams are left: a header without a frame
+    // count ("Info" with no fields) is skipped, the first audio frame counts
+    qint64 audio = first;
+    if (MpegFrameHeader::isInfoFrame(bytes, first, header)) {
+        audio = first + header.frameBytes;
+        header = MpegFrameHeader::parse(bytes, audio);
+        if (!header.isValid()) {
+            return 0;
+        }
+    }
+    return (audioEnd - audio) * 8 / header.bitrateKbps;
+}
+
+// ========== FLAC ==========
+
+bool TagReader::readFlac(QByteArrayView bytes, TagInfo &info)
+{
+    // Some taggers put an ID3v2 tag in front of the stream marker
+    qint64 pos = ContainerReader::id3v2Size(bytes);
+    if (pos + 4 > bytes.size() || bytes.sliced(pos, 4) != "fLaC") {
+        return false;
+    }
+    info.format = TagInfo::Format::Flac;
+    pos += 4;
+
+    bool last = false;
+    bool frontCover = false;
+    while (!last && pos + 4 <= bytes.size()) {
+        last = ContainerReader::u8(bytes, pos) & 0x80;
+        const int type = ContainerReader::u8(bytes, pos) & 0x7F;
+        const qint64 length = ContainerReader::be24(bytes, pos + 1);
+        pos += 4;
+        if (length > bytes.size() - pos) {
+            break;
+        }
+        const QByteArrayView block = bytes.sliced(pos, length);
+        pos += length;
+
+        if (type == 0 && block.size() >= 18) {
+            // STREAMINFO: 20 bit sample rate, then 36 bit total sample count
+            const quint32 sampleRate = (ContainerReader::u8(block, 10) << 12)
+                                     | (ContainerReader::u8(block, 11) << 4)
+                                     | (ContainerReader::u8(block, 12) >> 4);
+            const quint64 totalSamples = (quint64(ContainerReader::u8(block, 13) & 0x0F) << 32)
+                                       | ContainerReader::be32(block, 14);
+            if (sampleRate > 0) {
+                info.durationMs = qint64(totalSamples * 1000 / sampleRate);
+            }
+        } else if (type == 4) {
+            readVorbisComment(block, info);
+        } else if (type == 6) {
+            readFlacPicture(block, info, frontCover);
+        }
+    }
+    return true;
+}
+
+void TagReader::readVorbisComment(QByteArrayView block, TagInfo &info)
+{
+    // Little-endian, unlike the rest of FLAC: vendor string, then
+    // "KEY=value" UTF-8 fields
+    if (block.size() < 8) {
+        return;
+    }
+    qint64 pos = 4 + qint64(ContainerReader::le32(block, 0));
+    if (pos + 4 > block.size()) {
+        return;
+    }
+    const quint32 count = ContainerReader::le32(block, pos);
+    pos += 4;
+
+    for (quint32 i = 0; i < count && pos + 4 <= block.size(); ++i) {
+        const qint64 length = ContainerReader::le32(block, pos);
+        pos += 4;
+        if (length > block.size() - pos) {
+            return;
+        }
+        const QByteArrayView field = block.sliced(pos, length);
+        pos += length;
+
+        const qint64 equals = field.indexOf('=');
+        if (equals <= 0) {
+            continue;
+        }
+        const QByteArrayView key = field.first(equals);
+        const QByteArrayView value = field.sliced(equals + 1);
+
+        QString *target = nullptr;
+        if (key.compare("TITLE", Qt::CaseInsensitive) == 0) {
+            target = &info.title;
+        } else if (key.compare("ARTIST", Qt::CaseInsensitive) == 0) {
+            target = &info.artist;
+        } else if (key.compare("ALBUMARTIST", Qt::CaseInsensitive) == 0) {
+            target = &info.albumArtist;
+        } else if (key.compare("ALBUM", Qt::CaseInsensitive) == 0) {
+            target = &info.album;
+        }
+        // Fields may repeat; the first one wins
+        if (target && target->isEmpty()) {
+            *target = QString::fromUtf8(value);
+        }
+    }
+}
+
+void TagReader::readFlacPicture(QByteArrayView block, TagInfo &info, bool &frontCover)
+{
+    if (frontCover || block.size() < 8) {
+        return;
+    }
+
+    // Big-endian: type, MIME type, description, width, height, depth,
+    // palette size, data
+    const int pictureType = int(ContainerReader::be32(block, 0));
+    qint64 pos = 4;
+    const qint64 mimeLength = ContainerReader::be32(block, pos);
+    pos += 4;
+    if (mimeLength > block.size() - pos - 4) {
+        return;
+    }
+    const QByteArrayView mimeType = block.sliced(pos, mimeLength);
+    pos += mimeLength;
+    const qint64 descriptionLength = ContainerReader::be32(block, pos);
+    pos += 4 + descriptionLength + 16;
+    if (pos + 4 > block.size()) {
+        return;
+    }
+    const qint64 dataLength = ContainerReader::be32(block, pos);
+    pos += 4;
+    if (dataLength == 0 || dataLength > block.size() - pos) {
+        return;
+    }
+
+    if (info.cover.isEmpty() || pictureType == kFrontCoverType) {
+        info.cover = block.sliced(pos, dataLength);
+        info.coverMimeType = mimeType.toByteArray().toLower();
+        frontCover = pictureType == kFrontCoverType;
+    }
+}
+
+// ========== MP4 ==========
+
+bool TagReader::readMp4(QByteArrayView bytes, TagInfo &info)
+{
+    if (bytes.size() < 12 || bytes.sliced(4, 4) != "ftyp") {
+        return false;
+    }
+    info.format = TagInfo::Format::Mp4;
+    readMp4Boxes(bytes, info);
+    return true;
+}
+
+void TagReader::readMp4Boxes(QByteArrayView bytes, TagInfo &info)
+{
+    qint64 pos = 0;
+    QByteArrayView type;
+    QByteArrayView payload;
+    while (ContainerReader::nextMp4Box(bytes, pos, type, payload)) {
+        if (type == "moov" || type == "udta") {
+            readMp4Boxes(payload, info);
+        } else if (type == "meta") {
+            // A full box (version and flags first) in MP4, a plain box in
+            // QuickTime files, where the handler follows right away
+            const bool quickTime = payload.size() >= 8 && payload.sliced(4, 4) == "hdlr";
+            if (quickTime) {
+                readMp4Boxes(payload, info);
+            } else if (payload.size() > 4) {
+                readMp4Boxes(payload.sliced(4), info);
+            }
+        } else if (type == "mvhd" && !payload.isEmpty()) {
+            // Version 1 has 64 bit times and duration
+            const bool wide = ContainerReader::u8(payload, 0) == 1;
+            if (payload.size() < (wide ? 32 : 20)) {
+                continue;
+            }
+            const quint32 timescale = ContainerReader::be32(payload, wide ? 20 : 12);
+            const quint64 duration = wide ? ContainerReader::be64(payload, 24)
+                                          : ContainerReader::be32(payload, 16);
+            if (timescale > 0) {
+                info.durationMs = qint64(duration * 1000 / timescale);
+            }
+        } else if (type == "ilst") {
+            qint64 itemPos = 0;
+            QByteArrayView itemType;
+            QByteArrayView item;
+            while (ContainerReader::nextMp4Box(payload, itemPos, itemType, item)) {
+                readMp4Item(itemType, item, info);
+            }
+        }
+    }
+}
+
+void TagReader::readMp4Item(QByteArrayView type, QByteArrayView item, TagInfo &info)
+{
+    // The value is in the item's first "data" box: type indicator, locale,
+    // then the value itself
+    qint64 pos = 0;
+    QByteArrayView childType;
+    QByteArrayView data;
+    while (ContainerReader::nextMp4Box(item, pos, childType, data)) {
+        if (childType == "data") {
+            break;
+        }
+        data = QByteArrayView();
+    }
+    if (data.size() < 8) {
+        return;
+    }
+    const quint32 indicator = ContainerReader::be32(data, 0) & 0x00FFFFFF;
+    const QByteArrayView value = data.sliced(8);
+
+    if (type == "\xA9" "nam") {
+        info.title = QString::fromUtf8(value);
+    } else if (type == "\xA9" "ART") {
+        info.artist = QString::fromUtf8(value);
+    } else if (type == "aART") {
+        info.albumArtist = QString::fromUtf8(value);
+    } else if (type == "\xA9" "alb") {
+        info.album = QString::fromUtf8(value);
+    } else if (type == "covr" && info.cover.isEmpty() && !value.isEmpty()) {
+        info.cover = value;
+        info.coverMimeType = indicator == 13 ? "image/jpeg" : indicator == 14 ? "image/png" : QByteArray();
+    }
+}
+
+// ========== Helpers ==========
+
+QString TagReader::decodeId3Text(QByteArrayView text, int encoding)
+{
+    // Only the first value of a multi-value (null separated) frame
+    if (encoding == 1 || encoding == 2) {
+        qint64 end = 0;
+        while (end + 1 < text.size() && (text[end] != '\0' || text[end + 1] != '\0')) {
+            end += 2;
+        }
+        text = text.first(qMin(end, text.size()));
+
+        // Encoding 1 starts with a byte order mark, 2 is big-endian
+        bool bigEndian = encoding == 2;
+        if (encoding == 1 && text.size() >= 2) {
+            if (ContainerReader::u8(text, 0) == 0xFE && ContainerReader::u8(text, 1) == 0xFF) {
+                bigEndian = true;
+                text = text.sliced(2);
+            } else if (ContainerReader::u8(text, 0) == 0xFF && ContainerReader::u8(text, 1) == 0xFE) {
+                text = text.sliced(2);
+            }
+        }
+        QStringDecoder decoder(bigEndian ? QStringConverter::Utf16BE : QStringConverter::Utf16LE);
+        const QString decoded = decoder.decode(text);
+        return decoded.trimmed();
+    }
+
+    const qint64 end = text.indexOf('\0');
+    if (end >= 0) {
+        text = text.first(end);
+    }
+    return (encoding == 3 ? QString::fromUtf8(text) : QString::fromLatin1(text)).trimmed();
+}
+
+QByteArray TagReader::removeUnsynchronisation(QByteArrayView data)
+{
+    // Writers insert a zero byte after every 0xFF; drop them again
+    QByteArray result;
+    result.reserve(data.size());
+    for (qint64 i = 0; i < data.size(); ++i) {
+        result.append(data[i]);
+        if (ContainerReader::u8(data, i) == 0xFF && i + 1 < data.size() && data[i + 1] == '\0') {
+            ++i;
+        }
+    }
+    return result;
+}
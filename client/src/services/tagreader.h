@@ -0,0 +1,85 @@
+#ifndef TAGREADER_H
+#define TAGREADER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include "utils/mappedfile.h"
+
+/**
+ * @brief Tags, duration and embedded cover of one audio file
+ *
+ * cover points into the file's mapping (or into storage for the rare tags
+ * that had to be decoded first), so it stays valid for as long as this
+ * TagInfo exists.
+ */
+struct TagInfo
+{
+    enum class Format {
+        Unknown,
+        Mp3,
+        Flac,
+        Mp4
+    };
+
+    Format format = Format::Unknown;
+    QString title;
+    QString artist;
+    QString albumArtist;
+    QString album;
+    qint64 durationMs = 0;       // 0 if the header does not tell
+    QByteArrayView cover;        // Encoded image, empty if the file has none
+    QByteArray coverMimeType;    // "image/jpeg", "image/png", ... when known
+
+    MappedFilePtr file;          // Keeps cover valid
+    QByteArray storage;          // Decoded copy cover points into, if any
+
+    bool isValid() const { return format != Format::Unknown; }
+};
+
+/**
+ * @brief Reads ID3v2 (MP3), FLAC and MP4/M4A tags straight from a mapping
+ *
+ * Headers and tags are parsed in place from MappedFile spans: text is
+ * decoded into the QStrings of TagInfo, everything else (the cover in
+ * particular) is referenced, not copied. The only exception are ID3v2
+ * tags written with unsynchronisation, which are decoded into a copy.
+ *
+ * Supported:
+ *  - MP3: ID3v2.2/2.3/2.4 title, artist, album artist, album, TLEN and
+ *    cover (APIC/PIC), ID3v1 as a fallback; duration from TLEN or, failing
+ *    that, estimated from the first MPEG frame's bitrate
+ *  - FLAC: STREAMINFO duration, VORBIS_COMMENT and PICTURE blocks
+ *  - MP4/M4A: mvhd duration and the iTunes ilst items
+ *
+ * read() returns an invalid TagInfo for anything else, and for files it
+ * cannot make sense of; callers fall back to the Qt Multimedia backend.
+ * Safe to call from any thread.
+ */
+class TagReader
+{
+public:
+    static TagInfo read(const QString &filePath);
+    static TagInfo read(const MappedFilePtr &file);
+
+private:
+    static bool readMp3(QByteArrayView bytes, TagInfo &info);
+    static qint64 readId3v2(QByteArrayView bytes, TagInfo &info);
+    static void readId3v2Frame(QByteArrayView id, QByteArrayView body, TagInfo &info,
+                               bool &frontCover);
+    static void readId3v1(QByteArrayView bytes, TagInfo &info);
+    static qint64 estimateMpegDuration(QByteArrayView bytes, qint64 audioStart);
+
+    static bool readFlac(QByteArrayView bytes, TagInfo &info);
+    static void readVorbisComment(QByteArrayView block, TagInfo &info);
+    static void readFlacPicture(QByteArrayView block, TagInfo &info, bool &frontCover);
+
+    static bool readMp4(QByteArrayView bytes, TagInfo &info);
+    static void readMp4Boxes(QByteArrayView bytes, TagInfo &info);
+    static void readMp4Item(QByteArrayView type, QByteArrayView item, TagInfo &info);
+
+    static QString decodeId3Text(QByteArrayView text, int encoding);
+    static QByteArray removeUnsynchronisation(QByteArrayView data);
+};
+
+#endif // TAGREADER_H
@@ -0,0 +1,85 @@
+#include "thumbnailcache.h"
+#include "utils/metrics.h"
+#include "utils/networkfuture.h"
+#include <QNetworkReply>
+#include <QDebug>
+
+namespace {
+// Thumbnails are tiny; this comfortably covers every row a radio page shows
+constexpr int kMaxCachedThumbnails = 64;
+}
+
+ThumbnailCache::ThumbnailCache(const QSize &size, QObject *parent)
+    : QObject(parent)
+    , m_networkManager(new QNetworkAccessManager(this))
+    , m_size(size)
+{
+    m_cache.setMaxCost(kMaxCachedThumbnails);
+}
+
+QPixmap ThumbnailCache::thumbnail(const QString &url)
+{
+    if (url.isEmpty()) {
+        return QPixmap();
+    }
+
+    if (QPixmap *pixmap = m_cache.object(url)) {
+        EKNM_METRIC_COUNT(ThumbnailHits, 1);
+        return *pixmap;
+    }
+
+    fetch(url);
+    return QPixmap();
+}
+
+QFuture<QPixmap> ThumbnailCache::load(const QString &url)
+{
+    if (!url.isEmpty()) {
+        if (QPixmap *pixmap = m_cache.object(url)) {
+            EKNM_METRIC_COUNT(ThumbnailHits, 1);
+            return QtFuture::makeReadyValueFuture(*pixmap);
+        }
+    }
+    return fetch(url);
+}
+
+QFuture<QPixmap> ThumbnailCache::fetch(const QString &url)
+{
+    if (url.isEmpty() || m_failed.contains(url)) {
+        return QtFuture::makeReadyValueFuture(QPixmap());
+    }
+    // A download some caller canceled is started again
+    const auto pending = m_pending.constFind(url);
+    if (pending != m_pending.constEnd() && !pending.value().isCanceled()) {
+        return pending.value();
+    }
+    EKNM_METRIC_COUNT(ThumbnailMisses, 1);
+
+    QNetworkRequest request{QUrl(url)};
+    request.setHeader(QNetworkRequest::UserAgentHeader, "EKNMusic/1.0");
+
+    QNetworkReply *reply = m_networkManager->get(request);
+    EKNM_METRIC_HTTP(reply);
+    const QFuture<QPixmap> future = NetworkFuture::fromReply(reply, this, [this, url](QNetworkReply *reply) {
+        m_pending.remove(url);
+
+        QPixmap pixmap;
+        if (reply->error() == QNetworkReply::NoError) {
+            pixmap.loadFromData(reply->readAll());
+        }
+
+        if (pixmap.isNull()) {
+            qWarning() << "Failed to load thumbnail:" << url << reply->errorString();
+            m_failed.insert(url);
+            return QPixmap();
+        }
+
+        const QPixmap scaled = pixmap.scaled(m_size, Qt::KeepAspectRatioByExpanding,
+                                             Qt::SmoothTransformation);
+        m_cache.insert(url, new QPixmap(scaled));
+        emit thumbnailReady(url);
+        return scaled;
+    });
+    m_pending.insert(url, future);
+    return future;
+}
@@ -0,0 +1,52 @@
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QPixmap>
+#include <QCache>
+#include <QFuture>
+#include <QHash>
+#include <QSet>
+#include <QSize>
+
+/**
+ * @brief Downloads and caches scaled album art thumbnails by URL
+ *
+ * thumbnail() returns the cached pixmap, or a null pixmap while the image
+ * is being fetched; thumbnailReady() fires once it arrives. Each URL is
+ * fetched at most once while it stays in the cache, and failed URLs are
+ * not retried.
+ *
+ * load() is the same lookup as a future: ready at once on a hit, shared by
+ * every caller while the download runs, a null pixmap on failure.
+ */
+class ThumbnailCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ThumbnailCache(const QSize &size, QObject *parent = nullptr);
+
+    // Cached thumbnail for url; starts a download on a miss
+    QPixmap thumbnail(const QString &url);
+    // Scaled thumbnail for url, downloading it on a miss
+    QFuture<QPixmap> load(const QString &url);
+    bool contains(const QString &url) const { return m_cache.contains(url); }
+
+    QSize thumbnailSize() const { return m_size; }
+
+signals:
+    void thumbnailReady(const QString &url);
+
+private:
+    QFuture<QPixmap> fetch(const QString &url);
+
+    QNetworkAccessManager *m_networkManager;
+    QSize m_size;
+    QCache<QString, QPixmap> m_cache;
+    QHash<QString, QFuture<QPixmap>> m_pending;  // Downloads in flight
+    QSet<QString> m_failed;
+};
+
+#endif // THUMBNAILCACHE_H
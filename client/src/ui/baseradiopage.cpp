@@ -1,7 +1,8 @@
 #include "baseradiopage.h"
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonArray>
+#include "radiosongdelegate.h"
+#include "services/thumbnailcache.h"
+#include "utils/metrics.h"
+#include "utils/networkfuture.h"
 #include <QDebug>
 #include <QGraphicsBlurEffect>
 #include <QGraphicsOpacityEffect>
@@ -15,13 +16,13 @@ BaseRadioPage::BaseRadioPage(RadioService *radioService, QWidget *parent)
     , updateTimer(new QTimer(this))
     , currentDuration(0)
     , currentElapsed(0)
-    , m_songOrderCounter(1)
 {
     setupUI();
     connectSignals();
 
-    // Update progress bar every second
-    updateTimer->setInterval(1000);
+    // Interpolate the progress bar from the stream clock four times a
+    // second; the time labels still only change once a second
+    updateTimer->setInterval(250);
     connect(updateTimer, &QTimer::timeout, this, &BaseRadioPage::updateProgressBar);
 }
 
@@ -45,6 +46,15 @@ void BaseRadioPage::resizeEvent(QResizeEvent *event)
     }
 }
 
+void BaseRadioPage::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+
+    // No point ticking the progress bar of a page nobody sees;
+    // loadRadioBackground() restarts it when the page is shown again
+    updateTimer->stop();
+}
+
 void BaseRadioPage::setupUI()
 {
     // Main widget layout
@@ -289,26 +299,28 @@ void BaseRadioPage::setupRightPanel(QHBoxLayout *mainLayout)
     );
     songListTitle->setAlignment(Qt::AlignCenter);
 
-    // Song list widget
-    songListWidget = new QListWidget(rightPanel);
-    songListWidget->setSpacing(0);
-    songListWidget->setUniformItemSizes(true);
-    songListWidget->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    songListWidget->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-
-    songListWidget->setStyleSheet(
-        "QListWidget { padding: 0; margin: 0; }"
-        "QListWidget::viewport { padding: 0; margin: 0; }"
-        "QListWidget::item {"
-        "   padding: 6px 10px;"
-        "   margin: 0;"
-        "   border-bottom: 1px solid #3a3a4a;"
-        "}"
+    // Song list (model/delegate; rows are diffed, not rebuilt)
+    ThumbnailCache *thumbnails = new ThumbnailCache(
+        QSize(RadioSongDelegate::kThumbnailSize, RadioSongDelegate::kThumbnailSize), this);
+    m_songListModel = new RadioSongListModel(thumbnails, this);
+
+    songListView = new QListView(rightPanel);
+    songListView->setModel(m_songListModel);
+    songListView->setItemDelegate(new RadioSongDelegate(songListView));
+    songListView->setSpacing(0);
+    songListView->setUniformItemSizes(true);
+    songListView->setSelectionMode(QAbstractItemView::NoSelection);
+    songListView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    songListView->setFocusPolicy(Qt::NoFocus);
+    songListView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    songListView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+
+    songListView->setStyleSheet(
+        "QListView { padding: 0; margin: 0; background: transparent; border: none; }"
     );
 
-
     rightLayout->addWidget(songListTitle);
-    rightLayout->addWidget(songListWidget);
+    rightLayout->addWidget(songListView);
 
     mainLayout->addWidget(rightPanel, 1);
 }
@@ -318,108 +330,128 @@ void BaseRadioPage::loadRadioBackground()
     // Set station title now that the derived class is fully constructed
     stationTitle->setText(getStationName());
 
-    // Start fetching now playing data
-    m_radioService->fetchNowPlaying();
-
-    // Fetch song history and queue
-    m_radioService->fetchSongHistory(5);
-    m_radioService->fetchQueue();
+    // Subscribe to live now playing updates (no-op if already subscribed)
+    m_radioService->startNowPlayingUpdates();
+
+    // The service may already be warm (tracked while another station was
+    // shown); render its state right away instead of waiting for a change
+    RadioService::RadioState state = m_radioService->currentState();
+    if (!state.nowPlaying.song.title.isEmpty()) {
+        RadioService::RadioStateChange change;
+        change.state = state;
+        change.songChanged = true;
+        change.stationChanged = true;
+        change.progressChanged = true;
+        change.historyChanged = true;
+        change.queueChanged = true;
+        onRadioStateChanged(change);
+    }
+    onPlaybackStateChanged(m_radioService->isPlaying());
 
-    // Start the update timer
+    // Start the local progress ticker
     updateTimer->start();
 }
 
 void BaseRadioPage::connectSignals()
 {
     // Connect RadioService signals
-    connect(m_radioService, &RadioService::nowPlayingUpdated,
-            this, &BaseRadioPage::onNowPlayingUpdated);
+    connect(m_radioService, &RadioService::stateChanged,
+            this, &BaseRadioPage::onRadioStateChanged);
 
     connect(m_radioService, &RadioService::playbackStateChanged,
             this, &BaseRadioPage::onPlaybackStateChanged);
 
-    connect(m_radioService, &RadioService::songHistoryUpdated,
-            this, &BaseRadioPage::onSongHistoryReceived);
-
-    connect(m_radioService, &RadioService::queueUpdated,
-            this, &BaseRadioPage::onQueueReceived);
+    connect(m_radioService, &RadioService::streamTitleChanged,
+            this, &BaseRadioPage::onStreamTitleChanged);
 }
 
-void BaseRadioPage::onNowPlayingUpdated(const RadioService::NowPlayingInfo &info)
+void BaseRadioPage::onRadioStateChanged(const RadioService::RadioStateChange &change)
 {
-    // Check if current song changed
-    bool songChanged = (m_previousCurrentSongTitle != info.song.title);
+    const RadioService::NowPlayingInfo &info = change.state.nowPlaying;
 
-    if (songChanged) {
+    if (change.songChanged) {
         qDebug() << "Current song changed to:" << info.song.title;
-        m_previousCurrentSongTitle = info.song.title;
-        updateSongList();
-    }
 
-    // Update song info
-    songTitleLabel->setText(info.song.title);
-    artistLabel->setText(info.song.artist);
-    stationTitle->setText(info.stationName);
-
-    // Update timing
-    currentElapsed = info.elapsed;
-    currentDuration = info.duration;
-
-    if (currentDuration > 0) {
-        int progress = (currentElapsed * 100) / currentDuration;
-        progressBar->setValue(progress);
-
-        int elapsedMin = currentElapsed / 60;
-        int elapsedSec = currentElapsed % 60;
-        int durationMin = currentDuration / 60;
-        int durationSec = currentDuration % 60;
-
-        timeCurrentLabel->setText(QString("%1:%2")
-            .arg(elapsedMin, 2, 10, QChar('0'))
-            .arg(elapsedSec, 2, 10, QChar('0')));
-        timeTotalLabel->setText(QString("%1:%2")
-            .arg(durationMin, 2, 10, QChar('0'))
-            .arg(durationSec, 2, 10, QChar('0')));
+        // Update song info
+        songTitleLabel->setText(info.song.title);
+        artistLabel->setText(info.song.artist);
+
+        // Update background and album art
+        if (!info.song.artUrl.isEmpty() && info.song.artUrl != currentBackgroundUrl) {
+            updateBackgroundImage(info.song.artUrl);
+        }
     }
 
-    // Update background and album art
-    if (!info.song.artUrl.isEmpty() && info.song.artUrl != currentBackgroundUrl) {
-        updateBackgroundImage(info.song.artUrl);
+    if (change.stationChanged) {
+        stationTitle->setText(info.stationName);
     }
 
-    // Update song list
-    updateSongList();
+    if (change.progressChanged || change.songChanged) {
+        // Update timing (the stream clock has just been re-anchored on
+        // this update and accounts for the audio still in the buffer)
+        currentElapsed = int(m_radioService->clock().positionMs() / 1000);
+        currentDuration = info.duration;
+
+        if (currentDuration > 0) {
+            int progress = (currentElapsed * 100) / currentDuration;
+            progressBar->setValue(progress);
+
+            int elapsedMin = currentElapsed / 60;
+            int elapsedSec = currentElapsed % 60;
+            int durationMin = currentDuration / 60;
+            int durationSec = currentDuration % 60;
+
+            timeCurrentLabel->setText(QString("%1:%2")
+                .arg(elapsedMin, 2, 10, QChar('0'))
+                .arg(elapsedSec, 2, 10, QChar('0')));
+            timeTotalLabel->setText(QString("%1:%2")
+                .arg(durationMin, 2, 10, QChar('0'))
+                .arg(durationSec, 2, 10, QChar('0')));
+        }
+    }
 
-    qDebug() << "Now playing updated:" << info.song.artist << "-" << info.song.title;
+    // One list rebuild per change set, and only when the list content moved
+    if (change.listChanged()) {
+        m_songHistory = change.state.history;
+        m_queue = change.state.queue;
+        updateSongList();
+    }
 }
 
 void BaseRadioPage::updateBackgroundImage(const QString &imageUrl)
 {
     currentBackgroundUrl = imageUrl;
 
+    // The previous song's art must not land on top of this one's
+    backgroundLoad.cancel();
+
     QNetworkRequest imageRequest;
     imageRequest.setUrl(QUrl(imageUrl));
 
     QNetworkReply *imageReply = networkManager->get(imageRequest);
+    EKNM_METRIC_HTTP(imageReply);
+
+    backgroundLoad = NetworkFuture::fromReply(imageReply, this, [](QNetworkReply *reply) {
+        QPixmap pixmap;
+        if (reply->error() == QNetworkReply::NoError) {
+            pixmap.loadFromData(reply->readAll());
+        }
+        return pixmap;
+    });
 
-    connect(imageReply, &QNetworkReply::finished, this, [this, imageReply]() {
-        if (imageReply->error() == QNetworkReply::NoError) {
-            QByteArray imageData = imageReply->readAll();
-            QPixmap pixmap;
-            pixmap.loadFromData(imageData);
+    backgroundLoad.then(this, [this](const QPixmap &pixmap) {
+        if (pixmap.isNull()) {
+            return;
+        }
 
-            if (!pixmap.isNull()) {
-                // Set background
-                backgroundLabel->setPixmap(pixmap);
-                backgroundLabel->setGeometry(0, 0, width(), height());
+        // Set background
+        backgroundLabel->setPixmap(pixmap);
+        backgroundLabel->setGeometry(0, 0, width(), height());
 
-                // Set album art
-                albumArtLabel->setPixmap(pixmap.scaled(200, 200, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
+        // Set album art
+        albumArtLabel->setPixmap(pixmap.scaled(200, 200, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
 
-                qDebug() << "Background and album art updated";
-            }
-        }
-        imageReply->deleteLater();
+        qDebug() << "Background and album art updated";
     });
 }
 
@@ -432,6 +464,26 @@ void BaseRadioPage::onPlaybackStateChanged(bool isPlaying)
     }
 }
 
+void BaseRadioPage::onStreamTitleChanged(const QString &title)
+{
+    // ICY titles are "Artist - Title"; show them right away; art, timing and
+    // the playlist follow with the next now playing update
+    QString artist;
+    QString songTitle = title;
+    int separator = title.indexOf(" - ");
+    if (separator > 0) {
+        artist = title.left(separator).trimmed();
+        songTitle = title.mid(separator + 3).trimmed();
+    }
+
+    if (songTitle != songTitleLabel->text()) {
+        songTitleLabel->setText(songTitle);
+        if (!artist.isEmpty()) {
+            artistLabel->setText(artist);
+        }
+    }
+}
+
 void BaseRadioPage::onPlayPauseClicked()
 {
     m_radioService->togglePlayPause();
@@ -457,239 +509,65 @@ void BaseRadioPage::onRequestSongClicked()
 
 void BaseRadioPage::updateProgressBar()
 {
-    // Increment elapsed time locally
-    if (m_radioService->isPlaying() && currentDuration > 0 && currentElapsed < currentDuration) {
-        currentElapsed += 1;
-
-        int progress = (currentElapsed * 100) / currentDuration;
-        progressBar->setValue(progress);
-
-        int elapsedMin = currentElapsed / 60;
-        int elapsedSec = currentElapsed % 60;
-        timeCurrentLabel->setText(QString("%1:%2")
-            .arg(elapsedMin, 2, 10, QChar('0'))
-            .arg(elapsedSec, 2, 10, QChar('0')));
-    }
-
-    // Fetch fresh data when song is near the end (last 10 seconds)
-    int timeRemaining = currentDuration - currentElapsed;
-    if (timeRemaining <= 10 && timeRemaining > 0) {
-        static bool fetchedForCurrentSong = false;
-        if (!fetchedForCurrentSong) {
-            qDebug() << "Song ending soon (" << timeRemaining << "s remaining), fetching fresh data...";
-            m_radioService->fetchNowPlaying();
-            m_radioService->fetchSongHistory(5);
-            m_radioService->fetchQueue();
-            fetchedForCurrentSong = true;
-        }
-    } else {
-        static bool fetchedForCurrentSong = false;
-        fetchedForCurrentSong = false;
-    }
-}
-
-void BaseRadioPage::onSongHistoryReceived(const QList<RadioService::SongInfo> &history)
-{
-    // Check if history actually changed
-    bool historyChanged = false;
-    if (m_songHistory.size() != history.size()) {
-        historyChanged = true;
-    } else {
-        for (int i = 0; i < history.size(); i++) {
-            if (m_songHistory[i].title != history[i].title || m_songHistory[i].artist != history[i].artist) {
-                historyChanged = true;
-                break;
-            }
-        }
+    // Elapsed time comes from the stream clock: server elapsed time plus the
+    // audio actually played since, so it neither drifts nor runs on while
+    // the stream is buffering. Song changes are pushed by the now playing feed
+    if (currentDuration <= 0) {
+        return;
     }
 
-    if (historyChanged) {
-        m_songHistory = history;
-        qDebug() << "Song history changed:" << history.size() << "songs";
-        updateSongList();
+    const int elapsed = int(qMin<qint64>(m_radioService->clock().positionMs() / 1000, currentDuration));
+    if (elapsed == currentElapsed) {
+        return;
     }
-}
+    currentElapsed = elapsed;
 
-void BaseRadioPage::onQueueReceived(const QList<RadioService::SongInfo> &queue)
-{
-    // Check if queue actually changed
-    bool queueChanged = false;
-    if (m_queue.size() != queue.size()) {
-        queueChanged = true;
-    } else {
-        for (int i = 0; i < queue.size(); i++) {
-            if (m_queue[i].title != queue[i].title || m_queue[i].artist != queue[i].artist) {
-                queueChanged = true;
-                break;
-            }
-        }
-    }
+    int progress = (currentElapsed * 100) / currentDuration;
+    progressBar->setValue(progress);
 
-    if (queueChanged) {
-        m_queue = queue;
-        qDebug() << "Queue changed:" << queue.size() << "songs";
-        updateSongList();
-    }
+    int elapsedMin = currentElapsed / 60;
+    int elapsedSec = currentElapsed % 60;
+    timeCurrentLabel->setText(QString("%1:%2")
+        .arg(elapsedMin, 2, 10, QChar('0'))
+        .arg(elapsedSec, 2, 10, QChar('0')));
 }
 
 void BaseRadioPage::updateSongList()
 {
-    songListWidget->clear();
-    m_songOrderCounter = 1;  // Reset counter
-
-    qDebug() << "=== UPDATING SONG LIST ===";
-    qDebug() << "History size:" << m_songHistory.size();
-    qDebug() << "Queue size:" << m_queue.size();
-
-    // Get current song
-    RadioService::NowPlayingInfo currentInfo = m_radioService->currentNowPlaying();
-    QString currentTitle = currentInfo.song.title;
+    using Slot = RadioSongListModel::Slot;
+    QList<RadioSongListModel::Entry> entries;
 
-    qDebug() << "Current song:" << currentInfo.song.artist << "-" << currentTitle;
+    const RadioService::NowPlayingInfo currentInfo = m_radioService->currentNowPlaying();
+    const RadioService::SongInfo &current = currentInfo.song;
 
-    // Add previous songs (from history) - max 2, excluding current song
-    // History API returns songs in reverse chronological order (newest first)
-    // So we take the FIRST items (most recent past songs)
+    // Previous songs: the two most recent history entries (history is newest
+    // first), excluding the current song
     int historyToShow = 0;
-
-    qDebug() << "Adding up to 2 songs from history (size:" << m_songHistory.size() << ")";
     for (int i = 0; i < m_songHistory.size() && historyToShow < 2; i++) {
-        // Skip if this is the current song
-        if (m_songHistory[i].title == currentTitle && m_songHistory[i].artist == currentInfo.song.artist) {
-            qDebug() << "  Skipping duplicate current song in history:" << m_songHistory[i].title;
+        const RadioService::SongInfo &song = m_songHistory[i];
+        if (song.title == current.title && song.artist == current.artist) {
+            continue;
+        }
+        if (song.title.isEmpty() && song.artist.isEmpty()) {
             continue;
         }
-        qDebug() << "  Adding PREVIOUS [" << i << "]:" << m_songHistory[i].artist << "-" << m_songHistory[i].title;
-        addSongToList(m_songHistory[i], "PREVIOUS", false);
+        entries.append({song, Slot::Previous});
         historyToShow++;
     }
-    qDebug() << "Total PREVIOUS songs added:" << historyToShow;
 
-    // Add current song
-    if (!currentInfo.song.title.isEmpty()) {
-        qDebug() << "Adding NOW PLAYING:" << currentInfo.song.title;
-        addSongToList(currentInfo.song, "NOW PLAYING", true);
+    if (!current.title.isEmpty()) {
+        entries.append({current, Slot::Current});
     }
 
-    // Add upcoming songs (from queue) - only 1 NEXT song
-    if (!m_queue.isEmpty()) {
-        qDebug() << "Adding NEXT song:" << m_queue[0].artist << "-" << m_queue[0].title;
-        addSongToList(m_queue[0], "NEXT", false);
-    }
-
-    qDebug() << "=== SONG LIST UPDATE COMPLETE - Total items:" << songListWidget->count() << "===";
-}
-
-void BaseRadioPage::addSongToList(const RadioService::SongInfo &song, const QString &label, bool isCurrent)
-{
-    // Skip empty songs
-    if (song.title.isEmpty() && song.artist.isEmpty()) {
-        return;
-    }
-
-    QListWidgetItem *item = new QListWidgetItem(songListWidget);
-
-    // Create custom widget with horizontal layout
-    QWidget *itemWidget = new QWidget();
-    QHBoxLayout *mainItemLayout = new QHBoxLayout(itemWidget);
-    mainItemLayout->setContentsMargins(20, 12, 20, 12);
-    mainItemLayout->setSpacing(16);
-
-    // Album art thumbnail (70x70)
-    QLabel *thumbnailLabel = new QLabel(itemWidget);
-    thumbnailLabel->setFixedSize(70, 70);
-    thumbnailLabel->setScaledContents(true);
-    thumbnailLabel->setStyleSheet(
-        "background-color: #2a2a3a;"
-        "border-radius: 4px;"
-    );
-
-    // Load thumbnail from song art URL
-    if (!song.artUrl.isEmpty()) {
-        QNetworkAccessManager *thumbManager = new QNetworkAccessManager(itemWidget);
-        QNetworkRequest thumbRequest(song.artUrl);
-        QNetworkReply *thumbReply = thumbManager->get(thumbRequest);
-
-        connect(thumbReply, &QNetworkReply::finished, [thumbnailLabel, thumbReply]() {
-            if (thumbReply->error() == QNetworkReply::NoError) {
-                QPixmap pixmap;
-                pixmap.loadFromData(thumbReply->readAll());
-                if (!pixmap.isNull()) {
-                    thumbnailLabel->setPixmap(pixmap.scaled(70, 70, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
-                }
-            }
-            thumbReply->deleteLater();
-        });
-    }
-
-    // Song info (vertical layout)
-    QWidget *songInfoWidget = new QWidget(itemWidget);
-    QVBoxLayout *songInfoLayout = new QVBoxLayout(songInfoWidget);
-    songInfoLayout->setContentsMargins(0, 0, 0, 0);
-    songInfoLayout->setSpacing(6);
-
-    // Label (PREVIOUS/NOW PLAYING/NEXT)
-    QLabel *labelText = new QLabel(label, songInfoWidget);
-    labelText->setStyleSheet(QString(
-        "color: %1;"
-        "font-size: 12px;"
-        "font-weight: bold;"
-        "background: transparent;"
-        "letter-spacing: 0.5px;"
-    ).arg(isCurrent ? "#4a9eff" : "#bbb"));
-
-    // Title
-    QLabel *titleText = new QLabel(songInfoWidget);
-    titleText->setTextFormat(Qt::PlainText);
-    titleText->setTextInteractionFlags(Qt::TextSelectableByMouse);
-    titleText->setCursor(Qt::IBeamCursor);
-
-    QFont titleFont;
-    titleFont.setPixelSize(18);
-    titleFont.setWeight(QFont::DemiBold);
-    titleText->setFont(titleFont);
-    titleText->setStyleSheet("color: white; background: transparent;");
-
-    // Use elided text
-    QFontMetrics metrics(titleFont);
-    QString elidedTitle = metrics.elidedText(song.title, Qt::ElideRight, 700);
-    titleText->setText(elidedTitle);
-    titleText->setToolTip(song.title);  // Full text on hover
-
-    // Artist
-    QLabel *artistText = new QLabel(songInfoWidget);
-    artistText->setTextInteractionFlags(Qt::TextSelectableByMouse);
-    artistText->setCursor(Qt::IBeamCursor);
-
-    QFont artistFont;
-    artistFont.setPixelSize(15);
-    artistText->setFont(artistFont);
-    artistText->setStyleSheet("color: #ccc; background: transparent;");
-
-    // Use elided text
-    QFontMetrics artistMetrics(artistFont);
-    QString elidedArtist = artistMetrics.elidedText(song.artist, Qt::ElideRight, 700);
-    artistText->setText(elidedArtist);
-    artistText->setToolTip(song.artist);  // Full text on hover
-
-    songInfoLayout->addWidget(labelText);
-    songInfoLayout->addWidget(titleText);
-    songInfoLayout->addWidget(artistText);
-
-    // Add all to main layout
-    mainItemLayout->addWidget(thumbnailLabel);
-    mainItemLayout->addWidget(songInfoWidget, 1);
-
-    item->setSizeHint(QSize(itemWidget->width(), 100));
-
-    if (isCurrent) {
-        itemWidget->setStyleSheet("background-color: rgba(74, 158, 255, 0.2); border-radius: 4px;");
+    // Only the NEXT song
+    if (!m_queue.isEmpty() && !(m_queue[0].title.isEmpty() && m_queue[0].artist.isEmpty())) {
+        entries.append({m_queue[0], Slot::Next});
     }
 
-    songListWidget->addItem(item);
-    songListWidget->setItemWidget(item, itemWidget);
+    m_songListModel->setEntries(entries);
 
-    if (isCurrent) {
-        songListWidget->setCurrentItem(item);
+    QModelIndex currentIndex = m_songListModel->currentIndex();
+    if (currentIndex.isValid()) {
+        songListView->scrollTo(currentIndex);
     }
 }
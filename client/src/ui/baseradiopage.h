@@ -10,10 +10,12 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QPixmap>
+#include <QFuture>
 #include <QTimer>
 #include <QScrollArea>
-#include <QListWidget>
+#include <QListView>
 #include "services/radioservice.h"
+#include "models/radiosonglistmodel.h"
 
 /**
  * @brief Base class for all radio pages
@@ -39,6 +41,7 @@ public:
 protected:
     // Event handlers
     void resizeEvent(QResizeEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
 
     // Virtual methods for customization
     virtual QString getStationName() const = 0;
@@ -54,18 +57,16 @@ protected:
 
     // Song list methods
     void updateSongList();
-    void addSongToList(const RadioService::SongInfo &song, const QString &label, bool isCurrent = false);
 
 protected slots:
-    virtual void onNowPlayingUpdated(const RadioService::NowPlayingInfo &info);
+    virtual void onRadioStateChanged(const RadioService::RadioStateChange &change);
     virtual void onPlaybackStateChanged(bool isPlaying);
+    virtual void onStreamTitleChanged(const QString &title);
     virtual void onPlayPauseClicked();
     virtual void onVolumeSliderChanged(int value);
     virtual void onVolumeBtnClicked();
     virtual void onRequestSongClicked();
     virtual void updateProgressBar();
-    virtual void onSongHistoryReceived(const QList<RadioService::SongInfo> &history);
-    virtual void onQueueReceived(const QList<RadioService::SongInfo> &queue);
 
 private:
     void updateBackgroundImage(const QString &imageUrl);
@@ -93,27 +94,21 @@ protected:
 
     // Right panel - Song list
     QWidget *rightPanel;
-    QListWidget *songListWidget;
+    QListView *songListView;
+    RadioSongListModel *m_songListModel;
 
     // Services & Data
     RadioService *m_radioService;
     QNetworkAccessManager *networkManager;
     QTimer *updateTimer;
     QString currentBackgroundUrl;
+    QFuture<QPixmap> backgroundLoad;  // Art of currentBackgroundUrl, canceled when the song changes
     int currentDuration;
     int currentElapsed;
 
     // Song data cache
     QList<RadioService::SongInfo> m_songHistory;
     QList<RadioService::SongInfo> m_queue;
-
-    // Song list order counter
-    int m_songOrderCounter;
-
-    // Previous state for change detection
-    QString m_previousCurrentSongTitle;
-    QList<RadioService::SongInfo> m_previousHistory;
-    QList<RadioService::SongInfo> m_previousQueue;
 };
 
 #endif // BASERADIOPAGE_H
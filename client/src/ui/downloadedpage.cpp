@@ -1,30 +1,70 @@
 #include "downloadedpage.h"
+#include "downloadedsongdelegate.h"
+#include "nowplayinganimation.h"
+#include "theme.h"
+#include "services/playlistservice.h"
+#include "utils/metrics.h"
+#include <QInputDialog>
 #include <QListWidgetItem>
+#include <QMenu>
 #include <QPushButton>
 #include <QHBoxLayout>
-#include <QFileInfo>
-#include <QTimer>
-#include <QMovie>
+#include <QHash>
+#include <QScrollBar>
+
+namespace {
+constexpr int kPrioritizeDelayMs = 50;
+}
 
 DownloadedSongsPage::DownloadedSongsPage(QWidget *parent)
     : QWidget(parent)
     , musicStorage(MusicStorageService::instance())
     , playerService(PlayerService::instance())
+    , m_playingItem(nullptr)
+    , m_indicatorActive(false)
+    , m_prioritizeTimer(new QTimer(this))
 {
     setupUI();
-    loadDownloadedSongs();
+
+    // Rows in and around the viewport get their tags read first; scrolling
+    // re-prioritizes once it settles
+    m_prioritizeTimer->setSingleShot(true);
+    m_prioritizeTimer->setInterval(kPrioritizeDelayMs);
+    connect(m_prioritizeTimer, &QTimer::timeout, this, &DownloadedSongsPage::prioritizeVisibleRows);
+    connect(songListWidget->verticalScrollBar(), &QScrollBar::valueChanged,
+            m_prioritizeTimer, qOverload<>(&QTimer::start));
 
     // Connect to music storage changes
     connect(musicStorage, &MusicStorageService::tracksChanged,
             this, &DownloadedSongsPage::refreshSongList);
+    connect(musicStorage, &MusicStorageService::trackUpdated,
+            this, &DownloadedSongsPage::onTrackUpdated);
+    connect(musicStorage, &MusicStorageService::scanningChanged,
+            this, &DownloadedSongsPage::updateInfoLabel);
+
+    // Show whatever is already in memory; the library fills in
+    // asynchronously and arrives through tracksChanged
+    loadDownloadedSongs();
+    musicStorage->loadLibrary();
 
     // Connect to player service track changes
     connect(playerService, &PlayerService::trackChanged,
             this, &DownloadedSongsPage::onTrackChanged);
+
+    // Like state is kept per row; only the toggled row changes
+    connect(PlaylistService::instance(), &PlaylistService::membershipChanged,
+            this, &DownloadedSongsPage::onMembershipChanged);
+
+    // One shared animation drives the indicator; repaint just the playing row
+    connect(NowPlayingAnimation::instance(), &NowPlayingAnimation::frameChanged,
+            this, &DownloadedSongsPage::onAnimationFrame);
 }
 
 DownloadedSongsPage::~DownloadedSongsPage()
 {
+    if (m_indicatorActive) {
+        NowPlayingAnimation::instance()->release();
+    }
 }
 
 void DownloadedSongsPage::setupUI()
@@ -33,46 +73,20 @@ void DownloadedSongsPage::setupUI()
     mainLayout->setSpacing(15);
     mainLayout->setContentsMargins(40, 40, 40, 40);
 
-    // Light background
-    setStyleSheet(
-        "QWidget {"
-        "   background-color: #f5f5f5;"
-        "}"
-    );
+    // Light background and all row styles come from the application theme
+    setObjectName("downloadedPage");
 
     // Header layout with title and refresh button
     QHBoxLayout *headerLayout = new QHBoxLayout();
 
     // Simple title
     titleLabel = new QLabel("Downloaded Songs", this);
-    titleLabel->setStyleSheet(
-        "font-size: 32px;"
-        "font-weight: 600;"
-        "color: #000000;"
-        "margin-bottom: 5px;"
-    );
+    Theme::setRole(titleLabel, "pageTitle");
 
     // Refresh button
     QPushButton *refreshBtn = new QPushButton("⟳");
     refreshBtn->setFixedSize(40, 40);
-    refreshBtn->setStyleSheet(
-        "QPushButton {"
-        "   background-color: #f0f0f0;"
-        "   color: #333333;"
-        "   border: 1px solid #d0d0d0;"
-        "   border-radius: 20px;"
-        "   font-size: 24px;"
-        "   font-weight: bold;"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #4a9eff;"
-        "   color: white;"
-        "   border: 1px solid #4a9eff;"
-        "}"
-        "QPushButton:pressed {"
-        "   background-color: #3080dd;"
-        "}"
-    );
+    Theme::setRole(refreshBtn, "refreshButton");
     refreshBtn->setCursor(Qt::PointingHandCursor);
     refreshBtn->setToolTip("Refresh song list from folder");
     connect(refreshBtn, &QPushButton::clicked, this, &DownloadedSongsPage::onRefreshButtonClicked);
@@ -83,11 +97,7 @@ void DownloadedSongsPage::setupUI()
 
     // Simple info label
     infoLabel = new QLabel("0 songs • 0 MB", this);
-    infoLabel->setStyleSheet(
-        "font-size: 14px;"
-        "color: #666666;"
-        "margin-bottom: 25px;"
-    );
+    Theme::setRole(infoLabel, "pageInfo");
 
     // Simple song list widget with drag & drop
     songListWidget = new QListWidget(this);
@@ -97,43 +107,30 @@ void DownloadedSongsPage::setupUI()
     songListWidget->setDropIndicatorShown(true);
     songListWidget->setDragDropMode(QAbstractItemView::InternalMove);
     songListWidget->setDefaultDropAction(Qt::MoveAction);
-    songListWidget->setStyleSheet(
-        "QListWidget {"
-        "   background-color: transparent;"
-        "   border: none;"
-        "   outline: none;"
-        "}"
-        "QListWidget::item {"
-        "   background-color: white;"
-        "   border: none;"
-        "   border-bottom: 1px solid #e0e0e0;"
-        "   border-radius: 0px;"
-        "}"
-        "QListWidget::item:hover {"
-        "   background-color: #fafafa;"
-        "   cursor: pointer;"
-        "}"
-        "QListWidget::item:selected {"
-        "   background-color: #e8f4fd;"
-        "   border-left: 3px solid #4a9eff;"
-        "}"
-        "QScrollBar:vertical {"
-        "   background: transparent;"
-        "   width: 8px;"
-        "   margin: 0px;"
-        "}"
-        "QScrollBar::handle:vertical {"
-        "   background: #bdc3c7;"
-        "   border-radius: 4px;"
-        "   min-height: 30px;"
-        "}"
-        "QScrollBar::handle:vertical:hover {"
-        "   background: #95a5a6;"
-        "}"
-        "QScrollBar::add-line:vertical, QScrollBar::sub-line:vertical {"
-        "   height: 0px;"
-        "}"
-    );
+    songListWidget->setUniformItemSizes(true);
+    Theme::setRole(songListWidget, "songList");
+
+    // Rows are painted by the delegate, no widget per row
+    DownloadedSongDelegate *songDelegate = new DownloadedSongDelegate(songListWidget);
+    songListWidget->setItemDelegate(songDelegate);
+    connect(songDelegate, &DownloadedSongDelegate::playClicked, this, [this](const QModelIndex &index) {
+        const QString filePath = index.data(Qt::UserRole).toString();
+        setPlayingItem(songListWidget->item(index.row()));
+        onPlayButtonClicked(indexOfTrack(filePath));
+    });
+    connect(songDelegate, &DownloadedSongDelegate::deleteClicked, this, [this](const QModelIndex &index) {
+        onDeleteButtonClicked(index.data(Qt::UserRole).toString());
+    });
+    connect(songDelegate, &DownloadedSongDelegate::likeClicked, this, [](const QModelIndex &index) {
+        const QString filePath = index.data(Qt::UserRole).toString();
+        PlaylistService *playlists = PlaylistService::instance();
+        playlists->setLiked(filePath, !playlists->isLiked(filePath));
+    });
+
+    // Right click adds the row to a playlist
+    songListWidget->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(songListWidget, &QWidget::customContextMenuRequested,
+            this, &DownloadedSongsPage::onSongContextMenu);
 
     connect(songListWidget, &QListWidget::itemClicked, this, &DownloadedSongsPage::onSongItemClicked);
 
@@ -149,35 +146,63 @@ void DownloadedSongsPage::setupUI()
 
 void DownloadedSongsPage::loadDownloadedSongs()
 {
+    setPlayingItem(nullptr);
     songListWidget->clear();
+    m_itemsByPath.clear();
     downloadedTracks = musicStorage->getDownloadedTracks();
+    EKNM_METRIC_COUNT(DownloadedListRebuilds, 1);
+    EKNM_METRIC_COUNT(DownloadedRowsBuilt, downloadedTracks.size());
+
+    m_itemsByPath.reserve(downloadedTracks.size());
+    for (const Track &track : std::as_const(downloadedTracks)) {
+        // Filled before insertion so the view sees each row once
+        QListWidgetItem *item = new QListWidgetItem();
+        populateItem(item, track);
+        songListWidget->addItem(item);
+        m_itemsByPath.insert(track.filePath(), item);
+
+        if (track.filePath() == m_currentPlayingFile) {
+            setPlayingItem(item);
+        }
+    }
+    rebuildTrackIndex();
+
+    updateInfoLabel();
+    if (musicStorage->isScanning()) {
+        m_prioritizeTimer->start();
+    }
+}
+
+void DownloadedSongsPage::updateInfoLabel()
+{
+    if (!musicStorage->isLibraryLoaded()) {
+        infoLabel->setText("Loading library...");
+        return;
+    }
 
     if (downloadedTracks.isEmpty()) {
-        infoLabel->setText("No downloaded songs • Drop music files in: " + musicStorage->musicDirectory());
+        if (musicStorage->isScanning()) {
+            infoLabel->setText("Scanning songs folder...");
+        } else {
+            infoLabel->setText("No downloaded songs • Drop music files in: " + musicStorage->musicDirectory());
+        }
         return;
     }
 
+    // Sizes come from the library, no per-file stat on the GUI thread
     qint64 totalSize = 0;
-    for (int i = 0; i < downloadedTracks.size(); ++i) {
-        const Track &track = downloadedTracks[i];
-
-        QListWidgetItem *item = new QListWidgetItem(songListWidget);
-        QWidget *songWidget = createDownloadedSongItem(track, i);
-        item->setSizeHint(songWidget->sizeHint());
-        songListWidget->setItemWidget(item, songWidget);
-
-        // IMPORTANT: Store the file path in item data so we can retrieve it after drag & drop
-        item->setData(Qt::UserRole, track.filePath());
-
-        // Calculate total size
-        QFileInfo fileInfo(track.filePath());
-        totalSize += fileInfo.size();
+    for (const Track &track : std::as_const(downloadedTracks)) {
+        totalSize += track.fileSize();
     }
 
     double totalSizeMB = totalSize / (1024.0 * 1024.0);
-    infoLabel->setText(QString("%1 songs • %2 MB")
-                           .arg(downloadedTracks.size())
-                           .arg(totalSizeMB, 0, 'f', 1));
+    QString text = QString("%1 songs • %2 MB")
+                       .arg(downloadedTracks.size())
+                       .arg(totalSizeMB, 0, 'f', 1);
+    if (musicStorage->isScanning()) {
+        text += " • Scanning...";
+    }
+    infoLabel->setText(text);
 }
 
 void DownloadedSongsPage::refreshSongList()
@@ -185,171 +210,199 @@ void DownloadedSongsPage::refreshSongList()
     loadDownloadedSongs();
 }
 
-QWidget* DownloadedSongsPage::createDownloadedSongItem(const Track &track, int index)
+void DownloadedSongsPage::populateItem(QListWidgetItem *item, const Track &track)
+{
+    // IMPORTANT: Store the file path in item data so we can retrieve it after drag & drop
+    item->setData(Qt::UserRole, track.filePath());
+
+    // Everything the delegate paints is formatted once, here
+    item->setData(DownloadedSongDelegate::TitleRole, track.title());
+    item->setData(DownloadedSongDelegate::ArtistRole, track.artist());
+    item->setData(DownloadedSongDelegate::DateAddedTextRole, formatDateAdded(track.dateAdded()));
+    item->setData(DownloadedSongDelegate::DurationTextRole, formatDuration(track.duration()));
+    item->setData(DownloadedSongDelegate::FileSizeTextRole, formatFileSize(track.fileSize()));
+    item->setData(DownloadedSongDelegate::IsLikedRole, PlaylistService::instance()->isLiked(track.filePath()));
+
+    // Tracks from the library snapshot only carry the cover path; the
+    // delegate decodes and caches those when the row is first painted
+    if (!track.albumArt().isNull()) {
+        const int side = DownloadedSongDelegate::kAlbumArtSize;
+        item->setData(DownloadedSongDelegate::AlbumArtRole,
+                      track.albumArt().scaled(side, side, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
+    } else if (!track.albumArtPath().isEmpty()) {
+        item->setData(DownloadedSongDelegate::AlbumArtPathRole, track.albumArtPath());
+    }
+}
+
+int DownloadedSongsPage::indexOfTrack(const QString &filePath) const
 {
-    QWidget *widget = new QWidget();
-    widget->setMinimumHeight(64);
-    widget->setStyleSheet(
-        "QWidget {"
-        "   background-color: transparent;"
-        "}"
-    );
-    QHBoxLayout *layout = new QHBoxLayout(widget);
-    layout->setContentsMargins(16, 8, 16, 8);
-    layout->setSpacing(12);
-
-    // Play button/animation column (instead of index)
-    bool isPlaying = (m_currentPlayingFile == track.filePath());
-
-    QWidget *playWidget = new QWidget();playWidget->setObjectName("playWidget_" + QString::number(index));
-	playWidget->setFixedSize(32, 32);  // Увеличил контейнер для гифки
-	playWidget->setCursor(Qt::PointingHandCursor);
-
-	QLabel *playIconLabel = new QLabel(playWidget);
-	playIconLabel->setScaledContents(true);
-	playIconLabel->setAlignment(Qt::AlignCenter);
-
-	if (isPlaying) {
-    	// Show animated GIF for currently playing track (bigger)
-    	playIconLabel->setGeometry(0, 0, 32, 32);  // Гифка 32x32
-    	QMovie *movie = new QMovie(":/images/src/resources/images/songAnimation.gif", QByteArray(), playWidget);
-    	playIconLabel->setMovie(movie);
-    	movie->start();
-	} else {
-    	// Show static play button icon (original size)
-    	playIconLabel->setGeometry(8, 8, 16, 16);  // Иконка остается 16x16
-    	QPixmap playIcon(":/images/src/resources/images/playButton.png");
-    	playIconLabel->setPixmap(playIcon.scaled(12, 12, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    return m_trackIndex.value(filePath, -1);
+}
+
+void DownloadedSongsPage::rebuildTrackIndex()
+{
+    m_trackIndex.clear();
+    m_trackIndex.reserve(downloadedTracks.size());
+    for (int i = 0; i < downloadedTracks.size(); ++i) {
+        m_trackIndex.insert(downloadedTracks[i].filePath(), i);
+    }
+}
+
+void DownloadedSongsPage::onTrackUpdated(const Track &track)
+{
+    // Placeholder (or stale) row got its real metadata: update it in place
+    QListWidgetItem *item = m_itemsByPath.value(track.filePath());
+    if (!item) {
+        return;
+    }
+    populateItem(item, track);
+
+    const int index = indexOfTrack(track.filePath());
+    if (index >= 0) {
+        downloadedTracks[index] = track;
+    }
+}
+
+void DownloadedSongsPage::onMembershipChanged(qint64 playlistId, const QString &filePath, bool member)
+{
+    if (playlistId != PlaylistService::instance()->likedPlaylistId()) {
+        return;
+    }
+    if (QListWidgetItem *item = m_itemsByPath.value(filePath)) {
+        item->setData(DownloadedSongDelegate::IsLikedRole, member);
+    }
 }
 
-    // Make widget clickable
-    QPushButton *invisibleBtn = new QPushButton(playWidget);
-    invisibleBtn->setGeometry(0, 0, 32, 32);
-    invisibleBtn->setStyleSheet("QPushButton { background: transparent; border: none; }");
-    invisibleBtn->setCursor(Qt::PointingHandCursor);
-    connect(invisibleBtn, &QPushButton::clicked, this, [this, index, track]() {
-        m_currentPlayingFile = track.filePath();
-        onPlayButtonClicked(index);
-        refreshSongList(); // Refresh to show animation
+void DownloadedSongsPage::onSongContextMenu(const QPoint &pos)
+{
+    QListWidgetItem *item = songListWidget->itemAt(pos);
+    if (!item) {
+        return;
+    }
+    const QString filePath = item->data(Qt::UserRole).toString();
+    PlaylistService *playlists = PlaylistService::instance();
+
+    QMenu menu(this);
+    QMenu *addMenu = menu.addMenu("Add to playlist");
+    const QList<PlaylistInfo> infos = playlists->playlists();
+    for (const PlaylistInfo &info : infos) {
+        if (info.isLiked) {
+            continue;
+        }
+        QAction *action = addMenu->addAction(info.name);
+        action->setCheckable(true);
+        action->setChecked(playlists->contains(info.id, filePath));
+        const qint64 playlistId = info.id;
+        connect(action, &QAction::toggled, this, [playlists, playlistId, filePath](bool checked) {
+            if (checked) {
+                playlists->addTrack(playlistId, filePath);
+            } else {
+                playlists->removeTrack(playlistId, filePath);
+            }
+        });
+    }
+    if (!addMenu->isEmpty()) {
+        addMenu->addSeparator();
+    }
+    addMenu->addAction("New playlist...", this, [this, playlists, filePath]() {
+        const QString name = QInputDialog::getText(this, "New playlist", "Playlist name:");
+        const qint64 playlistId = playlists->createPlaylist(name);
+        if (playlistId != 0) {
+            playlists->addTrack(playlistId, filePath);
+        }
     });
 
-    // Album art column (show actual album art from track)
-    QLabel *albumArtLabel = new QLabel();
-    albumArtLabel->setFixedSize(48, 48);
-    albumArtLabel->setStyleSheet(
-        "background-color: #e0e0e0;"
-        "border: 1px solid #d0d0d0;"
-        "border-radius: 4px;"
-    );
+    menu.exec(songListWidget->viewport()->mapToGlobal(pos));
+}
 
-    // Load album art if available
-    if (!track.albumArt().isNull()) {
-        QPixmap scaledArt = track.albumArt().scaled(48, 48, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-        albumArtLabel->setPixmap(scaledArt);
-        albumArtLabel->setScaledContents(true);
+void DownloadedSongsPage::prioritizeVisibleRows()
+{
+    const int count = songListWidget->count();
+    if (count == 0 || !isVisible() || !musicStorage->isScanning()) {
+        return;
+    }
+
+    // Visible rows first, then a page below (where scrolling usually goes),
+    // then a page above
+    const QRect viewport = songListWidget->viewport()->rect();
+    const QModelIndex firstIndex = songListWidget->indexAt(viewport.topLeft());
+    const QModelIndex lastIndex = songListWidget->indexAt(viewport.bottomLeft());
+    const int first = firstIndex.isValid() ? firstIndex.row() : 0;
+    const int last = lastIndex.isValid() ? lastIndex.row() : count - 1;
+    const int pageRows = last - first + 1;
+
+    QStringList filePaths;
+    filePaths.reserve(pageRows * 3);
+    auto addRows = [&](int from, int to) {
+        for (int row = from; row <= to; ++row) {
+            filePaths.append(songListWidget->item(row)->data(Qt::UserRole).toString());
+        }
+    };
+    addRows(first, last);
+    addRows(last + 1, qMin(count - 1, last + pageRows));
+    addRows(qMax(0, first - pageRows), first - 1);
+
+    musicStorage->prioritizeTracks(filePaths);
+}
+
+void DownloadedSongsPage::setPlayingItem(QListWidgetItem *item)
+{
+    if (item == m_playingItem) {
+        return;
+    }
+
+    // Flipping the role repaints just the two affected rows
+    if (m_playingItem) {
+        m_playingItem->setData(DownloadedSongDelegate::IsPlayingRole, false);
+    }
+    m_playingItem = item;
+    if (m_playingItem) {
+        m_playingItem->setData(DownloadedSongDelegate::IsPlayingRole, true);
+    }
+
+    updateIndicatorActive();
+}
+
+void DownloadedSongsPage::updateIndicatorActive()
+{
+    // The shared timer only needs to run while a playing row can be seen
+    const bool active = m_playingItem && isVisible();
+    if (active == m_indicatorActive) {
+        return;
+    }
+
+    m_indicatorActive = active;
+    if (active) {
+        NowPlayingAnimation::instance()->acquire();
     } else {
-        // Fallback music icon
-        QLabel *fallbackIcon = new QLabel("♪", albumArtLabel);
-        fallbackIcon->setAlignment(Qt::AlignCenter);
-        fallbackIcon->setGeometry(0, 0, 48, 48);
-        fallbackIcon->setStyleSheet("color: #888888; font-size: 20px; background: transparent;");
+        NowPlayingAnimation::instance()->release();
     }
+}
 
-    // Title & Artist column (stacked vertically)
-    QWidget *titleArtistWidget = new QWidget();
-    titleArtistWidget->setStyleSheet("background: transparent;");
-    QVBoxLayout *titleArtistLayout = new QVBoxLayout(titleArtistWidget);
-    titleArtistLayout->setSpacing(2);
-    titleArtistLayout->setContentsMargins(0, 0, 0, 0);
-
-    QLabel *titleLabel = new QLabel(track.title());
-    titleLabel->setStyleSheet(
-        "font-size: 15px;"
-        "font-weight: 600;"
-        "color: #000000;"
-        "background: transparent;"
-    );
-    titleLabel->setWordWrap(false);
-
-    QLabel *artistLabel = new QLabel(track.artist());
-    artistLabel->setStyleSheet(
-        "font-size: 13px;"
-        "color: #888888;"
-        "background: transparent;"
-    );
-    artistLabel->setWordWrap(false);
-
-    titleArtistLayout->addWidget(titleLabel);
-    titleArtistLayout->addWidget(artistLabel);
-
-    // Date added column
-    QString dateText = formatDateAdded(track.dateAdded());
-    QLabel *dateLabel = new QLabel(dateText);
-    dateLabel->setFixedWidth(120);
-    dateLabel->setStyleSheet(
-        "font-size: 13px;"
-        "color: #666666;"
-        "background: transparent;"
-    );
-    dateLabel->setAlignment(Qt::AlignLeft | Qt::AlignVCenter);
-
-    // Duration column
-    QString durationText = formatDuration(track.duration());
-    QLabel *durationLabel = new QLabel(durationText);
-    durationLabel->setFixedWidth(80);
-    durationLabel->setAlignment(Qt::AlignCenter);
-    durationLabel->setStyleSheet(
-        "font-size: 13px;"
-        "color: #666666;"
-        "background: transparent;"
-    );
-
-    // File size column
-    QString sizeText = formatFileSize(track.fileSize());
-    QLabel *sizeLabel = new QLabel(sizeText);
-    sizeLabel->setFixedWidth(100);
-    sizeLabel->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
-    sizeLabel->setStyleSheet(
-        "font-size: 13px;"
-        "color: #666666;"
-        "background: transparent;"
-    );
-
-    // Delete button column with xButton.png (no circle border)
-    QPushButton *deleteBtn = new QPushButton();
-    deleteBtn->setFixedSize(40, 40);
-
-    // Set icon from resources (smaller to fit fully)
-    QPixmap xButtonIcon(":/images/src/resources/images/xButton.png");
-    QIcon xIcon(xButtonIcon);
-    deleteBtn->setIcon(xIcon);
-    deleteBtn->setIconSize(QSize(16, 16));
-
-    deleteBtn->setStyleSheet(
-        "QPushButton {"
-        "   background-color: transparent;"
-        "   border: none;"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #ffdddd;"
-        "}"
-    );
-    deleteBtn->setCursor(Qt::PointingHandCursor);
-    deleteBtn->setToolTip("Delete song");
-    connect(deleteBtn, &QPushButton::clicked, this, [this, track]() {
-        onDeleteButtonClicked(track.filePath());
-    });
+void DownloadedSongsPage::onAnimationFrame()
+{
+    if (m_indicatorActive && m_playingItem) {
+        songListWidget->viewport()->update(songListWidget->visualItemRect(m_playingItem));
+    }
+}
 
-    // Build layout
-    layout->addWidget(playWidget);
-    layout->addWidget(albumArtLabel);
-    layout->addWidget(titleArtistWidget, 1); // Stretch factor 1
-    layout->addWidget(dateLabel);
-    layout->addWidget(durationLabel);
-    layout->addWidget(sizeLabel);
-    layout->addWidget(deleteBtn);
+void DownloadedSongsPage::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    updateIndicatorActive();
+    m_prioritizeTimer->start();
+}
 
-    return widget;
+void DownloadedSongsPage::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    m_prioritizeTimer->start();
+}
+
+void DownloadedSongsPage::hideEvent(QHideEvent *event)
+{
+    QWidget::hideEvent(event);
+    updateIndicatorActive();
 }
 
 void DownloadedSongsPage::onSongItemClicked(QListWidgetItem *item)
@@ -361,13 +414,8 @@ void DownloadedSongsPage::onSongItemClicked(QListWidgetItem *item)
 void DownloadedSongsPage::onPlayButtonClicked(int index)
 {
     if (index >= 0 && index < downloadedTracks.size()) {
-        // Set playlist and play selected track
-        playerService->setPlaylist(downloadedTracks);
-        // The setPlaylist method already starts playing the first track,
-        // but we want to play the selected one, so we need to adjust
-        for (int i = 0; i < index; ++i) {
-            playerService->next();
-        }
+        // Set playlist and start at the selected track
+        playerService->setPlaylist(downloadedTracks, index);
     }
 }
 
@@ -380,58 +428,44 @@ void DownloadedSongsPage::onDeleteButtonClicked(const QString &filePath)
     }
 }
 
-void DownloadedSongsPage::onSongOrderChanged()
+void DownloadedSongsPage::onSongOrderChanged(const QModelIndex &parent, int start, int end,
+                                             const QModelIndex &destination, int row)
 {
-    // The song order has been changed by drag and drop
-    qDebug() << "Song order changed - saving new order";
-
-    // Collect file paths in the NEW visual order (after drag & drop)
-    QList<QString> orderedFilePaths;
+    Q_UNUSED(parent);
+    Q_UNUSED(destination);
+
+    // Rows [start, end] were moved in front of row (old numbering); only
+    // the moved tracks are re-ranked and saved
+    const int count = end - start + 1;
+    const bool forward = row > start;
+    const int newStart = forward ? row - count : row;
+    qDebug() << "Song order changed - moved" << count << "row(s) from" << start << "to" << newStart;
+
+    // Replay the move one track at a time, keeping the moved block in order:
+    // forward moves repeatedly take the first row to the block's last slot
+    for (int i = 0; i < count; ++i) {
+        const int from = forward ? start : start + i;
+        const int to = forward ? newStart + count - 1 : newStart + i;
+        if (from < downloadedTracks.size() && to < downloadedTracks.size()) {
+            downloadedTracks.move(from, to);
+        }
 
-    // Iterate through items in their current visual order
-    for (int i = 0; i < songListWidget->count(); ++i) {
-        QListWidgetItem *item = songListWidget->item(i);
+        QListWidgetItem *item = songListWidget->item(newStart + i);
         if (item) {
-            // Retrieve the file path we stored in Qt::UserRole
-            QString filePath = item->data(Qt::UserRole).toString();
-            if (!filePath.isEmpty()) {
-                orderedFilePaths.append(filePath);
-                qDebug() << "  Position" << i << ":" << filePath;
-            }
+            musicStorage->moveTrack(item->data(Qt::UserRole).toString(), to);
         }
     }
-
-    // Update the order in storage (saves to JSON immediately)
-    musicStorage->updateTrackOrder(orderedFilePaths);
-
-    qDebug() << "New order saved to playlist.json with" << orderedFilePaths.size() << "tracks";
+    rebuildTrackIndex();
 }
 
 void DownloadedSongsPage::onRefreshButtonClicked()
 {
     qDebug() << "Refreshing song list from folder...";
 
-    // Force refresh the list from the actual folder
-    // This will rescan the folder and pick up any new files
-    // or restore files that were previously deleted
-    refreshSongList();
-
-    // Show feedback to user
-    infoLabel->setText(infoLabel->text() + " • Refreshed!");
-
-    // Reset the text after 2 seconds
-    QTimer::singleShot(2000, this, [this]() {
-        // Recalculate the info
-        qint64 totalSize = 0;
-        for (const Track &track : downloadedTracks) {
-            QFileInfo fileInfo(track.filePath());
-            totalSize += fileInfo.size();
-        }
-        double totalSizeMB = totalSize / (1024.0 * 1024.0);
-        infoLabel->setText(QString("%1 songs • %2 MB")
-                              .arg(downloadedTracks.size())
-                              .arg(totalSizeMB, 0, 'f', 1));
-    });
+    // Rescan the folder in the background; new files, changed files and
+    // files deleted outside the app show up through tracksChanged
+    musicStorage->rescanLibrary();
+    updateInfoLabel();
 }
 
 QString DownloadedSongsPage::formatDateAdded(const QDateTime &dateTime) const
@@ -486,8 +520,6 @@ void DownloadedSongsPage::onTrackChanged(const Track &track)
     // Update the current playing file path
     m_currentPlayingFile = track.filePath();
 
-    // Refresh the list to update visual indicators (playing animation)
-    refreshSongList();
+    // Move the indicator to the new row; the list itself is not rebuilt
+    setPlayingItem(m_itemsByPath.value(m_currentPlayingFile));
 }
-
-// Animation now handled by QMovie with GIF, so this function is no longer needed
@@ -5,6 +5,8 @@
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QListWidget>
+#include <QHash>
+#include <QTimer>
 #include "models/track.h"
 #include "services/musicstorageservice.h"
 #include "services/playerservice.h"
@@ -23,14 +25,30 @@ private slots:
     void onSongItemClicked(QListWidgetItem *item);
     void onPlayButtonClicked(int index);
     void onDeleteButtonClicked(const QString &filePath);
-    void onSongOrderChanged();
+    void onSongOrderChanged(const QModelIndex &parent, int start, int end,
+                            const QModelIndex &destination, int row);
     void onRefreshButtonClicked();
     void onTrackChanged(const Track &track);
+    void updateInfoLabel();
+    void onAnimationFrame();
+    void onTrackUpdated(const Track &track);
+    void prioritizeVisibleRows();
+    void onMembershipChanged(qint64 playlistId, const QString &filePath, bool member);
+    void onSongContextMenu(const QPoint &pos);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
 
 private:
     void setupUI();
     void loadDownloadedSongs();
-    QWidget* createDownloadedSongItem(const Track &track, int index);
+    void populateItem(QListWidgetItem *item, const Track &track);
+    int indexOfTrack(const QString &filePath) const;
+    void rebuildTrackIndex();
+    void setPlayingItem(QListWidgetItem *item);
+    void updateIndicatorActive();
 
     QVBoxLayout *mainLayout;
     QLabel *titleLabel;
@@ -40,8 +58,13 @@ private:
     MusicStorageService *musicStorage;
     PlayerService *playerService;
     QList<Track> downloadedTracks;
+    QHash<QString, int> m_trackIndex;                   // File path -> index in downloadedTracks
+    QHash<QString, QListWidgetItem*> m_itemsByPath;     // File path -> row
 
     QString m_currentPlayingFile;
+    QListWidgetItem *m_playingItem;
+    bool m_indicatorActive;
+    QTimer *m_prioritizeTimer;
 
     QString formatDateAdded(const QDateTime &dateTime) const;
     QString formatFileSize(qint64 bytes) const;
@@ -0,0 +1,345 @@
+#include "downloadedsongdelegate.h"
+#include "nowplayinganimation.h"
+#include "theme.h"
+#include "utils/metrics.h"
+#include <QAbstractItemView>
+#include <QApplication>
+#include <QHelpEvent>
+#include <QHoverEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPixmapCache>
+#include <QToolTip>
+
+namespace {
+constexpr int kHorizontalMargin = 16;
+constexpr int kSpacing = 12;
+constexpr int kLineSpacing = 2;
+constexpr int kPlaySize = 32;
+constexpr int kPlayIconSize = 16;
+constexpr int kDeleteSize = 40;
+constexpr int kDeleteIconSize = 16;
+constexpr int kLikeSize = 32;
+constexpr int kDateWidth = 120;
+constexpr int kDurationWidth = 80;
+constexpr int kSizeWidth = 100;
+}
+
+DownloadedSongDelegate::DownloadedSongDelegate(QAbstractItemView *view)
+    : QStyledItemDelegate(view)
+    , m_view(view)
+    , m_hoverPart(Part::None)
+    , m_showFileDetails(true)
+    , m_textColor(Theme::color("text"))
+    , m_subtitleColor(Theme::color("textTertiary"))
+    , m_detailColor(Theme::color("textSecondary"))
+    , m_artBackground(Theme::color("divider"))
+    , m_artBorder(Theme::color("border"))
+    , m_deleteHover(Theme::color("danger"))
+{
+    // Icons are scaled once here instead of per row
+    const qreal dpr = qApp->devicePixelRatio();
+    m_playIcon = QPixmap(":/images/src/resources/images/playButton.png")
+                     .scaled(qRound(kPlayIconSize * dpr), qRound(kPlayIconSize * dpr),
+                             Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    m_playIcon.setDevicePixelRatio(dpr);
+    m_deleteIcon = QPixmap(":/images/src/resources/images/xButton.png")
+                       .scaled(qRound(kDeleteIconSize * dpr), qRound(kDeleteIconSize * dpr),
+                               Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    m_deleteIcon.setDevicePixelRatio(dpr);
+
+    // Hover on the play/delete areas changes the cursor and the delete
+    // highlight without the view having to repaint on every mouse move
+    m_view->viewport()->setAttribute(Qt::WA_Hover);
+    m_view->viewport()->installEventFilter(this);
+}
+
+// ========== Geometry ==========
+
+QRect DownloadedSongDelegate::playRect(const QRect &row) const
+{
+    return QRect(row.left() + kHorizontalMargin,
+                 row.top() + (row.height() - kPlaySize) / 2,
+                 kPlaySize, kPlaySize);
+}
+
+QRect DownloadedSongDelegate::albumArtRect(const QRect &row) const
+{
+    return QRect(playRect(row).right() + 1 + kSpacing,
+                 row.top() + (row.height() - kAlbumArtSize) / 2,
+                 kAlbumArtSize, kAlbumArtSize);
+}
+
+QRect DownloadedSongDelegate::deleteRect(const QRect &row) const
+{
+    return QRect(row.right() + 1 - kHorizontalMargin - kDeleteSize,
+                 row.top() + (row.height() - kDeleteSize) / 2,
+                 kDeleteSize, kDeleteSize);
+}
+
+QRect DownloadedSongDelegate::likeRect(const QRect &row) const
+{
+    // Left of the delete button, or in its place when that is hidden
+    const QRect anchor = deleteRect(row);
+    const int right = m_showFileDetails ? anchor.left() - kSpacing : anchor.right() + 1;
+    return QRect(right - kLikeSize, row.top() + (row.height() - kLikeSize) / 2,
+                 kLikeSize, kLikeSize);
+}
+
+DownloadedSongDelegate::Part DownloadedSongDelegate::partAt(const QRect &row, const QPoint &pos) const
+{
+    if (playRect(row).contains(pos)) {
+        return Part::Play;
+    }
+    if (likeRect(row).contains(pos)) {
+        return Part::Like;
+    }
+    if (m_showFileDetails && deleteRect(row).contains(pos)) {
+        return Part::Delete;
+    }
+    return Part::None;
+}
+
+// ========== Painting ==========
+
+QSize DownloadedSongDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    Q_UNUSED(index);
+    return QSize(option.rect.width(), kRowHeight);
+}
+
+QPixmap DownloadedSongDelegate::albumArt(const QModelIndex &index) const
+{
+    QPixmap art = qvariant_cast<QPixmap>(index.data(AlbumArtRole));
+    if (!art.isNull()) {
+        return art;
+    }
+
+    // Covers are decoded on first paint, so only rows that scroll into
+    // view pay for them; scaled covers survive list rebuilds in the cache
+    const QString artPath = index.data(AlbumArtPathRole).toString();
+    if (artPath.isEmpty()) {
+        return QPixmap();
+    }
+
+    const QString cacheKey = "downloaded48:" + artPath;
+    if (QPixmapCache::find(cacheKey, &art)) {
+        EKNM_METRIC_COUNT(CoverHits, 1);
+        return art;
+    }
+
+    EKNM_METRIC_COUNT(CoverMisses, 1);
+    QPixmap source(artPath);
+    if (!source.isNull()) {
+        art = source.scaled(kAlbumArtSize, kAlbumArtSize,
+                            Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+        QPixmapCache::insert(cacheKey, art);
+    }
+    return art;
+}
+
+void DownloadedSongDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                                   const QModelIndex &index) const
+{
+    // Background, hover, selection and separator from the theme's ::item rules
+    QStyleOptionViewItem panel = option;
+    initStyleOption(&panel, index);
+    panel.text.clear();
+    panel.icon = QIcon();
+    const QWidget *widget = option.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &panel, painter, widget);
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+
+    const QRect rect = option.rect;
+
+    // Play button, or the shared animation on the playing row
+    const QRect play = playRect(rect);
+    if (index.data(IsPlayingRole).toBool()) {
+        const QPixmap frame = NowPlayingAnimation::instance()->currentFrame();
+        if (!frame.isNull()) {
+            painter->drawPixmap(play, frame);
+        }
+    } else {
+        QRect icon(QPoint(0, 0), QSize(kPlayIconSize, kPlayIconSize));
+        icon.moveCenter(play.center());
+        painter->drawPixmap(icon, m_playIcon);
+    }
+
+    // Album art (center-cropped) or the fallback note
+    const QRect artRect = albumArtRect(rect);
+    QPainterPath artClip;
+    artClip.addRoundedRect(QRectF(artRect).adjusted(0.5, 0.5, -0.5, -0.5), 4, 4);
+    painter->fillPath(artClip, m_artBackground);
+
+    const QPixmap art = albumArt(index);
+    if (!art.isNull()) {
+        painter->setClipPath(artClip);
+        QRect source(QPoint(0, 0), artRect.size());
+        source.moveCenter(art.rect().center());
+        painter->drawPixmap(artRect, art, source);
+        painter->setClipping(false);
+    } else {
+        QFont noteFont = option.font;
+        noteFont.setPixelSize(20);
+        painter->setFont(noteFont);
+        painter->setPen(m_subtitleColor);
+        painter->drawText(artRect, Qt::AlignCenter, QStringLiteral("♪"));
+    }
+    painter->setPen(m_artBorder);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawPath(artClip);
+
+    // Right-hand columns, laid out from the like (and delete) button inwards
+    const QRect like = likeRect(rect);
+    const int detailsRight = like.left() - kSpacing;
+    const QRect size(detailsRight - kSizeWidth, rect.top(), kSizeWidth, rect.height());
+    const QRect duration((m_showFileDetails ? size.left() - kSpacing : detailsRight) - kDurationWidth,
+                         rect.top(), kDurationWidth, rect.height());
+    const QRect date(duration.left() - kSpacing - kDateWidth, rect.top(), kDateWidth, rect.height());
+
+    if (m_showFileDetails) {
+        const QRect remove = deleteRect(rect);
+        if (m_hoverPart == Part::Delete && m_hoverIndex == index) {
+            painter->fillRect(remove, m_deleteHover);
+        }
+        QRect deleteIcon(QPoint(0, 0), QSize(kDeleteIconSize, kDeleteIconSize));
+        deleteIcon.moveCenter(remove.center());
+        painter->drawPixmap(deleteIcon, m_deleteIcon);
+    }
+
+    const bool liked = index.data(IsLikedRole).toBool();
+    QFont likeFont = option.font;
+    likeFont.setPixelSize(18);
+    painter->setFont(likeFont);
+    painter->setPen(liked ? m_textColor : m_subtitleColor);
+    painter->drawText(like, Qt::AlignCenter, liked ? QStringLiteral("♥") : QStringLiteral("♡"));
+
+    QFont detailFont = option.font;
+    detailFont.setPixelSize(13);
+    painter->setFont(detailFont);
+    painter->setPen(m_detailColor);
+    painter->drawText(duration, Qt::AlignCenter,
+                      index.data(DurationTextRole).toString());
+    if (m_showFileDetails) {
+        painter->drawText(date, Qt::AlignLeft | Qt::AlignVCenter,
+                          index.data(DateAddedTextRole).toString());
+        painter->drawText(size, Qt::AlignRight | Qt::AlignVCenter,
+                          index.data(FileSizeTextRole).toString());
+    }
+
+    // Title and artist, stacked and vertically centered
+    const int textLeft = artRect.right() + 1 + kSpacing;
+    const int textRight = m_showFileDetails ? date.left() : duration.left();
+    const int textWidth = textRight - kSpacing - textLeft;
+    if (textWidth > 0) {
+        QFont titleFont = option.font;
+        titleFont.setPixelSize(15);
+        titleFont.setWeight(QFont::DemiBold);
+        QFont artistFont = detailFont;
+
+        QFontMetrics titleMetrics(titleFont);
+        QFontMetrics artistMetrics(artistFont);
+        const int blockHeight = titleMetrics.height() + kLineSpacing + artistMetrics.height();
+        int y = rect.top() + (rect.height() - blockHeight) / 2;
+
+        painter->setFont(titleFont);
+        painter->setPen(m_textColor);
+        painter->drawText(QRect(textLeft, y, textWidth, titleMetrics.height()), Qt::AlignLeft | Qt::AlignVCenter,
+                          titleMetrics.elidedText(index.data(TitleRole).toString(), Qt::ElideRight, textWidth));
+        y += titleMetrics.height() + kLineSpacing;
+
+        painter->setFont(artistFont);
+        painter->setPen(m_subtitleColor);
+        painter->drawText(QRect(textLeft, y, textWidth, artistMetrics.height()), Qt::AlignLeft | Qt::AlignVCenter,
+                          artistMetrics.elidedText(index.data(ArtistRole).toString(), Qt::ElideRight, textWidth));
+    }
+
+    painter->restore();
+}
+
+// ========== Interaction ==========
+
+bool DownloadedSongDelegate::editorEvent(QEvent *event, QAbstractItemModel *model,
+                                         const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (event->type() == QEvent::MouseButtonPress || event->type() == QEvent::MouseButtonRelease
+        || event->type() == QEvent::MouseButtonDblClick) {
+        auto *mouseEvent = static_cast<QMouseEvent*>(event);
+        const Part part = partAt(option.rect, mouseEvent->position().toPoint());
+        if (part != Part::None && mouseEvent->button() == Qt::LeftButton) {
+            // The buttons swallow presses so they neither select nor start a drag
+            if (event->type() == QEvent::MouseButtonRelease) {
+                if (part == Part::Play) {
+                    emit playClicked(index);
+                } else if (part == Part::Like) {
+                    emit likeClicked(index);
+                } else {
+                    emit deleteClicked(index);
+                }
+            }
+            return true;
+        }
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
+
+bool DownloadedSongDelegate::helpEvent(QHelpEvent *event, QAbstractItemView *view,
+                                       const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (event->type() == QEvent::ToolTip) {
+        const Part part = partAt(option.rect, event->pos());
+        if (part == Part::Delete) {
+            QToolTip::showText(event->globalPos(), "Delete song", view);
+            return true;
+        }
+        if (part == Part::Like) {
+            QToolTip::showText(event->globalPos(),
+                               index.data(IsLikedRole).toBool() ? "Remove from Liked Songs"
+                                                                : "Add to Liked Songs", view);
+            return true;
+        }
+    }
+    return QStyledItemDelegate::helpEvent(event, view, option, index);
+}
+
+bool DownloadedSongDelegate::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_view->viewport()) {
+        if (event->type() == QEvent::HoverMove || event->type() == QEvent::HoverEnter) {
+            const QPoint pos = static_cast<QHoverEvent*>(event)->position().toPoint();
+            const QModelIndex index = m_view->indexAt(pos);
+            setHover(index, index.isValid() ? partAt(m_view->visualRect(index), pos) : Part::None);
+        } else if (event->type() == QEvent::HoverLeave) {
+            setHover(QModelIndex(), Part::None);
+        }
+    }
+    return QStyledItemDelegate::eventFilter(watched, event);
+}
+
+void DownloadedSongDelegate::setHover(const QModelIndex &index, Part part)
+{
+    if (part == m_hoverPart && (part == Part::None || index == m_hoverIndex)) {
+        return;
+    }
+
+    if (part == Part::None) {
+        m_view->viewport()->unsetCursor();
+    } else if (m_hoverPart == Part::None) {
+        m_view->viewport()->setCursor(Qt::PointingHandCursor);
+    }
+
+    // Only the delete highlight depends on hover; repaint just that area
+    if (m_hoverPart == Part::Delete && m_hoverIndex.isValid()) {
+        m_view->viewport()->update(deleteRect(m_view->visualRect(m_hoverIndex)));
+    }
+    m_hoverIndex = index;
+    m_hoverPart = part;
+    if (m_hoverPart == Part::Delete && m_hoverIndex.isValid()) {
+        m_view->viewport()->update(deleteRect(m_view->visualRect(m_hoverIndex)));
+    }
+}
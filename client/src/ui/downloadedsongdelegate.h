@@ -0,0 +1,94 @@
+#ifndef DOWNLOADEDSONGDELEGATE_H
+#define DOWNLOADEDSONGDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QPersistentModelIndex>
+#include <QPixmap>
+#include <QColor>
+
+class QAbstractItemView;
+
+/**
+ * @brief Paints a Downloaded Songs row
+ *
+ * Same columns as the old per-row widgets (play button or now playing
+ * animation, album art, title/artist, date added, duration, size, like and
+ * delete buttons), drawn directly from item data so a row costs no child
+ * widgets. Pages that list tracks rather than files (Liked Songs) turn the
+ * date, size and delete columns off with setShowFileDetails(false).
+ * The playing row draws the shared NowPlayingAnimation frame; the view only
+ * has to repaint that row when the frame changes.
+ *
+ * Row background, hover and selection still come from the theme's ::item
+ * rules. Clicks on the play, like and delete areas are reported as signals.
+ */
+class DownloadedSongDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    // Qt::UserRole holds the file path (kept stable across drag & drop)
+    enum Role {
+        TitleRole = Qt::UserRole + 1,
+        ArtistRole,
+        DateAddedTextRole,
+        DurationTextRole,
+        FileSizeTextRole,
+        AlbumArtRole,       // QPixmap, only for tracks with in-memory art
+        AlbumArtPathRole,   // Cover file, scaled lazily through QPixmapCache
+        IsPlayingRole,
+        IsLikedRole
+    };
+
+    explicit DownloadedSongDelegate(QAbstractItemView *view);
+
+    // Date added, file size and delete button (on by default)
+    void setShowFileDetails(bool show) { m_showFileDetails = show; }
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    bool editorEvent(QEvent *event, QAbstractItemModel *model,
+                     const QStyleOptionViewItem &option, const QModelIndex &index) override;
+    bool helpEvent(QHelpEvent *event, QAbstractItemView *view,
+                   const QStyleOptionViewItem &option, const QModelIndex &index) override;
+
+    static constexpr int kRowHeight = 64;
+    static constexpr int kAlbumArtSize = 48;
+
+signals:
+    void playClicked(const QModelIndex &index);
+    void likeClicked(const QModelIndex &index);
+    void deleteClicked(const QModelIndex &index);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    enum class Part { None, Play, Like, Delete };
+
+    QRect playRect(const QRect &row) const;
+    QRect albumArtRect(const QRect &row) const;
+    QRect deleteRect(const QRect &row) const;
+    QRect likeRect(const QRect &row) const;
+    Part partAt(const QRect &row, const QPoint &pos) const;
+    QPixmap albumArt(const QModelIndex &index) const;
+    void setHover(const QModelIndex &index, Part part);
+
+    QAbstractItemView *m_view;
+    QPersistentModelIndex m_hoverIndex;
+    Part m_hoverPart;
+    bool m_showFileDetails;
+
+    QPixmap m_playIcon;
+    QPixmap m_deleteIcon;
+
+    QColor m_textColor;
+    QColor m_subtitleColor;
+    QColor m_detailColor;
+    QColor m_artBackground;
+    QColor m_artBorder;
+    QColor m_deleteHover;
+};
+
+#endif // DOWNLOADEDSONGDELEGATE_H
@@ -1,11 +1,27 @@
 #include "likedsongs.h"
+#include "downloadedsongdelegate.h"
+#include "theme.h"
+#include "services/musicstorageservice.h"
+#include "services/playerservice.h"
+#include "services/playlistservice.h"
 #include <QListWidgetItem>
 
 LikedSongsPage::LikedSongsPage(QWidget *parent)
     : QWidget(parent)
+    , m_playlistId(PlaylistService::instance()->likedPlaylistId())
 {
     setupUI();
-    addMockData();
+
+    PlaylistService *playlists = PlaylistService::instance();
+    connect(playlists, &PlaylistService::membershipChanged,
+            this, &LikedSongsPage::onMembershipChanged);
+
+    // Rows show library metadata, so a changed library means a new list
+    MusicStorageService *storage = MusicStorageService::instance();
+    connect(storage, &MusicStorageService::tracksChanged, this, &LikedSongsPage::reload);
+    storage->loadLibrary();
+
+    reload();
 }
 
 LikedSongsPage::~LikedSongsPage()
@@ -18,67 +34,40 @@ void LikedSongsPage::setupUI()
     mainLayout->setSpacing(15);
     mainLayout->setContentsMargins(40, 40, 40, 40);
 
-    // Simple light background
-    setStyleSheet(
-        "QWidget {"
-        "   background-color: #f5f5f5;"
-        "}"
-    );
+    // Light background and row styles come from the application theme
+    setObjectName("likedSongsPage");
 
     // Simple title - black and white
     titleLabel = new QLabel("Liked Songs", this);
-    titleLabel->setStyleSheet(
-        "font-size: 32px;"
-        "font-weight: 600;"
-        "color: #000000;"
-        "margin-bottom: 5px;"
-    );
+    Theme::setRole(titleLabel, "pageTitle");
 
     // Info label - gray
     infoLabel = new QLabel("0 songs", this);
-    infoLabel->setStyleSheet(
-        "font-size: 14px;"
-        "color: #666666;"
-        "margin-bottom: 25px;"
-    );
+    Theme::setRole(infoLabel, "pageInfo");
 
-    // Simple list with cards
+    // Same rows as Downloads, reorderable by drag and drop
     songListWidget = new QListWidget(this);
-    songListWidget->setStyleSheet(
-        "QListWidget {"
-        "   background-color: transparent;"
-        "   border: none;"
-        "   outline: none;"
-        "}"
-        "QListWidget::item {"
-        "   background-color: white;"
-        "   padding: 12px;"
-        "   border-radius: 8px;"
-        "   margin-bottom: 10px;"
-        "   border: 1px solid #e0e0e0;"
-        "}"
-        "QListWidget::item:hover {"
-        "   background-color: #fafafa;"
-        "   box-shadow: 0 2px 8px rgba(0,0,0,0.1);"
-        "}"
-        "QListWidget::item:selected {"
-        "   background-color: #ecf0f1;"
-        "   border: 1px solid #bdc3c7;"
-        "}"
-        "QScrollBar:vertical {"
-        "   background: transparent;"
-        "   width: 8px;"
-        "}"
-        "QScrollBar::handle:vertical {"
-        "   background: #bdc3c7;"
-        "   border-radius: 4px;"
-        "}"
-        "QScrollBar::handle:vertical:hover {"
-        "   background: #95a5a6;"
-        "}"
-    );
-
-    connect(songListWidget, &QListWidget::itemClicked, this, &LikedSongsPage::onSongItemClicked);
+    songListWidget->setSpacing(0);
+    songListWidget->setDragEnabled(true);
+    songListWidget->setAcceptDrops(true);
+    songListWidget->setDropIndicatorShown(true);
+    songListWidget->setDragDropMode(QAbstractItemView::InternalMove);
+    songListWidget->setDefaultDropAction(Qt::MoveAction);
+    songListWidget->setUniformItemSizes(true);
+    Theme::setRole(songListWidget, "songList");
+
+    DownloadedSongDelegate *songDelegate = new DownloadedSongDelegate(songListWidget);
+    songDelegate->setShowFileDetails(false);
+    songListWidget->setItemDelegate(songDelegate);
+    connect(songDelegate, &DownloadedSongDelegate::playClicked, this, [this](const QModelIndex &index) {
+        play(index.data(Qt::UserRole).toString());
+    });
+    connect(songDelegate, &DownloadedSongDelegate::likeClicked, this, [](const QModelIndex &index) {
+        PlaylistService::instance()->setLiked(index.data(Qt::UserRole).toString(), false);
+    });
+
+    connect(songListWidget->model(), &QAbstractItemModel::rowsMoved,
+            this, &LikedSongsPage::onSongOrderChanged);
 
     // Add to layout
     mainLayout->addWidget(titleLabel);
@@ -86,125 +75,103 @@ void LikedSongsPage::setupUI()
     mainLayout->addWidget(songListWidget);
 }
 
-void LikedSongsPage::addMockData()
+void LikedSongsPage::reload()
 {
-    // Mock song data for demonstration
-    struct Song {
-        QString title;
-        QString artist;
-        QString duration;
-    };
-
-    QList<Song> mockSongs = {
-        {"Blinding Lights", "The Weeknd", "3:20"},
-        {"Shape of You", "Ed Sheeran", "3:53"},
-        {"Someone Like You", "Adele", "4:45"},
-        {"Uptown Funk", "Mark Ronson ft. Bruno Mars", "4:30"},
-        {"Bohemian Rhapsody", "Queen", "5:55"},
-        {"Hotel California", "Eagles", "6:30"},
-        {"Imagine", "John Lennon", "3:03"},
-        {"Smells Like Teen Spirit", "Nirvana", "5:01"},
-        {"Billie Jean", "Michael Jackson", "4:54"},
-        {"Yesterday", "The Beatles", "2:05"}
-    };
-
-    for (const auto &song : mockSongs) {
-        QListWidgetItem *item = new QListWidgetItem(songListWidget);
-        QWidget *songWidget = createSongItem(song.title, song.artist, song.duration);
-        item->setSizeHint(songWidget->sizeHint());
-        songListWidget->setItemWidget(item, songWidget);
+    songListWidget->clear();
+    m_itemsByPath.clear();
+
+    const QList<Track> tracks = PlaylistService::instance()->tracks(m_playlistId);
+    m_itemsByPath.reserve(tracks.size());
+    for (const Track &track : tracks) {
+        appendItem(track);
     }
+    updateInfoLabel();
+}
 
-    infoLabel->setText(QString("%1 songs").arg(mockSongs.size()));
+void LikedSongsPage::appendItem(const Track &track)
+{
+    // Filled before insertion so the view sees each row once
+    QListWidgetItem *item = new QListWidgetItem();
+    item->setData(Qt::UserRole, track.filePath());
+    item->setData(DownloadedSongDelegate::TitleRole, track.title());
+    item->setData(DownloadedSongDelegate::ArtistRole, track.artist());
+    item->setData(DownloadedSongDelegate::DurationTextRole, track.formattedDuration());
+    item->setData(DownloadedSongDelegate::IsLikedRole, true);
+    if (!track.albumArt().isNull()) {
+        const int side = DownloadedSongDelegate::kAlbumArtSize;
+        item->setData(DownloadedSongDelegate::AlbumArtRole,
+                      track.albumArt().scaled(side, side, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
+    } else if (!track.albumArtPath().isEmpty()) {
+        item->setData(DownloadedSongDelegate::AlbumArtPathRole, track.albumArtPath());
+    }
+
+    songListWidget->addItem(item);
+    m_itemsByPath.insert(track.filePath(), item);
 }
 
-QWidget* LikedSongsPage::createSongItem(const QString &title, const QString &artist, const QString &duration)
+void LikedSongsPage::updateInfoLabel()
 {
-    QWidget *widget = new QWidget();
-    widget->setMinimumHeight(70); // Fix: установим минимальную высоту
-    QHBoxLayout *layout = new QHBoxLayout(widget);
-    layout->setContentsMargins(15, 10, 15, 10);
-    layout->setSpacing(15);
-
-    // Song info
-    QVBoxLayout *infoLayout = new QVBoxLayout();
-    infoLayout->setSpacing(5);
-
-    QLabel *titleLabel = new QLabel(title);
-    titleLabel->setStyleSheet(
-        "font-size: 15px;"
-        "font-weight: 600;"
-        "color: #000000;"
-    );
-    titleLabel->setWordWrap(false);
-    titleLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-
-    QLabel *artistLabel = new QLabel(artist);
-    artistLabel->setStyleSheet(
-        "font-size: 13px;"
-        "color: #888888;"
-    );
-    artistLabel->setWordWrap(false);
-    artistLabel->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-
-    infoLayout->addWidget(titleLabel);
-    infoLayout->addWidget(artistLabel);
-
-    // Duration - simple gray
-    QLabel *durationLabel = new QLabel(duration);
-    durationLabel->setStyleSheet(
-        "font-size: 13px;"
-        "color: #666666;"
-        "padding: 5px;"
-    );
-    durationLabel->setAlignment(Qt::AlignCenter);
-    durationLabel->setMinimumWidth(50);
-
-    // Simple like button
-    QPushButton *likeBtn = new QPushButton("♥");
-    likeBtn->setFixedSize(36, 36);
-    likeBtn->setStyleSheet(
-        "QPushButton {"
-        "   background-color: white;"
-        "   color: #000000;"
-        "   border: 1px solid #d0d0d0;"
-        "   border-radius: 18px;"
-        "   font-size: 18px;"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #f0f0f0;"
-        "   border: 1px solid #000000;"
-        "}"
-    );
-    likeBtn->setCursor(Qt::PointingHandCursor);
-
-    // Simple play button
-    QPushButton *playBtn = new QPushButton("▶");
-    playBtn->setFixedSize(42, 42);
-    playBtn->setStyleSheet(
-        "QPushButton {"
-        "   background-color: #000000;"
-        "   color: #FFFFFF;"
-        "   border: none;"
-        "   border-radius: 21px;"
-        "   font-size: 16px;"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #333333;"
-        "}"
-    );
-    playBtn->setCursor(Qt::PointingHandCursor);
-
-    layout->addLayout(infoLayout, 1);
-    layout->addWidget(durationLabel);
-    layout->addWidget(likeBtn);
-    layout->addWidget(playBtn);
-
-    return widget;
+    infoLabel->setText(QString("%1 songs").arg(songListWidget->count()));
 }
 
-void LikedSongsPage::onSongItemClicked(QListWidgetItem *item)
+void LikedSongsPage::onMembershipChanged(qint64 playlistId, const QString &filePath, bool member)
 {
-    // Handle song item click (play song in future iterations)
-    Q_UNUSED(item);
+    if (playlistId != m_playlistId) {
+        return;
+    }
+
+    if (member) {
+        // New likes go to the end of the playlist
+        const Track track = MusicStorageService::instance()->findTrack(filePath);
+        if (track.isValid() && !m_itemsByPath.contains(filePath)) {
+            appendItem(track);
+        }
+    } else {
+        delete m_itemsByPath.take(filePath);
+    }
+    updateInfoLabel();
+}
+
+void LikedSongsPage::onSongOrderChanged(const QModelIndex &parent, int start, int end,
+                                        const QModelIndex &destination, int row)
+{
+    Q_UNUSED(parent);
+    Q_UNUSED(destination);
+
+    // Each moved row is re-ranked in front of the row that now follows the
+    // block; nothing else in the playlist changes
+    const int count = end - start + 1;
+    const int newStart = row > start ? row - count : row;
+    QListWidgetItem *next = songListWidget->item(newStart + count);
+    const QString beforeFilePath = next ? next->data(Qt::UserRole).toString() : QString();
+
+    PlaylistService *playlists = PlaylistService::instance();
+    for (int i = newStart; i < newStart + count; ++i) {
+        playlists->moveTrack(m_playlistId, songListWidget->item(i)->data(Qt::UserRole).toString(),
+                             beforeFilePath);
+    }
+}
+
+void LikedSongsPage::play(const QString &filePath)
+{
+    // Play the playlist in its on-screen order, starting at the clicked song
+    MusicStorageService *storage = MusicStorageService::instance();
+    QList<Track> tracks;
+    tracks.reserve(songListWidget->count());
+    int startIndex = 0;
+    for (int i = 0; i < songListWidget->count(); ++i) {
+        const QString rowPath = songListWidget->item(i)->data(Qt::UserRole).toString();
+        const Track track = storage->findTrack(rowPath);
+        if (!track.isValid()) {
+            continue;
+        }
+        if (rowPath == filePath) {
+            startIndex = tracks.size();
+        }
+        tracks.append(track);
+    }
+
+    if (!tracks.isEmpty()) {
+        PlayerService::instance()->setPlaylist(tracks, startIndex);
+    }
 }
@@ -5,9 +5,17 @@
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QListWidget>
-#include <QPushButton>
-#include <QHBoxLayout>
+#include <QHash>
+#include "models/track.h"
 
+/**
+ * @brief The Liked Songs playlist
+ *
+ * Lists the liked playlist from PlaylistService in its saved order, with
+ * the downloads row delegate (without the file columns). Unliking removes
+ * the row, liking elsewhere appends one, and drag and drop moves a single
+ * entry; the list is only rebuilt when the library itself changes.
+ */
 class LikedSongsPage : public QWidget
 {
     Q_OBJECT
@@ -17,17 +25,24 @@ public:
     ~LikedSongsPage();
 
 private slots:
-    void onSongItemClicked(QListWidgetItem *item);
+    void reload();
+    void onMembershipChanged(qint64 playlistId, const QString &filePath, bool member);
+    void onSongOrderChanged(const QModelIndex &parent, int start, int end,
+                            const QModelIndex &destination, int row);
 
 private:
     void setupUI();
-    void addMockData();
-    QWidget* createSongItem(const QString &title, const QString &artist, const QString &duration);
+    void appendItem(const Track &track);
+    void updateInfoLabel();
+    void play(const QString &filePath);
 
     QVBoxLayout *mainLayout;
     QLabel *titleLabel;
     QLabel *infoLabel;
     QListWidget *songListWidget;
+
+    qint64 m_playlistId;
+    QHash<QString, QListWidgetItem*> m_itemsByPath;  // File path -> row
 };
 
 #endif // LIKEDSONGS_H
@@ -1,15 +1,28 @@
 #include "mainwindow.h"
 #include "searchpage.h"
 #include "downloadedpage.h"
-#include "eknmintercomradiopage.h"
+#include "likedsongs.h"
+#include "stationradiopage.h"
 #include "playerwidget.h"
+#include "services/radioservice.h"
+#include "services/stationregistry.h"
+#include "services/musicstorageservice.h"
+#include "utils/startuptrace.h"
+#include <QTimer>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
+    , searchPage(nullptr)
+    , downloadedPage(nullptr)
+    , likedPage(nullptr)
     , currentMode(SONGS)
+    , firstFrameReported(false)
 {
+    StartupTrace::Span span("MainWindow");
+
+    // Styles live in the application theme (ui/theme.cpp), scoped by this name
+    setObjectName("mainWindow");
     setupUI();
-    applyStyles();
 
     resize(1380, 800);
     setMinimumSize(1380, 800);
@@ -17,12 +30,28 @@ MainWindow::MainWindow(QWidget *parent)
 
     // Show Search page by default
     showSearch();
+
+    // Start reading the library snapshot once the window is up; the
+    // Downloads page picks it up from memory when first shown
+    QTimer::singleShot(0, MusicStorageService::instance(), &MusicStorageService::loadLibrary);
 }
 
 MainWindow::~MainWindow()
 {
 }
 
+void MainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+
+    // End of the startup trace: the user can see (and use) the window
+    if (!firstFrameReported) {
+        firstFrameReported = true;
+        StartupTrace::mark("first-frame");
+        StartupTrace::flush();
+    }
+}
+
 void MainWindow::setupUI()
 {
     centralWidget = new QWidget(this);
@@ -101,15 +130,12 @@ void MainWindow::createSidebar()
     // Navigation buttons for SONGS mode
     searchBtn = createNavButton("🔍 Search", "🔍");
     downloadedBtn = createNavButton("⬇ Downloads", "⬇");
-
-    // Navigation button for RADIO mode
-    eknmIntercomBtn = createNavButton("📻 EKNM Intercom", "📻");
-    eknmIntercomBtn->setVisible(false); // Hidden by default
+    likedBtn = createNavButton("♥ Liked Songs", "♥");
 
     // Connect signals
     connect(searchBtn, &QPushButton::clicked, this, &MainWindow::showSearch);
     connect(downloadedBtn, &QPushButton::clicked, this, &MainWindow::showDownloaded);
-    connect(eknmIntercomBtn, &QPushButton::clicked, this, &MainWindow::showRadio);
+    connect(likedBtn, &QPushButton::clicked, this, &MainWindow::showLiked);
 
     // Add widgets to sidebar
     sidebarLayout->addWidget(logoLabel);
@@ -117,9 +143,17 @@ void MainWindow::createSidebar()
     sidebarLayout->addSpacing(10);
     sidebarLayout->addWidget(searchBtn);
     sidebarLayout->addWidget(downloadedBtn);
-    sidebarLayout->addWidget(eknmIntercomBtn);
+    sidebarLayout->addWidget(likedBtn);
     sidebarLayout->addStretch();
 
+    // Navigation buttons for RADIO mode, one per station (hidden by default)
+    StationRegistry *registry = StationRegistry::instance();
+    const QList<RadioStation> stations = registry->stations();
+    for (const RadioStation &station : stations) {
+        addStationButton(station);
+    }
+    connect(registry, &StationRegistry::stationAdded, this, &MainWindow::onStationAdded);
+
     mainLayout->addWidget(sidebar);
 }
 
@@ -135,15 +169,7 @@ void MainWindow::createContent()
     // Create stacked widget for pages
     stackedWidget = new QStackedWidget(contentArea);
 
-    // Create pages
-    searchPage = new SearchPage(stackedWidget);
-    downloadedPage = new DownloadedSongsPage(stackedWidget);
-    radioPage = new EknmIntercomRadioPage(stackedWidget);
-
-    // Add pages to stacked widget
-    stackedWidget->addWidget(searchPage);
-    stackedWidget->addWidget(downloadedPage);
-    stackedWidget->addWidget(radioPage);
+    // Pages are created when first shown (see showSearch/showDownloaded/showStation)
 
     // Create player widget
     playerWidget = new PlayerWidget(contentArea);
@@ -156,40 +182,6 @@ void MainWindow::createContent()
     mainLayout->addWidget(contentArea);
 }
 
-void MainWindow::applyStyles()
-{
-    setStyleSheet(
-        "#sidebar {"
-        "   background-color: #ffffff;"
-        "   border-right: 1px solid #e0e0e0;"
-        "}"
-        "#contentArea {"
-        "   background-color: #f5f5f5;"
-        "}"
-        "QPushButton {"
-        "   background-color: transparent;"
-        "   color: #666666;"
-        "   border: none;"
-        "   border-radius: 6px;"
-        "   padding: 12px 16px;"
-        "   text-align: left;"
-        "   font-size: 14px;"
-        "   font-weight: 500;"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #f5f5f5;"
-        "   color: #000000;"
-        "}"
-        "QPushButton:pressed {"
-        "   background-color: #e8e8e8;"
-        "}"
-        "QPushButton[active=\"true\"] {"
-        "   background-color: #000000;"
-        "   color: #FFFFFF;"
-        "}"
-    );
-}
-
 QPushButton* MainWindow::createNavButton(const QString &text, const QString &iconText)
 {
     Q_UNUSED(iconText);  // Reserved for future icon support
@@ -199,49 +191,138 @@ QPushButton* MainWindow::createNavButton(const QString &text, const QString &ico
     return button;
 }
 
+void MainWindow::addStationButton(const RadioStation &station)
+{
+    QPushButton *button = createNavButton("📻 " + station.name, "📻");
+    button->setVisible(currentMode == RADIO);
+
+    QString stationId = station.id;
+    connect(button, &QPushButton::clicked, this, [this, stationId]() {
+        showStation(stationId);
+    });
+
+    // Keep station buttons above the trailing stretch
+    sidebarLayout->insertWidget(sidebarLayout->count() - 1, button);
+    stationButtons.insert(station.id, button);
+}
+
+void MainWindow::onStationAdded(const RadioStation &station)
+{
+    addStationButton(station);
+
+    if (currentMode == RADIO) {
+        RadioService *service = RadioService::forStation(station.id);
+        if (service) {
+            service->startNowPlayingUpdates();
+        }
+    }
+}
+
+void MainWindow::warmUpStations()
+{
+    // Track every listed station through the shared per-host feed so
+    // switching stations shows current data immediately
+    const QList<RadioStation> stations = StationRegistry::instance()->stations();
+    for (const RadioStation &station : stations) {
+        RadioService *service = RadioService::forStation(station.id);
+        if (service) {
+            service->startNowPlayingUpdates();
+        }
+    }
+
+    StationRegistry::instance()->discoverStations();
+}
+
 void MainWindow::showSearch()
 {
-    stackedWidget->setCurrentWidget(searchPage);
-    searchBtn->setProperty("active", true);
-    downloadedBtn->setProperty("active", false);
+    if (!searchPage) {
+        StartupTrace::Span span("SearchPage");
+        searchPage = new SearchPage(stackedWidget);
+        stackedWidget->addWidget(searchPage);
+    }
 
-    // Refresh styles
-    searchBtn->style()->unpolish(searchBtn);
-    searchBtn->style()->polish(searchBtn);
-    downloadedBtn->style()->unpolish(downloadedBtn);
-    downloadedBtn->style()->polish(downloadedBtn);
+    stackedWidget->setCurrentWidget(searchPage);
+    setActiveSongsButton(searchBtn);
 }
 
 void MainWindow::showDownloaded()
 {
+    if (!downloadedPage) {
+        StartupTrace::Span span("DownloadedSongsPage");
+        downloadedPage = new DownloadedSongsPage(stackedWidget);
+        stackedWidget->addWidget(downloadedPage);
+    }
+
     stackedWidget->setCurrentWidget(downloadedPage);
-    searchBtn->setProperty("active", false);
-    downloadedBtn->setProperty("active", true);
+    setActiveSongsButton(downloadedBtn);
+}
 
-    // Refresh styles
-    searchBtn->style()->unpolish(searchBtn);
-    searchBtn->style()->polish(searchBtn);
-    downloadedBtn->style()->unpolish(downloadedBtn);
-    downloadedBtn->style()->polish(downloadedBtn);
+void MainWindow::showLiked()
+{
+    if (!likedPage) {
+        StartupTrace::Span span("LikedSongsPage");
+        likedPage = new LikedSongsPage(stackedWidget);
+        stackedWidget->addWidget(likedPage);
+    }
+
+    stackedWidget->setCurrentWidget(likedPage);
+    setActiveSongsButton(likedBtn);
+}
+
+void MainWindow::setActiveSongsButton(QPushButton *active)
+{
+    for (QPushButton *button : {searchBtn, downloadedBtn, likedBtn}) {
+        button->setProperty("active", button == active);
+
+        // Refresh styles
+        button->style()->unpolish(button);
+        button->style()->polish(button);
+    }
 }
 
 void MainWindow::showRadio()
+{
+    if (currentStationId.isEmpty() || !stationButtons.contains(currentStationId)) {
+        currentStationId = StationRegistry::instance()->defaultStationId();
+    }
+    showStation(currentStationId);
+}
+
+void MainWindow::showStation(const QString &stationId)
 {
     // If we're not in RADIO mode yet, switch to it first
     if (currentMode != RADIO) {
+        currentStationId = stationId;
         switchToRadioMode();
         return;
     }
 
-    stackedWidget->setCurrentWidget(radioPage);
-    eknmIntercomBtn->setProperty("active", true);
+    RadioStation station = StationRegistry::instance()->station(stationId);
+    if (!station.isValid()) {
+        return;
+    }
+
+    StationRadioPage *page = stationPages.value(stationId);
+    if (!page) {
+        StartupTrace::Span span("StationRadioPage");
+        page = new StationRadioPage(station, stackedWidget);
+        stackedWidget->addWidget(page);
+        stationPages.insert(stationId, page);
+    }
+
+    currentStationId = stationId;
+    stackedWidget->setCurrentWidget(page);
 
     // Load radio background
-    radioPage->loadRadioBackground();
+    page->loadRadioBackground();
 
     // Refresh styles
-    eknmIntercomBtn->style()->unpolish(eknmIntercomBtn);
-    eknmIntercomBtn->style()->polish(eknmIntercomBtn);
+    for (auto it = stationButtons.constBegin(); it != stationButtons.constEnd(); ++it) {
+        QPushButton *button = it.value();
+        button->setProperty("active", it.key() == stationId);
+        button->style()->unpolish(button);
+        button->style()->polish(button);
+    }
 }
 
 void MainWindow::switchToSongsMode()
@@ -255,9 +336,12 @@ void MainWindow::switchToSongsMode()
     // Show SONGS navigation buttons
     searchBtn->setVisible(true);
     downloadedBtn->setVisible(true);
+    likedBtn->setVisible(true);
 
     // Hide RADIO navigation buttons
-    eknmIntercomBtn->setVisible(false);
+    for (QPushButton *button : std::as_const(stationButtons)) {
+        button->setVisible(false);
+    }
 
     // Show player widget for SONGS mode
     playerWidget->setVisible(true);
@@ -277,9 +361,14 @@ void MainWindow::switchToRadioMode()
     // Hide SONGS navigation buttons
     searchBtn->setVisible(false);
     downloadedBtn->setVisible(false);
+    likedBtn->setVisible(false);
 
     // Show RADIO navigation buttons
-    eknmIntercomBtn->setVisible(true);
+    for (QPushButton *button : std::as_const(stationButtons)) {
+        button->setVisible(true);
+    }
+
+    warmUpStations();
 
     // Hide player widget for RADIO mode (radio has its own player)
     playerWidget->setVisible(false);
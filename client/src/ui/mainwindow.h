@@ -9,12 +9,15 @@
 #include <QLabel>
 #include <QWidget>
 #include <QStyle>
+#include <QHash>
+#include "models/radiostation.h"
 
 // Forward declarations
 class PlayerWidget;
 class SearchPage;
 class DownloadedSongsPage;
-class EknmIntercomRadioPage;
+class LikedSongsPage;
+class StationRadioPage;
 
 class MainWindow : public QMainWindow
 {
@@ -24,10 +27,16 @@ public:
     explicit MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
 private slots:
     void showSearch();
     void showDownloaded();
+    void showLiked();
     void showRadio();
+    void showStation(const QString &stationId);
+    void onStationAdded(const RadioStation &station);
     void switchToSongsMode();
     void switchToRadioMode();
 
@@ -35,8 +44,10 @@ private:
     void setupUI();
     void createSidebar();
     void createContent();
-    void applyStyles();
     QPushButton* createNavButton(const QString &text, const QString &iconText);
+    void addStationButton(const RadioStation &station);
+    void setActiveSongsButton(QPushButton *active);
+    void warmUpStations();
 
     // UI Components
     QWidget *centralWidget;
@@ -55,17 +66,20 @@ private:
     // Navigation buttons (will change based on mode)
     QPushButton *searchBtn;
     QPushButton *downloadedBtn;
-    QPushButton *eknmIntercomBtn;
+    QPushButton *likedBtn;
+    QHash<QString, QPushButton*> stationButtons;  // RADIO mode, one per registry station
 
     // Content area
     QWidget *contentArea;
     QVBoxLayout *contentLayout;
     QStackedWidget *stackedWidget;
 
-    // Pages
+    // Pages (all created on first show)
     SearchPage *searchPage;
     DownloadedSongsPage *downloadedPage;
-    EknmIntercomRadioPage *radioPage;
+    LikedSongsPage *likedPage;
+    QHash<QString, StationRadioPage*> stationPages;  // Created on first show
+    QString currentStationId;
 
     // Player
     PlayerWidget *playerWidget;
@@ -73,6 +87,8 @@ private:
     // Current mode
     enum Mode { SONGS, RADIO };
     Mode currentMode;
+
+    bool firstFrameReported;
 };
 
 #endif // MAINWINDOW_H
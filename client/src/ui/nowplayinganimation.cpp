@@ -0,0 +1,106 @@
+#include "nowplayinganimation.h"
+#include <QDebug>
+#include <QGuiApplication>
+#include <QImageReader>
+
+namespace {
+constexpr const char *kAnimationPath = ":/images/src/resources/images/songAnimation.gif";
+
+// GIFs often declare 0 or 10 ms delays; browsers clamp those the same way
+constexpr int kMinFrameDelayMs = 20;
+constexpr int kDefaultFrameDelayMs = 100;
+}
+
+NowPlayingAnimation* NowPlayingAnimation::s_instance = nullptr;
+
+NowPlayingAnimation::NowPlayingAnimation(QObject *parent)
+    : QObject(parent)
+    , m_decoded(false)
+    , m_currentFrame(0)
+    , m_users(0)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &NowPlayingAnimation::advance);
+}
+
+NowPlayingAnimation::~NowPlayingAnimation()
+{
+}
+
+NowPlayingAnimation* NowPlayingAnimation::instance()
+{
+    if (!s_instance) {
+        s_instance = new NowPlayingAnimation(qApp);
+    }
+    return s_instance;
+}
+
+void NowPlayingAnimation::decodeFrames()
+{
+    m_decoded = true;
+
+    // Frames are scaled for the screen once, so painting is a plain blit
+    const qreal dpr = qApp ? qApp->devicePixelRatio() : 1.0;
+    const int side = qRound(kFrameSize * dpr);
+
+    QImageReader reader(kAnimationPath);
+    while (reader.canRead()) {
+        QImage frame = reader.read();
+        if (frame.isNull()) {
+            break;
+        }
+        int delay = reader.nextImageDelay();
+        if (delay <= 0) {
+            delay = kDefaultFrameDelayMs;
+        }
+
+        QPixmap pixmap = QPixmap::fromImage(
+            frame.scaled(side, side, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+        pixmap.setDevicePixelRatio(dpr);
+        m_frames.append(pixmap);
+        m_delays.append(qMax(delay, kMinFrameDelayMs));
+    }
+
+    if (m_frames.isEmpty()) {
+        qWarning() << "Failed to decode now playing animation:" << reader.errorString();
+    }
+}
+
+QPixmap NowPlayingAnimation::currentFrame() const
+{
+    if (m_frames.isEmpty()) {
+        return QPixmap();
+    }
+    return m_frames.at(m_currentFrame);
+}
+
+void NowPlayingAnimation::acquire()
+{
+    if (!m_decoded) {
+        decodeFrames();
+    }
+
+    ++m_users;
+    if (m_users == 1 && m_frames.size() > 1) {
+        m_timer.start(m_delays.at(m_currentFrame));
+    }
+}
+
+void NowPlayingAnimation::release()
+{
+    if (m_users == 0) {
+        return;
+    }
+
+    --m_users;
+    if (m_users == 0) {
+        m_timer.stop();
+    }
+}
+
+void NowPlayingAnimation::advance()
+{
+    m_currentFrame = (m_currentFrame + 1) % m_frames.size();
+    m_timer.start(m_delays.at(m_currentFrame));
+    emit frameChanged();
+}
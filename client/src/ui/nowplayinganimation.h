@@ -0,0 +1,60 @@
+#ifndef NOWPLAYINGANIMATION_H
+#define NOWPLAYINGANIMATION_H
+
+#include <QObject>
+#include <QList>
+#include <QPixmap>
+#include <QTimer>
+
+/**
+ * @brief Shared driver for the animated "now playing" indicator
+ *
+ * songAnimation.gif is decoded once, on first use, into pre-scaled frames
+ * that stay in memory for the lifetime of the application. A single timer
+ * advances the frame and emits frameChanged(); views repaint the one row
+ * that shows the indicator and draw currentFrame() from their delegate.
+ *
+ * The timer only runs while at least one view holds the animation through
+ * acquire(), so nothing ticks while no playing row is on screen.
+ */
+class NowPlayingAnimation : public QObject
+{
+    Q_OBJECT
+
+public:
+    static NowPlayingAnimation* instance();
+
+    static constexpr int kFrameSize = 32;
+
+    // Frame to paint right now (null if the GIF could not be decoded)
+    QPixmap currentFrame() const;
+
+    // Reference-counted start/stop of the shared timer
+    void acquire();
+    void release();
+
+signals:
+    void frameChanged();
+
+private slots:
+    void advance();
+
+private:
+    explicit NowPlayingAnimation(QObject *parent = nullptr);
+    ~NowPlayingAnimation();
+    NowPlayingAnimation(const NowPlayingAnimation&) = delete;
+    NowPlayingAnimation& operator=(const NowPlayingAnimation&) = delete;
+
+    void decodeFrames();
+
+    static NowPlayingAnimation *s_instance;
+
+    QList<QPixmap> m_frames;
+    QList<int> m_delays;
+    bool m_decoded;
+    int m_currentFrame;
+    int m_users;
+    QTimer m_timer;
+};
+
+#endif // NOWPLAYINGANIMATION_H
@@ -1,4 +1,6 @@
 #include "playerpage.h"
+#include "uiupdatescheduler.h"
+#include "services/playlistservice.h"
 #include <QPixmap>
 #include <QFile>
 #include <QStackedWidget>
@@ -11,6 +13,8 @@ PlayerPage::PlayerPage(QWidget *parent)
     , isRepeat(false)
     , isLiked(false)
     , isSeekingByUser(false)
+    , shownPositionSeconds(-1)
+    , shownDurationSeconds(-1)
     , playerService(PlayerService::instance())
 {
     setupUI();
@@ -216,25 +220,35 @@ QPushButton* PlayerPage::createControlButton(const QString &icon, int size)
     return button;
 }
 
-QString PlayerPage::formatTime(qint64 milliseconds) const
-{
-    qint64 seconds = milliseconds / 1000;
-    qint64 minutes = seconds / 60;
-    seconds = seconds % 60;
-    return QString("%1:%2").arg(minutes).arg(seconds, 2, 10, QChar('0'));
-}
-
 void PlayerPage::setupPlayerConnections()
 {
     // Connect to PlayerService signals
     connect(playerService, &PlayerService::trackChanged,
             this, &PlayerPage::onTrackChanged);
-    connect(playerService, &PlayerService::playbackStateChanged,
-            this, &PlayerPage::onPlaybackStateChanged);
-    connect(playerService, &PlayerService::positionChanged,
-            this, &PlayerPage::onPositionChanged);
-    connect(playerService, &PlayerService::durationChanged,
-            this, &PlayerPage::onDurationChanged);
+
+    // Liking the song elsewhere (Downloads, mini player) shows here too
+    connect(PlaylistService::instance(), &PlaylistService::membershipChanged,
+            this, [this](qint64 playlistId, const QString &filePath) {
+        if (playlistId == PlaylistService::instance()->likedPlaylistId()
+            && filePath == playerService->currentTrack().filePath()) {
+            updateLikeButton();
+        }
+    });
+
+    // Position, duration and state arrive at most once per frame, and not
+    // at all while this widget is hidden or its window is minimized
+    UiUpdateScheduler::instance()->subscribe(this, [this](const UiUpdateScheduler::PlayerFrame &frame,
+                                                          UiUpdateScheduler::Changes changes) {
+        if (changes & UiUpdateScheduler::StateChange) {
+            onPlaybackStateChanged(frame.state);
+        }
+        if (changes & UiUpdateScheduler::DurationChange) {
+            onDurationChanged(frame.duration);
+        }
+        if (changes & UiUpdateScheduler::PositionChange) {
+            onPositionChanged(frame.position);
+        }
+    });
 
     // Track user seeking
     connect(progressSlider, &QSlider::sliderPressed, this, [this]() {
@@ -306,15 +320,22 @@ void PlayerPage::onRepeatClicked()
 
 void PlayerPage::onLikeClicked()
 {
-    isLiked = !isLiked;
+    const QString filePath = playerService->currentTrack().filePath();
+    if (!filePath.isEmpty()) {
+        PlaylistService::instance()->setLiked(filePath, !isLiked);
+    }
+}
+
+void PlayerPage::updateLikeButton()
+{
+    isLiked = PlaylistService::instance()->isLiked(playerService->currentTrack().filePath());
     likeButton->setText(isLiked ? "♥" : "♡");
-    // TODO: Persist liked state to backend
 }
 
 void PlayerPage::onProgressChanged(int value)
 {
     if (!isSeekingByUser) {
-        currentTimeLabel->setText(formatTime(value));
+        UiUpdateScheduler::setTimeLabel(currentTimeLabel, value, shownPositionSeconds);
     }
 }
 
@@ -339,6 +360,7 @@ void PlayerPage::onTrackChanged(const Track &track)
 
     songTitleLabel->setText(track.title());
     songArtistLabel->setText(track.artist());
+    updateLikeButton();
 
     // Load album art if available
     // First try to use the QPixmap directly from track
@@ -377,14 +399,14 @@ void PlayerPage::onPositionChanged(qint64 position)
 {
     if (!isSeekingByUser) {
         progressSlider->setValue(position);
-        currentTimeLabel->setText(formatTime(position));
+        UiUpdateScheduler::setTimeLabel(currentTimeLabel, position, shownPositionSeconds);
     }
 }
 
 void PlayerPage::onDurationChanged(qint64 duration)
 {
     progressSlider->setRange(0, duration);
-    totalTimeLabel->setText(formatTime(duration));
+    UiUpdateScheduler::setTimeLabel(totalTimeLabel, duration, shownDurationSeconds);
 }
 
 void PlayerPage::onBackClicked()
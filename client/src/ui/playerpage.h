@@ -42,7 +42,7 @@ private:
     void applyStyles();
     void setupPlayerConnections();
     QPushButton* createControlButton(const QString &icon, int size);
-    QString formatTime(qint64 milliseconds) const;
+    void updateLikeButton();
 
     // Layout
     QVBoxLayout *mainLayout;
@@ -84,6 +84,8 @@ private:
     bool isRepeat;
     bool isLiked;
     bool isSeekingByUser;
+    qint64 shownPositionSeconds;
+    qint64 shownDurationSeconds;
 
     // Player service reference
     PlayerService *playerService;
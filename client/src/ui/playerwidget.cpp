@@ -1,5 +1,7 @@
 #include "playerwidget.h"
+#include "uiupdatescheduler.h"
 #include "playerpage.h"
+#include "services/playlistservice.h"
 #include <QPixmap>
 #include <QStackedWidget>
 #include <QEvent>
@@ -13,6 +15,8 @@ PlayerWidget::PlayerWidget(QWidget *parent)
     , isShuffle(false)
     , isRepeat(false)
     , isSeekingByUser(false)
+    , shownPositionSeconds(-1)
+    , shownDurationSeconds(-1)
     , playerService(PlayerService::instance())
 {
     setupUI();
@@ -73,6 +77,7 @@ void PlayerWidget::setupUI()
     likeButton = new QPushButton("♡");
     likeButton->setFixedSize(28, 28);
     likeButton->setCursor(Qt::PointingHandCursor);
+    connect(likeButton, &QPushButton::clicked, this, &PlayerWidget::onLikeClicked);
 
     songInfoLayout->addWidget(albumArtLabel);
     songInfoLayout->addLayout(songTextLayout, 1);
@@ -224,12 +229,30 @@ void PlayerWidget::setupPlayerConnections()
     // Connect to PlayerService signals
     connect(playerService, &PlayerService::trackChanged,
             this, &PlayerWidget::onTrackChanged);
-    connect(playerService, &PlayerService::playbackStateChanged,
-            this, &PlayerWidget::onPlaybackStateChanged);
-    connect(playerService, &PlayerService::positionChanged,
-            this, &PlayerWidget::onPositionChanged);
-    connect(playerService, &PlayerService::durationChanged,
-            this, &PlayerWidget::onDurationChanged);
+
+    // Liking the song elsewhere (Downloads, player page) shows here too
+    connect(PlaylistService::instance(), &PlaylistService::membershipChanged,
+            this, [this](qint64 playlistId, const QString &filePath) {
+        if (playlistId == PlaylistService::instance()->likedPlaylistId()
+            && filePath == playerService->currentTrack().filePath()) {
+            updateLikeButton();
+        }
+    });
+
+    // Position, duration and state arrive at most once per frame, and not
+    // at all while this widget is hidden or its window is minimized
+    UiUpdateScheduler::instance()->subscribe(this, [this](const UiUpdateScheduler::PlayerFrame &frame,
+                                                          UiUpdateScheduler::Changes changes) {
+        if (changes & UiUpdateScheduler::StateChange) {
+            onPlaybackStateChanged(frame.state);
+        }
+        if (changes & UiUpdateScheduler::DurationChange) {
+            onDurationChanged(frame.duration);
+        }
+        if (changes & UiUpdateScheduler::PositionChange) {
+            onPositionChanged(frame.position);
+        }
+    });
 
     // Track user seeking
     connect(progressSlider, &QSlider::sliderPressed, this, [this]() {
@@ -242,14 +265,12 @@ void PlayerWidget::setupPlayerConnections()
 
     // Initialize volume from player service
     volumeSlider->setValue(playerService->volume());
-}
 
-QString PlayerWidget::formatTime(qint64 milliseconds) const
-{
-    qint64 seconds = milliseconds / 1000;
-    qint64 minutes = seconds / 60;
-    seconds = seconds % 60;
-    return QString("%1:%2").arg(minutes).arg(seconds, 2, 10, QChar('0'));
+    // A restored session has a track before this widget exists
+    const Track currentTrack = playerService->currentTrack();
+    if (currentTrack.isValid()) {
+        onTrackChanged(currentTrack);
+    }
 }
 
 void PlayerWidget::onPlayPauseClicked()
@@ -304,7 +325,7 @@ void PlayerWidget::onRepeatClicked()
 void PlayerWidget::onProgressChanged(int value)
 {
     if (!isSeekingByUser) {
-        currentTimeLabel->setText(formatTime(value));
+        UiUpdateScheduler::setTimeLabel(currentTimeLabel, value, shownPositionSeconds);
     }
 }
 
@@ -323,12 +344,28 @@ void PlayerWidget::onVolumeChanged(int value)
     playerService->setVolume(value);
 }
 
+void PlayerWidget::onLikeClicked()
+{
+    const QString filePath = playerService->currentTrack().filePath();
+    if (!filePath.isEmpty()) {
+        PlaylistService *playlists = PlaylistService::instance();
+        playlists->setLiked(filePath, !playlists->isLiked(filePath));
+    }
+}
+
+void PlayerWidget::updateLikeButton()
+{
+    const bool liked = PlaylistService::instance()->isLiked(playerService->currentTrack().filePath());
+    likeButton->setText(liked ? "♥" : "♡");
+}
+
 void PlayerWidget::onTrackChanged(const Track &track)
 {
     qDebug() << "Track changed - Title:" << track.title() << "Artist:" << track.artist() << "Album art:" << track.albumArtPath();
 
     songTitleLabel->setText(track.title());
     songArtistLabel->setText(track.artist());
+    updateLikeButton();
 
     // Load album art if available
     QString artPath = track.albumArtPath();
@@ -363,14 +400,14 @@ void PlayerWidget::onPositionChanged(qint64 position)
 {
     if (!isSeekingByUser) {
         progressSlider->setValue(position);
-        currentTimeLabel->setText(formatTime(position));
+        UiUpdateScheduler::setTimeLabel(currentTimeLabel, position, shownPositionSeconds);
     }
 }
 
 void PlayerWidget::onDurationChanged(qint64 duration)
 {
     progressSlider->setRange(0, duration);
-    totalTimeLabel->setText(formatTime(duration));
+    UiUpdateScheduler::setTimeLabel(totalTimeLabel, duration, shownDurationSeconds);
 }
 
 bool PlayerWidget::eventFilter(QObject *obj, QEvent *event)
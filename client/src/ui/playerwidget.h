@@ -32,6 +32,7 @@ private slots:
     void onProgressChanged(int value);
     void onVolumeChanged(int value);
     void onAlbumArtClicked();
+    void onLikeClicked();
 
     // PlayerService slots
     void onTrackChanged(const Track &track);
@@ -43,8 +44,8 @@ private:
     void setupUI();
     void applyStyles();
     void setupPlayerConnections();
+    void updateLikeButton();
     QPushButton* createControlButton(const QString &icon, int size = 32);
-    QString formatTime(qint64 milliseconds) const;
 
     // Layout
     QHBoxLayout *mainLayout;
@@ -81,6 +82,8 @@ private:
     bool isShuffle;
     bool isRepeat;
     bool isSeekingByUser;
+    qint64 shownPositionSeconds;
+    qint64 shownDurationSeconds;
 
     // Player service reference
     PlayerService *playerService;
@@ -1,4 +1,5 @@
 #include "radiopage.h"
+#include "utils/networkfuture.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -296,8 +297,8 @@ void RadioPage::onNowPlayingUpdated(const RadioService::NowPlayingInfo &info)
     artistLabel->setText(info.song.artist);
     stationTitle->setText(info.stationName);
 
-    // Update timing
-    currentElapsed = info.elapsed;
+    // Update timing (from the stream clock, re-anchored on this update)
+    currentElapsed = int(m_radioService->clock().positionMs() / 1000);
     currentDuration = info.duration;
 
     if (currentDuration > 0) {
@@ -329,29 +330,35 @@ void RadioPage::updateBackgroundImage(const QString &imageUrl)
 {
     currentBackgroundUrl = imageUrl;
 
+    // The previous song's art must not land on top of this one's
+    backgroundLoad.cancel();
+
     QNetworkRequest imageRequest;
     imageRequest.setUrl(QUrl(imageUrl));
 
     QNetworkReply *imageReply = networkManager->get(imageRequest);
 
-    connect(imageReply, &QNetworkReply::finished, this, [this, imageReply]() {
-        if (imageReply->error() == QNetworkReply::NoError) {
-            QByteArray imageData = imageReply->readAll();
-            QPixmap pixmap;
-            pixmap.loadFromData(imageData);
+    backgroundLoad = NetworkFuture::fromReply(imageReply, this, [](QNetworkReply *reply) {
+        QPixmap pixmap;
+        if (reply->error() == QNetworkReply::NoError) {
+            pixmap.loadFromData(reply->readAll());
+        }
+        return pixmap;
+    });
+
+    backgroundLoad.then(this, [this](const QPixmap &pixmap) {
+        if (pixmap.isNull()) {
+            return;
+        }
 
-            if (!pixmap.isNull()) {
-                // Set background
-                backgroundLabel->setPixmap(pixmap);
-                backgroundLabel->setGeometry(0, 0, width(), height());
+        // Set background
+        backgroundLabel->setPixmap(pixmap);
+        backgroundLabel->setGeometry(0, 0, width(), height());
 
-                // Set album art
-                albumArtLabel->setPixmap(pixmap.scaled(120, 120, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
+        // Set album art
+        albumArtLabel->setPixmap(pixmap.scaled(120, 120, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation));
 
-                qDebug() << "Background and album art updated";
-            }
-        }
-        imageReply->deleteLater();
+        qDebug() << "Background and album art updated";
     });
 }
 
@@ -404,9 +411,9 @@ void RadioPage::onPlaylistClicked()
 
 void RadioPage::updateProgressBar()
 {
-    // Increment elapsed time locally
-    if (m_radioService->isPlaying() && currentDuration > 0 && currentElapsed < currentDuration) {
-        currentElapsed += 1; // Add 1 second
+    // Elapsed time from the stream clock instead of counting timer ticks
+    if (m_radioService->isPlaying() && currentDuration > 0) {
+        currentElapsed = int(qMin<qint64>(m_radioService->clock().positionMs() / 1000, currentDuration));
 
         int progress = (currentElapsed * 100) / currentDuration;
         progressBar->setValue(progress);
@@ -10,6 +10,7 @@
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QPixmap>
+#include <QFuture>
 #include <QTimer>
 #include "services/radioservice.h"
 
@@ -66,6 +67,7 @@ private:
     QNetworkAccessManager *networkManager;
     QTimer *updateTimer;
     QString currentBackgroundUrl;
+    QFuture<QPixmap> backgroundLoad;  // Art of currentBackgroundUrl, canceled when the song changes
     int currentDuration;
     int currentElapsed;
 };
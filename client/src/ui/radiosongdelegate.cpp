@@ -0,0 +1,101 @@
+#include "radiosongdelegate.h"
+#include "models/radiosonglistmodel.h"
+#include <QPainter>
+#include <QPainterPath>
+#include <QPixmap>
+
+namespace {
+constexpr int kHorizontalMargin = 20;
+constexpr int kSpacing = 16;
+constexpr int kLineSpacing = 6;
+}
+
+RadioSongDelegate::RadioSongDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+    m_labelFont.setPixelSize(12);
+    m_labelFont.setBold(true);
+    m_labelFont.setLetterSpacing(QFont::AbsoluteSpacing, 0.5);
+
+    m_titleFont.setPixelSize(18);
+    m_titleFont.setWeight(QFont::DemiBold);
+
+    m_artistFont.setPixelSize(15);
+}
+
+QSize RadioSongDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    Q_UNUSED(index);
+    return QSize(option.rect.width(), kRowHeight);
+}
+
+void RadioSongDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                              const QModelIndex &index) const
+{
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    const QRect rect = option.rect;
+    const bool isCurrent = index.data(RadioSongListModel::IsCurrentRole).toBool();
+
+    // Row background and separator
+    if (isCurrent) {
+        QPainterPath background;
+        background.addRoundedRect(rect.adjusted(0, 0, 0, -1), 4, 4);
+        painter->fillPath(background, QColor(74, 158, 255, 51));
+    }
+    painter->setPen(QColor("#3a3a4a"));
+    painter->drawLine(rect.bottomLeft(), rect.bottomRight());
+
+    // Thumbnail (placeholder until the cache delivers it)
+    QRect thumbRect(rect.left() + kHorizontalMargin,
+                    rect.top() + (rect.height() - kThumbnailSize) / 2,
+                    kThumbnailSize, kThumbnailSize);
+    QPainterPath thumbClip;
+    thumbClip.addRoundedRect(thumbRect, 4, 4);
+
+    QPixmap thumbnail = qvariant_cast<QPixmap>(index.data(Qt::DecorationRole));
+    if (thumbnail.isNull()) {
+        painter->fillPath(thumbClip, QColor("#2a2a3a"));
+    } else {
+        painter->setClipPath(thumbClip);
+        // Center-crop the expanded thumbnail into the square
+        QRect source(QPoint(0, 0), thumbRect.size());
+        source.moveCenter(thumbnail.rect().center());
+        painter->drawPixmap(thumbRect, thumbnail, source);
+        painter->setClipping(false);
+    }
+
+    // Text column
+    int textLeft = thumbRect.right() + 1 + kSpacing;
+    int textWidth = qMin(rect.right() - kHorizontalMargin - textLeft, 700);
+
+    QFontMetrics labelMetrics(m_labelFont);
+    QFontMetrics titleMetrics(m_titleFont);
+    QFontMetrics artistMetrics(m_artistFont);
+
+    int blockHeight = labelMetrics.height() + titleMetrics.height() + artistMetrics.height()
+                    + 2 * kLineSpacing;
+    int y = rect.top() + (rect.height() - blockHeight) / 2;
+
+    painter->setFont(m_labelFont);
+    painter->setPen(QColor(isCurrent ? "#4a9eff" : "#bbb"));
+    painter->drawText(QRect(textLeft, y, textWidth, labelMetrics.height()), Qt::AlignLeft | Qt::AlignVCenter,
+                      index.data(RadioSongListModel::SlotLabelRole).toString());
+    y += labelMetrics.height() + kLineSpacing;
+
+    painter->setFont(m_titleFont);
+    painter->setPen(Qt::white);
+    painter->drawText(QRect(textLeft, y, textWidth, titleMetrics.height()), Qt::AlignLeft | Qt::AlignVCenter,
+                      titleMetrics.elidedText(index.data(RadioSongListModel::TitleRole).toString(),
+                                              Qt::ElideRight, textWidth));
+    y += titleMetrics.height() + kLineSpacing;
+
+    painter->setFont(m_artistFont);
+    painter->setPen(QColor("#ccc"));
+    painter->drawText(QRect(textLeft, y, textWidth, artistMetrics.height()), Qt::AlignLeft | Qt::AlignVCenter,
+                      artistMetrics.elidedText(index.data(RadioSongListModel::ArtistRole).toString(),
+                                               Qt::ElideRight, textWidth));
+
+    painter->restore();
+}
@@ -0,0 +1,34 @@
+#ifndef RADIOSONGDELEGATE_H
+#define RADIOSONGDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QFont>
+
+/**
+ * @brief Paints a RadioSongListModel row
+ *
+ * Same look as the old per-row widgets (thumbnail, slot label, title,
+ * artist, highlighted NOW PLAYING row), drawn directly so a row costs no
+ * child widgets and an unchanged row is never re-laid out.
+ */
+class RadioSongDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit RadioSongDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+
+    static constexpr int kRowHeight = 100;
+    static constexpr int kThumbnailSize = 70;
+
+private:
+    QFont m_labelFont;
+    QFont m_titleFont;
+    QFont m_artistFont;
+};
+
+#endif // RADIOSONGDELEGATE_H
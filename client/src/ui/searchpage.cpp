@@ -1,4 +1,6 @@
 #include "searchpage.h"
+#include "theme.h"
+#include "utils/searchmatcher.h"
 #include <QListWidgetItem>
 #include <QPushButton>
 #include <QHBoxLayout>
@@ -32,89 +34,47 @@ SearchPage::~SearchPage()
 {
 }
 
+void SearchPage::setCatalog(const QList<Track> &tracks)
+{
+    allSongs.clear();
+    allSongs.reserve(tracks.size());
+    for (const Track &track : tracks) {
+        allSongs.append({track.title(), track.artist(), track.album()});
+    }
+
+    if (!searchInput->text().isEmpty()) {
+        performSearch(searchInput->text());
+    }
+}
+
 void SearchPage::setupUI()
 {
     mainLayout = new QVBoxLayout(this);
     mainLayout->setSpacing(25);
     mainLayout->setContentsMargins(30, 30, 30, 30);
 
+    // Styles come from the application theme
+    setObjectName("searchPage");
+
     // Simple title
     titleLabel = new QLabel("Search", this);
-    titleLabel->setStyleSheet(
-        "font-size: 32px;"
-        "font-weight: 600;"
-        "color: #000000;"
-        "margin-bottom: 5px;"
-    );
+    Theme::setRole(titleLabel, "pageTitle");
 
     // Simple search input
     searchInput = new QLineEdit(this);
     searchInput->setPlaceholderText("🔍 What do you want to listen to?");
     searchInput->setMinimumHeight(50);
-    searchInput->setStyleSheet(
-        "QLineEdit {"
-        "   background-color: #FFFFFF;"
-        "   border: 1px solid #d0d0d0;"
-        "   border-radius: 25px;"
-        "   padding: 0 20px;"
-        "   font-size: 14px;"
-        "   color: #000000;"
-        "}"
-        "QLineEdit:focus {"
-        "   border: 1px solid #000000;"
-        "   background-color: #fafafa;"
-        "}"
-        "QLineEdit::placeholder {"
-        "   color: #999999;"
-        "}"
-    );
     connect(searchInput, &QLineEdit::textChanged, this, &SearchPage::onSearchTextChanged);
 
     // Simple results list
     resultsListWidget = new QListWidget(this);
-    resultsListWidget->setStyleSheet(
-        "QListWidget {"
-        "   background-color: transparent;"
-        "   border: none;"
-        "   outline: none;"
-        "}"
-        "QListWidget::item {"
-        "   background-color: white;"
-        "   padding: 12px;"
-        "   border-radius: 8px;"
-        "   margin-bottom: 10px;"
-        "   border: 1px solid #e0e0e0;"
-        "}"
-        "QListWidget::item:hover {"
-        "   background-color: #fafafa;"
-        "   box-shadow: 0 2px 8px rgba(0,0,0,0.1);"
-        "}"
-        "QListWidget::item:selected {"
-        "   background-color: #ecf0f1;"
-        "   border: 1px solid #bdc3c7;"
-        "}"
-        "QScrollBar:vertical {"
-        "   background: transparent;"
-        "   width: 8px;"
-        "}"
-        "QScrollBar::handle:vertical {"
-        "   background: #bdc3c7;"
-        "   border-radius: 4px;"
-        "}"
-        "QScrollBar::handle:vertical:hover {"
-        "   background: #95a5a6;"
-        "}"
-    );
+    Theme::setRole(resultsListWidget, "songList");
     connect(resultsListWidget, &QListWidget::itemClicked, this, &SearchPage::onSearchItemClicked);
 
     // No results label
     noResultsLabel = new QLabel("Search for songs, artists, or albums", this);
     noResultsLabel->setAlignment(Qt::AlignCenter);
-    noResultsLabel->setStyleSheet(
-        "font-size: 14px;"
-        "color: #666666;"
-        "margin-top: 50px;"
-    );
+    Theme::setRole(noResultsLabel, "emptyHint");
 
     // Add to layout
     mainLayout->addWidget(titleLabel);
@@ -140,13 +100,11 @@ void SearchPage::onSearchTextChanged(const QString &text)
 void SearchPage::performSearch(const QString &query)
 {
     resultsListWidget->clear();
-    QString lowerQuery = query.toLower();
+    const SearchMatcher matcher(query);
 
     QList<Song> results;
     for (const auto &song : allSongs) {
-        if (song.title.toLower().contains(lowerQuery) ||
-            song.artist.toLower().contains(lowerQuery) ||
-            song.album.toLower().contains(lowerQuery)) {
+        if (matcher.matches(song.title, song.artist, song.album)) {
             results.append(song);
         }
     }
@@ -170,6 +128,7 @@ void SearchPage::performSearch(const QString &query)
 
 QWidget* SearchPage::createSearchResultItem(const QString &title, const QString &artist, const QString &album)
 {
+    // Styled by the application theme through role properties
     QWidget *widget = new QWidget();
     widget->setMinimumHeight(70);
     QHBoxLayout *layout = new QHBoxLayout(widget);
@@ -179,29 +138,18 @@ QWidget* SearchPage::createSearchResultItem(const QString &title, const QString
     // Simple album art placeholder
     QLabel *albumArtLabel = new QLabel();
     albumArtLabel->setFixedSize(55, 55);
-    albumArtLabel->setStyleSheet(
-        "background-color: #e0e0e0;"
-        "border: 1px solid #d0d0d0;"
-        "border-radius: 4px;"
-    );
+    Theme::setRole(albumArtLabel, "albumArt");
 
     // Song info
     QVBoxLayout *infoLayout = new QVBoxLayout();
     infoLayout->setSpacing(5);
 
     QLabel *titleLabel = new QLabel(title);
-    titleLabel->setStyleSheet(
-        "font-size: 15px;"
-        "font-weight: 600;"
-        "color: #000000;"
-    );
+    Theme::setRole(titleLabel, "songTitle");
     titleLabel->setWordWrap(false);
 
     QLabel *artistLabel = new QLabel(artist + " • " + album);
-    artistLabel->setStyleSheet(
-        "font-size: 13px;"
-        "color: #888888;"
-    );
+    Theme::setRole(artistLabel, "songSubtitle");
     artistLabel->setWordWrap(false);
 
     infoLayout->addWidget(titleLabel);
@@ -210,37 +158,13 @@ QWidget* SearchPage::createSearchResultItem(const QString &title, const QString
     // Simple play button
     QPushButton *playBtn = new QPushButton("▶");
     playBtn->setFixedSize(42, 42);
-    playBtn->setStyleSheet(
-        "QPushButton {"
-        "   background-color: #000000;"
-        "   color: #FFFFFF;"
-        "   border: none;"
-        "   border-radius: 21px;"
-        "   font-size: 16px;"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #333333;"
-        "}"
-    );
+    Theme::setRole(playBtn, "playButton");
     playBtn->setCursor(Qt::PointingHandCursor);
 
     // Simple add button
     QPushButton *addBtn = new QPushButton("+");
     addBtn->setFixedSize(36, 36);
-    addBtn->setStyleSheet(
-        "QPushButton {"
-        "   background-color: white;"
-        "   color: #000000;"
-        "   border: 1px solid #d0d0d0;"
-        "   border-radius: 18px;"
-        "   font-size: 20px;"
-        "   font-weight: bold;"
-        "}"
-        "QPushButton:hover {"
-        "   background-color: #f0f0f0;"
-        "   border: 1px solid #000000;"
-        "}"
-    );
+    Theme::setRole(addBtn, "addButton");
     addBtn->setCursor(Qt::PointingHandCursor);
 
     layout->addWidget(albumArtLabel);
@@ -6,6 +6,7 @@
 #include <QLineEdit>
 #include <QListWidget>
 #include <QLabel>
+#include "models/track.h"
 
 class SearchPage : public QWidget
 {
@@ -15,6 +16,9 @@ public:
     explicit SearchPage(QWidget *parent = nullptr);
     ~SearchPage();
 
+    // Replace the songs searched (the built-in mock catalog by default)
+    void setCatalog(const QList<Track> &tracks);
+
 private slots:
     void onSearchTextChanged(const QString &text);
     void onSearchItemClicked(QListWidgetItem *item);
@@ -0,0 +1,27 @@
+#include "stationradiopage.h"
+#include "services/radioservice.h"
+
+StationRadioPage::StationRadioPage(const RadioStation &station, QWidget *parent)
+    : BaseRadioPage(RadioService::forStation(station.id), parent)
+    , m_station(station)
+{
+}
+
+StationRadioPage::~StationRadioPage()
+{
+}
+
+QString StationRadioPage::getStationName() const
+{
+    return m_station.name.toUpper();
+}
+
+QString StationRadioPage::getStationId() const
+{
+    return m_station.id;
+}
+
+QString StationRadioPage::getRequestSongUrl() const
+{
+    return m_station.publicPageUrl;
+}
@@ -0,0 +1,30 @@
+#ifndef STATIONRADIOPAGE_H
+#define STATIONRADIOPAGE_H
+
+#include "baseradiopage.h"
+#include "models/radiostation.h"
+
+/**
+ * @brief Radio page for any StationRegistry station
+ *
+ * Concrete implementation of BaseRadioPage driven by a RadioStation entry
+ * and that station's RadioService instance.
+ */
+class StationRadioPage : public BaseRadioPage
+{
+    Q_OBJECT
+
+public:
+    explicit StationRadioPage(const RadioStation &station, QWidget *parent = nullptr);
+    ~StationRadioPage() override;
+
+protected:
+    QString getStationName() const override;
+    QString getStationId() const override;
+    QString getRequestSongUrl() const override;
+
+private:
+    RadioStation m_station;
+};
+
+#endif // STATIONRADIOPAGE_H
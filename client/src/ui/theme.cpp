@@ -0,0 +1,270 @@
+#include "theme.h"
+#include <QApplication>
+#include <QHash>
+#include <QRegularExpression>
+#include <QWidget>
+
+namespace {
+constexpr const char *kRoleProperty = "role";
+
+// Palette roles, referenced as @name in the rules below
+const QHash<QString, QString> &palette()
+{
+    static const QHash<QString, QString> colors = {
+        {"background", "#f5f5f5"},
+        {"surface", "#ffffff"},
+        {"hover", "#fafafa"},
+        {"pressed", "#e8e8e8"},
+        {"buttonFace", "#f0f0f0"},
+        {"text", "#000000"},
+        {"textSecondary", "#666666"},
+        {"textTertiary", "#888888"},
+        {"border", "#d0d0d0"},
+        {"divider", "#e0e0e0"},
+        {"accent", "#4a9eff"},
+        {"accentPressed", "#3080dd"},
+        {"selection", "#e8f4fd"},
+        {"cardSelection", "#ecf0f1"},
+        {"scrollHandle", "#bdc3c7"},
+        {"scrollHandleHover", "#95a5a6"},
+        {"danger", "#ffdddd"}
+    };
+    return colors;
+}
+
+// Main window rules come first: page rules of equal specificity (a page
+// id plus one attribute or pseudo-state) must win over them
+const char *const kRules = R"(
+#sidebar {
+    background-color: @surface;
+    border-right: 1px solid @divider;
+}
+#contentArea {
+    background-color: @background;
+}
+#mainWindow QPushButton {
+    background-color: transparent;
+    color: @textSecondary;
+    border: none;
+    border-radius: 6px;
+    padding: 12px 16px;
+    text-align: left;
+    font-size: 14px;
+    font-weight: 500;
+}
+#mainWindow QPushButton:hover {
+    background-color: @background;
+    color: @text;
+}
+#mainWindow QPushButton:pressed {
+    background-color: @pressed;
+}
+#mainWindow QPushButton[active="true"] {
+    background-color: @text;
+    color: @surface;
+}
+
+#downloadedPage, #downloadedPage QWidget,
+#likedSongsPage, #likedSongsPage QWidget {
+    background-color: @background;
+}
+
+QLabel[role="pageTitle"] {
+    font-size: 32px;
+    font-weight: 600;
+    color: @text;
+    margin-bottom: 5px;
+}
+QLabel[role="pageInfo"] {
+    font-size: 14px;
+    color: @textSecondary;
+    margin-bottom: 25px;
+}
+QLabel[role="emptyHint"] {
+    font-size: 14px;
+    color: @textSecondary;
+    margin-top: 50px;
+}
+
+#downloadedPage QPushButton[role="refreshButton"] {
+    background-color: @buttonFace;
+    color: #333333;
+    border: 1px solid @border;
+    border-radius: 20px;
+    font-size: 24px;
+    font-weight: bold;
+}
+#downloadedPage QPushButton[role="refreshButton"]:hover {
+    background-color: @accent;
+    color: white;
+    border: 1px solid @accent;
+}
+#downloadedPage QPushButton[role="refreshButton"]:pressed {
+    background-color: @accentPressed;
+}
+
+#searchPage QLineEdit {
+    background-color: @surface;
+    border: 1px solid @border;
+    border-radius: 25px;
+    padding: 0 20px;
+    font-size: 14px;
+    color: @text;
+}
+#searchPage QLineEdit:focus {
+    border: 1px solid @text;
+    background-color: @hover;
+}
+
+#downloadedPage QListWidget[role="songList"],
+#searchPage QListWidget[role="songList"],
+#likedSongsPage QListWidget[role="songList"] {
+    background-color: transparent;
+    border: none;
+    outline: none;
+}
+#downloadedPage QListWidget[role="songList"]::item,
+#likedSongsPage QListWidget[role="songList"]::item {
+    background-color: @surface;
+    border: none;
+    border-bottom: 1px solid @divider;
+    border-radius: 0px;
+}
+#downloadedPage QListWidget[role="songList"]::item:hover,
+#likedSongsPage QListWidget[role="songList"]::item:hover {
+    background-color: @hover;
+}
+#downloadedPage QListWidget[role="songList"]::item:selected,
+#likedSongsPage QListWidget[role="songList"]::item:selected {
+    background-color: @selection;
+    border-left: 3px solid @accent;
+}
+#searchPage QListWidget[role="songList"]::item {
+    background-color: @surface;
+    padding: 12px;
+    border-radius: 8px;
+    margin-bottom: 10px;
+    border: 1px solid @divider;
+}
+#searchPage QListWidget[role="songList"]::item:hover {
+    background-color: @hover;
+}
+#searchPage QListWidget[role="songList"]::item:selected {
+    background-color: @cardSelection;
+    border: 1px solid @scrollHandle;
+}
+
+#downloadedPage QListWidget[role="songList"] QScrollBar:vertical,
+#searchPage QListWidget[role="songList"] QScrollBar:vertical,
+#likedSongsPage QListWidget[role="songList"] QScrollBar:vertical {
+    background: transparent;
+    width: 8px;
+    margin: 0px;
+}
+#downloadedPage QListWidget[role="songList"] QScrollBar::handle:vertical,
+#searchPage QListWidget[role="songList"] QScrollBar::handle:vertical,
+#likedSongsPage QListWidget[role="songList"] QScrollBar::handle:vertical {
+    background: @scrollHandle;
+    border-radius: 4px;
+    min-height: 30px;
+}
+#downloadedPage QListWidget[role="songList"] QScrollBar::handle:vertical:hover,
+#searchPage QListWidget[role="songList"] QScrollBar::handle:vertical:hover,
+#likedSongsPage QListWidget[role="songList"] QScrollBar::handle:vertical:hover {
+    background: @scrollHandleHover;
+}
+#downloadedPage QListWidget[role="songList"] QScrollBar::add-line:vertical,
+#downloadedPage QListWidget[role="songList"] QScrollBar::sub-line:vertical,
+#searchPage QListWidget[role="songList"] QScrollBar::add-line:vertical,
+#searchPage QListWidget[role="songList"] QScrollBar::sub-line:vertical,
+#likedSongsPage QListWidget[role="songList"] QScrollBar::add-line:vertical,
+#likedSongsPage QListWidget[role="songList"] QScrollBar::sub-line:vertical {
+    height: 0px;
+}
+
+QLabel[role="songTitle"] {
+    font-size: 15px;
+    font-weight: 600;
+    color: @text;
+}
+QLabel[role="songSubtitle"] {
+    font-size: 13px;
+    color: @textTertiary;
+}
+QLabel[role="songDetail"] {
+    font-size: 13px;
+    color: @textSecondary;
+}
+
+#searchPage QLabel[role="albumArt"] {
+    background-color: @divider;
+    border: 1px solid @border;
+    border-radius: 4px;
+}
+QLabel[role="albumArtFallback"] {
+    color: @textTertiary;
+    font-size: 20px;
+}
+
+#searchPage QPushButton[role="playButton"] {
+    background-color: @text;
+    color: @surface;
+    border: none;
+    border-radius: 21px;
+    font-size: 16px;
+}
+#searchPage QPushButton[role="playButton"]:hover {
+    background-color: #333333;
+}
+#searchPage QPushButton[role="addButton"] {
+    background-color: @surface;
+    color: @text;
+    border: 1px solid @border;
+    border-radius: 18px;
+    font-size: 20px;
+    font-weight: bold;
+}
+#searchPage QPushButton[role="addButton"]:hover {
+    background-color: @buttonFace;
+    border: 1px solid @text;
+}
+)";
+}
+
+QString Theme::styleSheet()
+{
+    static const QString compiled = []() {
+        const QHash<QString, QString> &colors = palette();
+        QString sheet = QString::fromUtf8(kRules);
+
+        static const QRegularExpression token("@([A-Za-z]+)");
+        QString result;
+        result.reserve(sheet.size());
+        qsizetype last = 0;
+        QRegularExpressionMatchIterator it = token.globalMatch(sheet);
+        while (it.hasNext()) {
+            const QRegularExpressionMatch match = it.next();
+            result += QStringView(sheet).mid(last, match.capturedStart() - last);
+            result += colors.value(match.captured(1), match.captured(0));
+            last = match.capturedEnd();
+        }
+        result += QStringView(sheet).mid(last);
+        return result;
+    }();
+    return compiled;
+}
+
+void Theme::apply()
+{
+    qApp->setStyleSheet(styleSheet());
+}
+
+void Theme::setRole(QWidget *widget, const char *role)
+{
+    widget->setProperty(kRoleProperty, QString::fromLatin1(role));
+}
+
+QColor Theme::color(const char *name)
+{
+    return QColor(palette().value(QString::fromLatin1(name)));
+}
@@ -0,0 +1,37 @@
+#ifndef THEME_H
+#define THEME_H
+
+#include <QColor>
+#include <QString>
+
+class QWidget;
+
+/**
+ * @brief Application-wide stylesheet for the main window and song lists
+ *
+ * The rules are built from a small colour palette and installed on the
+ * QApplication once at startup, so Qt parses them a single time. Widgets
+ * opt in by object name (pages) or by a "role" dynamic property (rows and
+ * their children) instead of calling setStyleSheet(); creating a list row
+ * therefore involves no style sheet parsing at all.
+ *
+ * Page-level rules are scoped by the page's object name, so a page's rules
+ * outrank the main window's generic button rules regardless of nesting.
+ */
+class Theme
+{
+public:
+    // Install styleSheet() on the application (call once, after QApplication)
+    static void apply();
+
+    // The compiled application stylesheet
+    static QString styleSheet();
+
+    // Tag a widget for the "role" rules; must happen before it is shown
+    static void setRole(QWidget *widget, const char *role);
+
+    // Palette colour by name, for rows painted by a delegate
+    static QColor color(const char *name);
+};
+
+#endif // THEME_H
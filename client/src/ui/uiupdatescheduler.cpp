@@ -0,0 +1,192 @@
+#include "uiupdatescheduler.h"
+#include "services/playerservice.h"
+#include <QEvent>
+#include <QLabel>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QWidget>
+
+namespace {
+constexpr qreal kDefaultRefreshRate = 60.0;
+constexpr qreal kMinRefreshRate = 30.0;
+constexpr qreal kMaxRefreshRate = 240.0;
+}
+
+UiUpdateScheduler* UiUpdateScheduler::s_instance = nullptr;
+
+UiUpdateScheduler::UiUpdateScheduler(QObject *parent)
+    : QObject(parent)
+    , m_pending(NoChange)
+    , m_frameIntervalMs(16)
+{
+    qreal refreshRate = kDefaultRefreshRate;
+    if (QScreen *screen = QGuiApplication::primaryScreen()) {
+        if (screen->refreshRate() > 0) {
+            refreshRate = screen->refreshRate();
+        }
+    }
+    refreshRate = qBound(kMinRefreshRate, refreshRate, kMaxRefreshRate);
+    m_frameIntervalMs = qMax(1, qRound(1000.0 / refreshRate));
+
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &UiUpdateScheduler::flush);
+
+    PlayerService *player = PlayerService::instance();
+    m_frame.position = player->position();
+    m_frame.duration = player->duration();
+    m_frame.state = player->playbackState();
+
+    connect(player, &PlayerService::positionChanged,
+            this, &UiUpdateScheduler::onPositionChanged);
+    connect(player, &PlayerService::durationChanged,
+            this, &UiUpdateScheduler::onDurationChanged);
+    connect(player, &PlayerService::playbackStateChanged,
+            this, &UiUpdateScheduler::onPlaybackStateChanged);
+}
+
+UiUpdateScheduler::~UiUpdateScheduler()
+{
+}
+
+UiUpdateScheduler* UiUpdateScheduler::instance()
+{
+    if (!s_instance) {
+        s_instance = new UiUpdateScheduler(qApp);
+    }
+    return s_instance;
+}
+
+void UiUpdateScheduler::subscribe(QWidget *widget, Callback callback)
+{
+    Subscriber subscriber;
+    subscriber.widget = widget;
+    subscriber.callback = std::move(callback);
+    subscriber.pending = AllChanges;
+    m_subscribers.append(subscriber);
+
+    // Becoming visible again flushes whatever accumulated while hidden;
+    // the window is watched too, for restore from minimized
+    widget->installEventFilter(this);
+    widget->window()->installEventFilter(this);
+
+    scheduleFlush();
+}
+
+// ========== Player Signals ==========
+
+void UiUpdateScheduler::onPositionChanged(qint64 position)
+{
+    if (position != m_frame.position) {
+        m_frame.position = position;
+        markChanged(PositionChange);
+    }
+}
+
+void UiUpdateScheduler::onDurationChanged(qint64 duration)
+{
+    if (duration != m_frame.duration) {
+        m_frame.duration = duration;
+        markChanged(DurationChange);
+    }
+}
+
+void UiUpdateScheduler::onPlaybackStateChanged(QMediaPlayer::PlaybackState state)
+{
+    if (state != m_frame.state) {
+        m_frame.state = state;
+        markChanged(StateChange);
+    }
+}
+
+// ========== Frame Delivery ==========
+
+void UiUpdateScheduler::markChanged(Change change)
+{
+    m_pending |= change;
+    scheduleFlush();
+}
+
+void UiUpdateScheduler::scheduleFlush()
+{
+    // Any number of signals within one frame interval collapse into one flush
+    if (!m_timer.isActive()) {
+        m_timer.start(m_frameIntervalMs);
+    }
+}
+
+bool UiUpdateScheduler::isOnScreen(const QWidget *widget)
+{
+    return widget->isVisible() && !widget->window()->isMinimized();
+}
+
+void UiUpdateScheduler::flush()
+{
+    const Changes changes = m_pending;
+    m_pending = NoChange;
+
+    // The media clock interpolates between QMediaPlayer's sparse reports
+    if (changes & PositionChange) {
+        m_frame.position = PlayerService::instance()->clock().positionMs();
+    }
+
+    // Index loop: a callback may subscribe another widget
+    for (int i = 0; i < m_subscribers.size(); ) {
+        Subscriber &subscriber = m_subscribers[i];
+        if (!subscriber.widget) {
+            m_subscribers.removeAt(i);
+            continue;
+        }
+
+        subscriber.pending |= changes;
+        if (subscriber.pending == NoChange) {
+            ++i;
+            continue;
+        }
+
+        if (isOnScreen(subscriber.widget)) {
+            const Changes delivered = subscriber.pending;
+            subscriber.pending = NoChange;
+            const Callback callback = subscriber.callback;
+            callback(m_frame, delivered);
+        } else {
+            // Skipped: watch the current window (it may have been
+            // re-parented since subscribe) so restoring it flushes
+            subscriber.widget->window()->installEventFilter(this);
+        }
+        ++i;
+    }
+}
+
+bool UiUpdateScheduler::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Show || event->type() == QEvent::WindowStateChange) {
+        for (const Subscriber &subscriber : std::as_const(m_subscribers)) {
+            if (subscriber.widget && subscriber.pending != NoChange) {
+                scheduleFlush();
+                break;
+            }
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+// ========== Time Labels ==========
+
+QString UiUpdateScheduler::formatTime(qint64 milliseconds)
+{
+    qint64 seconds = milliseconds / 1000;
+    qint64 minutes = seconds / 60;
+    seconds = seconds % 60;
+    return QString("%1:%2").arg(minutes).arg(seconds, 2, 10, QChar('0'));
+}
+
+void UiUpdateScheduler::setTimeLabel(QLabel *label, qint64 milliseconds, qint64 &shownSeconds)
+{
+    // Labels show whole seconds; skip formatting until that changes
+    const qint64 seconds = milliseconds / 1000;
+    if (seconds != shownSeconds) {
+        shownSeconds = seconds;
+        label->setText(formatTime(milliseconds));
+    }
+}
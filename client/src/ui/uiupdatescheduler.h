@@ -0,0 +1,100 @@
+#ifndef UIUPDATESCHEDULER_H
+#define UIUPDATESCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QPointer>
+#include <QTimer>
+#include <QMediaPlayer>
+#include <functional>
+
+class QWidget;
+class QLabel;
+
+/**
+ * @brief Coalesces high-frequency player signals into per-frame UI updates
+ *
+ * PlayerService position, duration and state changes are recorded here
+ * instead of being forwarded to every widget. At most once per display
+ * refresh interval the latest values are delivered to each subscriber,
+ * together with the set of fields that changed since that subscriber was
+ * last updated.
+ *
+ * Subscribers that are hidden or sit in a minimized window are skipped;
+ * their changes accumulate and are delivered in one go when they become
+ * visible again.
+ */
+class UiUpdateScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Change {
+        NoChange = 0x0,
+        PositionChange = 0x1,
+        DurationChange = 0x2,
+        StateChange = 0x4,
+        AllChanges = PositionChange | DurationChange | StateChange
+    };
+    Q_DECLARE_FLAGS(Changes, Change)
+
+    // Latest player values as of the current frame
+    struct PlayerFrame {
+        qint64 position = 0;
+        qint64 duration = 0;
+        QMediaPlayer::PlaybackState state = QMediaPlayer::StoppedState;
+    };
+
+    using Callback = std::function<void(const PlayerFrame &frame, Changes changes)>;
+
+    static UiUpdateScheduler* instance();
+
+    // Deliver player updates to widget until it is destroyed; the first
+    // visible frame carries AllChanges
+    void subscribe(QWidget *widget, Callback callback);
+
+    int frameIntervalMs() const { return m_frameIntervalMs; }
+
+    // "m:ss" for a player time
+    static QString formatTime(qint64 milliseconds);
+    // Show milliseconds on label, reformatting only when the whole second
+    // differs from shownSeconds (which is updated)
+    static void setTimeLabel(QLabel *label, qint64 milliseconds, qint64 &shownSeconds);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private slots:
+    void onPositionChanged(qint64 position);
+    void onDurationChanged(qint64 duration);
+    void onPlaybackStateChanged(QMediaPlayer::PlaybackState state);
+    void flush();
+
+private:
+    explicit UiUpdateScheduler(QObject *parent = nullptr);
+    ~UiUpdateScheduler();
+    UiUpdateScheduler(const UiUpdateScheduler&) = delete;
+    UiUpdateScheduler& operator=(const UiUpdateScheduler&) = delete;
+
+    struct Subscriber {
+        QPointer<QWidget> widget;
+        Callback callback;
+        Changes pending;
+    };
+
+    void markChanged(Change change);
+    void scheduleFlush();
+    static bool isOnScreen(const QWidget *widget);
+
+    static UiUpdateScheduler *s_instance;
+
+    QList<Subscriber> m_subscribers;
+    PlayerFrame m_frame;
+    Changes m_pending;
+    int m_frameIntervalMs;
+    QTimer m_timer;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(UiUpdateScheduler::Changes)
+
+#endif // UIUPDATESCHEDULER_H
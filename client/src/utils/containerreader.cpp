@@ -0,0 +1,51 @@
+#include "containerreader.h"
+
+qint64 ContainerReader::id3v2Size(QByteArrayView bytes)
+{
+    if (bytes.size() < 10 || !bytes.startsWith("ID3")) {
+        return 0;
+    }
+    const bool footer = u8(bytes, 3) >= 4 && (u8(bytes, 5) & 0x10);
+    return 10 + qint64(syncsafe32(bytes, 6)) + (footer ? 10 : 0);
+}
+
+bool ContainerReader::nextMp4Box(QByteArrayView data, qint64 &pos, QByteArrayView &type,
+                                 QByteArrayView &payload)
+{
+    if (pos + 8 > data.size()) {
+        return false;
+    }
+
+    qint64 size = be32(data, pos);
+    qint64 header = 8;
+    if (size == 1) {
+        if (pos + 16 > data.size()) {
+            return false;
+        }
+        size = qint64(be64(data, pos + 8));
+        header = 16;
+    } else if (size == 0) {
+        size = data.size() - pos;  // Runs to the end of the container
+    }
+    if (size < header || size > data.size() - pos) {
+        return false;
+    }
+
+    type = data.sliced(pos + 4, 4);
+    payload = data.sliced(pos + header, size - header);
+    pos += size;
+    return true;
+}
+
+QByteArrayView ContainerReader::findMp4Box(QByteArrayView data, QByteArrayView type)
+{
+    qint64 pos = 0;
+    QByteArrayView childType;
+    QByteArrayView payload;
+    while (nextMp4Box(data, pos, childType, payload)) {
+        if (childType == type) {
+            return payload;
+        }
+    }
+    return QByteArrayView();
+}
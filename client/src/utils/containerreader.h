@@ -0,0 +1,68 @@
+#ifndef CONTAINERREADER_H
+#define CONTAINERREADER_H
+
+#include <QByteArrayView>
+
+/**
+ * @brief Byte-level helpers shared by the audio container parsers
+ *
+ * Integer readers take a span and a position and do no bounds checking;
+ * callers check the span is long enough first. The structure helpers
+ * (ID3v2 tag size, MP4 box walking) do check, and stop at anything that
+ * would run past the end.
+ */
+class ContainerReader
+{
+public:
+    static quint32 u8(QByteArrayView bytes, qint64 pos)
+    {
+        return quint8(bytes[pos]);
+    }
+
+    static quint32 be16(QByteArrayView bytes, qint64 pos)
+    {
+        return (u8(bytes, pos) << 8) | u8(bytes, pos + 1);
+    }
+
+    static quint32 be24(QByteArrayView bytes, qint64 pos)
+    {
+        return (u8(bytes, pos) << 16) | be16(bytes, pos + 1);
+    }
+
+    static quint32 be32(QByteArrayView bytes, qint64 pos)
+    {
+        return (u8(bytes, pos) << 24) | be24(bytes, pos + 1);
+    }
+
+    static quint64 be64(QByteArrayView bytes, qint64 pos)
+    {
+        return (quint64(be32(bytes, pos)) << 32) | be32(bytes, pos + 4);
+    }
+
+    static quint32 le32(QByteArrayView bytes, qint64 pos)
+    {
+        return u8(bytes, pos) | (u8(bytes, pos + 1) << 8) | (u8(bytes, pos + 2) << 16)
+             | (u8(bytes, pos + 3) << 24);
+    }
+
+    // ID3v2 sizes carry 7 bits per byte
+    static quint32 syncsafe32(QByteArrayView bytes, qint64 pos)
+    {
+        return ((u8(bytes, pos) & 0x7F) << 21) | ((u8(bytes, pos + 1) & 0x7F) << 14)
+             | ((u8(bytes, pos + 2) & 0x7F) << 7) | (u8(bytes, pos + 3) & 0x7F);
+    }
+
+    // Size of the ID3v2 tag at the start of bytes (header and footer
+    // included), 0 if there is none
+    static qint64 id3v2Size(QByteArrayView bytes);
+
+    // Next MP4 box of a container at pos, advancing pos past it; false at
+    // the end or on a box whose size doesn't fit
+    static bool nextMp4Box(QByteArrayView data, qint64 &pos, QByteArrayView &type,
+                           QByteArrayView &payload);
+    // Payload of the first box of the given type among data's children,
+    // empty if there is none
+    static QByteArrayView findMp4Box(QByteArrayView data, QByteArrayView type);
+};
+
+#endif // CONTAINERREADER_H
@@ -0,0 +1,451 @@
+#include "jsonpullreader.h"
+#include <cstring>
+
+JsonPullReader::JsonPullReader(QByteArrayView data)
+    : m_pos(data.data())
+    , m_end(data.data() + data.size())
+    , m_error(false)
+    , m_firstInContainer(false)
+{
+}
+
+void JsonPullReader::skipWhitespace()
+{
+    while (m_pos < m_end) {
+        char c = *m_pos;
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            break;
+        }
+        ++m_pos;
+    }
+}
+
+bool JsonPullReader::expect(char c)
+{
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == c) {
+        ++m_pos;
+        return true;
+    }
+    m_error = true;
+    return false;
+}
+
+bool JsonPullReader::atEnd()
+{
+    skipWhitespace();
+    return m_pos >= m_end;
+}
+
+JsonPullReader::ValueType JsonPullReader::peek()
+{
+    skipWhitespace();
+    if (m_error || m_pos >= m_end) {
+        return ValueType::Invalid;
+    }
+
+    switch (*m_pos) {
+    case '{': return ValueType::Object;
+    case '[': return ValueType::Array;
+    case '"': return ValueType::String;
+    case 't':
+    case 'f': return ValueType::Bool;
+    case 'n': return ValueType::Null;
+    default:
+        if (*m_pos == '-' || (*m_pos >= '0' && *m_pos <= '9')) {
+            return ValueType::Number;
+        }
+        return ValueType::Invalid;
+    }
+}
+
+// ========== Containers ==========
+
+bool JsonPullReader::enterObject()
+{
+    if (peek() != ValueType::Object) {
+        skipValue();
+        return false;
+    }
+    ++m_pos;
+    m_firstInContainer = true;
+    return true;
+}
+
+bool JsonPullReader::nextKey(QByteArrayView &key)
+{
+    if (m_error) {
+        return false;
+    }
+
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == '}') {
+        ++m_pos;
+        m_firstInContainer = false;
+        return false;
+    }
+
+    if (!m_firstInContainer && !expect(',')) {
+        return false;
+    }
+    m_firstInContainer = false;
+
+    skipWhitespace();
+    if (m_pos >= m_end || *m_pos != '"') {
+        m_error = true;
+        return false;
+    }
+
+    QByteArrayView raw = scanString();
+    if (m_error || !expect(':')) {
+        return false;
+    }
+
+    // Strip the quotes
+    key = raw.sliced(1, raw.size() - 2);
+    return true;
+}
+
+bool JsonPullReader::enterArray()
+{
+    if (peek() != ValueType::Array) {
+        skipValue();
+        return false;
+    }
+    ++m_pos;
+    m_firstInContainer = true;
+    return true;
+}
+
+bool JsonPullReader::nextElement()
+{
+    if (m_error) {
+        return false;
+    }
+
+    skipWhitespace();
+    if (m_pos < m_end && *m_pos == ']') {
+        ++m_pos;
+        m_firstInContainer = false;
+        return false;
+    }
+
+    if (!m_firstInContainer && !expect(',')) {
+        return false;
+    }
+    m_firstInContainer = false;
+    return true;
+}
+
+bool JsonPullReader::findKey(QByteArrayView key)
+{
+    if (!enterObject()) {
+        return false;
+    }
+
+    QByteArrayView currentKey;
+    while (nextKey(currentKey)) {
+        if (currentKey == key) {
+            return true;
+        }
+        skipValue();
+    }
+    return false;
+}
+
+void JsonPullReader::leaveContainer()
+{
+    while (!m_error) {
+        skipWhitespace();
+        if (m_pos >= m_end) {
+            m_error = true;
+            return;
+        }
+
+        char c = *m_pos;
+        if (c == '}' || c == ']') {
+            ++m_pos;
+            m_firstInContainer = false;
+            return;
+        }
+        if (c == ',' || c == ':') {
+            ++m_pos;
+            continue;
+        }
+        skipValue();
+    }
+}
+
+// ========== Scalars ==========
+
+QString JsonPullReader::readString(const QString &defaultValue)
+{
+    if (peek() != ValueType::String) {
+        skipValue();
+        return defaultValue;
+    }
+
+    QByteArrayView raw = scanString();
+    m_firstInContainer = false;
+    if (m_error) {
+        return defaultValue;
+    }
+    return decodeString(raw.sliced(1, raw.size() - 2));
+}
+
+qint64 JsonPullReader::readInt(qint64 defaultValue)
+{
+    if (peek() != ValueType::Number) {
+        skipValue();
+        return defaultValue;
+    }
+
+    QByteArrayView number = scanNumber();
+    m_firstInContainer = false;
+
+    bool negative = false;
+    qint64 value = 0;
+    for (qsizetype i = 0; i < number.size(); ++i) {
+        char c = number[i];
+        if (c == '-' && i == 0) {
+            negative = true;
+        } else if (c >= '0' && c <= '9') {
+            value = value * 10 + (c - '0');
+        } else {
+            // Fractional or exponent form: fall back to the double parser
+            bool ok = false;
+            double d = number.toByteArray().toDouble(&ok);
+            return ok ? static_cast<qint64>(d) : defaultValue;
+        }
+    }
+    return negative ? -value : value;
+}
+
+double JsonPullReader::readDouble(double defaultValue)
+{
+    if (peek() != ValueType::Number) {
+        skipValue();
+        return defaultValue;
+    }
+
+    QByteArrayView number = scanNumber();
+    m_firstInContainer = false;
+
+    bool ok = false;
+    double value = number.toByteArray().toDouble(&ok);
+    return ok ? value : defaultValue;
+}
+
+bool JsonPullReader::readBool(bool defaultValue)
+{
+    if (peek() != ValueType::Bool) {
+        skipValue();
+        return defaultValue;
+    }
+
+    m_firstInContainer = false;
+    if (*m_pos == 't') {
+        return scanLiteral("true", 4) ? true : defaultValue;
+    }
+    return scanLiteral("false", 5) ? false : defaultValue;
+}
+
+// ========== Scanning ==========
+
+QByteArrayView JsonPullReader::skipValue()
+{
+    skipWhitespace();
+    m_firstInContainer = false;
+    if (m_error || m_pos >= m_end) {
+        m_error = true;
+        return QByteArrayView();
+    }
+
+    const char *start = m_pos;
+    char c = *m_pos;
+
+    if (c == '"') {
+        return scanString();
+    }
+
+    if (c == '{' || c == '[') {
+        // Depth scan; strings are skipped whole so brackets inside them don't count
+        int depth = 0;
+        while (m_pos < m_end) {
+            char ch = *m_pos;
+            if (ch == '"') {
+                scanString();
+                if (m_error) {
+                    return QByteArrayView();
+                }
+                continue;
+            }
+            if (ch == '{' || ch == '[') {
+                ++depth;
+            } else if (ch == '}' || ch == ']') {
+                if (--depth == 0) {
+                    ++m_pos;
+                    return QByteArrayView(start, m_pos - start);
+                }
+            }
+            ++m_pos;
+        }
+        m_error = true;
+        return QByteArrayView();
+    }
+
+    if (c == 't') {
+        scanLiteral("true", 4);
+    } else if (c == 'f') {
+        scanLiteral("false", 5);
+    } else if (c == 'n') {
+        scanLiteral("null", 4);
+    } else {
+        scanNumber();
+    }
+
+    return QByteArrayView(start, m_pos - start);
+}
+
+QByteArrayView JsonPullReader::scanString()
+{
+    // Cursor is on the opening quote; returns the span including both quotes
+    const char *start = m_pos;
+    ++m_pos;
+
+    while (m_pos < m_end) {
+        const char *quote = static_cast<const char *>(std::memchr(m_pos, '"', m_end - m_pos));
+        if (!quote) {
+            break;
+        }
+
+        // A quote is escaped if preceded by an odd number of backslashes
+        const char *backslash = quote;
+        while (backslash > m_pos && *(backslash - 1) == '\\') {
+            --backslash;
+        }
+        m_pos = quote + 1;
+        if (((quote - backslash) & 1) == 0) {
+            return QByteArrayView(start, m_pos - start);
+        }
+    }
+
+    m_pos = m_end;
+    m_error = true;
+    return QByteArrayView();
+}
+
+QByteArrayView JsonPullReader::scanNumber()
+{
+    const char *start = m_pos;
+    while (m_pos < m_end) {
+        char c = *m_pos;
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            ++m_pos;
+        } else {
+            break;
+        }
+    }
+
+    if (m_pos == start) {
+        m_error = true;
+    }
+    return QByteArrayView(start, m_pos - start);
+}
+
+bool JsonPullReader::scanLiteral(const char *literal, int length)
+{
+    if (m_end - m_pos < length || std::memcmp(m_pos, literal, length) != 0) {
+        m_error = true;
+        return false;
+    }
+    m_pos += length;
+    return true;
+}
+
+QString JsonPullReader::decodeString(QByteArrayView raw)
+{
+    // Fast path: no escapes, decode the UTF-8 bytes directly
+    if (!raw.contains('\\')) {
+        return QString::fromUtf8(raw);
+    }
+
+    QByteArray utf8;
+    utf8.reserve(raw.size());
+
+    auto appendCodePoint = [&utf8](uint cp) {
+        if (cp < 0x80) {
+            utf8.append(char(cp));
+        } else if (cp < 0x800) {
+            utf8.append(char(0xC0 | (cp >> 6)));
+            utf8.append(char(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            utf8.append(char(0xE0 | (cp >> 12)));
+            utf8.append(char(0x80 | ((cp >> 6) & 0x3F)));
+            utf8.append(char(0x80 | (cp & 0x3F)));
+        } else {
+            utf8.append(char(0xF0 | (cp >> 18)));
+            utf8.append(char(0x80 | ((cp >> 12) & 0x3F)));
+            utf8.append(char(0x80 | ((cp >> 6) & 0x3F)));
+            utf8.append(char(0x80 | (cp & 0x3F)));
+        }
+    };
+
+    auto parseHex4 = [&raw](qsizetype at, uint &out) {
+        if (at + 4 > raw.size()) {
+            return false;
+        }
+        out = 0;
+        for (qsizetype i = at; i < at + 4; ++i) {
+            char c = raw[i];
+            out <<= 4;
+            if (c >= '0' && c <= '9') out |= uint(c - '0');
+            else if (c >= 'a' && c <= 'f') out |= uint(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') out |= uint(c - 'A' + 10);
+            else return false;
+        }
+        return true;
+    };
+
+    for (qsizetype i = 0; i < raw.size(); ++i) {
+        char c = raw[i];
+        if (c != '\\' || i + 1 >= raw.size()) {
+            utf8.append(c);
+            continue;
+        }
+
+        char escaped = raw[++i];
+        switch (escaped) {
+        case 'b': utf8.append('\b'); break;
+        case 'f': utf8.append('\f'); break;
+        case 'n': utf8.append('\n'); break;
+        case 'r': utf8.append('\r'); break;
+        case 't': utf8.append('\t'); break;
+        case 'u': {
+            uint cp = 0;
+            if (!parseHex4(i + 1, cp)) {
+                break;
+            }
+            i += 4;
+
+            // Surrogate pair
+            if (cp >= 0xD800 && cp <= 0xDBFF && i + 6 < raw.size()
+                && raw[i + 1] == '\\' && raw[i + 2] == 'u') {
+                uint low = 0;
+                if (parseHex4(i + 3, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+            }
+            appendCodePoint(cp);
+            break;
+        }
+        default:
+            // \" \\ \/
+            utf8.append(escaped);
+            break;
+        }
+    }
+
+    return QString::fromUtf8(utf8);
+}
@@ -0,0 +1,88 @@
+#ifndef JSONPULLREADER_H
+#define JSONPULLREADER_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+
+/**
+ * @brief Forward-only, allocation-free JSON reader over a byte buffer
+ *
+ * Walks a JSON document in place instead of building a QJsonDocument DOM.
+ * Callers descend only into the members they need and skip the rest;
+ * skipped values cost a byte scan and no allocations. Strings are only
+ * materialized (as QString) when a caller asks for them.
+ *
+ * Typical use:
+ *   JsonPullReader reader(data);
+ *   if (reader.enterObject()) {
+ *       QByteArrayView key;
+ *       while (reader.nextKey(key)) {
+ *           if (key == "title") title = reader.readString();
+ *           else reader.skipValue();
+ *       }
+ *   }
+ *
+ * The buffer must outlive the reader. Object keys are returned raw
+ * (without unescaping), which is fine for the ASCII keys of API payloads.
+ */
+class JsonPullReader
+{
+public:
+    enum class ValueType {
+        Invalid,
+        Object,
+        Array,
+        String,
+        Number,
+        Bool,
+        Null
+    };
+
+    explicit JsonPullReader(QByteArrayView data);
+
+    // Type of the value at the cursor (does not consume it)
+    ValueType peek();
+
+    // Objects: enterObject() consumes '{', nextKey() yields keys until '}' is consumed
+    bool enterObject();
+    bool nextKey(QByteArrayView &key);
+
+    // Arrays: enterArray() consumes '[', nextElement() is true while a value follows
+    bool enterArray();
+    bool nextElement();
+
+    // Scalars (the default is returned on a type mismatch, which is then skipped)
+    QString readString(const QString &defaultValue = QString());
+    qint64 readInt(qint64 defaultValue = 0);
+    double readDouble(double defaultValue = 0.0);
+    bool readBool(bool defaultValue = false);
+
+    // Skip the value at the cursor, returning its raw bytes
+    QByteArrayView skipValue();
+
+    // Descend into the value of `key` within the object at the cursor,
+    // skipping every other member. Leaves the cursor on the value.
+    bool findKey(QByteArrayView key);
+
+    // Skip the remaining members/elements of the container the cursor is in
+    void leaveContainer();
+
+    bool hasError() const { return m_error; }
+    bool atEnd();
+
+private:
+    void skipWhitespace();
+    bool expect(char c);
+    QByteArrayView scanString();
+    QByteArrayView scanNumber();
+    bool scanLiteral(const char *literal, int length);
+    static QString decodeString(QByteArrayView raw);
+
+    const char *m_pos;
+    const char *m_end;
+    bool m_error;
+    bool m_firstInContainer;
+};
+
+#endif // JSONPULLREADER_H
@@ -0,0 +1,154 @@
+#include "mappedfile.h"
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QDebug>
+#include <iterator>
+
+#if defined(Q_OS_UNIX)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Expired registry entries are swept once the registry grows past this
+constexpr int kRegistrySweepSize = 256;
+
+struct Registry
+{
+    QMutex mutex;
+    QHash<QString, std::weak_ptr<const MappedFile>> files;
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+}
+
+// ========== Opening ==========
+
+MappedFilePtr MappedFile::open(const QString &filePath)
+{
+    const QFileInfo info(filePath);
+    if (!info.isFile()) {
+        qWarning() << "MappedFile: not a file:" << filePath;
+        return nullptr;
+    }
+
+    Registry &shared = registry();
+    QMutexLocker locker(&shared.mutex);
+
+    // Reuse a live mapping unless the file was rewritten since
+    if (MappedFilePtr existing = shared.files.value(filePath).lock()) {
+        if (existing->m_size == info.size() && existing->m_modified == info.lastModified()) {
+            return existing;
+        }
+    }
+
+    std::shared_ptr<MappedFile> file(new MappedFile(filePath));
+    if (!file->map()) {
+        return nullptr;
+    }
+
+    if (shared.files.size() >= kRegistrySweepSize) {
+        for (auto it = shared.files.begin(); it != shared.files.end();) {
+            it = it.value().expired() ? shared.files.erase(it) : std::next(it);
+        }
+    }
+    shared.files.insert(filePath, file);
+    return file;
+}
+
+MappedFile::MappedFile(const QString &filePath)
+    : m_filePath(filePath)
+    , m_file(filePath)
+    , m_data(nullptr)
+    , m_size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data && m_size > 0) {
+        m_file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+    }
+}
+
+bool MappedFile::map()
+{
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "MappedFile: cannot open" << m_filePath << m_file.errorString();
+        return false;
+    }
+
+    m_size = m_file.size();
+    m_modified = QFileInfo(m_file).lastModified();
+    if (m_size == 0) {
+        // Nothing to map; bytes() is a valid empty view
+        static const char kEmpty = '\0';
+        m_data = &kEmpty;
+        m_file.close();
+        return true;
+    }
+
+    uchar *data = m_file.map(0, m_size);
+    if (!data) {
+        qWarning() << "MappedFile: cannot map" << m_filePath << m_file.errorString();
+        return false;
+    }
+    m_data = reinterpret_cast<const char*>(data);
+
+    // The mapping outlives the descriptor; QFile only has to stay alive
+    // to unmap it
+    m_file.close();
+    return true;
+}
+
+// ========== Access ==========
+
+QByteArrayView MappedFile::span(qint64 offset, qint64 length) const
+{
+    if (offset < 0 || offset >= m_size || length <= 0) {
+        return QByteArrayView();
+    }
+    return QByteArrayView(m_data + offset, qMin(length, m_size - offset));
+}
+
+QByteArray MappedFile::rawData(qint64 offset, qint64 length) const
+{
+    const QByteArrayView view = span(offset, length);
+    return QByteArray::fromRawData(view.data(), view.size());
+}
+
+void MappedFile::advise(Access access, qint64 offset, qint64 length) const
+{
+#if defined(Q_OS_UNIX)
+    if (m_size == 0 || offset < 0 || offset >= m_size) {
+        return;
+    }
+    if (length < 0 || length > m_size - offset) {
+        length = m_size - offset;
+    }
+
+    // madvise wants a page-aligned start
+    static const qint64 pageSize = sysconf(_SC_PAGESIZE);
+    const qint64 alignedOffset = offset - offset % pageSize;
+    length += offset - alignedOffset;
+
+    int advice = MADV_NORMAL;
+    switch (access) {
+    case Access::Normal:     advice = MADV_NORMAL; break;
+    case Access::Sequential: advice = MADV_SEQUENTIAL; break;
+    case Access::Random:     advice = MADV_RANDOM; break;
+    case Access::WillNeed:   advice = MADV_WILLNEED; break;
+    }
+    madvise(const_cast<char*>(m_data) + alignedOffset, size_t(length), advice);
+#else
+    Q_UNUSED(access);
+    Q_UNUSED(offset);
+    Q_UNUSED(length);
+#endif
+}
@@ -0,0 +1,78 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QDateTime>
+#include <QFile>
+#include <QString>
+#include <memory>
+
+class MappedFile;
+using MappedFilePtr = std::shared_ptr<const MappedFile>;
+
+/**
+ * @brief Read-only memory mapping of a whole file, shared by all its readers
+ *
+ * open() maps a file once and hands the same mapping to everyone who asks
+ * for that file while it is in use (tag reader, playback device, ...), so
+ * no layer keeps its own copy of the bytes. Readers get QByteArrayView
+ * spans straight into the mapping; a span is valid for as long as the
+ * MappedFilePtr it came from is held.
+ *
+ * A mapping never changes after it is made and may be read from any
+ * thread. A file that changed on disk since it was mapped (size or
+ * modification time) is mapped again on the next open(); truncating a file
+ * that is still being read is not supported (reads past the new end fault
+ * on POSIX systems).
+ *
+ * advise() passes access pattern hints to the kernel (madvise); it is a
+ * no-op where the platform has no equivalent.
+ */
+class MappedFile
+{
+public:
+    enum class Access {
+        Normal,
+        Sequential,   // Streaming from start to end: read ahead aggressively
+        Random,       // Tag and header lookups: don't read ahead
+        WillNeed      // About to be read: start paging in now
+    };
+
+    // Shared mapping of filePath, nullptr (with a warning) if it cannot be
+    // opened; an empty file gives a valid, empty mapping
+    static MappedFilePtr open(const QString &filePath);
+
+    ~MappedFile();
+
+    QString filePath() const { return m_filePath; }
+    qint64 size() const { return m_size; }
+    QDateTime modified() const { return m_modified; }
+    bool isEmpty() const { return m_size == 0; }
+
+    // The whole file, or [offset, offset + length) clamped to the file
+    QByteArrayView bytes() const { return QByteArrayView(m_data, m_size); }
+    QByteArrayView span(qint64 offset, qint64 length) const;
+
+    // QByteArray over the mapping without copying (QByteArray::fromRawData),
+    // for APIs that take a QByteArray; must not outlive this MappedFile
+    QByteArray rawData(qint64 offset, qint64 length) const;
+
+    // Access pattern hint for a range (length < 0: to the end of the file)
+    void advise(Access access, qint64 offset = 0, qint64 length = -1) const;
+
+private:
+    MappedFile(const QString &filePath);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool map();
+
+    QString m_filePath;
+    QFile m_file;
+    const char *m_data;
+    qint64 m_size;
+    QDateTime m_modified;  // When the mapped version was written
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,48 @@
+#include "mappedfiledevice.h"
+#include <cstring>
+
+MappedFileDevice::MappedFileDevice(const MappedFilePtr &file, QObject *parent)
+    : MappedFileDevice(file, 0, parent)
+{
+}
+
+MappedFileDevice::MappedFileDevice(const MappedFilePtr &file, qint64 start, QObject *parent)
+    : QIODevice(parent)
+    , m_file(file)
+    , m_start(file ? qBound<qint64>(0, start, file->size()) : 0)
+{
+    if (m_file) {
+        m_file->advise(MappedFile::Access::Sequential, m_start);
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+}
+
+qint64 MappedFileDevice::size() const
+{
+    return m_file ? m_file->size() - m_start : 0;
+}
+
+bool MappedFileDevice::seek(qint64 pos)
+{
+    if (pos < 0 || pos > size()) {
+        return false;
+    }
+    return QIODevice::seek(pos);
+}
+
+qint64 MappedFileDevice::readData(char *data, qint64 maxSize)
+{
+    // span() is empty at the end of the file, which reads as 0 bytes
+    const QByteArrayView bytes = m_file->span(m_start + pos(), maxSize);
+    if (!bytes.isEmpty()) {
+        std::memcpy(data, bytes.data(), size_t(bytes.size()));
+    }
+    return bytes.size();
+}
+
+qint64 MappedFileDevice::writeData(const char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
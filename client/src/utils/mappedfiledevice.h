@@ -0,0 +1,45 @@
+#ifndef MAPPEDFILEDEVICE_H
+#define MAPPEDFILEDEVICE_H
+
+#include <QIODevice>
+#include "utils/mappedfile.h"
+
+/**
+ * @brief Random-access QIODevice over a MappedFile
+ *
+ * Lets QMediaPlayer::setSourceDevice() / QAudioDecoder::setSourceDevice()
+ * read from the shared mapping instead of opening the file a second time.
+ * The device is unbuffered, so the only copy is the one into the reader's
+ * own buffer. Opening it hints sequential access for the whole file.
+ *
+ * With a start offset the device shows only the file from there on
+ * (position 0 is byte start of the file), e.g. to hand a decoder a stream
+ * that begins at a known frame.
+ */
+class MappedFileDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    // Opens the device read-only; check isOpen() (fails if file is null)
+    explicit MappedFileDevice(const MappedFilePtr &file, QObject *parent = nullptr);
+    MappedFileDevice(const MappedFilePtr &file, qint64 start, QObject *parent = nullptr);
+
+    MappedFilePtr file() const { return m_file; }
+    qint64 start() const { return m_start; }
+
+    // QIODevice
+    bool isSequential() const override { return false; }
+    qint64 size() const override;
+    bool seek(qint64 pos) override;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    MappedFilePtr m_file;
+    qint64 m_start;  // File offset of device position 0
+};
+
+#endif // MAPPEDFILEDEVICE_H
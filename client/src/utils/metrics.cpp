@@ -0,0 +1,299 @@
+#include "metrics.h"
+#include <QJsonArray>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QNetworkReply>
+#include <QtAlgorithms>
+#include <QDebug>
+#include <atomic>
+#include <array>
+#include <chrono>
+
+namespace {
+// Bucket i holds values in [2^i, 2^(i+1)); 2^47 ns is about 39 hours
+constexpr int kBuckets = 48;
+constexpr int kMetricCount = Metrics::kMetricCount;
+
+const char *const kNames[] = {
+    "library.files_scanned",
+    "library.extract_ns",
+    "playback.stream_bytes",
+    "playback.decoded_frames",
+    "playback.decode_ns",
+    "playback.start_ns",
+    "network.http_latency_ns",
+    "network.http_errors",
+    "cache.thumbnail_hits",
+    "cache.thumbnail_misses",
+    "cache.cover_hits",
+    "cache.cover_misses",
+    "ui.downloaded_list_rebuilds",
+    "ui.downloaded_rows_built",
+    "ui.radio_list_updates"
+};
+static_assert(sizeof(kNames) / sizeof(kNames[0]) == kMetricCount, "one name per Metrics::Id");
+
+// One per recording thread; only the owning thread writes, so plain
+// load+store (no read-modify-write) is enough
+struct ThreadSlot {
+    std::atomic<bool> inUse;
+    std::atomic<quint64> counts[kMetricCount];
+    std::atomic<quint64> sums[kMetricCount];
+    std::atomic<quint64> buckets[kMetricCount][kBuckets];
+
+    ThreadSlot()
+        : inUse(true)
+    {
+        for (int i = 0; i < kMetricCount; ++i) {
+            counts[i].store(0, std::memory_order_relaxed);
+            sums[i].store(0, std::memory_order_relaxed);
+            for (int b = 0; b < kBuckets; ++b) {
+                buckets[i][b].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+QMutex &slotsMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+// Slots are never freed: a finished thread's totals stay in the snapshot
+// and its slot is handed to the next new thread
+QList<ThreadSlot*> &allSlots()
+{
+    static QList<ThreadSlot*> slots;
+    return slots;
+}
+
+ThreadSlot *acquireSlot()
+{
+    QMutexLocker locker(&slotsMutex());
+    for (ThreadSlot *slot : std::as_const(allSlots())) {
+        if (!slot->inUse.load(std::memory_order_relaxed)) {
+            slot->inUse.store(true, std::memory_order_relaxed);
+            return slot;
+        }
+    }
+
+    ThreadSlot *slot = new ThreadSlot();
+    allSlots().append(slot);
+    return slot;
+}
+
+struct SlotOwner {
+    ThreadSlot *slot;
+
+    SlotOwner() : slot(acquireSlot()) {}
+    ~SlotOwner()
+    {
+        QMutexLocker locker(&slotsMutex());
+        slot->inUse.store(false, std::memory_order_relaxed);
+    }
+};
+
+ThreadSlot &currentSlot()
+{
+    thread_local SlotOwner owner;
+    return *owner.slot;
+}
+
+inline void bump(std::atomic<quint64> &value, quint64 n)
+{
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline int bucketFor(quint64 value)
+{
+    if (value == 0) {
+        return 0;
+    }
+    return qMin(63 - int(qCountLeadingZeroBits(value)), kBuckets - 1);
+}
+
+inline quint64 bucketUpperBound(int bucket)
+{
+    return (quint64(1) << (bucket + 1)) - 1;
+}
+
+double ratio(quint64 hits, quint64 misses)
+{
+    return hits + misses > 0 ? double(hits) / double(hits + misses) : 0.0;
+}
+}
+
+// ========== Recording ==========
+
+const char *Metrics::name(Id id)
+{
+    return id < Id::Count ? kNames[int(id)] : "";
+}
+
+qint64 Metrics::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Metrics::add(Id id, quint64 n)
+{
+    ThreadSlot &slot = currentSlot();
+    bump(slot.counts[int(id)], 1);
+    bump(slot.sums[int(id)], n);
+}
+
+void Metrics::record(Id id, quint64 value)
+{
+    ThreadSlot &slot = currentSlot();
+    bump(slot.counts[int(id)], 1);
+    bump(slot.sums[int(id)], value);
+    bump(slot.buckets[int(id)][bucketFor(value)], 1);
+}
+
+void Metrics::watchReply(QNetworkReply *reply)
+{
+    if (!reply) {
+        return;
+    }
+
+    const qint64 startNs = nowNs();
+    QObject::connect(reply, &QNetworkReply::finished, reply, [reply, startNs]() {
+        record(Id::HttpLatencyNs, quint64(nowNs() - startNs));
+        if (reply->error() != QNetworkReply::NoError
+            && reply->error() != QNetworkReply::OperationCanceledError) {
+            add(Id::HttpErrors);
+        }
+    });
+}
+
+// ========== Snapshot ==========
+
+Metrics::Snapshot Metrics::snapshot()
+{
+    Snapshot result;
+    std::array<std::array<quint64, kBuckets>, kMetricCount> buckets{};
+
+    {
+        QMutexLocker locker(&slotsMutex());
+        for (const ThreadSlot *slot : std::as_const(allSlots())) {
+            for (int i = 0; i < kMetricCount; ++i) {
+                result.values[i].count += slot->counts[i].load(std::memory_order_relaxed);
+                result.values[i].sum += slot->sums[i].load(std::memory_order_relaxed);
+                for (int b = 0; b < kBuckets; ++b) {
+                    buckets[i][b] += slot->buckets[i][b].load(std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < kMetricCount; ++i) {
+        quint64 total = 0;
+        for (int b = 0; b < kBuckets; ++b) {
+            total += buckets[i][b];
+        }
+        if (total == 0) {
+            continue;  // Counter, or a histogram with no records
+        }
+
+        Value &value = result.values[i];
+        quint64 seen = 0;
+        for (int b = 0; b < kBuckets; ++b) {
+            if (buckets[i][b] == 0) {
+                continue;
+            }
+            seen += buckets[i][b];
+            if (value.p50 == 0 && seen * 2 >= total) {
+                value.p50 = bucketUpperBound(b);
+            }
+            if (value.p95 == 0 && seen * 100 >= total * 95) {
+                value.p95 = bucketUpperBound(b);
+            }
+            value.max = bucketUpperBound(b);
+        }
+    }
+
+    return result;
+}
+
+double Metrics::Snapshot::scanFilesPerSecond() const
+{
+    const Value &time = (*this)[Id::LibraryExtractNs];
+    return time.sum > 0 ? (*this)[Id::LibraryFilesScanned].sum / (time.sum / 1e9) : 0.0;
+}
+
+double Metrics::Snapshot::decodeFramesPerSecond() const
+{
+    // Frames per second of time spent draining the decoder on our side
+    const Value &time = (*this)[Id::DecodeNs];
+    return time.sum > 0 ? (*this)[Id::DecodedFrames].sum / (time.sum / 1e9) : 0.0;
+}
+
+double Metrics::Snapshot::httpLatencyMsP50() const
+{
+    return (*this)[Id::HttpLatencyNs].p50 / 1e6;
+}
+
+double Metrics::Snapshot::httpLatencyMsP95() const
+{
+    return (*this)[Id::HttpLatencyNs].p95 / 1e6;
+}
+
+double Metrics::Snapshot::thumbnailHitRatio() const
+{
+    return ratio((*this)[Id::ThumbnailHits].sum, (*this)[Id::ThumbnailMisses].sum);
+}
+
+double Metrics::Snapshot::coverHitRatio() const
+{
+    return ratio((*this)[Id::CoverHits].sum, (*this)[Id::CoverMisses].sum);
+}
+
+quint64 Metrics::Snapshot::uiRebuilds() const
+{
+    return (*this)[Id::DownloadedListRebuilds].sum + (*this)[Id::RadioListUpdates].sum;
+}
+
+QJsonObject Metrics::Snapshot::toJson() const
+{
+    QJsonObject metrics;
+    for (int i = 0; i < kMetricCount; ++i) {
+        const Value &value = values[i];
+        QJsonObject entry;
+        entry["count"] = double(value.count);
+        entry["sum"] = double(value.sum);
+        if (value.max > 0) {
+            entry["p50"] = double(value.p50);
+            entry["p95"] = double(value.p95);
+            entry["max"] = double(value.max);
+        }
+        metrics[kNames[i]] = entry;
+    }
+
+    QJsonObject derived;
+    derived["scan_files_per_s"] = scanFilesPerSecond();
+    derived["decode_frames_per_s"] = decodeFramesPerSecond();
+    derived["http_latency_ms_p50"] = httpLatencyMsP50();
+    derived["http_latency_ms_p95"] = httpLatencyMsP95();
+    derived["thumbnail_hit_ratio"] = thumbnailHitRatio();
+    derived["cover_hit_ratio"] = coverHitRatio();
+    derived["ui_rebuilds"] = double(uiRebuilds());
+
+    QJsonObject root;
+    root["metrics"] = metrics;
+    root["derived"] = derived;
+    return root;
+}
+
+void Metrics::logSnapshot()
+{
+    const Snapshot s = snapshot();
+    qDebug().nospace() << "Metrics: scan " << s.scanFilesPerSecond() << " files/s"
+                       << ", decode " << s.decodeFramesPerSecond() << " frames/s"
+                       << ", http p50/p95 " << s.httpLatencyMsP50() << "/" << s.httpLatencyMsP95() << " ms"
+                       << ", thumbnail hits " << s.thumbnailHitRatio()
+                       << ", cover hits " << s.coverHitRatio()
+                       << ", ui rebuilds " << s.uiRebuilds();
+}
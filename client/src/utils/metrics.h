@@ -0,0 +1,174 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QJsonObject>
+#include <QtGlobal>
+#include <array>
+
+class QNetworkReply;
+
+/**
+ * @brief Low-overhead counters, timers and histograms for hot paths
+ *
+ * Every thread records into its own slot of relaxed atomics (single
+ * writer, no locks, no allocation after the thread's first record);
+ * snapshot() sums all slots. Histograms use power-of-two buckets, so
+ * percentiles are approximate upper bounds.
+ *
+ * Use the EKNM_METRIC_* macros rather than the functions: they compile
+ * to nothing unless EKNM_METRICS_ENABLED is defined (CMake's
+ * ENABLE_METRICS, non-Release builds only), and individual categories
+ * can be compiled out with the EKNM_METRICS_CATEGORIES bit mask.
+ *
+ *   EKNM_METRIC_COUNT(LibraryFilesScanned, 1);
+ *   EKNM_METRIC_SCOPED_TIMER(LibraryExtractNs);
+ *   EKNM_METRIC_HTTP(reply);
+ */
+class Metrics
+{
+public:
+    enum class Category : quint32 {
+        Library  = 1u << 0,
+        Playback = 1u << 1,
+        Network  = 1u << 2,
+        Cache    = 1u << 3,
+        Ui       = 1u << 4
+    };
+
+    enum class Id : int {
+        // Library
+        LibraryFilesScanned,    // files whose metadata was extracted
+        LibraryExtractNs,       // time per extraction
+        // Playback
+        StreamBytes,            // compressed radio bytes received
+        DecodedFrames,          // PCM frames handed to the jitter buffer
+        DecodeNs,               // time per decoder buffer drain
+        PlaybackStartNs,        // play() of a loaded track to playing state
+        // Network
+        HttpLatencyNs,          // request start to finished
+        HttpErrors,
+        // Cache
+        ThumbnailHits,
+        ThumbnailMisses,
+        CoverHits,
+        CoverMisses,
+        // UI
+        DownloadedListRebuilds,
+        DownloadedRowsBuilt,
+        RadioListUpdates,
+        Count
+    };
+
+    static constexpr int kMetricCount = int(Id::Count);
+
+    struct Value {
+        quint64 count = 0;  // number of records
+        quint64 sum = 0;    // total of recorded values
+        quint64 p50 = 0;    // histograms only (bucket upper bound)
+        quint64 p95 = 0;
+        quint64 max = 0;
+    };
+
+    struct Snapshot {
+        std::array<Value, kMetricCount> values;
+
+        const Value &operator[](Id id) const { return values[int(id)]; }
+
+        // Derived figures (0 when nothing was recorded)
+        double scanFilesPerSecond() const;
+        double decodeFramesPerSecond() const;
+        double httpLatencyMsP50() const;
+        double httpLatencyMsP95() const;
+        double thumbnailHitRatio() const;
+        double coverHitRatio() const;
+        quint64 uiRebuilds() const;
+
+        QJsonObject toJson() const;
+    };
+
+    static constexpr Category categoryOf(Id id)
+    {
+        return id <= Id::LibraryExtractNs ? Category::Library
+             : id <= Id::PlaybackStartNs ? Category::Playback
+             : id <= Id::HttpErrors ? Category::Network
+             : id <= Id::CoverMisses ? Category::Cache
+             : Category::Ui;
+    }
+
+    static constexpr bool isCompiledIn(Id id)
+    {
+#if defined(EKNM_METRICS_ENABLED)
+#  if defined(EKNM_METRICS_CATEGORIES)
+        return (quint32(EKNM_METRICS_CATEGORIES) & quint32(categoryOf(id))) != 0;
+#  else
+        return true;
+#  endif
+#else
+        Q_UNUSED(id);
+        return false;
+#endif
+    }
+
+    static const char *name(Id id);
+
+    // Monotonic nanoseconds (arbitrary origin)
+    static qint64 nowNs();
+
+    // Counter: add n to the metric
+    static void add(Id id, quint64 n = 1);
+
+    // Histogram: record one value (nanoseconds for *Ns metrics)
+    static void record(Id id, quint64 value);
+
+    // Record HttpLatencyNs / HttpErrors when the reply finishes
+    static void watchReply(QNetworkReply *reply);
+
+    static Snapshot snapshot();
+
+    // Write a one-line summary of snapshot() to the debug log
+    static void logSnapshot();
+
+    template <bool Enabled>
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(Id) {}
+    };
+};
+
+template <>
+class Metrics::ScopedTimer<true>
+{
+public:
+    explicit ScopedTimer(Id id) : m_id(id), m_startNs(nowNs()) {}
+    ~ScopedTimer() { record(m_id, quint64(nowNs() - m_startNs)); }
+
+private:
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    Id m_id;
+    qint64 m_startNs;
+};
+
+#define EKNM_METRIC_CONCAT_INNER(a, b) a##b
+#define EKNM_METRIC_CONCAT(a, b) EKNM_METRIC_CONCAT_INNER(a, b)
+
+#if defined(EKNM_METRICS_ENABLED)
+#define EKNM_METRIC_COUNT(id, n) \
+    do { if constexpr (Metrics::isCompiledIn(Metrics::Id::id)) Metrics::add(Metrics::Id::id, quint64(n)); } while (0)
+#define EKNM_METRIC_RECORD(id, value) \
+    do { if constexpr (Metrics::isCompiledIn(Metrics::Id::id)) Metrics::record(Metrics::Id::id, quint64(value)); } while (0)
+#define EKNM_METRIC_SCOPED_TIMER(id) \
+    Metrics::ScopedTimer<Metrics::isCompiledIn(Metrics::Id::id)> \
+        EKNM_METRIC_CONCAT(metricTimer_, __LINE__)(Metrics::Id::id)
+#define EKNM_METRIC_HTTP(reply) \
+    do { if constexpr (Metrics::isCompiledIn(Metrics::Id::HttpLatencyNs)) Metrics::watchReply(reply); } while (0)
+#else
+#define EKNM_METRIC_COUNT(id, n) do {} while (0)
+#define EKNM_METRIC_RECORD(id, value) do {} while (0)
+#define EKNM_METRIC_SCOPED_TIMER(id) do {} while (0)
+#define EKNM_METRIC_HTTP(reply) do {} while (0)
+#endif
+
+#endif // METRICS_H
@@ -0,0 +1,121 @@
+#include "mpegframeheader.h"
+#include "containerreader.h"
+
+namespace {
+// ID3v1 tag at the end of an MP3 file
+constexpr qint64 kId3v1Size = 128;
+}
+
+MpegFrameHeader MpegFrameHeader::parse(QByteArrayView bytes, qint64 pos)
+{
+    static const int kBitrates[2][3][15] = {
+        {   // MPEG-1: layer I, II, III
+            { 0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448 },
+            { 0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384 },
+            { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 }
+        },
+        {   // MPEG-2 and 2.5: layer I, II, III
+            { 0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256 },
+            { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 },
+            { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 }
+        }
+    };
+    static const int kSampleRates[3] = { 44100, 48000, 32000 };
+
+    MpegFrameHeader header;
+    if (pos < 0 || pos + 4 > bytes.size()) {
+        return header;
+    }
+    const quint8 *data = reinterpret_cast<const quint8*>(bytes.data()) + pos;
+    if (data[0] != 0xFF || (data[1] & 0xE0) != 0xE0) {
+        return header;
+    }
+
+    const int version = (data[1] >> 3) & 0x03;      // 0: 2.5, 2: 2, 3: 1
+    const int layerBits = (data[1] >> 1) & 0x03;    // 1: III, 2: II, 3: I
+    const int bitrateIndex = data[2] >> 4;
+    const int rateIndex = (data[2] >> 2) & 0x03;
+    const int padding = (data[2] >> 1) & 0x01;
+    if (version == 1 || layerBits == 0 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) {
+        return header;
+    }
+
+    const int layer = 4 - layerBits;
+    header.mpeg1 = version == 3;
+    header.mono = (data[3] >> 6) == 3;
+    header.bitrateKbps = kBitrates[header.mpeg1 ? 0 : 1][layer - 1][bitrateIndex];
+    header.sampleRate = kSampleRates[rateIndex] >> (header.mpeg1 ? 0 : (version == 2 ? 1 : 2));
+
+    const int bitrate = header.bitrateKbps * 1000;
+    if (layer == 1) {
+        header.samplesPerFrame = 384;
+        header.frameBytes = (12 * bitrate / header.sampleRate + padding) * 4;
+    } else if (layer == 3 && !header.mpeg1) {
+        header.samplesPerFrame = 576;
+        header.frameBytes = 72 * bitrate / header.sampleRate + padding;
+    } else {
+        header.samplesPerFrame = 1152;
+        header.frameBytes = 144 * bitrate / header.sampleRate + padding;
+    }
+    return header;
+}
+
+qint64 MpegFrameHeader::findFirst(QByteArrayView bytes, qint64 from, qint64 end, qint64 searchBytes)
+{
+    end = qMin(end, bytes.size());
+    const qint64 searchEnd = searchBytes < 0 ? end - 4 : qMin(end - 4, from + searchBytes);
+    for (qint64 pos = qMax<qint64>(0, from); pos < searchEnd; ++pos) {
+        if (quint8(bytes[pos]) != 0xFF) {
+            continue;
+        }
+        const MpegFrameHeader header = parse(bytes, pos);
+        if (!header.isValid()) {
+            continue;
+        }
+        const qint64 next = pos + header.frameBytes;
+        if (next + 4 <= end && !parse(bytes, next).isValid()) {
+            continue;
+        }
+        return pos;
+    }
+    return -1;
+}
+
+qint64 MpegFrameHeader::streamEnd(QByteArrayView bytes, qint64 audioStart)
+{
+    const qint64 end = bytes.size();
+    if (end - audioStart >= kId3v1Size && bytes.sliced(end - kId3v1Size).startsWith("TAG")) {
+        return end - kId3v1Size;
+    }
+    return end;
+}
+
+bool MpegFrameHeader::isInfoFrame(QByteArrayView bytes, qint64 pos, const MpegFrameHeader &header)
+{
+    const qint64 tag = pos + header.sideInfoEnd();
+    if (tag + 4 > bytes.size()) {
+        return false;
+    }
+    const QByteArrayView id = bytes.sliced(tag, 4);
+    return id == "Xing" || id == "Info";
+}
+
+qint64 MpegFrameHeader::announcedFrames(QByteArrayView bytes, qint64 pos, const MpegFrameHeader &header)
+{
+    if (isInfoFrame(bytes, pos, header)) {
+        // "Xing"/"Info", flags; the frame count comes first when flagged
+        const qint64 flagsPos = pos + header.sideInfoEnd() + 4;
+        if (flagsPos + 8 > bytes.size() || !(ContainerReader::be32(bytes, flagsPos) & 0x01)) {
+            return -1;
+        }
+        return ContainerReader::be32(bytes, flagsPos + 4);
+    }
+
+    // Fraunhofer VBRI: always 32 bytes after the header; "VBRI", version,
+    // delay, quality, stream bytes, frame count
+    const qint64 vbri = pos + 4 + 32;
+    if (vbri + 18 > bytes.size() || bytes.sliced(vbri, 4) != "VBRI") {
+        return -1;
+    }
+    return ContainerReader::be32(bytes, vbri + 14);
+}
@@ -0,0 +1,43 @@
+#ifndef MPEGFRAMEHEADER_H
+#define MPEGFRAMEHEADER_H
+
+#include <QByteArrayView>
+
+/**
+ * @brief One MPEG audio (layer I-III) frame header
+ *
+ * parse() reads the four header bytes at a position of a byte span; the
+ * result is invalid if there is no frame sync there or the header uses
+ * reserved or free-format values (whose frame size can't be computed).
+ */
+struct MpegFrameHeader
+{
+    int bitrateKbps = 0;
+    int sampleRate = 0;
+    int frameBytes = 0;        // Whole frame, header included
+    int samplesPerFrame = 0;
+    bool mpeg1 = false;
+    bool mono = false;
+
+    bool isValid() const { return bitrateKbps > 0 && sampleRate > 0 && frameBytes > 0; }
+
+    // Offset of a Xing/Info tag in the frame: right after the side information
+    int sideInfoEnd() const { return 4 + (mpeg1 ? (mono ? 17 : 32) : (mono ? 9 : 17)); }
+
+    static MpegFrameHeader parse(QByteArrayView bytes, qint64 pos);
+
+    // First frame in [from, end) whose successor is a frame too, so stray
+    // sync bytes (in padding, say) are skipped; searches at most
+    // searchBytes (< 0: up to end), -1 if there is none
+    static qint64 findFirst(QByteArrayView bytes, qint64 from, qint64 end,
+                            qint64 searchBytes = -1);
+    // End of the frames of an MP3 file: before a trailing ID3v1 tag
+    static qint64 streamEnd(QByteArrayView bytes, qint64 audioStart);
+    // Whether the frame at pos carries a Xing/Info tag instead of audio
+    static bool isInfoFrame(QByteArrayView bytes, qint64 pos, const MpegFrameHeader &header);
+    // Audio frames announced by a Xing/Info or VBRI header in the frame at
+    // pos, -1 if it has none (or one without a frame count)
+    static qint64 announcedFrames(QByteArrayView bytes, qint64 pos, const MpegFrameHeader &header);
+};
+
+#endif // MPEGFRAMEHEADER_H
@@ -0,0 +1,60 @@
+#ifndef NETWORKFUTURE_H
+#define NETWORKFUTURE_H
+
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QNetworkReply>
+#include <QObject>
+#include <QPromise>
+#include <memory>
+#include <type_traits>
+
+/**
+ * @brief Turns a QNetworkReply into a cancellable QFuture
+ *
+ * fromReply() runs handler on context's thread once the reply has finished
+ * and makes its return value the future's result; the reply is deleted
+ * afterwards, so handlers only read from it.
+ *
+ * cancel() on the returned future is the cancellation token: it aborts the
+ * request and the handler never runs. The future is also canceled when
+ * context is destroyed before the reply finishes.
+ *
+ * Usage:
+ *   QFuture<QPixmap> art = NetworkFuture::fromReply(manager->get(request), this,
+ *       [](QNetworkReply *reply) { ... return pixmap; });
+ *   art.then(this, [this](const QPixmap &pixmap) { ... });
+ */
+class NetworkFuture
+{
+public:
+    template<typename Handler>
+    static auto fromReply(QNetworkReply *reply, QObject *context, Handler handler)
+        -> QFuture<std::invoke_result_t<Handler, QNetworkReply*>>
+    {
+        using Result = std::invoke_result_t<Handler, QNetworkReply*>;
+
+        // Shared with the finished handler; destroying an unfinished
+        // promise cancels its future
+        auto promise = std::make_shared<QPromise<Result>>();
+        promise->start();
+        QFuture<Result> future = promise->future();
+
+        // Owned by the reply, so it goes away with it
+        auto *watcher = new QFutureWatcher<Result>(reply);
+        QObject::connect(watcher, &QFutureWatcherBase::canceled, reply, &QNetworkReply::abort);
+        watcher->setFuture(future);
+
+        QObject::connect(reply, &QNetworkReply::finished, context, [promise, reply, handler]() {
+            reply->deleteLater();
+            if (!promise->isCanceled()) {
+                promise->addResult(handler(reply));
+            }
+            promise->finish();
+        });
+
+        return future;
+    }
+};
+
+#endif // NETWORKFUTURE_H
@@ -0,0 +1,105 @@
+#include "pcmringbuffer.h"
+#include <cstring>
+
+#if defined(Q_OS_UNIX)
+#include <sys/mman.h>
+#endif
+
+PcmRingBuffer::PcmRingBuffer(qint64 capacity)
+    : m_capacity(qMax<qint64>(1, capacity))
+    , m_data(new char[size_t(m_capacity)])
+    , m_locked(false)
+    , m_readPos(0)
+    , m_writePos(0)
+{
+    // Touch every page now rather than on the first write
+    std::memset(m_data.get(), 0, size_t(m_capacity));
+}
+
+PcmRingBuffer::~PcmRingBuffer()
+{
+    unlockMemory();
+}
+
+bool PcmRingBuffer::lockMemory()
+{
+#if defined(Q_OS_UNIX)
+    if (!m_locked) {
+        m_locked = mlock(m_data.get(), size_t(m_capacity)) == 0;
+    }
+#endif
+    return m_locked;
+}
+
+void PcmRingBuffer::unlockMemory()
+{
+#if defined(Q_OS_UNIX)
+    if (m_locked) {
+        munlock(m_data.get(), size_t(m_capacity));
+    }
+#endif
+    m_locked = false;
+}
+
+// ========== Positions ==========
+
+qint64 PcmRingBuffer::readable() const
+{
+    return m_writePos.load(std::memory_order_acquire) - m_readPos.load(std::memory_order_acquire);
+}
+
+qint64 PcmRingBuffer::writable() const
+{
+    return m_capacity - readable();
+}
+
+// ========== Transfer ==========
+
+qint64 PcmRingBuffer::write(const char *data, qint64 size)
+{
+    const qint64 writePos = m_writePos.load(std::memory_order_relaxed);
+    const qint64 readPos = m_readPos.load(std::memory_order_acquire);
+    const qint64 count = qMin(size, m_capacity - (writePos - readPos));
+    if (count <= 0) {
+        return 0;
+    }
+
+    // At most two pieces: up to the end of the storage, then from the start
+    const qint64 offset = writePos % m_capacity;
+    const qint64 first = qMin(count, m_capacity - offset);
+    std::memcpy(m_data.get() + offset, data, size_t(first));
+    std::memcpy(m_data.get(), data + first, size_t(count - first));
+
+    m_writePos.store(writePos + count, std::memory_order_release);
+    return count;
+}
+
+qint64 PcmRingBuffer::read(char *data, qint64 size)
+{
+    const qint64 readPos = m_readPos.load(std::memory_order_relaxed);
+    const qint64 writePos = m_writePos.load(std::memory_order_acquire);
+    const qint64 count = qMin(size, writePos - readPos);
+    if (count <= 0) {
+        return 0;
+    }
+
+    const qint64 offset = readPos % m_capacity;
+    const qint64 first = qMin(count, m_capacity - offset);
+    std::memcpy(data, m_data.get() + offset, size_t(first));
+    std::memcpy(data + first, m_data.get(), size_t(count - first));
+
+    m_readPos.store(readPos + count, std::memory_order_release);
+    return count;
+}
+
+qint64 PcmRingBuffer::discard(qint64 size)
+{
+    const qint64 readPos = m_readPos.load(std::memory_order_relaxed);
+    const qint64 writePos = m_writePos.load(std::memory_order_acquire);
+    const qint64 count = qMin(size, writePos - readPos);
+    if (count <= 0) {
+        return 0;
+    }
+    m_readPos.store(readPos + count, std::memory_order_release);
+    return count;
+}
@@ -0,0 +1,60 @@
+#ifndef PCMRINGBUFFER_H
+#define PCMRINGBUFFER_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief Fixed-size byte ring for one producer and one consumer thread
+ *
+ * All storage is allocated by the constructor; write() and read() only
+ * copy bytes and publish positions with atomics, so neither side ever
+ * allocates, locks or waits. That makes it safe on real-time audio threads
+ * (see AudioRenderThread).
+ *
+ * Positions grow monotonically and are reduced modulo the capacity on
+ * access, so a full ring is told apart from an empty one without wasting a
+ * byte. Only the consumer may call read() and discard(); only the producer
+ * may call write().
+ */
+class PcmRingBuffer
+{
+public:
+    explicit PcmRingBuffer(qint64 capacity);
+    ~PcmRingBuffer();
+    PcmRingBuffer(const PcmRingBuffer&) = delete;
+    PcmRingBuffer& operator=(const PcmRingBuffer&) = delete;
+
+    qint64 capacity() const { return m_capacity; }
+    qint64 readable() const;
+    qint64 writable() const;
+    // Bytes ever written / read: the producer's and the consumer's position
+    qint64 totalWritten() const { return m_writePos.load(std::memory_order_acquire); }
+    qint64 totalRead() const { return m_readPos.load(std::memory_order_acquire); }
+
+    // Producer: copies up to size bytes, returns how many fit
+    qint64 write(const char *data, qint64 size);
+    // Consumer: copies up to size bytes, returns how many were there
+    qint64 read(char *data, qint64 size);
+    // Consumer: drops up to size bytes, returns how many were dropped
+    qint64 discard(qint64 size);
+
+    // Pin the storage in RAM (mlock) so the audio path never page-faults;
+    // false where not permitted (RLIMIT_MEMLOCK) or not supported. The
+    // constructor already touched every page; locking keeps them resident
+    bool lockMemory();
+    void unlockMemory();  // Also done by the destructor
+
+private:
+    qint64 m_capacity;
+    std::unique_ptr<char[]> m_data;
+    bool m_locked;
+
+    // Each side owns one position; on separate cache lines so the two
+    // threads don't keep stealing the line from each other
+    alignas(64) std::atomic<qint64> m_readPos;
+    alignas(64) std::atomic<qint64> m_writePos;
+};
+
+#endif // PCMRINGBUFFER_H
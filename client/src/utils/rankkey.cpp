@@ -0,0 +1,219 @@
+#include "rankkey.h"
+#include <QDebug>
+
+namespace {
+// Ascending in ASCII, so byte-wise comparison of keys is numeric order
+constexpr char kDigits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+constexpr int kBase = 62;
+constexpr char kZero = '0';
+constexpr char kMaxDigit = 'z';
+
+int digitValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'A' && c <= 'Z') {
+        return c - 'A' + 10;
+    }
+    if (c >= 'a' && c <= 'z') {
+        return c - 'a' + 36;
+    }
+    return -1;
+}
+
+// The lowest integer part ("A" followed by 26 zeros) has nothing below it
+QByteArray smallestInteger()
+{
+    return QByteArray("A") + QByteArray(26, kZero);
+}
+}
+
+// ========== Key Structure ==========
+
+int RankKey::integerLength(char head)
+{
+    if (head >= 'a' && head <= 'z') {
+        return head - 'a' + 2;
+    }
+    if (head >= 'A' && head <= 'Z') {
+        return 'Z' - head + 2;
+    }
+    return -1;
+}
+
+bool RankKey::isValid(const QByteArray &key)
+{
+    if (key.isEmpty()) {
+        return false;
+    }
+
+    const int length = integerLength(key.at(0));
+    if (length < 0 || length > key.size()) {
+        return false;
+    }
+    if (key.left(length) == smallestInteger() && key.size() == length) {
+        return false;
+    }
+    for (int i = 1; i < key.size(); ++i) {
+        if (digitValue(key.at(i)) < 0) {
+            return false;
+        }
+    }
+
+    // A trailing zero would make "x0" and "x" distinct keys for one position
+    return key.size() == length || key.back() != kZero;
+}
+
+// ========== Arithmetic ==========
+
+QByteArray RankKey::midpoint(const QByteArray &a, const QByteArray &b)
+{
+    // Fractions in [0, 1): a is the lower bound (empty = 0), b the upper
+    // bound (empty = 1); both are free of trailing zeros
+    if (!b.isEmpty()) {
+        int common = 0;
+        while (common < b.size() && (common < a.size() ? a.at(common) : kZero) == b.at(common)) {
+            ++common;
+        }
+        if (common > 0) {
+            return b.left(common) + midpoint(a.mid(common), b.mid(common));
+        }
+    }
+
+    const int digitA = a.isEmpty() ? 0 : digitValue(a.at(0));
+    const int digitB = b.isEmpty() ? kBase : digitValue(b.at(0));
+    if (digitB - digitA > 1) {
+        return QByteArray(1, kDigits[(digitA + digitB + 1) / 2]);
+    }
+
+    // Consecutive first digits: b's first digit alone is already below b,
+    // otherwise keep a's first digit and go one level deeper
+    if (b.size() > 1) {
+        return b.left(1);
+    }
+    return QByteArray(1, kDigits[digitA]) + midpoint(a.mid(1), QByteArray());
+}
+
+QByteArray RankKey::incrementInteger(const QByteArray &integer)
+{
+    const char head = integer.at(0);
+    QByteArray digits = integer.mid(1);
+
+    bool carry = true;
+    for (int i = digits.size() - 1; carry && i >= 0; --i) {
+        const int value = digitValue(digits.at(i)) + 1;
+        if (value == kBase) {
+            digits[i] = kZero;
+        } else {
+            digits[i] = kDigits[value];
+            carry = false;
+        }
+    }
+    if (!carry) {
+        return head + digits;
+    }
+
+    // Overflowed the current length: move to the next head
+    if (head == 'Z') {
+        return QByteArray("a") + kZero;
+    }
+    if (head == 'z') {
+        return QByteArray();
+    }
+    const char nextHead = char(head + 1);
+    if (nextHead > 'a') {
+        digits.append(kZero);
+    } else {
+        digits.chop(1);
+    }
+    return nextHead + digits;
+}
+
+QByteArray RankKey::decrementInteger(const QByteArray &integer)
+{
+    const char head = integer.at(0);
+    QByteArray digits = integer.mid(1);
+
+    bool borrow = true;
+    for (int i = digits.size() - 1; borrow && i >= 0; --i) {
+        const int value = digitValue(digits.at(i)) - 1;
+        if (value < 0) {
+            digits[i] = kMaxDigit;
+        } else {
+            digits[i] = kDigits[value];
+            borrow = false;
+        }
+    }
+    if (!borrow) {
+        return head + digits;
+    }
+
+    if (head == 'a') {
+        return QByteArray("Z") + kMaxDigit;
+    }
+    if (head == 'A') {
+        return QByteArray();
+    }
+    const char nextHead = char(head - 1);
+    if (nextHead < 'Z') {
+        digits.append(kMaxDigit);
+    } else {
+        digits.chop(1);
+    }
+    return nextHead + digits;
+}
+
+// ========== Public API ==========
+
+QByteArray RankKey::between(const QByteArray &before, const QByteArray &after)
+{
+    if ((!before.isEmpty() && !isValid(before)) || (!after.isEmpty() && !isValid(after))) {
+        qWarning() << "Invalid rank key bound:" << before << after;
+        return QByteArray();
+    }
+    if (!before.isEmpty() && !after.isEmpty() && before >= after) {
+        qWarning() << "Rank key bounds out of order:" << before << after;
+        return QByteArray();
+    }
+
+    if (before.isEmpty()) {
+        if (after.isEmpty()) {
+            return QByteArray("a") + kZero;
+        }
+
+        const QByteArray integer = after.left(integerLength(after.at(0)));
+        const QByteArray fraction = after.mid(integer.size());
+        if (integer == smallestInteger()) {
+            return integer + midpoint(QByteArray(), fraction);
+        }
+        if (integer < after) {
+            return integer;
+        }
+        const QByteArray decremented = decrementInteger(integer);
+        if (decremented.isEmpty()) {
+            qWarning() << "Rank key space exhausted below" << after;
+        }
+        return decremented;
+    }
+
+    const QByteArray integerA = before.left(integerLength(before.at(0)));
+    const QByteArray fractionA = before.mid(integerA.size());
+
+    if (after.isEmpty()) {
+        const QByteArray incremented = incrementInteger(integerA);
+        return incremented.isEmpty() ? integerA + midpoint(fractionA, QByteArray()) : incremented;
+    }
+
+    const QByteArray integerB = after.left(integerLength(after.at(0)));
+    const QByteArray fractionB = after.mid(integerB.size());
+    if (integerA == integerB) {
+        return integerA + midpoint(fractionA, fractionB);
+    }
+
+    const QByteArray incremented = incrementInteger(integerA);
+    if (!incremented.isEmpty() && incremented < after) {
+        return incremented;
+    }
+    return integerA + midpoint(fractionA, QByteArray());
+}
@@ -0,0 +1,43 @@
+#ifndef RANKKEY_H
+#define RANKKEY_H
+
+#include <QByteArray>
+
+/**
+ * @brief Fractional order keys for user-ordered lists
+ *
+ * A rank key is a short ASCII string; list order is plain byte-wise
+ * comparison of the keys. Between any two distinct keys there is always
+ * room for another one, so moving an item only assigns it a new key and
+ * never renumbers its neighbours.
+ *
+ * Keys are an integer part, whose length is encoded by its first character
+ * ('a'..'z' grow upwards, 'A'..'Z' downwards), followed by an optional base
+ * 62 fraction without trailing zeros. Appending at either end increments
+ * the integer part, so a list built by appends stays at a handful of
+ * characters per key even at 100k entries; repeated inserts between the
+ * same two neighbours lengthen the fraction by about one character per six
+ * inserts.
+ */
+class RankKey
+{
+public:
+    // A key strictly between before and after; an empty bound is open-ended.
+    // Returns an empty key (with a warning) if the bounds are invalid or not
+    // in order.
+    static QByteArray between(const QByteArray &before, const QByteArray &after);
+
+    // Shorthands for appending and prepending
+    static QByteArray after(const QByteArray &key) { return between(key, QByteArray()); }
+    static QByteArray before(const QByteArray &key) { return between(QByteArray(), key); }
+
+    static bool isValid(const QByteArray &key);
+
+private:
+    static int integerLength(char head);
+    static QByteArray midpoint(const QByteArray &a, const QByteArray &b);
+    static QByteArray incrementInteger(const QByteArray &integer);
+    static QByteArray decrementInteger(const QByteArray &integer);
+};
+
+#endif // RANKKEY_H
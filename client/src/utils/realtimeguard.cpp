@@ -0,0 +1,255 @@
+#include "realtimeguard.h"
+#include <QDebug>
+#include <atomic>
+
+#if defined(EKNM_RT_CHECKS)
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#include <pthread.h>
+#endif
+#endif
+
+namespace {
+std::atomic<quint64> s_allocations{0};
+std::atomic<quint64> s_frees{0};
+std::atomic<quint64> s_locks{0};
+std::atomic<quint64> s_reportedTotal{0};
+
+#if defined(EKNM_RT_CHECKS)
+// Plain bool with a constant initializer: reading it from inside malloc
+// never allocates
+thread_local bool t_inScope = false;
+
+inline void noteAllocation()
+{
+    if (t_inScope) {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+inline void noteFree()
+{
+    if (t_inScope) {
+        s_frees.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+inline void noteLock()
+{
+    if (t_inScope) {
+        s_locks.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+#endif
+}
+
+// ========== Scope ==========
+
+#if defined(EKNM_RT_CHECKS)
+RealtimeGuard::Scope::Scope()
+    : m_outermost(!t_inScope)
+{
+    t_inScope = true;
+}
+
+RealtimeGuard::Scope::~Scope()
+{
+    if (m_outermost) {
+        t_inScope = false;
+    }
+}
+#endif
+
+bool RealtimeGuard::isEnabled()
+{
+#if defined(EKNM_RT_CHECKS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool RealtimeGuard::isInScope()
+{
+#if defined(EKNM_RT_CHECKS)
+    return t_inScope;
+#else
+    return false;
+#endif
+}
+
+// ========== Reporting ==========
+
+RealtimeGuard::Violations RealtimeGuard::violations()
+{
+    Violations violations;
+    violations.allocations = s_allocations.load(std::memory_order_relaxed);
+    violations.frees = s_frees.load(std::memory_order_relaxed);
+    violations.locks = s_locks.load(std::memory_order_relaxed);
+    return violations;
+}
+
+void RealtimeGuard::reset()
+{
+    s_allocations.store(0, std::memory_order_relaxed);
+    s_frees.store(0, std::memory_order_relaxed);
+    s_locks.store(0, std::memory_order_relaxed);
+    s_reportedTotal.store(0, std::memory_order_relaxed);
+}
+
+void RealtimeGuard::reportNew(const char *where)
+{
+    const Violations current = violations();
+    const quint64 total = current.total();
+    if (s_reportedTotal.exchange(total, std::memory_order_relaxed) < total) {
+        qWarning().nospace() << "RealtimeGuard: " << where << " on a real-time thread: "
+                             << current.allocations << " allocations, " << current.frees
+                             << " frees, " << current.locks << " blocking locks so far";
+    }
+}
+
+// ========== Interception ==========
+
+#if defined(EKNM_RT_CHECKS)
+#if defined(__GLIBC__)
+namespace {
+using MutexLockFunction = int (*)(pthread_mutex_t *);
+MutexLockFunction s_mutexLock = nullptr;
+thread_local bool t_resolving = false;
+
+MutexLockFunction realMutexLock()
+{
+    if (Q_UNLIKELY(!s_mutexLock) && !t_resolving) {
+        t_resolving = true;
+        s_mutexLock = reinterpret_cast<MutexLockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        t_resolving = false;
+    }
+    return s_mutexLock;
+}
+
+// Resolved while the process is still single-threaded
+__attribute__((constructor)) void resolveMutexLock()
+{
+    realMutexLock();
+}
+}
+
+// The allocator is reached through glibc's exported __libc_* entry points,
+// which don't go through these hooks again
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *pointer);
+
+void *malloc(size_t size)
+{
+    noteAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    noteAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size)
+{
+    noteAllocation();
+    return __libc_realloc(pointer, size);
+}
+
+void free(void *pointer)
+{
+    if (pointer) {
+        noteFree();
+    }
+    __libc_free(pointer);
+}
+
+int posix_memalign(void **result, size_t alignment, size_t size)
+{
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    noteAllocation();
+    void *pointer = __libc_memalign(alignment, size);
+    if (!pointer) {
+        return ENOMEM;
+    }
+    *result = pointer;
+    return 0;
+}
+
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    noteAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+int pthread_mutex_lock(pthread_mutex_t *mutex)
+{
+    noteLock();
+    // Null only if dlsym itself locks while it is being resolved, which
+    // happens before any other thread exists
+    const MutexLockFunction lock = realMutexLock();
+    return lock ? lock(mutex) : 0;
+}
+}
+#else
+// Without a way to reach the C allocator's internals, only C++
+// allocations are seen
+void *operator new(std::size_t size)
+{
+    noteAllocation();
+    if (void *pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    noteAllocation();
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    if (pointer) {
+        noteFree();
+    }
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+    operator delete(pointer);
+}
+#endif
+#endif
@@ -0,0 +1,72 @@
+#ifndef REALTIMEGUARD_H
+#define REALTIMEGUARD_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Catches allocations and blocking locks in real-time audio code
+ *
+ * Code that must never wait (the render callback of AudioRenderThread,
+ * the sink's pulls) runs inside a RealtimeGuard::Scope. In builds with
+ * ENABLE_RT_CHECKS (EKNM_RT_CHECKS) the process's allocator and mutex
+ * entry points are intercepted, and every call made on a thread while it
+ * is inside a Scope counts as a violation:
+ *
+ *  - glibc: malloc, calloc, realloc, free, posix_memalign, aligned_alloc
+ *    (which covers operator new/delete) and pthread_mutex_lock
+ *  - other platforms: operator new/delete only
+ *
+ * QMutex takes its uncontended path in user space, so it is only seen
+ * where it is built on pthread mutexes; real-time code uses lock-free
+ * structures instead (PcmRingBuffer, MediaClock::feed()).
+ *
+ * The hooks only bump atomic counters. violations() reads them and
+ * reportNew() logs what was added since its last call; both belong
+ * outside a Scope, as logging allocates. Without ENABLE_RT_CHECKS a Scope
+ * compiles to nothing and the counters stay at zero.
+ */
+class RealtimeGuard
+{
+public:
+    struct Violations
+    {
+        quint64 allocations = 0;
+        quint64 frees = 0;
+        quint64 locks = 0;
+
+        quint64 total() const { return allocations + frees + locks; }
+    };
+
+#if defined(EKNM_RT_CHECKS)
+    // Marks the calling thread as real-time for the Scope's lifetime
+    class Scope
+    {
+    public:
+        Scope();
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        bool m_outermost;
+    };
+#else
+    class Scope
+    {
+    public:
+        Scope() {}
+    };
+#endif
+
+    // Whether this build intercepts anything
+    static bool isEnabled();
+    static bool isInScope();
+
+    // Totals since startup or reset(), over all real-time threads
+    static Violations violations();
+    static void reset();
+    // Log the violations since the previous call, if there were any
+    static void reportNew(const char *where);
+};
+
+#endif // REALTIMEGUARD_H
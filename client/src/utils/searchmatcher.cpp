@@ -0,0 +1,17 @@
+#include "searchmatcher.h"
+
+SearchMatcher::SearchMatcher(const QString &query)
+    : m_query(query)
+    , m_matcher(m_query, Qt::CaseInsensitive)
+{
+}
+
+bool SearchMatcher::matches(const QString &title, const QString &artist, const QString &album) const
+{
+    if (m_query.isEmpty()) {
+        return true;
+    }
+    return m_matcher.indexIn(title) >= 0
+        || m_matcher.indexIn(artist) >= 0
+        || m_matcher.indexIn(album) >= 0;
+}
@@ -0,0 +1,26 @@
+#ifndef SEARCHMATCHER_H
+#define SEARCHMATCHER_H
+
+#include <QString>
+#include <QStringMatcher>
+
+/**
+ * @brief Case-insensitive substring match over title/artist/album
+ *
+ * Built once per query and reused for every candidate, so neither the
+ * query nor the candidate fields are lower-cased per comparison.
+ */
+class SearchMatcher
+{
+public:
+    explicit SearchMatcher(const QString &query);
+
+    bool isEmpty() const { return m_query.isEmpty(); }
+    bool matches(const QString &title, const QString &artist, const QString &album) const;
+
+private:
+    QString m_query;
+    QStringMatcher m_matcher;
+};
+
+#endif // SEARCHMATCHER_H
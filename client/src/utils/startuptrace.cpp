@@ -0,0 +1,171 @@
+#include "startuptrace.h"
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QDebug>
+#include <atomic>
+#include <chrono>
+
+namespace {
+constexpr const char *kTraceEnvVar = "EKNM_STARTUP_TRACE";
+
+// Captured during static initialisation, i.e. before main() runs
+const std::chrono::steady_clock::time_point kOrigin = std::chrono::steady_clock::now();
+
+std::atomic<bool> &enabledFlag()
+{
+    static std::atomic<bool> enabled(qEnvironmentVariableIsSet(kTraceEnvVar));
+    return enabled;
+}
+
+QMutex &eventsMutex()
+{
+    static QMutex mutex;
+    return mutex;
+}
+
+QList<StartupTrace::Event> &eventStore()
+{
+    static QList<StartupTrace::Event> events;
+    return events;
+}
+
+void append(const StartupTrace::Event &event)
+{
+    QMutexLocker locker(&eventsMutex());
+    eventStore().append(event);
+}
+
+quint64 currentThreadId()
+{
+    return quint64(quintptr(QThread::currentThreadId()));
+}
+}
+
+// ========== Span ==========
+
+StartupTrace::Span::Span(const char *name)
+    : m_name(name)
+    , m_startNs(isEnabled() ? nowNs() : -1)
+{
+}
+
+StartupTrace::Span::~Span()
+{
+    if (m_startNs >= 0) {
+        record(m_name, m_startNs, nowNs());
+    }
+}
+
+// ========== Recording ==========
+
+bool StartupTrace::isEnabled()
+{
+    return enabledFlag().load(std::memory_order_relaxed);
+}
+
+void StartupTrace::setEnabled(bool enabled)
+{
+    enabledFlag().store(enabled, std::memory_order_relaxed);
+}
+
+qint64 StartupTrace::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - kOrigin).count();
+}
+
+void StartupTrace::record(const char *name, qint64 startNs, qint64 endNs)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    Event event;
+    event.name = name;
+    event.phase = 'X';
+    event.startNs = startNs;
+    event.durationNs = qMax<qint64>(0, endNs - startNs);
+    event.threadId = currentThreadId();
+    append(event);
+}
+
+void StartupTrace::mark(const char *name)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    Event event;
+    event.name = name;
+    event.phase = 'i';
+    event.startNs = nowNs();
+    event.threadId = currentThreadId();
+    append(event);
+}
+
+QList<StartupTrace::Event> StartupTrace::events()
+{
+    QMutexLocker locker(&eventsMutex());
+    return eventStore();
+}
+
+void StartupTrace::clear()
+{
+    QMutexLocker locker(&eventsMutex());
+    eventStore().clear();
+}
+
+// ========== Export ==========
+
+bool StartupTrace::writeChromeTrace(const QString &filePath)
+{
+    const QList<Event> recorded = events();
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray traceEvents;
+    for (const Event &event : recorded) {
+        QJsonObject entry;
+        entry["name"] = QString::fromUtf8(event.name);
+        entry["cat"] = "startup";
+        entry["ph"] = QString(QChar::fromLatin1(event.phase));
+        entry["ts"] = event.startNs / 1000.0;  // Trace viewer wants microseconds
+        entry["pid"] = pid;
+        entry["tid"] = double(event.threadId);
+        if (event.phase == 'X') {
+            entry["dur"] = event.durationNs / 1000.0;
+        } else {
+            entry["s"] = "p";  // Process-wide instant marker
+        }
+        traceEvents.append(entry);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Cannot write startup trace to" << filePath;
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+void StartupTrace::flush()
+{
+    const QString filePath = qEnvironmentVariable(kTraceEnvVar);
+    if (filePath.isEmpty() || !isEnabled()) {
+        return;
+    }
+
+    if (writeChromeTrace(filePath)) {
+        qDebug() << "Startup trace written to" << filePath;
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Lightweight startup instrumentation
+ *
+ * Records named spans and instant markers with monotonic timestamps
+ * (nanoseconds since process start). Recording is off unless the
+ * EKNM_STARTUP_TRACE environment variable is set, in which case its
+ * value is the output path and flush() writes the events there as a
+ * Chrome trace-event JSON file (open it in chrome://tracing or Perfetto).
+ *
+ *   EKNM_STARTUP_TRACE=/tmp/eknm-startup.json ./EKNMusic
+ *
+ * Names must be string literals (or otherwise outlive the trace);
+ * they are stored by pointer to keep recording cheap. Safe to use from
+ * any thread.
+ */
+class StartupTrace
+{
+public:
+    // Records the enclosing scope as a complete span
+    class Span
+    {
+    public:
+        explicit Span(const char *name);
+        ~Span();
+
+    private:
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        const char *m_name;
+        qint64 m_startNs;
+    };
+
+    struct Event {
+        const char *name = nullptr;
+        char phase = 'X';       // 'X' complete span, 'i' instant marker
+        qint64 startNs = 0;
+        qint64 durationNs = 0;
+        quint64 threadId = 0;
+    };
+
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    // Monotonic nanoseconds since process start
+    static qint64 nowNs();
+
+    // Record a span measured by hand (for work that ends in another callback)
+    static void record(const char *name, qint64 startNs, qint64 endNs);
+
+    // Record an instant marker, e.g. "first-frame"
+    static void mark(const char *name);
+
+    static QList<Event> events();
+    static void clear();
+
+    // Write the recorded events as Chrome trace-event JSON
+    static bool writeChromeTrace(const QString &filePath);
+
+    // Write to $EKNM_STARTUP_TRACE if set (rewrites the whole file)
+    static void flush();
+};
+
+#endif // STARTUPTRACE_H